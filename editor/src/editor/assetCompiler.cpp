@@ -3,6 +3,7 @@
 #include "filesWatcher.h"
 #include "resource\resourceManager.h"
 #include "resource\converter.h"
+#include "resource\assetCooker.h"
 #include "core\concurrency\concurrency.h"
 #include "core\container\mpmc_bounded_queue.h"
 #include "core\serialization\jsonArchive.h"
@@ -105,6 +106,7 @@ namespace Cjing3D
 		void SetupAssets();
 		void ScanDirectory(const char* dir, U64 lastModTime);
 		bool Compile(const ResCompileTask& task);
+		bool CookResources();
 		ResourceManager::LoadHook::HookResult OnBeforeLoad(Resource* res);
 		void ProcessCompiledTasks();
 		void ProcessChangedFiles();
@@ -144,6 +146,7 @@ namespace Cjing3D
 			}
 
 			impl->mCompiledTasks.Enqueue(task);
+			Concurrency::AtomicDecrement(&impl->mPendingTasks);
 		}
 		return 0;
 	}
@@ -370,6 +373,33 @@ namespace Cjing3D
 		return ret;
 	}
 
+	bool AssetCompilerImpl::CookResources()
+	{
+		AssetCooker cooker(mFileSystem);
+		DynamicArray<IResConverter*> converters;
+		for (auto plugin : mConverterPlugins)
+		{
+			IResConverter* converter = plugin->CreateConverter();
+			converters.push(converter);
+			cooker.AddConverter(converter);
+		}
+
+		{
+			Concurrency::ScopedReadLock lock(mRWLock);
+			for (const auto& kvp : mResources) {
+				cooker.AddAsset(kvp.second.mResPath.c_str());
+			}
+		}
+
+		bool ret = cooker.Cook();
+		cooker.PrintReport();
+
+		for (int i = 0; i < mConverterPlugins.size(); i++) {
+			mConverterPlugins[i]->DestroyConverter(converters[i]);
+		}
+		return ret;
+	}
+
 	ResourceManager::LoadHook::HookResult AssetCompilerImpl::OnBeforeLoad(Resource* res)
 	{
 		// check res need to convert before load
@@ -463,7 +493,8 @@ namespace Cjing3D
 
 	void AssetCompilerImpl::OnFileChanged(const char* path)
 	{
-		if (StringUtils::StartsWithPrefix(path, COMPILED_PATH_NAME)) {
+		if (StringUtils::StartsWithPrefix(path, COMPILED_PATH_NAME) ||
+			StringUtils::StartsWithPrefix(path, AssetCooker::DEFAULT_CACHE_PATH)) {
 			return;
 		}
 
@@ -523,25 +554,15 @@ namespace Cjing3D
 		mImpl->ProcessChangedFiles();
 	}
 
-	void AssetCompiler::CompileResources()
+	bool AssetCompiler::CompileResources()
 	{
-		// TODO
-		// compile all resources
-		for (const auto& kvp : mImpl->mResources)
+		// wait for compiling tasks of loading resources, then cook all resources
+		while (mImpl->mPendingTasks > 0)
 		{
-			Path convertedPath;
-			if (!mImpl->CheckResourceNeedConvert(kvp.second.mResPath, &convertedPath)) {
-				continue;
-			}
-
-			ResCompileTask task;
-			task.mRes = nullptr;
-			task.mInPath = kvp.second.mResPath;
-			mImpl->mToCompileTasks.Enqueue(task);
-
-			Concurrency::AtomicIncrement(&mImpl->mPendingTasks);
-			mImpl->mCompileSemaphore.Signal(1);
+			mImpl->ProcessCompiledTasks();
+			Concurrency::YieldCPU();
 		}
+		return mImpl->CookResources();
 	}
 
 	Signal<void()>& AssetCompiler::GetOnListChanged()
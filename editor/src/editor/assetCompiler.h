@@ -15,7 +15,8 @@ namespace Cjing3D
 
 		void SetupAssets();
 		void Update(F32 deltaTime);
-		void CompileResources();
+		// cook all resources in batch, return false if any resource is failed
+		bool CompileResources();
 
 		Signal<void()>& GetOnListChanged();
 		
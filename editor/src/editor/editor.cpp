@@ -43,6 +43,10 @@ namespace Cjing3D
 
 	void GameEditor::PreInitialize()
 	{
+		if (mIsBatchCook) {
+			return;
+		}
+
 		RegisterWidget("MenuBar", CJING_MAKE_SHARED<EditorWidgetMenu>(*this));
 		//RegisterWidget("GameView", CJING_MAKE_SHARED<EditorWidgetGameView>(*this));
 		//RegisterWidget("SceneView", CJING_MAKE_SHARED<EditorWidgetSceneView>(*this));
@@ -58,6 +62,18 @@ namespace Cjing3D
 	{
 		MainComponent::Initialize();
 
+		// batch cook only requires asset compiler
+		if (mIsBatchCook)
+		{
+			mAssetCompiler = CJING_MAKE_UNIQUE<AssetCompiler>(*this);
+			mAssetCompiler->SetupAssets();
+			if (!mAssetCompiler->CompileResources()) {
+				Logger::Error("Failed to cook assets.");
+			}
+			GetEngine()->RequestExit();
+			return;
+		}
+
 		// creat imgui context
 		ImGuiRHI::Manager::CreateContext();
 
@@ -101,6 +117,13 @@ namespace Cjing3D
 
 	void GameEditor::Uninitialize()
 	{
+		if (mIsBatchCook)
+		{
+			mAssetCompiler.Reset();
+			MainComponent::Uninitialize();
+			return;
+		}
+
 		SaveEditorSetting();
 
 		mRegisteredMenuViews.clear();
@@ -36,6 +36,8 @@ namespace Cjing3D
 		void Update(F32 deltaTime)override;
 		void HandleSystemMessage(const Event& systemEvent);
 		void RequestExit();
+		// cook all assets in initialize without widgets and imgui, the engine should be headless
+		void SetBatchCook(bool isBatchCook) { mIsBatchCook = isBatchCook; }
 
 		void LoadEditorSetting();
 		void SaveEditorSetting();
@@ -56,6 +58,7 @@ namespace Cjing3D
 		bool mIsShowDemo = false;
 		bool mIsDockingEnable = false;
 		bool mIsDockingBegin = false;
+		bool mIsBatchCook = false;
 		EditorSettings mSettings;
 
 		HashMap<StringID, I32> mWidgetMap;
@@ -25,10 +25,16 @@ int WINAPI WinMain(
 	config.mTitle = "Cjing3D Editor";
 	config.mIsApp = false;
 
+	// "-cook": cook all assets and exit, runs headless without window and graphics device
+	const bool isBatchCook = lpCmdLine != nullptr && strstr(lpCmdLine, "-cook") != nullptr;
+	config.mIsHeadless = isBatchCook;
+
 	Win32::GameAppWin32 gameApp(hInstance);
 	gameApp.Run(config,
-		[](const SharedPtr<Engine> engine)->SharedPtr<MainComponent> {
-			return CJING_MAKE_SHARED<GameEditor>(engine);
+		[isBatchCook](const SharedPtr<Engine> engine)->SharedPtr<MainComponent> {
+			auto editor = CJING_MAKE_SHARED<GameEditor>(engine);
+			editor->SetBatchCook(isBatchCook);
+			return editor;
 		}
 	);
 
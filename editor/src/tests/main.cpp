@@ -4,7 +4,13 @@
 #include "core\platform\platform.h"
 #include "core\concurrency\jobsystem.h"
 #include "renderer\renderGraph\renderGraph.h"
+#include "renderer\renderGraph\transientAllocator.h"
 #include "renderer\renderImage.h"
+#include "renderer\renderQueue.h"
+#include "core\helper\timer.h"
+#include "core\helper\profiler.h"
+#include "gpu\gpu.h"
+#include "gpu\null\deviceNull.h"
 
 #define CATCH_CONFIG_RUNNER
 #include "catch\catch.hpp"
@@ -124,6 +130,576 @@ TEST_CASE("RenderGraphTest", "[Render]")
 	Logger::Info("RenderGraph test finished");
 }
 
+namespace
+{
+	// chain of passes, each pass reads the output of previous pass
+	void SetupChainRenderGraph(RenderGraph& graph, I32 passCount, U32 size)
+	{
+		GPU::TextureDesc desc;
+		desc.mWidth = size;
+		desc.mHeight = size;
+		desc.mFormat = GPU::FORMAT_R8G8B8A8_UNORM;
+
+		RenderGraphResource prevRes;
+		for (I32 i = 0; i < passCount; i++)
+		{
+			graph.AddCallbackRenderPass(
+				StaticString<32>().Sprintf("Pass%d", i).c_str(),
+				RenderGraphQueueFlag::RENDER_GRAPH_QUEUE_GRAPHICS_BIT,
+				[&](RenderGraphResBuilder& builder) {
+
+					if (prevRes) {
+						builder.ReadTexture(prevRes);
+					}
+					auto output = builder.CreateTexture(StaticString<32>().Sprintf("Output%d", i).c_str(), &desc);
+					prevRes = builder.AddRTV(output);
+
+					return [](RenderGraphResources& resources, GPU::CommandList& cmd) {};
+				}
+			);
+		}
+		graph.SetFinalResource(prevRes);
+	}
+
+	// a chain of passes, each pass also draws into its own scratch target
+	void SetupScratchRenderGraph(RenderGraph& graph, I32 passCount, U32 size)
+	{
+		GPU::TextureDesc desc;
+		desc.mWidth = size;
+		desc.mHeight = size;
+		desc.mFormat = GPU::FORMAT_R8G8B8A8_UNORM;
+
+		RenderGraphResource prevRes;
+		for (I32 i = 0; i < passCount; i++)
+		{
+			graph.AddCallbackRenderPass(
+				StaticString<32>().Sprintf("Pass%d", i).c_str(),
+				RenderGraphQueueFlag::RENDER_GRAPH_QUEUE_GRAPHICS_BIT,
+				[&](RenderGraphResBuilder& builder) {
+
+					if (prevRes) {
+						builder.ReadTexture(prevRes);
+					}
+					auto scratch = builder.CreateTexture(StaticString<32>().Sprintf("Scratch%d", i).c_str(), &desc);
+					builder.AddRTV(scratch);
+					auto output = builder.CreateTexture(StaticString<32>().Sprintf("Output%d", i).c_str(), &desc);
+					prevRes = builder.AddRTV(output);
+
+					return [](RenderGraphResources& resources, GPU::CommandList& cmd) {};
+				}
+			);
+		}
+		graph.SetFinalResource(prevRes);
+	}
+}
+
+TEST_CASE("RenderGraph compile cache", "[Render]")
+{
+	RenderGraph graph;
+	for (I32 frame = 0; frame < 4; frame++)
+	{
+		SetupChainRenderGraph(graph, 8, 256);
+		REQUIRE(graph.Compile());
+		graph.Clear();
+	}
+	REQUIRE(graph.GetCompileStats().mCompileCount == 4);
+	REQUIRE(graph.GetCompileStats().mCacheHitCount == 3);
+
+	// desc changed
+	SetupChainRenderGraph(graph, 8, 512);
+	REQUIRE(graph.Compile());
+	graph.Clear();
+	REQUIRE(graph.GetCompileStats().mCacheHitCount == 3);
+
+	// pass count changed
+	SetupChainRenderGraph(graph, 9, 512);
+	REQUIRE(graph.Compile());
+	graph.Clear();
+	REQUIRE(graph.GetCompileStats().mCacheHitCount == 3);
+
+	SetupChainRenderGraph(graph, 9, 512);
+	REQUIRE(graph.Compile());
+	graph.Clear();
+	REQUIRE(graph.GetCompileStats().mCacheHitCount == 4);
+	REQUIRE(graph.GetCompileStats().GetCacheHitRate() == Approx(4.0f / 7.0f));
+}
+
+TEST_CASE("TransientHeapAllocator", "[Render]")
+{
+	const U64 size = TransientHeapAllocator::PLACEMENT_ALIGNMENT * 4;
+	TransientHeapAllocator allocator;
+	I32 a = allocator.AddResource(0, size, 0, 1);
+	I32 b = allocator.AddResource(0, size, 1, 2);
+	I32 c = allocator.AddResource(0, size, 2, 3);
+	I32 d = allocator.AddResource(0, size / 2, 3, 3);
+	I32 e = allocator.AddResource(1, 100, 0, 3);
+	allocator.Build();
+
+	// a and c are not alive at the same time
+	REQUIRE(allocator.GetPlacement(a).mOffset == allocator.GetPlacement(c).mOffset);
+	REQUIRE(allocator.GetPlacement(a).mOffset != allocator.GetPlacement(b).mOffset);
+	REQUIRE(allocator.GetPlacement(d).mOffset == allocator.GetPlacement(b).mOffset);
+	REQUIRE(allocator.GetPlacement(e).mSize == TransientHeapAllocator::PLACEMENT_ALIGNMENT);
+	REQUIRE(allocator.GetHeapCount() == 2);
+	REQUIRE(allocator.GetHeapSize(0) == size * 2);
+	REQUIRE(allocator.GetResourceMemory() == size * 3 + size / 2 + TransientHeapAllocator::PLACEMENT_ALIGNMENT);
+	REQUIRE(allocator.GetHeapMemory() == size * 2 + TransientHeapAllocator::PLACEMENT_ALIGNMENT);
+}
+
+TEST_CASE("RenderGraph transient heaps", "[Render][GPU]")
+{
+	GPU::ScopedHeadlessDevice device;
+
+	// scratch targets and the final output are used in a single pass, so that they are placed in heaps,
+	// the other outputs are read by the next pass and are not transient
+	const U64 textureSize = GPU::GetTextureSize(GPU::FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 1);
+	{
+		RenderGraph graph;
+		for (I32 frame = 0; frame < 2; frame++)
+		{
+			SetupScratchRenderGraph(graph, 4, 256);
+			REQUIRE(graph.Compile());
+
+			auto memoryStats = graph.GetMemoryStats();
+			REQUIRE(memoryStats.mPlacedResourceCount == 5);
+			REQUIRE(memoryStats.mResourceMemory == textureSize * 5);
+			REQUIRE(memoryStats.mHeapMemory == textureSize * 2);
+
+			JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+			REQUIRE(graph.Execute(jobHandle));
+			JobSystem::Wait(&jobHandle);
+			REQUIRE(device->GetCurrentFrameStats().mValidationErrors == 0);
+
+			GPU::EndFrame();
+			graph.Clear();
+		}
+	}
+	REQUIRE(device->GetMemoryStats().mTransientHeapMemory == textureSize * 2);
+
+	// placed textures are aliased in the same render pass
+	GPU::TextureDesc desc;
+	desc.mWidth = 256;
+	desc.mHeight = 256;
+	desc.mFormat = GPU::FORMAT_R8G8B8A8_UNORM;
+	desc.mBindFlags = GPU::BIND_RENDER_TARGET;
+	GPU::TransientPlacement placement;
+	placement.mSize = textureSize;
+
+	GPU::RenderPassInfo passInfo;
+	passInfo.mTextures.push(GPU::CreateTransientTexture(&desc, &placement));
+	passInfo.mTextures.push(GPU::CreateTransientTexture(&desc, &placement));
+	GPU::CommandList* cmd = GPU::CreateCommandlist();
+	cmd->BeginRenderPass(passInfo);
+	cmd->EndRenderPass();
+	REQUIRE_FALSE(GPU::CompileCommandList(*cmd));
+	GPU::SubmitCommandLists();
+	REQUIRE(device->GetCurrentFrameStats().mValidationErrors == 1);
+
+	GPU::EndFrame();
+}
+
+namespace
+{
+	// a single pass draws in parallel recorders
+	void SetupParallelDrawRenderGraph(RenderGraph& graph, GPU::ResHandle pipeline, I32 recorderCount, I32 drawCount)
+	{
+		GPU::TextureDesc desc;
+		desc.mWidth = 256;
+		desc.mHeight = 256;
+		desc.mFormat = GPU::FORMAT_R8G8B8A8_UNORM;
+
+		RenderGraphResource output;
+		graph.AddCallbackRenderPass(
+			"ParallelDraw",
+			RenderGraphQueueFlag::RENDER_GRAPH_QUEUE_GRAPHICS_BIT,
+			[&](RenderGraphResBuilder& builder) {
+
+				output = builder.AddRTV(builder.CreateTexture("Output", &desc));
+
+				return [=](RenderGraphResources& resources, GPU::CommandList& cmd) {
+					cmd.BindPipelineState(pipeline);
+
+					auto recorders = resources.CreateParallelRecorders(recorderCount);
+					JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+					JobSystem::RunJobs(recorderCount, 1, [&](I32 index, JobSystem::JobGroupArgs* args, void* sharedMem) {
+						GPU::CommandList& recorder = *recorders[index];
+						const I32 begin = drawCount * index / recorderCount;
+						const I32 end = drawCount * (index + 1) / recorderCount;
+						for (I32 i = begin; i < end; i++) {
+							recorder.Draw(3, i);
+						}
+						return true;
+					}, 0, &jobHandle);
+					JobSystem::Wait(&jobHandle);
+				};
+			}
+		);
+		graph.SetFinalResource(output);
+	}
+}
+
+TEST_CASE("RenderGraph parallel recorders", "[Render][GPU]")
+{
+	GPU::ScopedHeadlessDevice device;
+
+	const U8 byteCode[4] = {};
+	GPU::ResHandle vs = GPU::CreateShader(GPU::SHADERSTAGES_VS, byteCode, sizeof(byteCode));
+	GPU::PipelineStateDesc pipelineDesc;
+	pipelineDesc.mVS = vs;
+	GPU::ResHandle pipeline = GPU::CreatePipelineState(&pipelineDesc);
+	{
+		RenderGraph graph;
+		SetupParallelDrawRenderGraph(graph, pipeline, 8, 1000);
+		REQUIRE(graph.Compile());
+
+		JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+		REQUIRE(graph.Execute(jobHandle));
+		JobSystem::Wait(&jobHandle);
+
+		// draws are recorded after the pipeline state in the frame binding set
+		auto frameStats = device->GetCurrentFrameStats();
+		REQUIRE(frameStats.mValidationErrors == 0);
+		REQUIRE(frameStats.mCompiledCommandLists == 1);
+		REQUIRE(frameStats.GetCommandCount(GPU::CommandType::DRAW) == 1000);
+
+		GPU::EndFrame();
+		graph.Clear();
+	}
+
+	GPU::DestroyResource(pipeline);
+	GPU::DestroyResource(vs);
+	GPU::EndFrame();
+}
+
+TEST_CASE("RenderGraph parallel recorders 50K draws", "[.][Render][GPU]")
+{
+	GPU::ScopedHeadlessDevice device;
+
+	const U8 byteCode[4] = {};
+	GPU::ResHandle vs = GPU::CreateShader(GPU::SHADERSTAGES_VS, byteCode, sizeof(byteCode));
+	GPU::PipelineStateDesc pipelineDesc;
+	pipelineDesc.mVS = vs;
+	GPU::ResHandle pipeline = GPU::CreatePipelineState(&pipelineDesc);
+	{
+		RenderGraph graph;
+		const I32 drawCount = 50000;
+		const I32 frameCount = 10;
+		for (I32 recorderCount : { 1, 2, 4, 8 })
+		{
+			F64 elapsed = 0.0;
+			for (I32 frame = 0; frame < frameCount; frame++)
+			{
+				SetupParallelDrawRenderGraph(graph, pipeline, recorderCount, drawCount);
+				graph.Compile();
+
+				const F64 time = Timer::GetAbsoluteTime();
+				JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+				graph.Execute(jobHandle);
+				JobSystem::Wait(&jobHandle);
+				elapsed += Timer::GetAbsoluteTime() - time;
+
+				GPU::EndFrame();
+				graph.Clear();
+			}
+			Logger::Print("[RenderGraph] %d draws, %d recorders: %.2fms/frame", drawCount, recorderCount, elapsed * 1000.0 / frameCount);
+		}
+	}
+
+	GPU::DestroyResource(pipeline);
+	GPU::DestroyResource(vs);
+	GPU::EndFrame();
+}
+
+namespace
+{
+	// depth -> async light culling -> lighting, graphics passes between them are independent of light culling
+	// and draw into their own scratch targets
+	void SetupAsyncComputeRenderGraph(RenderGraph& graph, I32 graphicsPassCount, I32 dispatchCount)
+	{
+		GPU::TextureDesc desc;
+		desc.mWidth = 256;
+		desc.mHeight = 256;
+		desc.mFormat = GPU::FORMAT_R8G8B8A8_UNORM;
+
+		RenderGraphResource depth;
+		graph.AddCallbackRenderPass(
+			"Depth",
+			RenderGraphQueueFlag::RENDER_GRAPH_QUEUE_GRAPHICS_BIT,
+			[&](RenderGraphResBuilder& builder) {
+				depth = builder.AddRTV(builder.CreateTexture("Depth", &desc));
+				return [](RenderGraphResources& resources, GPU::CommandList& cmd) {};
+			}
+		);
+
+		RenderGraphResource lightGrid;
+		graph.AddCallbackRenderPass(
+			"LightCulling",
+			RenderGraphQueueFlag::RENDER_GRAPH_QUEUE_ASYNC_COMPUTE_BIT,
+			[&](RenderGraphResBuilder& builder) {
+				builder.ReadTexture(depth);
+				builder.WriteTexture(builder.CreateTexture("CullingScratch", &desc));
+				lightGrid = builder.WriteTexture(builder.CreateTexture("LightGrid", &desc));
+				return [=](RenderGraphResources& resources, GPU::CommandList& cmd) {
+					for (I32 i = 0; i < dispatchCount; i++) {
+						cmd.Dispatch(1, 1, 1);
+					}
+				};
+			}
+		);
+
+		RenderGraphResource color = depth;
+		for (I32 i = 0; i < graphicsPassCount; i++)
+		{
+			graph.AddCallbackRenderPass(
+				StaticString<32>().Sprintf("Graphics%d", i).c_str(),
+				RenderGraphQueueFlag::RENDER_GRAPH_QUEUE_GRAPHICS_BIT,
+				[&](RenderGraphResBuilder& builder) {
+					builder.ReadTexture(color);
+					builder.AddRTV(builder.CreateTexture(StaticString<32>().Sprintf("GraphicsScratch%d", i).c_str(), &desc));
+					color = builder.AddRTV(builder.CreateTexture(StaticString<32>().Sprintf("Color%d", i).c_str(), &desc));
+					return [](RenderGraphResources& resources, GPU::CommandList& cmd) {};
+				}
+			);
+		}
+
+		RenderGraphResource output;
+		graph.AddCallbackRenderPass(
+			"Lighting",
+			RenderGraphQueueFlag::RENDER_GRAPH_QUEUE_GRAPHICS_BIT,
+			[&](RenderGraphResBuilder& builder) {
+				builder.ReadTexture(depth);
+				builder.ReadTexture(lightGrid);
+				builder.ReadTexture(color);
+				output = builder.AddRTV(builder.CreateTexture("Lighting", &desc));
+				return [](RenderGraphResources& resources, GPU::CommandList& cmd) {};
+			}
+		);
+		graph.SetFinalResource(output);
+	}
+}
+
+TEST_CASE("RenderGraph async compute", "[Render][GPU]")
+{
+	GPU::ScopedHeadlessDevice device;
+
+	const U64 textureSize = GPU::GetTextureSize(GPU::FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 1);
+	{
+		RenderGraph graph;
+		for (I32 frame = 0; frame < 2; frame++)
+		{
+			// light culling is hoisted right after depth: Depth, LightCulling, Graphics0, Graphics1, Lighting
+			SetupAsyncComputeRenderGraph(graph, 2, 16);
+			REQUIRE(graph.Compile());
+
+			// the scratch of light culling is alive until lighting waits for it, so that it is not 
+			// aliased with scratches of graphics passes executed concurrently
+			auto memoryStats = graph.GetMemoryStats();
+			REQUIRE(memoryStats.mPlacedResourceCount == 4);
+			REQUIRE(memoryStats.mHeapMemory == textureSize * 2);
+
+			JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+			REQUIRE(graph.Execute(jobHandle));
+			JobSystem::Wait(&jobHandle);
+
+			// light culling waits for depth, lighting waits for light culling
+			auto frameStats = device->GetCurrentFrameStats();
+			REQUIRE(frameStats.mValidationErrors == 0);
+			REQUIRE(frameStats.mSubmittedCommandLists == 5);
+			REQUIRE(frameStats.mQueueWaits == 2);
+
+			String timeline = graph.ExportTimeline();
+			REQUIRE(strstr(timeline.c_str(), "\"Async Compute\"") != nullptr);
+			REQUIRE(strstr(timeline.c_str(), "\"name\":\"LightCulling\",\"ph\":\"X\",\"pid\":0,\"tid\":1") != nullptr);
+			REQUIRE(strstr(timeline.c_str(), "\"pass\":4,\"waits\":[1]") != nullptr);
+
+			GPU::EndFrame();
+			graph.Clear();
+
+			// light culling is overlapped with graphics passes
+			auto queueTimeline = device->GetLastFrameTimeline();
+			REQUIRE(queueTimeline.size() == 5);
+			REQUIRE(GPU::GraphicsDeviceNull::GetQueueOverlap(Span(queueTimeline.data(), queueTimeline.size())) > 0);
+		}
+		REQUIRE(graph.GetCompileStats().mCacheHitCount == 1);
+	}
+
+	// the waited command list must be submitted before
+	GPU::CommandList* computeCmd = GPU::CreateCommandlist(GPU::COMMAND_LIST_ASYNC_COMPUTE);
+	GPU::CommandList* graphicsCmd = GPU::CreateCommandlist(GPU::COMMAND_LIST_GRAPHICS);
+	computeCmd->Dispatch(1, 1, 1);
+	computeCmd->Wait(*graphicsCmd);
+	GPU::SubmitCommandLists();
+	REQUIRE(device->GetCurrentFrameStats().mValidationErrors == 1);
+
+	GPU::EndFrame();
+}
+
+TEST_CASE("RenderGraph compile 50 passes", "[.][Render]")
+{
+	const I32 frameCount = 1000;
+	const I32 passCount = 50;
+
+	// structure changed every frame
+	RenderGraph graph;
+	F64 compileTime = 0.0;
+	for (I32 frame = 0; frame < frameCount; frame++)
+	{
+		SetupChainRenderGraph(graph, passCount, 256 + (frame & 1));
+		const F64 time = Timer::GetAbsoluteTime();
+		graph.Compile();
+		compileTime += Timer::GetAbsoluteTime() - time;
+		graph.Clear();
+	}
+	REQUIRE(graph.GetCompileStats().mCacheHitCount == 0);
+
+	// structure unchanged
+	RenderGraph cachedGraph;
+	F64 cachedCompileTime = 0.0;
+	for (I32 frame = 0; frame < frameCount; frame++)
+	{
+		SetupChainRenderGraph(cachedGraph, passCount, 256);
+		const F64 time = Timer::GetAbsoluteTime();
+		cachedGraph.Compile();
+		cachedCompileTime += Timer::GetAbsoluteTime() - time;
+		cachedGraph.Clear();
+	}
+	REQUIRE(cachedGraph.GetCompileStats().mCacheHitCount == frameCount - 1);
+
+	Logger::Print("[RenderGraph] %d passes, compile: %.1fus/frame, cached compile: %.1fus/frame, hit rate: %.2f",
+		passCount, compileTime * 1e6 / frameCount, cachedCompileTime * 1e6 / frameCount, 
+		cachedGraph.GetCompileStats().GetCacheHitRate());
+}
+
+namespace
+{
+	// batches of random states and depths, objects are added in order
+	void SetupRandomRenderQueue(RenderQueue& queue, U32 count, bool isTransparent)
+	{
+		U32 seed = 0x12345678;
+		auto Random = [&seed]() {
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			return seed;
+		};
+
+		queue.Clear();
+		queue.Reserve(count);
+		for (U32 i = 0; i < count; i++)
+		{
+			const U32 meshIndex = Random() % 1024;
+			queue.AddBatch().Setup(RENDERPASS_MAIN, meshIndex % 8, meshIndex % 64, meshIndex, i, (F32)(Random() % 10000) / 10000.0f, isTransparent);
+		}
+	}
+
+	bool IsRenderQueueSorted(const RenderQueue& queue)
+	{
+		const auto& batches = queue.GetBatches();
+		for (I32 i = 1; i < batches.size(); i++)
+		{
+			if (batches[i - 1].mSortKey > batches[i].mSortKey) {
+				return false;
+			}
+			// stable for the same keys
+			if (batches[i - 1].mSortKey == batches[i].mSortKey && batches[i - 1].mObjectIndex > batches[i].mObjectIndex) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST_CASE("RenderQueue sort", "[Render]")
+{
+	// opaque batches are grouped by states, then front to back in the same mesh
+	RenderQueue queue;
+	const F32 depths[] = { 0.5f, 0.1f, 0.9f, 0.3f };
+	for (U32 i = 0; i < 12; i++) {
+		queue.AddBatch().Setup(RENDERPASS_MAIN, i % 2, i % 3, i % 3, i, depths[i % 4], false);
+	}
+	queue.Sort();
+	REQUIRE(IsRenderQueueSorted(queue));
+
+	const auto& batches = queue.GetBatches();
+	U32 meshChanges = 0;
+	for (I32 i = 1; i < batches.size(); i++)
+	{
+		const RenderBatch& prev = batches[i - 1];
+		const RenderBatch& batch = batches[i];
+		if (prev.mMeshIndex != batch.mMeshIndex || prev.mObjectIndex % 2 != batch.mObjectIndex % 2) {
+			meshChanges++;
+		}
+		else {
+			REQUIRE(depths[prev.mObjectIndex % 4] <= depths[batch.mObjectIndex % 4]);
+		}
+	}
+	// 2 pipelines x 3 meshes
+	REQUIRE(meshChanges == 5);
+
+	// transparent batches are back to front
+	queue.Clear();
+	for (U32 i = 0; i < 12; i++) {
+		queue.AddBatch().Setup(RENDERPASS_MAIN, i % 2, i % 3, i % 3, i, (F32)i / 12.0f, true);
+	}
+	queue.Sort();
+	for (I32 i = 0; i < batches.size(); i++) {
+		REQUIRE(batches[i].mObjectIndex == 11 - i);
+	}
+
+	// radix sorts, large queues are sorted on job threads
+	const U32 counts[] = { RenderQueue::RADIX_SORT_THRESHOLD, RenderQueue::PARALLEL_SORT_THRESHOLD * 4 + 123 };
+	for (U32 count : counts)
+	{
+		for (bool isTransparent : { false, true })
+		{
+			SetupRandomRenderQueue(queue, count, isTransparent);
+			queue.Sort();
+			REQUIRE(queue.GetCount() == count);
+			REQUIRE(IsRenderQueueSorted(queue));
+
+			U64 objectSum = 0;
+			for (const RenderBatch& batch : queue.GetBatches()) {
+				objectSum += batch.mObjectIndex;
+			}
+			REQUIRE(objectSum == (U64)count * (count - 1) / 2);
+		}
+	}
+}
+
+TEST_CASE("RenderQueue sort 1M", "[.][Render]")
+{
+	const U32 count = 1000000;
+	const I32 frameCount = 10;
+
+	RenderQueue queue;
+	F64 sortTime = 0.0;
+	for (I32 frame = 0; frame < frameCount; frame++)
+	{
+		SetupRandomRenderQueue(queue, count, false);
+		const F64 time = Timer::GetAbsoluteTime();
+		queue.Sort();
+		sortTime += Timer::GetAbsoluteTime() - time;
+	}
+	REQUIRE(IsRenderQueueSorted(queue));
+
+	// comparison sort of the same batches
+	F64 stdSortTime = 0.0;
+	DynamicArray<RenderBatch> batches;
+	for (I32 frame = 0; frame < frameCount; frame++)
+	{
+		SetupRandomRenderQueue(queue, count, false);
+		batches = queue.GetBatches();
+		const F64 time = Timer::GetAbsoluteTime();
+		std::stable_sort(batches.begin(), batches.end(), [](const RenderBatch& a, const RenderBatch& b) {
+			return a.mSortKey < b.mSortKey;
+		});
+		stdSortTime += Timer::GetAbsoluteTime() - time;
+	}
+
+	Logger::Print("[RenderQueue] %u batches, radix sort: %.2fms, std::stable_sort: %.2fms",
+		count, sortTime * 1e3 / frameCount, stdSortTime * 1e3 / frameCount);
+}
+
 int main(int argc, char* argv[])
 {
 	// init logger
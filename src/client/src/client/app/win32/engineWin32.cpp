@@ -93,13 +93,23 @@ namespace Cjing3D::Win32
 		ResourceManager::Initialize(filesystem);
 
 		// init input system
-		mImpl->mInputSystem = CJING_NEW(Win32::InputManagerWin32);
-		mImpl->mInputSystem->Initialize(*mImpl->mGameWindowWin32);
+		if (mImpl->mGameWindowWin32 != nullptr)
+		{
+			mImpl->mInputSystem = CJING_NEW(Win32::InputManagerWin32);
+			mImpl->mInputSystem->Initialize(*mImpl->mGameWindowWin32);
+		}
 
-		// init renderer
+		// init renderer, headless app uses the null device
 		GPU::GPUSetupParams gpuSetupParams;
-		gpuSetupParams.mWindow = mImpl->mGameWindowWin32->GetHwnd();
-		gpuSetupParams.mIsFullscreen = mInitConfig.mIsFullScreen;
+		if (mImpl->mGameWindowWin32 != nullptr)
+		{
+			gpuSetupParams.mWindow = mImpl->mGameWindowWin32->GetHwnd();
+			gpuSetupParams.mIsFullscreen = mInitConfig.mIsFullScreen;
+		}
+		else
+		{
+			gpuSetupParams.mIsHeadless = true;
+		}
 		Renderer::Initialize(gpuSetupParams, mInitConfig.mIsApp ? true : false);
 
 		// load plugins
@@ -133,8 +143,11 @@ namespace Cjing3D::Win32
 		Renderer::Uninitialize();
 
 		// uninit input system
-		mImpl->mInputSystem->Uninitialize();
-		CJING_SAFE_DELETE(mImpl->mInputSystem);
+		if (mImpl->mInputSystem != nullptr)
+		{
+			mImpl->mInputSystem->Uninitialize();
+			CJING_SAFE_DELETE(mImpl->mInputSystem);
+		}
 
 		// uninit resource manager
 		ResourceManager::Uninitialize();
@@ -151,7 +164,7 @@ namespace Cjing3D::Win32
 	void EngineWin32::Update(Universe& universe, F32 dt)
 	{
 		// update input system
-		bool isActive = mImpl->mGameWindowWin32->IsWindowActive();
+		bool isActive = mImpl->mGameWindowWin32 != nullptr && mImpl->mGameWindowWin32->IsWindowActive();
 		if (isActive) {
 			mImpl->mInputSystem->Update(dt);
 		}
@@ -181,7 +194,9 @@ namespace Cjing3D::Win32
 
 	void EngineWin32::RequestExit()
 	{
-		mImpl->mGameWindowWin32->SetIsExiting(true);
+		if (mImpl->mGameWindowWin32 != nullptr) {
+			mImpl->mGameWindowWin32->SetIsExiting(true);
+		}
 	}
 
 	void EngineWin32::SetSystemEventQueue(const SharedPtr<EventQueue>& eventQueue)
@@ -88,8 +88,10 @@ namespace Cjing3D::Win32
 
 			// system event queue
 			mEventQueue = CJING_MAKE_SHARED<EventQueue>();
-			// create game window
-			mGameWindow = CJING_MAKE_SHARED<GameWindowWin32>(mHinstance, config.mTitle, mEventQueue, config);
+			// create game window, headless app has no window
+			if (!config.mIsHeadless) {
+				mGameWindow = CJING_MAKE_SHARED<GameWindowWin32>(mHinstance, config.mTitle, mEventQueue, config);
+			}
 			// create game engine
 			mEngine = CJING_MAKE_SHARED<EngineWin32>(mGameWindow, config);
 			mEngine->SetSystemEventQueue(mEventQueue);
@@ -118,6 +120,11 @@ namespace Cjing3D::Win32
 
 		void Update()
 		{
+			// headless app finishes its work in initialize
+			if (mGameWindow == nullptr) {
+				return;
+			}
+
 			while (mGameWindow->Tick())
 			{
 				if (mGameWindow->IsExiting()) {
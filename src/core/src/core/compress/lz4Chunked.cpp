@@ -0,0 +1,337 @@
+#include "lz4Chunked.h"
+#include "lz4.h"
+#include "core\container\dynamicArray.h"
+#include "core\concurrency\jobsystem.h"
+#include "core\helper\debug.h"
+#include "core\helper\profiler.h"
+
+namespace Cjing3D
+{
+namespace LZ4Chunked
+{
+	namespace
+	{
+		struct BlockTable
+		{
+			Header mHeader;
+			const U32* mBlockSizes = nullptr;
+			const U8* mBlockData = nullptr;
+			U64 mBlockDataSize = 0;
+		};
+
+		bool ParseBlockTable(const U8* src, U64 srcSize, BlockTable& table)
+		{
+			if (srcSize < sizeof(Header)) {
+				return false;
+			}
+
+			Memory::Memcpy(&table.mHeader, src, sizeof(Header));
+			const Header& header = table.mHeader;
+			if (header.mBlockSize == 0 || header.mBlockSize >= RAW_BLOCK_FLAG) {
+				return false;
+			}
+
+			const U64 expectedCount = (header.mDecompressedSize + header.mBlockSize - 1) / header.mBlockSize;
+			if (expectedCount != header.mBlockCount) {
+				return false;
+			}
+
+			const U64 tableSize = sizeof(Header) + (U64)header.mBlockCount * sizeof(U32);
+			if (srcSize < tableSize) {
+				return false;
+			}
+
+			table.mBlockSizes = (const U32*)(src + sizeof(Header));
+			table.mBlockData = src + tableSize;
+			table.mBlockDataSize = srcSize - tableSize;
+			return true;
+		}
+
+		// compute block offsets in compressed data
+		bool GetBlockOffsets(const BlockTable& table, DynamicArray<U64>& offsets)
+		{
+			offsets.resize(table.mHeader.mBlockCount);
+			U64 offset = 0;
+			for (U32 i = 0; i < table.mHeader.mBlockCount; i++)
+			{
+				offsets[i] = offset;
+				offset += table.mBlockSizes[i] & ~RAW_BLOCK_FLAG;
+			}
+			return offset <= table.mBlockDataSize;
+		}
+
+		bool DecompressBlock(const BlockTable& table, U32 blockIndex, U64 srcOffset, U8* dst)
+		{
+			const Header& header = table.mHeader;
+			const U32 blockSize = table.mBlockSizes[blockIndex];
+			const U32 compressedSize = blockSize & ~RAW_BLOCK_FLAG;
+			const U64 dstOffset = (U64)blockIndex * header.mBlockSize;
+			const U32 decompressedSize = (U32)std::min((U64)header.mBlockSize, header.mDecompressedSize - dstOffset);
+			const U8* blockSrc = table.mBlockData + srcOffset;
+
+			if (blockSize & RAW_BLOCK_FLAG)
+			{
+				if (compressedSize != decompressedSize) {
+					return false;
+				}
+				Memory::Memcpy(dst, blockSrc, decompressedSize);
+				return true;
+			}
+
+			const I32 ret = LZ4_decompress_safe((const char*)blockSrc, (char*)dst, (I32)compressedSize, (I32)decompressedSize);
+			return ret == (I32)decompressedSize;
+		}
+
+		static const U64 MAX_STREAM_SIZE = 0xFFFFFFFFull;
+		// max size of compressed blocks kept in memory at once
+		static const U64 MAX_BATCH_SIZE = 64 * 1024 * 1024;
+
+		bool SetupHeader(U64 size, const Options& options, Header& header, DynamicArray<U32>& blockSizes)
+		{
+			if (options.mBlockSize == 0 || options.mBlockSize > LZ4_MAX_INPUT_SIZE) {
+				return false;
+			}
+
+			const U64 blockCount = (size + options.mBlockSize - 1) / options.mBlockSize;
+			if (blockCount > MAX_STREAM_SIZE / sizeof(U32)) {
+				return false;
+			}
+
+			header.mBlockSize = options.mBlockSize;
+			header.mBlockCount = (U32)blockCount;
+			header.mDecompressedSize = size;
+			blockSizes.resize(header.mBlockCount);
+			if (header.mBlockCount > 0) {
+				Memory::Memset(blockSizes.data(), 0, header.mBlockCount * sizeof(U32));
+			}
+			return true;
+		}
+
+		// blocks are compressed in batches, each batch is compressed concurrently and then written
+		// in order, so only a batch of compressed blocks is kept in memory
+		template<typename WriteFunc>
+		bool CompressBlocks(const U8* data, U64 size, const Options& options, DynamicArray<U32>& blockSizes, const WriteFunc& writeBlock)
+		{
+			const U32 blockCount = blockSizes.size();
+			if (blockCount == 0) {
+				return true;
+			}
+
+			const U64 blockBound = (U64)LZ4_compressBound((I32)options.mBlockSize);
+			const U32 batchBlockCount = (U32)std::max(std::min(MAX_BATCH_SIZE / blockBound, (U64)blockCount), (U64)1);
+			DynamicArray<U8> batchBuffer;
+			batchBuffer.resize((U32)(batchBlockCount * blockBound));
+
+			auto compressBlock = [&](U32 blockIndex, U8* dst)
+			{
+				const U64 srcOffset = (U64)blockIndex * options.mBlockSize;
+				const I32 srcSize = (I32)std::min((U64)options.mBlockSize, size - srcOffset);
+				const I32 compressedSize = LZ4_compress_fast((const char*)data + srcOffset, (char*)dst, srcSize, (I32)blockBound, options.mAcceleration);
+
+				// store the raw block if it can not be compressed
+				if (compressedSize <= 0 || compressedSize >= srcSize)
+				{
+					Memory::Memcpy(dst, data + srcOffset, srcSize);
+					blockSizes[blockIndex] = (U32)srcSize | RAW_BLOCK_FLAG;
+				}
+				else
+				{
+					blockSizes[blockIndex] = (U32)compressedSize;
+				}
+			};
+
+			for (U32 batchBegin = 0; batchBegin < blockCount; batchBegin += batchBlockCount)
+			{
+				const U32 batchCount = std::min(batchBlockCount, blockCount - batchBegin);
+				if (options.mIsParallel && batchCount > 1 && JobSystem::IsInitialized())
+				{
+					JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+					JobSystem::RunJobs(batchCount, 1, [&](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+						compressBlock(batchBegin + jobIndex, batchBuffer.data() + (U64)jobIndex * blockBound);
+						return false;
+					}, 0, &jobHandle);
+					JobSystem::Wait(&jobHandle);
+				}
+				else
+				{
+					for (U32 i = 0; i < batchCount; i++) {
+						compressBlock(batchBegin + i, batchBuffer.data() + (U64)i * blockBound);
+					}
+				}
+
+				for (U32 i = 0; i < batchCount; i++)
+				{
+					const U32 blockSize = blockSizes[batchBegin + i] & ~RAW_BLOCK_FLAG;
+					if (!writeBlock(batchBuffer.data() + (U64)i * blockBound, blockSize)) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+	}
+
+	bool Compress(const U8* data, U64 size, MemoryStream& outputStream, const Options& options)
+	{
+		PROFILE_FUNCTION();
+		Header header;
+		DynamicArray<U32> blockSizes;
+		if (!SetupHeader(size, options, header, blockSizes)) {
+			return false;
+		}
+
+		const U64 tableSize = (U64)header.mBlockCount * sizeof(U32);
+		const U64 tableOffset = (U64)outputStream.Size() + sizeof(Header);
+		if (tableOffset + tableSize > MAX_STREAM_SIZE) {
+			return false;
+		}
+
+		// block table is filled after all blocks are compressed
+		outputStream.Write(header);
+		outputStream.Resize((U32)(tableOffset + tableSize));
+		const bool ret = CompressBlocks(data, size, options, blockSizes, [&outputStream](const U8* block, U32 blockSize) {
+			if ((U64)outputStream.Size() + blockSize > MAX_STREAM_SIZE) {
+				return false;
+			}
+			outputStream.Write(block, blockSize);
+			return true;
+		});
+		if (!ret) {
+			return false;
+		}
+
+		if (tableSize > 0) {
+			Memory::Memcpy(outputStream.data() + tableOffset, blockSizes.data(), (size_t)tableSize);
+		}
+		return true;
+	}
+
+	bool Compress(const U8* data, U64 size, File& file, const Options& options)
+	{
+		PROFILE_FUNCTION();
+		Header header;
+		DynamicArray<U32> blockSizes;
+		if (!SetupHeader(size, options, header, blockSizes)) {
+			return false;
+		}
+
+		// block table is written as zeros, and rewritten after all blocks are compressed
+		const size_t tableOffset = file.Tell() + sizeof(Header);
+		const size_t tableSize = (size_t)header.mBlockCount * sizeof(U32);
+		bool ret = file.Write(&header, sizeof(Header)) != 0;
+		if (ret && tableSize > 0) {
+			ret = file.Write(blockSizes.data(), tableSize) != 0;
+		}
+		if (!ret) {
+			return false;
+		}
+
+		ret = CompressBlocks(data, size, options, blockSizes, [&file](const U8* block, U32 blockSize) {
+			return file.Write(block, blockSize) != 0;
+		});
+		if (!ret) {
+			return false;
+		}
+
+		if (tableSize > 0)
+		{
+			const size_t endOffset = file.Tell();
+			ret = file.Seek(tableOffset) &&
+				file.Write(blockSizes.data(), tableSize) != 0 &&
+				file.Seek(endOffset);
+		}
+		return ret;
+	}
+
+	bool GetHeader(const U8* src, U64 srcSize, Header& header)
+	{
+		BlockTable table;
+		if (!ParseBlockTable(src, srcSize, table)) {
+			return false;
+		}
+		header = table.mHeader;
+		return true;
+	}
+
+	bool Decompress(const U8* src, U64 srcSize, U8* dst, U64 dstSize, bool isParallel)
+	{
+		PROFILE_FUNCTION();
+		BlockTable table;
+		if (!ParseBlockTable(src, srcSize, table) || table.mHeader.mDecompressedSize > dstSize) {
+			return false;
+		}
+
+		DynamicArray<U64> offsets;
+		if (!GetBlockOffsets(table, offsets)) {
+			return false;
+		}
+
+		const U32 blockCount = table.mHeader.mBlockCount;
+		volatile I32 failedCount = 0;
+		if (isParallel && blockCount > 1 && JobSystem::IsInitialized())
+		{
+			JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+			JobSystem::RunJobs(blockCount, 1, [&](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+				U8* blockDst = dst + (U64)jobIndex * table.mHeader.mBlockSize;
+				if (!DecompressBlock(table, jobIndex, offsets[jobIndex], blockDst)) {
+					Concurrency::AtomicIncrement(&failedCount);
+				}
+				return false;
+			}, 0, &jobHandle);
+			JobSystem::Wait(&jobHandle);
+		}
+		else
+		{
+			for (U32 i = 0; i < blockCount; i++)
+			{
+				if (!DecompressBlock(table, i, offsets[i], dst + (U64)i * table.mHeader.mBlockSize))
+				{
+					failedCount++;
+					break;
+				}
+			}
+		}
+
+		return failedCount == 0;
+	}
+
+	bool DecompressRange(const U8* src, U64 srcSize, U8* dst, U64 offset, U64 size)
+	{
+		PROFILE_FUNCTION();
+		BlockTable table;
+		if (!ParseBlockTable(src, srcSize, table)) {
+			return false;
+		}
+
+		const Header& header = table.mHeader;
+		if (size == 0 || offset > header.mDecompressedSize || size > header.mDecompressedSize - offset) {
+			return false;
+		}
+
+		DynamicArray<U64> offsets;
+		if (!GetBlockOffsets(table, offsets)) {
+			return false;
+		}
+
+		// decompress touched blocks into a temp block, then copy the overlapped part
+		DynamicArray<U8> blockData;
+		blockData.resize(header.mBlockSize);
+
+		const U32 firstBlock = (U32)(offset / header.mBlockSize);
+		const U32 lastBlock = (U32)((offset + size - 1) / header.mBlockSize);
+		for (U32 i = firstBlock; i <= lastBlock; i++)
+		{
+			if (!DecompressBlock(table, i, offsets[i], blockData.data())) {
+				return false;
+			}
+
+			const U64 blockBegin = (U64)i * header.mBlockSize;
+			const U64 copyBegin = std::max(offset, blockBegin);
+			const U64 copyEnd = std::min(offset + size, blockBegin + header.mBlockSize);
+			Memory::Memcpy(dst + (copyBegin - offset), blockData.data() + (copyBegin - blockBegin), (size_t)(copyEnd - copyBegin));
+		}
+
+		return true;
+	}
+}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "core\common\definitions.h"
+#include "core\helper\stream.h"
+#include "core\filesystem\file.h"
+
+namespace Cjing3D
+{
+	// LZ4 chunked container, data is split into independent blocks
+	// which could be compressed and decompressed concurrently.
+	// [Header][U32 blockSizes[blockCount]][block0][block1]...
+	namespace LZ4Chunked
+	{
+		static const U32 DEFAULT_BLOCK_SIZE = 256 * 1024;
+		static const U32 RAW_BLOCK_FLAG = 1u << 31;
+		// LZ4 could not expand data more than 255 times
+		static const U64 MAX_COMPRESSION_RATIO = 255;
+
+#pragma pack(1)
+		struct Header
+		{
+			U32 mBlockSize = DEFAULT_BLOCK_SIZE;
+			U32 mBlockCount = 0;
+			U64 mDecompressedSize = 0;
+		};
+#pragma pack()
+
+		struct Options
+		{
+			U32 mBlockSize = DEFAULT_BLOCK_SIZE;
+			// LZ4 acceleration, 1 is the best ratio, larger is faster
+			I32 mAcceleration = 1;
+			bool mIsParallel = true;
+		};
+
+		// output stream is limited to 4 GB, larger data should be compressed into file
+		bool Compress(const U8* data, U64 size, MemoryStream& outputStream, const Options& options = Options());
+		// blocks are compressed in batches and written to the file, the block table is written at last
+		bool Compress(const U8* data, U64 size, File& file, const Options& options = Options());
+		bool GetHeader(const U8* src, U64 srcSize, Header& header);
+		bool Decompress(const U8* src, U64 srcSize, U8* dst, U64 dstSize, bool isParallel = true);
+		// decompress blocks overlapped with [offset, offset + size) into dst
+		bool DecompressRange(const U8* src, U64 srcSize, U8* dst, U64 offset, U64 size);
+	}
+}
@@ -346,6 +346,7 @@ namespace Concurrency
 
 		void Sleep(ConditionMutex& lock, I32 timeout = INFINITE);
 		void Wakeup();
+		void WakeupAll();
 
 	private:
 		ConditionVariable(const ConditionVariable&) = delete;
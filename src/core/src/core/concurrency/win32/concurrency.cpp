@@ -709,6 +709,11 @@ namespace Concurrency
 		::WakeConditionVariable((CONDITION_VARIABLE*)mImplData);
 	}
 
+	void ConditionVariable::WakeupAll()
+	{
+		::WakeAllConditionVariable((CONDITION_VARIABLE*)mImplData);
+	}
+
 	ConditionMutex::ConditionMutex()
 	{
 		static_assert(sizeof(mImplData) >= sizeof(SRWLOCK), "Size is not enough");
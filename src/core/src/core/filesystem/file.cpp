@@ -166,10 +166,21 @@ namespace Cjing3D
 
 		bool Write(const void* buffer, size_t bytes)override
 		{
-			size_t written = 0;
+			// WriteFile writes at most 4 GB at once
+			const size_t MAX_WRITE_SIZE = 1u << 30;
 			const U8* writeBuffer = static_cast<const U8*>(buffer);
-			BOOL success = ::WriteFile(mHandle, writeBuffer, (DWORD)bytes, (LPDWORD)&written, nullptr);
-			return success && bytes == written;
+			while (bytes > 0)
+			{
+				const DWORD writeSize = (DWORD)std::min(bytes, MAX_WRITE_SIZE);
+				DWORD written = 0;
+				BOOL success = ::WriteFile(mHandle, writeBuffer, writeSize, &written, nullptr);
+				if (!success || written != writeSize) {
+					return false;
+				}
+				writeBuffer += writeSize;
+				bytes -= writeSize;
+			}
+			return true;
 		}
 
 		bool Seek(size_t offset)override
@@ -205,6 +216,7 @@ namespace Cjing3D
 			{
 				::FlushFileBuffers(mHandle);
 				::CloseHandle(mHandle);
+				mHandle = INVALID_HANDLE_VALUE;
 			}
 		}
 
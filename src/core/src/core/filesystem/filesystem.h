@@ -36,5 +36,10 @@ namespace Cjing3D
 		virtual U64  GetLastModTime(const char* path) = 0;
 		virtual bool MoveFile(const char* from, const char* to) = 0;
 		virtual DynamicArray<String> EnumerateFiles(const char* path, int mask = EnumrateMode_ALL) = 0;
+
+		// ReadFile, GetFileLocation and PrefetchRange are called from io threads concurrently
+		// physical location of the file in the underlying storage, used to order and prefetch reads
+		virtual bool GetFileLocation(const char* path, U64& offset, U64& size) { return false; }
+		virtual void PrefetchRange(U64 offset, U64 size) {}
 	};
 }
\ No newline at end of file
@@ -112,8 +112,9 @@ namespace Cjing3D {
 		MaxPathString fullpath(mBasePath, path);
 		if (auto file = File(fullpath, FileFlags::DEFAULT_READ))
 		{
+			// each read opens its own handle, so reads are safe from io threads
 			size_t size = file.Size();
-			data.reserve(size);
+			data.resize((U32)size);
 			size_t readed = file.Read(data.data(), size);
 			return readed == size;
 		}
@@ -142,8 +143,8 @@ namespace Cjing3D {
 
 		if (auto file = File(fullpath, FileFlags::DEFAULT_WRITE))
 		{
-			size_t wrote = file.Write(buffer, length);
-			return wrote == length;
+			// File::Write returns the result of FileImpl::Write, not the written size
+			return file.Write(buffer, length) != 0;
 		}
 		return false;
 	}
@@ -0,0 +1,592 @@
+#include "filesystem_pack.h"
+#include "core\compress\lz4Chunked.h"
+#include "core\helper\debug.h"
+#include "core\helper\profiler.h"
+#include "core\memory\memory.h"
+#include "core\string\stringUtils.h"
+
+#include <algorithm>
+
+namespace Cjing3D
+{
+	const U32 PackHeader::MAGIC = 0x4B415043; // 'CPAK'
+
+	namespace
+	{
+		U64 AlignPackOffset(U64 offset)
+		{
+			return (offset + PACK_ALIGNMENT - 1) & ~(PACK_ALIGNMENT - 1);
+		}
+
+		bool WritePadding(File& file, U64 currentOffset, U64 targetOffset)
+		{
+			static const U8 zeros[PACK_ALIGNMENT] = { 0 };
+			const size_t paddingSize = (size_t)(targetOffset - currentOffset);
+			return paddingSize == 0 || file.Write(zeros, paddingSize) != 0;
+		}
+
+		// file which owns the decompressed entry data
+		class PackBufferFile : public FileImpl
+		{
+		private:
+			U8* mData = nullptr;
+			size_t mSize = 0;
+			size_t mPos = 0;
+			MaxPathString mPath;
+
+		public:
+			PackBufferFile(U8* data, size_t size, const char* path) :
+				mData(data),
+				mSize(size),
+				mPath(path)
+			{
+			}
+
+			~PackBufferFile()
+			{
+				Close();
+			}
+
+			bool Read(void* buffer, size_t bytes)override
+			{
+				const size_t copySize = std::min(mSize - mPos, bytes);
+				Memory::Memcpy(buffer, mData + mPos, copySize);
+				mPos += copySize;
+				return copySize > 0;
+			}
+
+			bool Write(const void* buffer, size_t bytes)override
+			{
+				return false;
+			}
+
+			bool Seek(size_t offset)override
+			{
+				if (offset < mSize)
+				{
+					mPos = offset;
+					return true;
+				}
+				return false;
+			}
+
+			size_t Tell() const override {
+				return mPos;
+			}
+
+			size_t Size() const override {
+				return mSize;
+			}
+
+			FileFlags GetFlags() const override {
+				return FileFlags::READ;
+			}
+
+			bool IsValid() const override {
+				return mData != nullptr;
+			}
+
+			void Close()override
+			{
+				if (mData != nullptr)
+				{
+					CJING_FREE(mData);
+					mData = nullptr;
+				}
+			}
+
+			const char* GetPath() const override {
+				return mPath.c_str();
+			}
+		};
+	}
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// PackFileBuilder
+	PackFileBuilder::PackFileBuilder()
+	{
+	}
+
+	PackFileBuilder::~PackFileBuilder()
+	{
+		Clear();
+	}
+
+	bool PackFileBuilder::AddFile(const char* path, const U8* data, U64 size, bool compress)
+	{
+		Path entryPath(path);
+		if (entryPath.IsEmpty()) {
+			return false;
+		}
+
+		for (const BuildEntry* entry : mEntries)
+		{
+			if (entry->mPath == entryPath)
+			{
+				Logger::Warning("[Pack] Duplicate file \"%s\"", path);
+				return false;
+			}
+		}
+
+		BuildEntry* entry = CJING_NEW(BuildEntry);
+		entry->mPath = entryPath;
+		entry->mDecompressedSize = size;
+
+		if (compress && size > 0)
+		{
+			LZ4Chunked::Options options;
+			options.mAcceleration = mCompressAcceleration;
+			if (LZ4Chunked::Compress(data, size, entry->mData, options) &&
+				(F32)entry->mData.Size() <= (F32)size * mMinCompressRatio)
+			{
+				entry->mFlags |= PackEntry::COMPRESSED_LZ4_CHUNKED;
+			}
+		}
+
+		// store raw data if it is not worth compressing
+		if (!(entry->mFlags & PackEntry::COMPRESSED_LZ4_CHUNKED))
+		{
+			entry->mData.Clear();
+			entry->mData.Write(data, (U32)size);
+		}
+
+		mEntries.push(entry);
+		return true;
+	}
+
+	bool PackFileBuilder::AddFile(BaseFileSystem& fs, const char* path, bool compress)
+	{
+		DynamicArray<char> data;
+		if (!fs.ReadFile(path, data))
+		{
+			Logger::Warning("[Pack] Failed to read file \"%s\"", path);
+			return false;
+		}
+		return AddFile(path, (const U8*)data.data(), data.size(), compress);
+	}
+
+	I32 PackFileBuilder::AddDirectory(BaseFileSystem& fs, const char* dir, bool compress)
+	{
+		I32 fileCount = 0;
+		auto files = fs.EnumerateFiles(dir, EnumrateMode_ALL);
+		for (const auto& file : files)
+		{
+			Path fullPath(dir);
+			fullPath.AppendPath(file.c_str());
+
+			if (fs.IsDirExists(fullPath.c_str()))
+			{
+				fileCount += AddDirectory(fs, fullPath.c_str(), compress);
+			}
+			else if (AddFile(fs, fullPath.c_str(), compress))
+			{
+				fileCount++;
+			}
+		}
+		return fileCount;
+	}
+
+	bool PackFileBuilder::Build(BaseFileSystem& fs, const char* outputPath)
+	{
+		PROFILE_FUNCTION();
+		// sort entries by hash, entries with same hash are ordered by path
+		std::sort(mEntries.begin(), mEntries.end(), [](const BuildEntry* a, const BuildEntry* b) {
+			if (a->mPath.GetHash() != b->mPath.GetHash()) {
+				return a->mPath.GetHash() < b->mPath.GetHash();
+			}
+			return CompareString(a->mPath.c_str(), b->mPath.c_str()) < 0;
+		});
+
+		// layout
+		DynamicArray<PackEntry> packEntries;
+		packEntries.resize(mEntries.size());
+		MemoryStream stringTable;
+		U64 offset = AlignPackOffset(sizeof(PackHeader));
+		for (int i = 0; i < mEntries.size(); i++)
+		{
+			const BuildEntry& buildEntry = *mEntries[i];
+			PackEntry& entry = packEntries[i];
+			entry.mPathHash = buildEntry.mPath.GetHash();
+			entry.mFlags = buildEntry.mFlags;
+			entry.mPathOffset = stringTable.Size();
+			entry.mPathLength = (U32)StringLength(buildEntry.mPath.c_str());
+			entry.mOffset = offset;
+			entry.mSize = buildEntry.mData.Size();
+			entry.mDecompressedSize = buildEntry.mDecompressedSize;
+
+			stringTable.Write(buildEntry.mPath.c_str(), entry.mPathLength + 1);
+			offset = AlignPackOffset(offset + entry.mSize);
+		}
+
+		PackHeader header;
+		header.mEntryCount = packEntries.size();
+		header.mIndexOffset = offset;
+		header.mStringTableOffset = offset + packEntries.size() * sizeof(PackEntry);
+		header.mStringTableSize = stringTable.Size();
+
+		// write
+		File file;
+		if (!fs.OpenFile(outputPath, file, FileFlags::DEFAULT_WRITE))
+		{
+			Logger::Error("[Pack] Failed to open pack file \"%s\"", outputPath);
+			return false;
+		}
+
+		// File::Write returns the result of FileImpl::Write, not the written size
+		bool ret = file.Write(&header, sizeof(header)) != 0;
+		U64 currentOffset = sizeof(header);
+		for (int i = 0; i < mEntries.size() && ret; i++)
+		{
+			const PackEntry& entry = packEntries[i];
+			ret &= WritePadding(file, currentOffset, entry.mOffset);
+			if (entry.mSize > 0) {
+				ret &= file.Write(mEntries[i]->mData.data(), entry.mSize) != 0;
+			}
+			currentOffset = entry.mOffset + entry.mSize;
+		}
+		if (ret)
+		{
+			ret &= WritePadding(file, currentOffset, header.mIndexOffset);
+			if (packEntries.size() > 0) {
+				ret &= file.Write(packEntries.data(), packEntries.size() * sizeof(PackEntry)) != 0;
+			}
+			if (stringTable.Size() > 0) {
+				ret &= file.Write(stringTable.data(), stringTable.Size()) != 0;
+			}
+		}
+		file.Close();
+
+		if (!ret)
+		{
+			Logger::Error("[Pack] Failed to write pack file \"%s\"", outputPath);
+			return false;
+		}
+
+		Logger::Info("[Pack] Build pack \"%s\", %d files, %llu bytes", outputPath, packEntries.size(), header.mStringTableOffset + header.mStringTableSize);
+		return true;
+	}
+
+	void PackFileBuilder::Clear()
+	{
+		for (BuildEntry* entry : mEntries) {
+			CJING_SAFE_DELETE(entry);
+		}
+		mEntries.clear();
+	}
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// FileSystemPack
+	FileSystemPack::FileSystemPack(const char* packPath) :
+		mPackPath(packPath)
+	{
+		MaxPathString parentPath;
+		Path::GetPathParentPath(packPath, parentPath.toSpan());
+		SetBasePath(parentPath.c_str());
+
+		if (!Platform::MapFile(packPath, mMappedFile))
+		{
+			Logger::Error("[Pack] Failed to map pack file \"%s\"", packPath);
+			return;
+		}
+
+		// validate header and index
+		bool isValid = mMappedFile.mSize >= sizeof(PackHeader);
+		if (isValid)
+		{
+			Memory::Memcpy(&mHeader, mMappedFile.mData, sizeof(PackHeader));
+			isValid = mHeader.mMagic == PackHeader::MAGIC &&
+				mHeader.mVersion == PackHeader::VERSION &&
+				mHeader.mIndexOffset + (U64)mHeader.mEntryCount * sizeof(PackEntry) <= mMappedFile.mSize &&
+				mHeader.mStringTableOffset + mHeader.mStringTableSize <= mMappedFile.mSize;
+		}
+		if (!isValid)
+		{
+			Logger::Error("[Pack] Invalid pack file \"%s\"", packPath);
+			Platform::UnmapFile(mMappedFile);
+			return;
+		}
+
+		mEntries = (const PackEntry*)(mMappedFile.mData + mHeader.mIndexOffset);
+		mStringTable = (const char*)(mMappedFile.mData + mHeader.mStringTableOffset);
+		mLastModTime = Platform::GetLastModTime(packPath);
+	}
+
+	FileSystemPack::~FileSystemPack()
+	{
+		Platform::UnmapFile(mMappedFile);
+	}
+
+	const PackEntry* FileSystemPack::FindEntry(const char* path) const
+	{
+		if (!IsValid()) {
+			return nullptr;
+		}
+
+		Path entryPath(path);
+		const U32 hash = entryPath.GetHash();
+		const PackEntry* begin = mEntries;
+		const PackEntry* end = mEntries + mHeader.mEntryCount;
+		const PackEntry* it = std::lower_bound(begin, end, hash, [](const PackEntry& entry, U32 hash) {
+			return entry.mPathHash < hash;
+		});
+		for (; it != end && it->mPathHash == hash; ++it)
+		{
+			if (EqualString(GetEntryPath(*it), entryPath.c_str())) {
+				return it;
+			}
+		}
+		return nullptr;
+	}
+
+	const char* FileSystemPack::GetEntryPath(const PackEntry& entry) const
+	{
+		if (entry.mPathOffset >= mHeader.mStringTableSize) {
+			return "";
+		}
+		return mStringTable + entry.mPathOffset;
+	}
+
+	const U8* FileSystemPack::GetEntryData(const PackEntry& entry) const
+	{
+		if (entry.mFlags & PackEntry::COMPRESSED_LZ4_CHUNKED) {
+			return nullptr;
+		}
+		if (entry.mOffset + entry.mSize > mMappedFile.mSize) {
+			return nullptr;
+		}
+		return mMappedFile.mData + entry.mOffset;
+	}
+
+	bool FileSystemPack::ReadEntry(const PackEntry& entry, U8* buffer, U64 size) const
+	{
+		if (entry.mOffset + entry.mSize > mMappedFile.mSize || size < entry.mDecompressedSize) {
+			return false;
+		}
+
+		const U8* src = mMappedFile.mData + entry.mOffset;
+		if (entry.mFlags & PackEntry::COMPRESSED_LZ4_CHUNKED) {
+			return LZ4Chunked::Decompress(src, entry.mSize, buffer, size);
+		}
+
+		Memory::Memcpy(buffer, src, entry.mSize);
+		return true;
+	}
+
+	void FileSystemPack::SetBasePath(const char* path)
+	{
+		Path::FormatPath(path, mBasePath.toSpan());
+		if (!mBasePath.empty() && mBasePath.back() != '/' && mBasePath.back() != '\\') {
+			mBasePath.append(Path::PATH_SEPERATOR);
+		}
+	}
+
+	char* FileSystemPack::GetBasePath()
+	{
+		return mBasePath.c_str();
+	}
+
+	bool FileSystemPack::CreateDir(const char* path)
+	{
+		return false;
+	}
+
+	bool FileSystemPack::DeleteDir(const char* path)
+	{
+		return false;
+	}
+
+	bool FileSystemPack::IsDirExists(const char* path)
+	{
+		MaxPathString dirPath;
+		Path::FormatPath(path, dirPath.toSpan());
+		if (dirPath.empty()) {
+			return IsValid();
+		}
+		if (dirPath.back() != '/') {
+			dirPath.append(Path::PATH_SEPERATOR);
+		}
+
+		for (U32 i = 0; i < mHeader.mEntryCount; i++)
+		{
+			if (StringUtils::StartsWithPrefix(GetEntryPath(mEntries[i]), dirPath.c_str())) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool FileSystemPack::IsFileExists(const char* path)
+	{
+		return FindEntry(path) != nullptr;
+	}
+
+	bool FileSystemPack::ReadFile(const char* path, DynamicArray<char>& data)
+	{
+		const PackEntry* entry = FindEntry(path);
+		if (entry == nullptr)
+		{
+			Logger::Warning("[Pack] The file \"%s\" is not exists.", path);
+			return false;
+		}
+
+		data.resize((U32)entry->mDecompressedSize);
+		if (!ReadEntry(*entry, (U8*)data.data(), entry->mDecompressedSize))
+		{
+			Logger::Warning("[Pack] The file \"%s\" read failed.", path);
+			return false;
+		}
+		return true;
+	}
+
+	bool FileSystemPack::ReadFileRange(const char* path, U64 offset, U8* buffer, U64 size)
+	{
+		const PackEntry* entry = FindEntry(path);
+		if (entry == nullptr)
+		{
+			Logger::Warning("[Pack] The file \"%s\" is not exists.", path);
+			return false;
+		}
+
+		if (entry->mOffset + entry->mSize > mMappedFile.mSize ||
+			offset > entry->mDecompressedSize || size > entry->mDecompressedSize - offset) {
+			return false;
+		}
+
+		const U8* src = mMappedFile.mData + entry->mOffset;
+		if (entry->mFlags & PackEntry::COMPRESSED_LZ4_CHUNKED) {
+			return LZ4Chunked::DecompressRange(src, entry->mSize, buffer, offset, size);
+		}
+
+		Memory::Memcpy(buffer, src + offset, (size_t)size);
+		return true;
+	}
+
+	bool FileSystemPack::ReadFile(const char* path, char** buffer, U32& size)
+	{
+		const PackEntry* entry = FindEntry(path);
+		if (entry == nullptr)
+		{
+			Logger::Warning("[Pack] The file \"%s\" is not exists.", path);
+			return false;
+		}
+
+		size = (U32)entry->mDecompressedSize;
+		*buffer = (char*)CJING_MALLOC(sizeof(char) * size);
+		if (!ReadEntry(*entry, (U8*)*buffer, size))
+		{
+			Logger::Warning("[Pack] The file \"%s\" read failed.", path);
+			CJING_FREE(*buffer);
+			*buffer = nullptr;
+			return false;
+		}
+		return true;
+	}
+
+	bool FileSystemPack::WriteFile(const char* path, const char* buffer, size_t length)
+	{
+		return false;
+	}
+
+	bool FileSystemPack::DeleteFile(const char* path)
+	{
+		return false;
+	}
+
+	bool FileSystemPack::OpenFile(const char* path, File& file, FileFlags flags)
+	{
+		if (FLAG_ANY(flags, FileFlags::WRITE)) {
+			return false;
+		}
+
+		const PackEntry* entry = FindEntry(path);
+		if (entry == nullptr)
+		{
+			Logger::Warning("[Pack] The file \"%s\" is not exists.", path);
+			return false;
+		}
+
+		// zero-copy view of the mapped pack
+		if (const U8* data = GetEntryData(*entry))
+		{
+			file = std::move(File((void*)data, (size_t)entry->mSize, FileFlags::READ));
+			return true;
+		}
+
+		U8* buffer = (U8*)CJING_MALLOC((size_t)entry->mDecompressedSize);
+		if (!ReadEntry(*entry, buffer, entry->mDecompressedSize))
+		{
+			Logger::Warning("[Pack] The file \"%s\" read failed.", path);
+			CJING_FREE(buffer);
+			return false;
+		}
+
+		file = std::move(File(CJING_NEW(PackBufferFile)(buffer, (size_t)entry->mDecompressedSize, path)));
+		return true;
+	}
+
+	U64 FileSystemPack::GetLastModTime(const char* path)
+	{
+		return FindEntry(path) != nullptr ? mLastModTime : 0;
+	}
+
+	bool FileSystemPack::MoveFile(const char* from, const char* to)
+	{
+		return false;
+	}
+
+	bool FileSystemPack::GetFileLocation(const char* path, U64& offset, U64& size)
+	{
+		const PackEntry* entry = FindEntry(path);
+		if (entry == nullptr) {
+			return false;
+		}
+		offset = entry->mOffset;
+		size = entry->mSize;
+		return true;
+	}
+
+	void FileSystemPack::PrefetchRange(U64 offset, U64 size)
+	{
+		if (!IsValid() || offset >= mMappedFile.mSize) {
+			return;
+		}
+		size = std::min(size, (U64)mMappedFile.mSize - offset);
+		Platform::PrefetchMemory(mMappedFile.mData + offset, (size_t)size);
+	}
+
+	DynamicArray<String> FileSystemPack::EnumerateFiles(const char* path, int mask)
+	{
+		MaxPathString dirPath;
+		Path::FormatPath(path, dirPath.toSpan());
+		if (!dirPath.empty() && dirPath.back() != '/') {
+			dirPath.append(Path::PATH_SEPERATOR);
+		}
+		const size_t dirLength = StringLength(dirPath.c_str());
+
+		// collect direct children of the dir
+		DynamicArray<String> paths;
+		for (U32 i = 0; i < mHeader.mEntryCount; i++)
+		{
+			const char* entryPath = GetEntryPath(mEntries[i]);
+			if (!StringUtils::StartsWithPrefix(entryPath, dirPath.c_str())) {
+				continue;
+			}
+
+			const char* name = entryPath + dirLength;
+			const I32 slashPos = FindStringChar(name, Path::PATH_SEPERATOR, 0);
+			const bool isDirectory = slashPos >= 0;
+			if (isDirectory && !(mask & EnumrateMode_DIRECTORY)) {
+				continue;
+			}
+			if (!isDirectory && !(mask & EnumrateMode_FILE)) {
+				continue;
+			}
+
+			String childName = isDirectory ? String(name, name + slashPos) : String(name);
+			if (std::find(paths.begin(), paths.end(), childName) == paths.end()) {
+				paths.push(childName);
+			}
+		}
+		return paths;
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "core\filesystem\filesystem.h"
+#include "core\platform\platform.h"
+#include "core\helper\stream.h"
+
+namespace Cjing3D
+{
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// Pack file format
+	/// [PackHeader][entry data (PACK_ALIGNMENT aligned)...][PackEntry index (sorted by hash)][path strings]
+#pragma pack(1)
+	struct PackHeader
+	{
+		static const U32 MAGIC;
+		static const U32 VERSION = 1;
+
+		U32 mMagic = MAGIC;
+		U32 mVersion = VERSION;
+		U32 mEntryCount = 0;
+		U32 mFlags = 0;
+		U64 mIndexOffset = 0;
+		U64 mStringTableOffset = 0;
+		U64 mStringTableSize = 0;
+	};
+
+	struct PackEntry
+	{
+		enum Flags
+		{
+			COMPRESSED_LZ4_CHUNKED = 1 << 0,
+		};
+
+		U32 mPathHash = 0;
+		U32 mFlags = 0;
+		U32 mPathOffset = 0;
+		U32 mPathLength = 0;
+		U64 mOffset = 0;
+		U64 mSize = 0;
+		U64 mDecompressedSize = 0;
+	};
+#pragma pack()
+
+	static const U64 PACK_ALIGNMENT = 4096;
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// PackFileBuilder
+	class PackFileBuilder
+	{
+	public:
+		PackFileBuilder();
+		~PackFileBuilder();
+
+		bool AddFile(const char* path, const U8* data, U64 size, bool compress = true);
+		bool AddFile(BaseFileSystem& fs, const char* path, bool compress = true);
+		// add all files in dir recursively, path in pack is relative to the filesystem
+		I32  AddDirectory(BaseFileSystem& fs, const char* dir, bool compress = true);
+		bool Build(BaseFileSystem& fs, const char* outputPath);
+		void Clear();
+
+		I32 GetFileCount()const { return mEntries.size(); }
+		void SetCompressAcceleration(I32 acceleration) { mCompressAcceleration = acceleration; }
+		// entry is stored raw if compressed size / raw size is greater than ratio
+		void SetMinCompressRatio(F32 ratio) { mMinCompressRatio = ratio; }
+
+	private:
+		struct BuildEntry
+		{
+			Path mPath;
+			U32 mFlags = 0;
+			U64 mDecompressedSize = 0;
+			MemoryStream mData;
+		};
+		DynamicArray<BuildEntry*> mEntries;
+		I32 mCompressAcceleration = 1;
+		F32 mMinCompressRatio = 0.9f;
+	};
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// FileSystemPack
+	/// Read-only filesystem over a memory mapped pack file, uncompressed
+	/// entries are returned as zero-copy views of the mapping.
+	class FileSystemPack : public BaseFileSystem
+	{
+	public:
+		FileSystemPack(const char* packPath);
+		virtual ~FileSystemPack();
+
+		bool IsValid()const { return mMappedFile.mData != nullptr; }
+		I32 GetFileCount()const { return (I32)mHeader.mEntryCount; }
+		const PackEntry* FindEntry(const char* path)const;
+		const char* GetEntryPath(const PackEntry& entry)const;
+		// get mapped data of the entry, return nullptr if entry is compressed
+		const U8* GetEntryData(const PackEntry& entry)const;
+		// read [offset, offset + size) of the file, only overlapped blocks of compressed entry are decompressed
+		bool ReadFileRange(const char* path, U64 offset, U8* buffer, U64 size);
+		// absolute path of the pack file
+		const char* GetPackPath()const { return mPackPath.c_str(); }
+
+		virtual void SetBasePath(const char* path);
+		virtual char* GetBasePath();
+
+		virtual bool CreateDir(const char* path);
+		virtual bool DeleteDir(const char* path);
+		virtual bool IsDirExists(const char* path);
+		virtual bool IsFileExists(const char* path);
+		virtual bool ReadFile(const char* path, DynamicArray<char>& data);
+		virtual bool ReadFile(const char* path, char** buffer, U32& size);
+		virtual bool WriteFile(const char* path, const char* buffer, size_t length);
+		virtual bool DeleteFile(const char* path);
+		virtual bool OpenFile(const char* path, File& file, FileFlags flags);
+		virtual U64  GetLastModTime(const char* path);
+		virtual bool MoveFile(const char* from, const char* to);
+
+		DynamicArray<String> EnumerateFiles(const char* path, int mask = EnumrateMode_ALL)override;
+		bool GetFileLocation(const char* path, U64& offset, U64& size)override;
+		void PrefetchRange(U64 offset, U64 size)override;
+
+	private:
+		bool ReadEntry(const PackEntry& entry, U8* buffer, U64 size)const;
+
+		MaxPathString mBasePath;
+		MaxPathString mPackPath;
+		Platform::MappedFile mMappedFile;
+		PackHeader mHeader;
+		const PackEntry* mEntries = nullptr;
+		const char* mStringTable = nullptr;
+		U64 mLastModTime = 0;
+	};
+}
@@ -149,6 +149,8 @@ namespace Cjing3D {
 
 	bool FileSystemPhysfs::ReadFile(const char* name, char** buffer, U32& size)
 	{
+		// errors of physfs are global, reads from io threads are serialized
+		Concurrency::ScopedMutex lock(mReadMutex);
 		if (!PHYSFS_exists(name))
 		{
 			Logger::Warning(String("[fileData] The file : ") + name + " isn't exits.");
@@ -177,6 +179,7 @@ namespace Cjing3D {
 
 	bool FileSystemPhysfs::ReadFile(const char* name, DynamicArray<char>& data)
 	{
+		Concurrency::ScopedMutex lock(mReadMutex);
 		if (!PHYSFS_exists(name))
 		{
 			Logger::Warning(String("[fileData] The file : ") + name + " isn't exits.");
@@ -289,13 +292,14 @@ namespace Cjing3D {
 			return false;
 		}
 
-		if (!PHYSFS_write(file, buffer, (PHYSFS_uint32)length, 1))
+		// write by bytes, the legacy PHYSFS_write truncates length to U32
+		PHYSFS_sint64 wrote = PHYSFS_writeBytes(file, buffer, (PHYSFS_uint64)length);
+		PHYSFS_close(file);
+		if (wrote < 0 || (PHYSFS_uint64)wrote != (PHYSFS_uint64)length)
 		{
 			Logger::Warning(String("[fileData] The file : ") + path + " write failed.");
 			return false;
 		}
-
-		PHYSFS_close(file);
 		return true;
 	}
 }
\ No newline at end of file
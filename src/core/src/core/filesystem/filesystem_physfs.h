@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core\filesystem\filesystem.h"
+#include "core\concurrency\concurrency.h"
 
 namespace Cjing3D 
 {
@@ -28,5 +29,6 @@ namespace Cjing3D
 		DynamicArray<String> EnumerateFiles(const char* path, int mask = EnumrateMode_ALL)override;
 	private:
 		MaxPathString mBasePath;
+		Concurrency::Mutex mReadMutex;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+//#define CJING_TEST_FILESYSTEM
+#ifdef CJING_TEST_FILESYSTEM
+
+#include "core\filesystem\filesystem_generic.h"
+#include "core\filesystem\filesystem_pack.h"
+#include "core\concurrency\jobsystem.h"
+#include "core\helper\timer.h"
+#include "core\helper\debug.h"
+
+#define CATCH_CONFIG_MAIN
+#include "catch\catch.hpp"
+
+using namespace Cjing3D;
+
+namespace
+{
+    static const I32 MAX_FIBER_COUNT = 128;
+    static const I32 FIBER_STACK_SIZE = 16 * 1024;
+    static const char* PACK_PATH = "test.pak";
+}
+
+TEST_CASE("pack build and read", "[filesystem]")
+{
+    JobSystem::ScopedManager scoped(4, MAX_FIBER_COUNT, FIBER_STACK_SIZE);
+    FileSystemGeneric fileSystem(".");
+
+    // compressible and incompressible data
+    DynamicArray<U8> textData;
+    textData.resize(1024 * 1024);
+    for (int i = 0; i < textData.size(); i++) {
+        textData[i] = (U8)('a' + (i % 16));
+    }
+    DynamicArray<U8> randomData;
+    randomData.resize(10000);
+    U32 seed = 1;
+    for (int i = 0; i < randomData.size(); i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        randomData[i] = (U8)(seed >> 24);
+    }
+
+    {
+        PackFileBuilder builder;
+        REQUIRE(builder.AddFile("data/text.txt", textData.data(), textData.size()));
+        REQUIRE(builder.AddFile("data\\sub\\random.bin", randomData.data(), randomData.size()));
+        REQUIRE(!builder.AddFile("data/text.txt", textData.data(), textData.size()));
+        REQUIRE(builder.Build(fileSystem, PACK_PATH));
+    }
+
+    // the pack is written through the generic file
+    {
+        File file;
+        REQUIRE(fileSystem.OpenFile(PACK_PATH, file, FileFlags::DEFAULT_READ));
+        PackHeader header;
+        REQUIRE(file.Size() > sizeof(PackHeader));
+        REQUIRE(file.Read(&header, sizeof(PackHeader)) != 0);
+        REQUIRE(header.mMagic == PackHeader::MAGIC);
+        REQUIRE(header.mEntryCount == 2);
+        REQUIRE(file.Size() == header.mStringTableOffset + header.mStringTableSize);
+    }
+
+    {
+        FileSystemPack pack(PACK_PATH);
+        REQUIRE(pack.IsValid());
+        REQUIRE(pack.GetFileCount() == 2);
+        REQUIRE(pack.IsFileExists("data/text.txt"));
+        REQUIRE(pack.IsFileExists("data/sub/random.bin"));
+        REQUIRE(!pack.IsFileExists("data/none.txt"));
+        REQUIRE(pack.IsDirExists("data/sub"));
+
+        const PackEntry* entry = pack.FindEntry("data/sub/random.bin");
+        REQUIRE(entry != nullptr);
+        REQUIRE(entry->mOffset % PACK_ALIGNMENT == 0);
+
+        DynamicArray<char> data;
+        REQUIRE(pack.ReadFile("data/text.txt", data));
+        REQUIRE(data.size() == textData.size());
+        REQUIRE(memcmp(data.data(), textData.data(), textData.size()) == 0);
+
+        File file;
+        REQUIRE(pack.OpenFile("data/sub/random.bin", file, FileFlags::DEFAULT_READ));
+        REQUIRE(file.Size() == randomData.size());
+        DynamicArray<U8> fileData;
+        fileData.resize((U32)file.Size());
+        file.Read(fileData.data(), file.Size());
+        REQUIRE(memcmp(fileData.data(), randomData.data(), randomData.size()) == 0);
+
+        auto files = pack.EnumerateFiles("data");
+        REQUIRE(files.size() == 2);
+
+        // ranged read only decompresses overlapped blocks
+        const U64 rangeOffset = 300000;
+        const U64 rangeSize = 500000;
+        DynamicArray<U8> rangeData;
+        rangeData.resize((U32)rangeSize);
+        REQUIRE(pack.ReadFileRange("data/text.txt", rangeOffset, rangeData.data(), rangeSize));
+        REQUIRE(memcmp(rangeData.data(), textData.data() + rangeOffset, rangeSize) == 0);
+        REQUIRE(pack.ReadFileRange("data/sub/random.bin", 100, rangeData.data(), 1000));
+        REQUIRE(memcmp(rangeData.data(), randomData.data() + 100, 1000) == 0);
+        REQUIRE(!pack.ReadFileRange("data/text.txt", textData.size() - 10, rangeData.data(), 20));
+    }
+
+    fileSystem.DeleteFile(PACK_PATH);
+}
+
+#endif
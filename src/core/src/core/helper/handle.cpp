@@ -1,5 +1,7 @@
 #include "handle.h"
 #include "core\helper\debug.h"
+#include "core\memory\memory.h"
+#include "core\concurrency\concurrency.h"
 
 namespace Cjing3D
 {
@@ -8,15 +10,17 @@ namespace Cjing3D
 	HandleAllocator::HandleAllocator(I32 typeCount) :
 		mMaxTypeCount(typeCount)
 	{
-		I32 maxMagic = Handle::MAX_INDEX * Handle::MAX_TYPE;
-		mMagicIDs.resize(maxMagic);
-		for (I32 i = 0; i < maxMagic; i++) {
-			mMagicIDs[i] = 1;
-		}
+		Debug::CheckAssertion(typeCount <= Handle::MAX_TYPE);
 	}
 
 	HandleAllocator::~HandleAllocator()
 	{
+		for (HandleTypeData& data : mHandleTypeDatas)
+		{
+			for (SlotPage* page : data.mPages) {
+				CJING_SAFE_DELETE(page);
+			}
+		}
 	}
 
 	Handle HandleAllocator::Alloc(I32 type)
@@ -24,32 +28,27 @@ namespace Cjing3D
 		Debug::CheckAssertion(type >= 0 && type < mMaxTypeCount);
 		HandleTypeData& data = mHandleTypeDatas[type];
 
-		Handle ret;
-		bool success = false;
-		if (data.mFreeList.size() > 0)
+		// reuse freed index first, otherwise bump a new index
+		I32 index = PopFreeIndex(data);
+		if (index < 0)
 		{
-			ret.mIndex = data.mFreeList.back();
-			ret.mType = type;
-			data.mFreeList.pop();
-			success = true;
-		}
-		else
-		{
-			if (data.mAllocated.size() < Handle::MAX_INDEX)
+			index = Concurrency::AtomicIncrement(&data.mIndexCount) - 1;
+			if (index >= Handle::MAX_INDEX)
 			{
-				data.mAllocated.push(0);
-				ret.mIndex = data.mAllocated.size() - 1;
-				ret.mType = type;
-				success = true;
+				Concurrency::AtomicDecrement(&data.mIndexCount);
+				return Handle();
 			}
 		}
 
-		if (success)
-		{
-			Debug::CheckAssertion(ret.mIndex < data.mAllocated.size());
-			data.mAllocated[ret.mIndex] = 1;
-			ret.mMagic = GetMagicID(ret.mIndex, ret.mType);
-		}
+		Slot& slot = AllocSlot(data, index);
+		const I32 magic = slot.mState & MAGIC_MASK;
+		Concurrency::AtomicExchange(&slot.mState, magic | ALLOCATED_BIT);
+		Concurrency::AtomicIncrement(&data.mAllocatedCount);
+
+		Handle ret;
+		ret.mIndex = index;
+		ret.mMagic = magic;
+		ret.mType = type;
 		return ret;
 	}
 
@@ -59,60 +58,112 @@ namespace Cjing3D
 			return;
 		}
 		HandleTypeData& data = mHandleTypeDatas[handle.mType];
+		Slot& slot = *GetSlot(handle.mType, handle.mIndex);
 
-		auto& magicID = GetMagicID(handle.mIndex, handle.mType);
-		if (magicID >= Handle::MAX_MAGIC - 1) {
-			magicID = 0;
+		// magic inc, to validate new handle and old handle, only one of concurrent frees could succeed
+		I32 magic = handle.mMagic + 1;
+		if (magic >= Handle::MAX_MAGIC) {
+			magic = 1;
+		}
+		const I32 state = handle.mMagic | ALLOCATED_BIT;
+		if (Concurrency::AtomicCmpExchange(&slot.mState, magic, state) != state) {
+			return;
 		}
 
-		// magic inc, to validate new handle and old handle
-		magicID++;
-
-		data.mAllocated[handle.mIndex] = 0;
-		data.mFreeList.push(handle.mIndex);
+		Concurrency::AtomicDecrement(&data.mAllocatedCount);
+		PushFreeIndex(data, handle.mIndex);
 	}
 
 	I32 HandleAllocator::GetTotalHandleCount(I32 type)
 	{
 		Debug::CheckAssertion(type >= 0 && type < mMaxTypeCount);
-		HandleTypeData& data = mHandleTypeDatas[type];
-		I32 count = 0;
-		for (auto isAllocated : data.mAllocated) 
-		{
-			if (isAllocated) {
-				count++;
-			}
-		}
-		return count;
+		return mHandleTypeDatas[type].mAllocatedCount;
 	}
 
 	I32 HandleAllocator::GetMaxHandleCount(I32 type)
 	{
 		Debug::CheckAssertion(type >= 0 && type < mMaxTypeCount);
-		HandleTypeData& data = mHandleTypeDatas[type];
-		return data.mAllocated.size();
+		const I32 indexCount = mHandleTypeDatas[type].mIndexCount;
+		return indexCount < Handle::MAX_INDEX ? indexCount : Handle::MAX_INDEX;
 	}
 
 	bool HandleAllocator::IsValid(Handle handle)
 	{
-		return mMagicIDs[handle.mIndex + handle.mType * Handle::MAX_INDEX] == handle.mMagic;
+		if ((I32)handle.mType >= mMaxTypeCount) {
+			return false;
+		}
+		const Slot* slot = GetSlot(handle.mType, handle.mIndex);
+		return slot != nullptr && slot->mState == (I32)(handle.mMagic | ALLOCATED_BIT);
 	}
 
 	bool HandleAllocator::IsAllocated(Handle handle)const
 	{
-		const HandleTypeData& data = mHandleTypeDatas[handle.mType];
-		return data.mAllocated[handle.mIndex] != 0;
+		return IsAllocated(handle.mType, handle.mIndex);
 	}
 
 	bool HandleAllocator::IsAllocated(I32 type, I32 index)const
 	{
 		Debug::CheckAssertion(type >= 0 && type < mMaxTypeCount);
-		const HandleTypeData& data = mHandleTypeDatas[type];
-		return data.mAllocated[index] != 0;
+		const Slot* slot = GetSlot(type, index);
+		return slot != nullptr && (slot->mState & ALLOCATED_BIT) != 0;
+	}
+
+	HandleAllocator::Slot* HandleAllocator::GetSlot(U32 type, U32 index)const
+	{
+		if (index >= (U32)Handle::MAX_INDEX) {
+			return nullptr;
+		}
+		SlotPage* page = mHandleTypeDatas[type].mPages[index / PAGE_SIZE];
+		return page != nullptr ? &page->mSlots[index % PAGE_SIZE] : nullptr;
 	}
 
-	U16& HandleAllocator::GetMagicID(U32 index, U32 type)
+	HandleAllocator::Slot& HandleAllocator::AllocSlot(HandleTypeData& data, I32 index)
 	{
-		return mMagicIDs[index + type * Handle::MAX_INDEX];
+		// the first thread which touches the page publishes it, others release their pages
+		SlotPage* volatile& page = data.mPages[index / PAGE_SIZE];
+		if (page == nullptr)
+		{
+			SlotPage* newPage = CJING_NEW(SlotPage);
+			if (Concurrency::AtomicCmpExchange((volatile I64*)&page, (I64)newPage, 0) != 0) {
+				CJING_DELETE(newPage);
+			}
+		}
+		return page->mSlots[index % PAGE_SIZE];
+	}
+
+	I32 HandleAllocator::PopFreeIndex(HandleTypeData& data)
+	{
+		while (true)
+		{
+			const I64 head = data.mFreeHead;
+			const I32 first = (I32)(head & 0xFFFFFFFF);
+			if (first == 0) {
+				return -1;
+			}
+
+			// pages of freed indices always exist, the next may be stale if the head is changed
+			// by other threads, which is detected by the tag
+			const I32 index = first - 1;
+			const I32 next = data.mPages[index / PAGE_SIZE]->mSlots[index % PAGE_SIZE].mNext;
+			const I64 newHead = (I64)((((U64)head >> 32) + 1) << 32) | (U32)next;
+			if (Concurrency::AtomicCmpExchange(&data.mFreeHead, newHead, head) == head) {
+				return index;
+			}
+		}
+	}
+
+	void HandleAllocator::PushFreeIndex(HandleTypeData& data, I32 index)
+	{
+		Slot& slot = data.mPages[index / PAGE_SIZE]->mSlots[index % PAGE_SIZE];
+		while (true)
+		{
+			const I64 head = data.mFreeHead;
+			slot.mNext = (I32)(head & 0xFFFFFFFF);
+
+			const I64 newHead = (I64)((((U64)head >> 32) + 1) << 32) | (U32)(index + 1);
+			if (Concurrency::AtomicCmpExchange(&data.mFreeHead, newHead, head) == head) {
+				return;
+			}
+		}
 	}
 }
\ No newline at end of file
@@ -66,6 +66,12 @@ namespace Cjing3D
 		};
 	};
 	
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// HandleAllocator
+	/// Lock-free handle allocator. Each type has a free list of indices (a stack with tagged head to
+	/// avoid ABA), new indices are bumped from the index count of the type. Slots are allocated by
+	/// pages on demand and never released until the allocator is destroyed. The generation (magic)
+	/// of slot is increased when freed, so that stale handles are invalid.
 	class HandleAllocator
 	{
 	public:
@@ -82,17 +88,36 @@ namespace Cjing3D
 		bool IsAllocated(I32 type, I32 index)const;
 
 	private:
-		U16& GetMagicID(U32 index, U32 type);
+		static const I32 PAGE_SIZE = 1024;
+		static const I32 MAX_PAGE_COUNT = (Handle::MAX_INDEX + PAGE_SIZE - 1) / PAGE_SIZE;
+		static const I32 ALLOCATED_BIT = 1 << 12;
+		static const I32 MAGIC_MASK = ALLOCATED_BIT - 1;
+
+		struct Slot
+		{
+			volatile I32 mState = 1;	// magic | ALLOCATED_BIT
+			volatile I32 mNext = 0;		// next index + 1 in free list
+		};
+
+		struct SlotPage
+		{
+			Slot mSlots[PAGE_SIZE];
+		};
 
 		struct HandleTypeData
 		{
-			DynamicArray<U32> mFreeList;
-			DynamicArray<U8>  mAllocated;	// 0:free, 1:allocated
+			volatile I64 mFreeHead = 0;			// (tag << 32) | (index + 1)
+			volatile I32 mIndexCount = 0;
+			volatile I32 mAllocatedCount = 0;
+			SlotPage* volatile mPages[MAX_PAGE_COUNT] = {};
 		};
-		StaticArray<HandleTypeData, Handle::MAX_TYPE> mHandleTypeDatas;
 
-		// MAX_TYPE * MAX_INDEX magic ids for validating handle
-		DynamicArray<U16> mMagicIDs;	
+		Slot* GetSlot(U32 type, U32 index)const;
+		Slot& AllocSlot(HandleTypeData& data, I32 index);
+		I32  PopFreeIndex(HandleTypeData& data);
+		void PushFreeIndex(HandleTypeData& data, I32 index);
+
+		StaticArray<HandleTypeData, Handle::MAX_TYPE> mHandleTypeDatas;
 		I32 mMaxTypeCount;
 	};
 }
\ No newline at end of file
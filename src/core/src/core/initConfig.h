@@ -23,6 +23,8 @@ namespace Cjing3D
 		U32    mMultiSampleCount = 1;
 		bool   mIsFullScreen = false;
 		bool   mIsApp = false;
+		// headless app runs without window, input and graphics api
+		bool   mIsHeadless = false;
 		I32    mFlag = 0;
 	};
 }
\ No newline at end of file
@@ -120,6 +120,18 @@ namespace Platform {
 	void   SetCurrentDir(const char* path);
 	void   GetCurrentDir(Span<char> path);
 
+	// read-only file mapping
+	struct MappedFile
+	{
+		const U8* mData = nullptr;
+		size_t mSize = 0;
+		void* mFileHandle = nullptr;
+		void* mMappingHandle = nullptr;
+	};
+	bool   MapFile(const char* path, MappedFile& mappedFile);
+	void   UnmapFile(MappedFile& mappedFile);
+	void   PrefetchMemory(const void* data, size_t size);
+
 	FileIterator* CreateFileIterator(const char* path, const char* ext = nullptr);
 	void DestroyFileIterator(FileIterator* it);
 	bool GetNextFile(FileIterator* it, FileInfo& info);
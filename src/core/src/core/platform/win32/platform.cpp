@@ -561,6 +561,67 @@ namespace Platform {
 		return WCharToChar(path, tmp);
 	}
 
+	bool MapFile(const char* path, MappedFile& mappedFile)
+	{
+		const WPathString wpath(path);
+		HANDLE fileHandle = ::CreateFile(wpath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (fileHandle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!::GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0)
+		{
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		HANDLE mappingHandle = ::CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mappingHandle == NULL)
+		{
+			Logger::Warning("Failed to create file mapping \"%s\", error:%x", path, ::GetLastError());
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		void* data = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr)
+		{
+			Logger::Warning("Failed to map view of file \"%s\", error:%x", path, ::GetLastError());
+			::CloseHandle(mappingHandle);
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		mappedFile.mData = (const U8*)data;
+		mappedFile.mSize = (size_t)size.QuadPart;
+		mappedFile.mFileHandle = fileHandle;
+		mappedFile.mMappingHandle = mappingHandle;
+		return true;
+	}
+
+	void UnmapFile(MappedFile& mappedFile)
+	{
+		if (mappedFile.mData != nullptr) {
+			::UnmapViewOfFile(mappedFile.mData);
+		}
+		if (mappedFile.mMappingHandle != nullptr) {
+			::CloseHandle((HANDLE)mappedFile.mMappingHandle);
+		}
+		if (mappedFile.mFileHandle != nullptr) {
+			::CloseHandle((HANDLE)mappedFile.mFileHandle);
+		}
+		mappedFile = MappedFile();
+	}
+
+	void PrefetchMemory(const void* data, size_t size)
+	{
+		WIN32_MEMORY_RANGE_ENTRY entry;
+		entry.VirtualAddress = (PVOID)data;
+		entry.NumberOfBytes = size;
+		::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &entry, 0);
+	}
+
 	struct FileIterator
 	{
 		HANDLE mHandle;
@@ -6,6 +6,9 @@
 #include "core\concurrency\jobsystem.h"
 #include "core\helper\stringID.h"
 #include "core\helper\reflection.h"
+#include "core\helper\stream.h"
+
+#include <type_traits>
 
 namespace Cjing3D
 {
@@ -51,13 +54,33 @@ namespace ECS
 	};
 
 	// Component ṩentityComponentӳ
+	namespace Impl
+	{
+		// non-POD components could be serialized by providing:
+		// void Serialize(MemoryStream& stream)const;
+		// bool Unserialize(InputMemoryStream& stream);
+		template<typename T, typename = void>
+		struct HasStreamSerializer : std::false_type {};
+
+		template<typename T>
+		struct HasStreamSerializer<T, std::enable_if_t<
+			std::is_void<decltype(std::declval<const T&>().Serialize(std::declval<MemoryStream&>()))>::value &&
+			std::is_same<decltype(std::declval<T&>().Unserialize(std::declval<InputMemoryStream&>())), bool>::value>> : std::true_type {};
+	}
+
 	class BaseComponentManager
 	{
 	public:
 		BaseComponentManager() = default;
 		virtual~BaseComponentManager() = default;
+
+		virtual void Clear() = 0;
+		virtual bool IsSerializable()const = 0;
+		virtual void Serialize(MemoryStream& stream)const = 0;
+		virtual bool Unserialize(InputMemoryStream& stream) = 0;
 	};
 
+
 	template<typename ComponentT>
 	class ComponentManager : public BaseComponentManager
 	{
@@ -83,7 +106,7 @@ namespace ECS
 			}
 		}
 
-		inline void Clear()
+		void Clear() override
 		{
 			mEntities.clear();
 			mComponents.clear();
@@ -309,6 +332,93 @@ namespace ECS
 			return mComponents[index];
 		}
 
+		// serialization
+		// format: count, entities[count], components
+		// trivially copyable components are written as a raw block
+		static constexpr bool IS_RAW_COMPONENT = std::is_trivially_copyable<ComponentT>::value;
+
+		bool IsSerializable()const override
+		{
+			return IS_RAW_COMPONENT || Impl::HasStreamSerializer<ComponentT>::value;
+		}
+
+		void Serialize(MemoryStream& stream)const override
+		{
+			const U32 count = (U32)mComponents.size();
+			stream.Write(count);
+			if (count == 0) {
+				return;
+			}
+
+			stream.Write(mEntities.data(), count * sizeof(Entity));
+			if constexpr (IS_RAW_COMPONENT)
+			{
+				stream.Write(mComponents.data(), count * sizeof(ComponentT));
+			}
+			else if constexpr (Impl::HasStreamSerializer<ComponentT>::value)
+			{
+				for (const ComponentT& component : mComponents) {
+					component.Serialize(stream);
+				}
+			}
+		}
+
+		bool Unserialize(InputMemoryStream& stream) override
+		{
+			if (!IsSerializable()) {
+				return false;
+			}
+
+			Clear();
+
+			U32 count = 0;
+			if (!stream.Read(&count, sizeof(count))) {
+				return false;
+			}
+			if (count == 0) {
+				return true;
+			}
+			if (count > (stream.Size() - stream.Offset()) / sizeof(Entity)) {
+				return false;
+			}
+
+			// bulk insert, keep the same order as the source manager
+			Reserve(count);
+			mEntities.resize(count);
+			if (!stream.Read(mEntities.data(), count * sizeof(Entity))) 
+			{
+				Clear();
+				return false;
+			}
+
+			mComponents.resize(count);
+			if constexpr (IS_RAW_COMPONENT)
+			{
+				if (!stream.Read(mComponents.data(), count * sizeof(ComponentT)))
+				{
+					Clear();
+					return false;
+				}
+			}
+			else if constexpr (Impl::HasStreamSerializer<ComponentT>::value)
+			{
+				for (ComponentT& component : mComponents)
+				{
+					if (!component.Unserialize(stream))
+					{
+						Clear();
+						return false;
+					}
+				}
+			}
+
+			for (U32 i = 0; i < count; i++) {
+				mLookup.insert(mEntities[i], (size_t)i);
+			}
+			return true;
+		}
+
+
 	private:
 		DynamicArray<Entity> mEntities;
 		DynamicArray<ComponentT> mComponents;
@@ -2,6 +2,7 @@
 #include "core\container\staticArray.h"
 #include "core\container\hashMap.h"
 #include "core\string\stringUtils.h"
+#include "core\helper\debug.h"
 
 namespace Cjing3D
 {
@@ -53,9 +54,35 @@ namespace ECS::SceneReflection
 			}
 		}
 
+		// hash 0 is reserved for the entity section of universe
+		Debug::CheckAssertion(hash != 0, "Invalid component type name.");
 		RegisterdComponentType& componentType = manager.mComponentTypes[manager.mComponentTypeCount++];
 		componentType.mNameHash = hash;
 		return { (U32)(manager.mComponentTypeCount - 1) };
 	}
+
+	ComponentType GetComponentTypeByHash(U32 nameHash)
+	{
+		auto& manager = GetManager();
+		for (int i = 0; i < manager.mComponentTypeCount; i++)
+		{
+			if (manager.mComponentTypes[i].mNameHash == nameHash) {
+				return { (U32)i };
+			}
+		}
+		return ComponentType::INVALID;
+	}
+
+	U32 GetComponentTypeHash(ComponentType type)
+	{
+		auto& manager = GetManager();
+		if (type.mTypeIndex >= (U32)manager.mComponentTypeCount)
+		{
+			Debug::CheckAssertion(false, "Invalid component type.");
+			return 0;
+		}
+		return manager.mComponentTypes[type.mTypeIndex].mNameHash;
+	}
+
 }
 }
\ No newline at end of file
@@ -17,6 +17,9 @@ namespace ECS::SceneReflection
 	///////////////////////////////////////////////////////////////////////////////////////
 	ComponentType GetComponentType(const char* name);
 	ComponentType RegisterComponentType(const char* name);
+	ComponentType GetComponentTypeByHash(U32 nameHash);
+	U32 GetComponentTypeHash(ComponentType type);
+
 
 	///////////////////////////////////////////////////////////////////////////////////////
 	// Scene reflection
@@ -0,0 +1,98 @@
+//#define CJING_TEST_SCENE
+#ifdef CJING_TEST_SCENE
+
+#include "core\scene\universe.h"
+#include "core\scene\reflection.h"
+#include "core\concurrency\jobsystem.h"
+#include "core\helper\timer.h"
+#include "core\helper\debug.h"
+
+#define CATCH_CONFIG_MAIN
+#include "catch\catch.hpp"
+
+using namespace Cjing3D;
+
+namespace
+{
+    static const I32 MAX_FIBER_COUNT = 128;
+    static const I32 FIBER_STACK_SIZE = 16 * 1024;
+}
+
+TEST_CASE("universe serialize", "[scene]")
+{
+    JobSystem::ScopedManager scoped(4, MAX_FIBER_COUNT, FIBER_STACK_SIZE);
+
+    Universe universe;
+    ECS::Entity entity = universe.CreateEntity("Test");
+    Transform transform;
+    transform.Translate(F32x3(1.0f, 2.0f, 3.0f));
+    universe.SetEntityTransform(entity, transform);
+
+    MemoryStream stream;
+    REQUIRE(universe.Serialize(stream));
+
+    Universe loadedUniverse;
+    InputMemoryStream inputStream(stream);
+    REQUIRE(loadedUniverse.Unserialize(inputStream));
+    REQUIRE(loadedUniverse.HasEntity(entity));
+    REQUIRE(EqualString(loadedUniverse.GetEntityName(entity), "Test"));
+
+    auto transforms = loadedUniverse.GetComponents<Transform>(ECS::SceneReflection::GetComponentType("Transform"));
+    REQUIRE(transforms->GetComponent(entity) != nullptr);
+    REQUIRE(transforms->GetComponent(entity)->GetTranslationLocal().x() == 1.0f);
+}
+
+TEST_CASE("universe unserialize into existing universe", "[scene]")
+{
+    JobSystem::ScopedManager scoped(4, MAX_FIBER_COUNT, FIBER_STACK_SIZE);
+
+    struct TestComponent
+    {
+        I32 mValue = 0;
+    };
+
+    Universe universe;
+    ECS::Entity entity = universe.CreateEntity("Test");
+    MemoryStream stream;
+    REQUIRE(universe.Serialize(stream));
+
+    // the component section is missing in the stream, stale components are cleared
+    Universe loadedUniverse;
+    auto components = loadedUniverse.RegisterComponents<TestComponent>(ECS::SceneReflection::RegisterComponentType("TestComponent"));
+    components->Create(loadedUniverse.CreateEntity("Stale")).mValue = 1;
+
+    InputMemoryStream inputStream(stream);
+    REQUIRE(loadedUniverse.Unserialize(inputStream));
+    REQUIRE(loadedUniverse.HasEntity(entity));
+    REQUIRE(components->GetCount() == 0);
+}
+
+TEST_CASE("universe serialize 1M entities", "[scene]")
+{
+    JobSystem::ScopedManager scoped(4, MAX_FIBER_COUNT, FIBER_STACK_SIZE);
+
+    const I32 entityCount = 1000000;
+    Universe universe(entityCount + 1);
+    for (I32 i = 0; i < entityCount; i++)
+    {
+        ECS::Entity entity = universe.CreateEntity("Entity");
+        universe.SetEntityTransform(entity, Transform::IDENTITY);
+    }
+
+    MemoryStream stream;
+    F64 startTime = Timer::GetAbsoluteTime();
+    REQUIRE(universe.Serialize(stream));
+    F64 saveTime = Timer::GetAbsoluteTime() - startTime;
+
+    Universe loadedUniverse;
+    InputMemoryStream inputStream(stream);
+    startTime = Timer::GetAbsoluteTime();
+    REQUIRE(loadedUniverse.Unserialize(inputStream));
+    F64 loadTime = Timer::GetAbsoluteTime() - startTime;
+
+    Logger::Print("Universe serialize %d entities, size:%d bytes", entityCount, stream.Size());
+    Logger::Print("\tSave: %f ms", saveTime * 1000.0);
+    Logger::Print("\tLoad: %f ms", loadTime * 1000.0);
+}
+
+#endif
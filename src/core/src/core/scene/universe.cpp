@@ -1,9 +1,17 @@
 #include "universe.h"
+#include "core\filesystem\filesystem.h"
+#include "core\compress\lz4.h"
+#include "core\helper\profiler.h"
+#include "core\helper\log.h"
+
 
 namespace Cjing3D
 {
 	using namespace ECS;
 
+	const U32 UniverseHeader::MAGIC = 0x56494E55; // 'UNIV'
+
+
 	/// ////////////////////////////////////////////////////////////////////////////////
 	// systems
 
@@ -397,6 +405,294 @@ namespace Cjing3D
 		CalculateSystemShedule();
 	}
 
+	/// ////////////////////////////////////////////////////////////////////////////////
+	// Serialization
+
+	namespace
+	{
+		// the section smaller than MIN_COMPRESS_SIZE is stored uncompressed
+		static const U32 MIN_COMPRESS_SIZE = 4 * 1024;
+
+		struct UniverseSection
+		{
+			UniverseSectionHeader mHeader;
+			BaseComponentManager* mManager = nullptr;
+			MemoryStream mData;
+			const U8* mSrc = nullptr;
+		};
+
+		bool CompressSection(UniverseSection& section, const MemoryStream& rawData)
+		{
+			section.mHeader.mDecompressedSize = rawData.Size();
+			if (rawData.Size() < MIN_COMPRESS_SIZE)
+			{
+				section.mData.Write(rawData.data(), rawData.Size());
+				section.mHeader.mSize = rawData.Size();
+				return true;
+			}
+
+			const I32 bound = LZ4_compressBound((I32)rawData.Size());
+			section.mData.Resize(bound);
+			const I32 compressedSize = LZ4_compress_default((const char*)rawData.data(), (char*)section.mData.data(), (I32)rawData.Size(), bound);
+			if (compressedSize <= 0) {
+				return false;
+			}
+
+			section.mData.Resize(compressedSize);
+			section.mHeader.mSize = compressedSize;
+			section.mHeader.mFlags |= UniverseSectionHeader::COMPRESSED_LZ4;
+			return true;
+		}
+
+		bool DecompressSection(const UniverseSection& section, MemoryStream& outData)
+		{
+			const UniverseSectionHeader& header = section.mHeader;
+			if (!(header.mFlags & UniverseSectionHeader::COMPRESSED_LZ4))
+			{
+				outData.Write(section.mSrc, (U32)header.mSize);
+				return outData.Size() == header.mDecompressedSize;
+			}
+
+			outData.Resize((U32)header.mDecompressedSize);
+			const I32 ret = LZ4_decompress_safe((const char*)section.mSrc, (char*)outData.data(), (I32)header.mSize, (I32)header.mDecompressedSize);
+			return ret == (I32)header.mDecompressedSize;
+		}
+	}
+
+	bool Universe::Serialize(MemoryStream& stream)
+	{
+		PROFILE_FUNCTION();
+
+		// collect sections
+		DynamicArray<UniverseSection> sections;
+		sections.reserve(mComponentMangers.size() + 1);
+		sections.emplace();	// entity section
+		for (auto kvp : mComponentMangers)
+		{
+			BaseComponentManager* manager = kvp.second;
+			if (manager == nullptr || !manager->IsSerializable()) {
+				continue;
+			}
+
+			const U32 nameHash = SceneReflection::GetComponentTypeHash(kvp.first);
+			if (nameHash == UniverseSectionHeader::ENTITY_SECTION)
+			{
+				Logger::Warning("Invalid component type:%u", kvp.first.mTypeIndex);
+				continue;
+			}
+
+			UniverseSection& section = sections.emplace();
+			section.mHeader.mNameHash = nameHash;
+			section.mManager = manager;
+		}
+
+		// serialize and compress sections concurrently
+		volatile I32 failedCount = 0;
+		JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+		JobSystem::RunJobs(sections.size(), 1, [&](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+			
+			UniverseSection& section = sections[jobIndex];
+			MemoryStream rawData;
+			if (section.mManager != nullptr)
+			{
+				section.mManager->Serialize(rawData);
+			}
+			else
+			{
+				// entity section: capacity, valid entities
+				U32 validCount = 0;
+				for (const EntityInst& inst : mEntities) {
+					validCount += inst.mIsValid ? 1 : 0;
+				}
+				rawData.Write(validCount);
+				for (I32 i = 0; i < mEntities.size(); i++)
+				{
+					if (mEntities[i].mIsValid) {
+						rawData.Write((Entity)i);
+					}
+				}
+			}
+
+			if (!CompressSection(section, rawData)) {
+				Concurrency::AtomicIncrement(&failedCount);
+			}
+			return false;
+
+		}, 0, &jobHandle);
+		JobSystem::Wait(&jobHandle);
+
+		if (failedCount > 0)
+		{
+			Logger::Warning("Failed to serialize universe.");
+			return false;
+		}
+
+		// write sections in order
+		UniverseHeader header;
+		header.mEntityCapacity = mCapacity;
+		header.mSectionCount = sections.size();
+		stream.Write(header);
+		for (const UniverseSection& section : sections)
+		{
+			stream.Write(section.mHeader);
+			stream.Write(section.mData.data(), section.mData.Size());
+		}
+
+		return true;
+	}
+
+	bool Universe::Unserialize(InputMemoryStream& stream)
+	{
+		PROFILE_FUNCTION();
+
+		UniverseHeader header;
+		if (!stream.Read(&header, sizeof(header)) || 
+			header.mMagic != UniverseHeader::MAGIC ||
+			header.mVersion != UniverseHeader::VERSION)
+		{
+			Logger::Warning("Universe version mismatch.");
+			return false;
+		}
+
+		// read section table, section data is referenced directly from the stream
+		DynamicArray<UniverseSection> sections;
+		sections.resize(header.mSectionCount);
+		for (I32 i = 0; i < sections.size(); i++)
+		{
+			// only the first section is the entity section
+			UniverseSection& section = sections[i];
+			if (!stream.Read(&section.mHeader, sizeof(section.mHeader)) ||
+				stream.Offset() + section.mHeader.mSize > stream.Size() ||
+				(i > 0 && section.mHeader.mNameHash == UniverseSectionHeader::ENTITY_SECTION))
+			{
+				Logger::Warning("Invalid universe section.");
+				return false;
+			}
+
+			section.mSrc = stream.data() + stream.Offset();
+			stream.AddOffset((U32)section.mHeader.mSize);
+
+			if (section.mHeader.mNameHash != UniverseSectionHeader::ENTITY_SECTION)
+			{
+				ComponentType type = SceneReflection::GetComponentTypeByHash(section.mHeader.mNameHash);
+				auto it = mComponentMangers.find(type);
+				if (it != mComponentMangers.end()) {
+					section.mManager = it.value();
+				}
+				else {
+					Logger::Warning("Unknown component section:%u", section.mHeader.mNameHash);
+				}
+			}
+		}
+
+		if (sections.empty() || sections[0].mHeader.mNameHash != UniverseSectionHeader::ENTITY_SECTION)
+		{
+			Logger::Warning("Missing entity section of universe.");
+			return false;
+		}
+
+		// reset all managers, the ones without section in the stream stay empty
+		for (auto kvp : mComponentMangers)
+		{
+			if (kvp.second != nullptr) {
+				kvp.second->Clear();
+			}
+		}
+
+		// entity section
+		{
+			MemoryStream rawData;
+			if (!DecompressSection(sections[0], rawData)) {
+				return false;
+			}
+
+			// check the valid count before resizing, it comes from the stream
+			InputMemoryStream entityStream(rawData);
+			U32 validCount = 0;
+			if (!entityStream.Read(&validCount, sizeof(validCount)) ||
+				validCount > (entityStream.Size() - entityStream.Offset()) / sizeof(Entity))
+			{
+				Logger::Warning("Invalid entity section of universe.");
+				return false;
+			}
+
+			I32 capacity = std::max(mCapacity, (I32)header.mEntityCapacity);
+			if ((I32)validCount >= capacity) {
+				capacity = validCount * 2;
+			}
+
+			mEntities.clear();
+			mEntities.resize(capacity);
+			mFreeList.resize(capacity);
+			mCapacity = capacity;
+
+			for (U32 i = 0; i < validCount; i++)
+			{
+				Entity entity = entityStream.Read<Entity>();
+				if (entity < (Entity)capacity) {
+					mEntities[entity].mIsValid = true;
+				}
+			}
+			ResizeFreeList();
+		}
+
+		// component sections are independent, bulk insert them concurrently
+		volatile I32 failedCount = 0;
+		JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+		JobSystem::RunJobs(sections.size() - 1, 1, [&](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+			
+			const UniverseSection& section = sections[jobIndex + 1];
+			if (section.mManager == nullptr) {
+				return false;
+			}
+
+			MemoryStream rawData;
+			if (!DecompressSection(section, rawData))
+			{
+				Concurrency::AtomicIncrement(&failedCount);
+				return false;
+			}
+
+			InputMemoryStream componentStream(rawData);
+			if (!section.mManager->Unserialize(componentStream)) {
+				Concurrency::AtomicIncrement(&failedCount);
+			}
+			return false;
+
+		}, 0, &jobHandle);
+		JobSystem::Wait(&jobHandle);
+
+		if (failedCount > 0)
+		{
+			Logger::Warning("Failed to unserialize universe.");
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Universe::Save(BaseFileSystem& fileSystem, const char* path)
+	{
+		MemoryStream stream;
+		if (!Serialize(stream)) {
+			return false;
+		}
+		return fileSystem.WriteFile(path, (const char*)stream.data(), stream.Size());
+	}
+
+	bool Universe::Load(BaseFileSystem& fileSystem, const char* path)
+	{
+		DynamicArray<char> data;
+		if (!fileSystem.ReadFile(path, data))
+		{
+			Logger::Warning("Failed to read universe:%s", path);
+			return false;
+		}
+
+		InputMemoryStream stream((const U8*)data.data(), data.size());
+		return Unserialize(stream);
+	}
+
 	void Universe::CalculateSystemShedule()
 	{
 		mOrderedSystems.clear();
@@ -9,9 +9,44 @@
 
 namespace Cjing3D
 {
+	class BaseFileSystem;
+
 	const I32 DEFAULT_UNIVERSE_CAPACITY = 128;
 	const I32 ENTITY_NAME_MAX_LENGTH = 64;
 
+	// Binary universe format
+	// [UniverseHeader][SectionHeader][SectionData]...[SectionHeader][SectionData]
+	// The first section is always the entity section, others are component sections
+	// which are independent with each other, so they could be decoded concurrently.
+#pragma pack(1)
+	struct UniverseHeader
+	{
+		static const U32 MAGIC;
+		static const I32 VERSION = 1;
+
+		U32 mMagic = MAGIC;
+		I32 mVersion = VERSION;
+		U32 mEntityCapacity = 0;
+		U32 mSectionCount = 0;
+	};
+
+	struct UniverseSectionHeader
+	{
+		enum Flags
+		{
+			COMPRESSED_LZ4 = 1 << 0
+		};
+		// reserved name hash of the entity section
+		static const U32 ENTITY_SECTION = 0;
+
+		U32 mNameHash = ENTITY_SECTION;		// hash of component type name
+		U32 mFlags = 0;
+		U64 mSize = 0;
+		U64 mDecompressedSize = 0;
+	};
+#pragma pack()
+
+
 	struct EntityName
 	{
 		StaticString<ENTITY_NAME_MAX_LENGTH> mName;
@@ -69,6 +104,13 @@ namespace Cjing3D
 
 		void RegisterSystem(ECS::ISystem* system);
 
+		// serialization
+		bool Serialize(MemoryStream& stream);
+		bool Unserialize(InputMemoryStream& stream);
+		bool Save(BaseFileSystem& fileSystem, const char* path);
+		bool Load(BaseFileSystem& fileSystem, const char* path);
+
+
 		Signal<void(ECS::Entity entity)> OnEntityDestroyed;
 
 		template<typename ComponentT>
@@ -59,6 +59,13 @@ project (PROJECT_GPU_NAME)
         SOURCE_DIR .. "/*.hpp",
         SOURCE_DIR .. "/*.h",
         SOURCE_DIR .. "/*.inl",
+
+        -- null device is always available for headless mode
+        SOURCE_DIR .. "/null/*.cpp",
+        SOURCE_DIR .. "/null/*.h",
+
+        -- module tests, enabled by CJING_TEST_GPU
+        SOURCE_DIR .. "/test/*.cpp",
     }
     
     -- includes
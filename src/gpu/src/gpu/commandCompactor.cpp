@@ -0,0 +1,358 @@
+#include "commandCompactor.h"
+
+namespace Cjing3D {
+namespace GPU
+{
+	namespace
+	{
+		bool IsSameViewport(const ViewPort& a, const ViewPort& b)
+		{
+			return a.mTopLeftX == b.mTopLeftX && a.mTopLeftY == b.mTopLeftY &&
+				a.mWidth == b.mWidth && a.mHeight == b.mHeight &&
+				a.mMinDepth == b.mMinDepth && a.mMaxDepth == b.mMaxDepth;
+		}
+
+		bool IsSameScissorRect(const ScissorRect& a, const ScissorRect& b)
+		{
+			return a.mLeft == b.mLeft && a.mTop == b.mTop && a.mRight == b.mRight && a.mBottom == b.mBottom;
+		}
+
+		bool IsSameBindingBuffer(const BindingBuffer& a, const BindingBuffer& b)
+		{
+			return a.mResource == b.mResource && a.mOffset == b.mOffset && a.mStride == b.mStride;
+		}
+
+		bool IsSameBarrier(const GPUBarrier& a, const GPUBarrier& b)
+		{
+			if (a.mType != b.mType) {
+				return false;
+			}
+
+			switch (a.mType)
+			{
+			case GPUBarrier::MEMORY_BARRIER:
+				return a.mMemory.mResHash == b.mMemory.mResHash;
+			case GPUBarrier::IMAGE_BARRIER:
+				return a.mImage.mResHash == b.mImage.mResHash &&
+					a.mImage.mLayoutBefore == b.mImage.mLayoutBefore &&
+					a.mImage.mLayoutAfter == b.mImage.mLayoutAfter;
+			case GPUBarrier::BUFFER_BARRIER:
+				return a.mBuffer.mResHash == b.mBuffer.mResHash &&
+					a.mBuffer.mStateBefore == b.mBuffer.mStateBefore &&
+					a.mBuffer.mStateAfter == b.mBuffer.mStateAfter;
+			default:
+				return false;
+			}
+		}
+	}
+
+	void CommandCompactStats::Merge(const CommandCompactStats& stats)
+	{
+		mInputCommands += stats.mInputCommands;
+		mOutputCommands += stats.mOutputCommands;
+		mRedundantBinds += stats.mRedundantBinds;
+		mOverwrittenBinds += stats.mOverwrittenBinds;
+		mMergedUpdates += stats.mMergedUpdates;
+		mMergedBarriers += stats.mMergedBarriers;
+	}
+
+	void CommandCompactor::Compact(DynamicArray<Command*>& commands)
+	{
+		ResetStates();
+		mCommands.clear();
+		mCommands.reserve(commands.size());
+
+		for (Command* command : commands)
+		{
+			// removed commands are set to null, and erased at the end
+			mCommands.push(command);
+
+			switch (command->mType)
+			{
+			case CommandType::BIND_PIPELINE_STATE:
+				Compact(static_cast<CommandBindPipelineState*>(command));
+				break;
+			case CommandType::BIND_VIEWPORT:
+				Compact(static_cast<CommandBindViewport*>(command));
+				break;
+			case CommandType::BIND_SCISSOR_RECT:
+				Compact(static_cast<CommandBindScissorRect*>(command));
+				break;
+			case CommandType::BIND_INDEX_BUFFER:
+				Compact(static_cast<CommandBindIndexBuffer*>(command));
+				break;
+			case CommandType::BIND_VERTEX_BUFFER:
+				Compact(static_cast<CommandBindVertexBuffer*>(command));
+				break;
+			case CommandType::BIND_PIPELINE_BINDING_SET:
+				Compact(static_cast<CommandBindPipelineBindingSet*>(command));
+				break;
+			case CommandType::BIND_RESOURCE:
+				Compact(static_cast<CommandBindResource*>(command));
+				break;
+			case CommandType::UPDATE_BUFFER:
+				Compact(static_cast<CommandUpdateBuffer*>(command));
+				break;
+			case CommandType::BARRIER:
+				Compact(static_cast<CommandBarrier*>(command));
+				break;
+			case CommandType::DRAW:
+			case CommandType::DRAW_INDIRECT:
+			case CommandType::DISPATCH:
+			case CommandType::DISPATCH_INDIRECT:
+				ApplyPendingStates();
+				break;
+			case CommandType::BEGIN_FRAME_BINDING_SET:
+			case CommandType::END_FRAME_BINDING_SET:
+			case CommandType::BEGIN_RENDER_PASS:
+			case CommandType::END_RENDER_PASS:
+				ResetStates();
+				break;
+			default:
+				break;
+			}
+		}
+
+		mStats.mInputCommands += (U32)commands.size();
+		commands.clear();
+		for (Command* command : mCommands)
+		{
+			if (command != nullptr) {
+				commands.push(command);
+			}
+		}
+		mStats.mOutputCommands += (U32)commands.size();
+		mCommands.clear();
+	}
+
+	void CommandCompactor::ResetStates()
+	{
+		// pending binds are kept, but the bound states are unknown
+		mPipelineState = TrackedState<ResHandle>();
+		mViewport = TrackedState<ViewPort>();
+		mScissorRect = TrackedState<ScissorRect>();
+		mIndexBuffer = TrackedState<CommandBindIndexBuffer>();
+		mVertexBuffer = nullptr;
+		mPipelineBindingSet = ResHandle::INVALID_HANDLE;
+		for (auto& resources : mResources)
+		{
+			for (auto& resource : resources) {
+				resource.mIsValid = false;
+			}
+		}
+	}
+
+	void CommandCompactor::ApplyPendingStates()
+	{
+		auto ApplyState = [](auto& state) {
+			if (state.mPendingIndex >= 0)
+			{
+				state.mApplied = state.mPending;
+				state.mIsAppliedValid = true;
+				state.mPendingIndex = -1;
+			}
+		};
+		ApplyState(mPipelineState);
+		ApplyState(mViewport);
+		ApplyState(mScissorRect);
+		ApplyState(mIndexBuffer);
+	}
+
+	void CommandCompactor::Remove(I32 index)
+	{
+		Debug::CheckAssertion(mCommands[index] != nullptr);
+		mCommands[index] = nullptr;
+	}
+
+	I32 CommandCompactor::GetLastCommandIndex()const
+	{
+		// the last command which is not removed, except the current command
+		for (I32 index = mCommands.size() - 2; index >= 0; index--)
+		{
+			if (mCommands[index] != nullptr) {
+				return index;
+			}
+		}
+		return -1;
+	}
+
+	template<typename T, typename EqualFunc>
+	void CommandCompactor::CompactState(TrackedState<T>& state, const T& value, EqualFunc equal)
+	{
+		// the pending bind is not used by any draw
+		if (state.mPendingIndex >= 0)
+		{
+			Remove(state.mPendingIndex);
+			state.mPendingIndex = -1;
+			mStats.mOverwrittenBinds++;
+		}
+
+		const I32 index = mCommands.size() - 1;
+		if (state.mIsAppliedValid && equal(state.mApplied, value))
+		{
+			Remove(index);
+			mStats.mRedundantBinds++;
+			return;
+		}
+
+		state.mPending = value;
+		state.mPendingIndex = index;
+	}
+
+	void CommandCompactor::Compact(CommandBindPipelineState* cmd)
+	{
+		CompactState(mPipelineState, cmd->mHandle, [](const ResHandle& a, const ResHandle& b) {
+			return a == b;
+		});
+	}
+
+	void CommandCompactor::Compact(CommandBindViewport* cmd)
+	{
+		CompactState(mViewport, cmd->mViewport, IsSameViewport);
+	}
+
+	void CommandCompactor::Compact(CommandBindScissorRect* cmd)
+	{
+		CompactState(mScissorRect, cmd->mRect, IsSameScissorRect);
+	}
+
+	void CommandCompactor::Compact(CommandBindIndexBuffer* cmd)
+	{
+		CompactState(mIndexBuffer, *cmd, [](const CommandBindIndexBuffer& a, const CommandBindIndexBuffer& b) {
+			return a.mFormat == b.mFormat && IsSameBindingBuffer(a.mIndexBuffer, b.mIndexBuffer);
+		});
+	}
+
+	void CommandCompactor::Compact(CommandBindVertexBuffer* cmd)
+	{
+		// vertex buffers may be bound partially, only the same binds are removed
+		const CommandBindVertexBuffer* bound = mVertexBuffer;
+		if (bound != nullptr &&
+			bound->mStartSlot == cmd->mStartSlot &&
+			bound->mVertexBuffer.length() == cmd->mVertexBuffer.length())
+		{
+			bool isSame = true;
+			for (U32 i = 0; i < cmd->mVertexBuffer.length() && isSame; i++) {
+				isSame = IsSameBindingBuffer(bound->mVertexBuffer[i], cmd->mVertexBuffer[i]);
+			}
+			if (isSame)
+			{
+				Remove(mCommands.size() - 1);
+				mStats.mRedundantBinds++;
+				return;
+			}
+		}
+		mVertexBuffer = cmd;
+	}
+
+	void CommandCompactor::Compact(CommandBindPipelineBindingSet* cmd)
+	{
+		if (cmd->mHandle != ResHandle::INVALID_HANDLE && cmd->mHandle == mPipelineBindingSet)
+		{
+			Remove(mCommands.size() - 1);
+			mStats.mRedundantBinds++;
+			return;
+		}
+
+		// binding set may overwrite any bound resource
+		mPipelineBindingSet = cmd->mHandle;
+		for (auto& resources : mResources)
+		{
+			for (auto& resource : resources) {
+				resource.mIsValid = false;
+			}
+		}
+	}
+
+	void CommandCompactor::Compact(CommandBindResource* cmd)
+	{
+		// bound resource may overwrite the binding of binding set
+		mPipelineBindingSet = ResHandle::INVALID_HANDLE;
+		if (cmd->mStage < 0 || cmd->mStage >= SHADERSTAGES_COUNT ||
+			cmd->mSlot < 0 || cmd->mSlot >= MAX_TRACKED_RESOURCE_SLOTS) {
+			return;
+		}
+
+		BoundResource& resource = mResources[cmd->mStage][cmd->mSlot];
+		if (resource.mIsValid &&
+			resource.mHandle == cmd->mHandle &&
+			resource.mSubresourceIndex == cmd->mSubresourceIndex)
+		{
+			Remove(mCommands.size() - 1);
+			mStats.mRedundantBinds++;
+			return;
+		}
+
+		resource.mHandle = cmd->mHandle;
+		resource.mSubresourceIndex = cmd->mSubresourceIndex;
+		resource.mIsValid = true;
+	}
+
+	void CommandCompactor::Compact(CommandUpdateBuffer* cmd)
+	{
+		const I32 lastIndex = GetLastCommandIndex();
+		if (lastIndex < 0 || mCommands[lastIndex]->mType != CommandType::UPDATE_BUFFER) {
+			return;
+		}
+
+		auto* lastUpdate = static_cast<CommandUpdateBuffer*>(mCommands[lastIndex]);
+		if (lastUpdate->mHandle != cmd->mHandle) {
+			return;
+		}
+
+		// the update covers the range of last update
+		if (cmd->mOffset == lastUpdate->mOffset &&
+			(cmd->mSize < 0 || (lastUpdate->mSize >= 0 && cmd->mSize >= lastUpdate->mSize)))
+		{
+			Remove(lastIndex);
+			mStats.mMergedUpdates++;
+			return;
+		}
+
+		// adjacent ranges with contiguous data
+		if (lastUpdate->mSize >= 0 && cmd->mSize >= 0 &&
+			lastUpdate->mOffset + lastUpdate->mSize == cmd->mOffset &&
+			(const U8*)lastUpdate->mData + lastUpdate->mSize == (const U8*)cmd->mData)
+		{
+			lastUpdate->mSize += cmd->mSize;
+			Remove(mCommands.size() - 1);
+			mStats.mMergedUpdates++;
+		}
+	}
+
+	void CommandCompactor::Compact(CommandBarrier* cmd)
+	{
+		if (cmd->mBarriers.empty())
+		{
+			Remove(mCommands.size() - 1);
+			mStats.mMergedBarriers++;
+			return;
+		}
+
+		const I32 lastIndex = GetLastCommandIndex();
+		if (lastIndex < 0 || mCommands[lastIndex]->mType != CommandType::BARRIER) {
+			return;
+		}
+
+		// consecutive barriers are submitted together, and the same barriers are submitted once
+		auto* lastBarrier = static_cast<CommandBarrier*>(mCommands[lastIndex]);
+		for (const GPUBarrier& barrier : cmd->mBarriers)
+		{
+			bool isDuplicated = false;
+			for (const GPUBarrier& existing : lastBarrier->mBarriers)
+			{
+				if (IsSameBarrier(existing, barrier))
+				{
+					isDuplicated = true;
+					break;
+				}
+			}
+			if (!isDuplicated) {
+				lastBarrier->mBarriers.push(barrier);
+			}
+		}
+		Remove(mCommands.size() - 1);
+		mStats.mMergedBarriers++;
+	}
+}
+}
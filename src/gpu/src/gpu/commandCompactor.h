@@ -0,0 +1,87 @@
+#pragma once
+
+#include "definitions.h"
+#include "commands.h"
+#include "core\container\dynamicArray.h"
+
+namespace Cjing3D {
+namespace GPU
+{
+	struct CommandCompactStats
+	{
+		U32 mInputCommands = 0;
+		U32 mOutputCommands = 0;
+		U32 mRedundantBinds = 0;		// binds of the state which is already bound
+		U32 mOverwrittenBinds = 0;		// binds overwritten before any draw or dispatch
+		U32 mMergedUpdates = 0;
+		U32 mMergedBarriers = 0;
+
+		U32 GetRemovedCommands()const { return mInputCommands - mOutputCommands; }
+		void Merge(const CommandCompactStats& stats);
+	};
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// CommandCompactor
+	/// Backend-agnostic pass over the recorded commands before compiling. Binds which do not change the
+	/// bound state or are overwritten before used are removed, consecutive updates of adjacent buffer
+	/// ranges and consecutive barriers are merged. Bound states are unknown at the begin of command list
+	/// and after frame binding sets or render passes begin and end, so they are never removed across.
+	class CommandCompactor
+	{
+	public:
+		CommandCompactor() = default;
+		~CommandCompactor() = default;
+
+		void Compact(DynamicArray<Command*>& commands);
+		const CommandCompactStats& GetStats()const { return mStats; }
+
+	private:
+		// state which is applied by draws, and the bind which is not used yet
+		template<typename T>
+		struct TrackedState
+		{
+			T mApplied;
+			bool mIsAppliedValid = false;
+			I32 mPendingIndex = -1;
+			T mPending;
+		};
+
+		void ResetStates();
+		void ApplyPendingStates();
+		void Remove(I32 index);
+		I32 GetLastCommandIndex()const;
+
+		template<typename T, typename EqualFunc>
+		void CompactState(TrackedState<T>& state, const T& value, EqualFunc equal);
+
+		void Compact(CommandBindPipelineState* cmd);
+		void Compact(CommandBindViewport* cmd);
+		void Compact(CommandBindScissorRect* cmd);
+		void Compact(CommandBindIndexBuffer* cmd);
+		void Compact(CommandBindVertexBuffer* cmd);
+		void Compact(CommandBindPipelineBindingSet* cmd);
+		void Compact(CommandBindResource* cmd);
+		void Compact(CommandUpdateBuffer* cmd);
+		void Compact(CommandBarrier* cmd);
+
+		static const I32 MAX_TRACKED_RESOURCE_SLOTS = 16;
+		struct BoundResource
+		{
+			ResHandle mHandle;
+			I32 mSubresourceIndex = -1;
+			bool mIsValid = false;
+		};
+
+		DynamicArray<Command*> mCommands;
+		CommandCompactStats mStats;
+
+		TrackedState<ResHandle> mPipelineState;
+		TrackedState<ViewPort> mViewport;
+		TrackedState<ScissorRect> mScissorRect;
+		TrackedState<CommandBindIndexBuffer> mIndexBuffer;
+		CommandBindVertexBuffer* mVertexBuffer = nullptr;
+		ResHandle mPipelineBindingSet;
+		BoundResource mResources[SHADERSTAGES_COUNT][MAX_TRACKED_RESOURCE_SLOTS];
+	};
+}
+}
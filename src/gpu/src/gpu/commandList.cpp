@@ -19,6 +19,53 @@ namespace GPU {
         mAllocator.Reset();
         mCommands.clear();
         mIsCompiled = false;
+        mParent = nullptr;
+        mWaitCommandLists.clear();
+    }
+
+    void CommandList::Wait(const CommandList& cmd)
+    {
+        Debug::CheckAssertion(&cmd != this);
+        Debug::CheckAssertion(cmd.mHandle != ResHandle::INVALID_HANDLE);
+        if (cmd.mType == mType) {
+            return;
+        }
+
+        for (const ResHandle& handle : mWaitCommandLists)
+        {
+            if (handle == cmd.mHandle) {
+                return;
+            }
+        }
+        mWaitCommandLists.push(cmd.mHandle);
+    }
+
+    void CommandList::MergeSecondaries(I32 position, Span<CommandList*> secondaries)
+    {
+        Debug::CheckAssertion(position >= 0 && position <= mCommands.size());
+        Debug::CheckAssertion(!mIsCompiled);
+
+        I32 commandCount = mCommands.size();
+        for (CommandList* secondary : secondaries) {
+            commandCount += secondary->mCommands.size();
+        }
+
+        DynamicArray<Command*> commands;
+        commands.reserve(commandCount);
+        for (I32 i = 0; i < position; i++) {
+            commands.push(mCommands[i]);
+        }
+        for (CommandList* secondary : secondaries)
+        {
+            Debug::CheckAssertion(secondary->mParent == this);
+            for (Command* command : secondary->mCommands) {
+                commands.push(command);
+            }
+        }
+        for (I32 i = position; i < mCommands.size(); i++) {
+            commands.push(mCommands[i]);
+        }
+        mCommands = std::move(commands);
     }
 
     void CommandList::UpdateBuffer(ResHandle handle, const void* data, I32 offset, I32 size)
@@ -136,6 +183,24 @@ namespace GPU {
         mCommands.push(command);
     }
 
+    void CommandList::DrawInstancedIndirect(ResHandle buffer, U32 offset)
+    {
+        auto* command = Alloc<CommandDrawIndirect>();
+        command->mHandle = buffer;
+        command->mOffset = offset;
+        command->mIsIndexed = false;
+        mCommands.push(command);
+    }
+
+    void CommandList::DrawIndexedInstancedIndirect(ResHandle buffer, U32 offset)
+    {
+        auto* command = Alloc<CommandDrawIndirect>();
+        command->mHandle = buffer;
+        command->mOffset = offset;
+        command->mIsIndexed = true;
+        mCommands.push(command);
+    }
+
     void CommandList::DispatchIndirect(ResHandle buffer, U32 offset)
     {
         auto* command = Alloc<CommandDispatchIndirect>();
@@ -204,9 +269,10 @@ namespace GPU {
         mCommands.push(command);
     }
 
-    GPUAllocation CommandList::GPUAlloc(size_t size)
+    GPUAllocation CommandList::GPUAlloc(size_t size, U32 alignment)
     {
-        return GPU::GPUAllcate(*this, size);
+        // the upload ring is shared by all command lists, include secondary command lists
+        return GPU::GPUAllcate(size, alignment);
     }
 }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "commands.h"
 #include "core\container\span.h"
 #include "core\memory\linearAllocator.h"
+#include "core\concurrency\concurrency.h"
 
 namespace Cjing3D {
 namespace GPU {
@@ -18,6 +19,13 @@ namespace GPU {
 		DynamicArray<Command*> mCommands;
 		bool mIsCompiled = false;
 
+		// secondary command list only records commands, which are merged into the parent
+		CommandList* mParent = nullptr;
+
+		// queue of command list, and command lists on other queues which must be finished before this starts
+		CommandListType mType = COMMAND_LIST_GRAPHICS;
+		DynamicArray<ResHandle> mWaitCommandLists;
+
 	public:
 		CommandList(I32 bufferSize = 1024 * 1024);
 		~CommandList();
@@ -27,6 +35,18 @@ namespace GPU {
 		ResHandle GetHanlde()const { return mHandle; }
 		bool IsCompiled()const { return mIsCompiled; }
 		void SetCompiled(bool isCompiled) { mIsCompiled = isCompiled; }
+		void SetParent(CommandList* parent) { mParent = parent; }
+		CommandList* GetParent()const { return mParent; }
+		void SetType(CommandListType type) { mType = type; }
+		CommandListType GetType()const { return mType; }
+
+		// cross-queue dependency, the waited command list must be submitted before this one
+		void Wait(const CommandList& cmd);
+		Span<const ResHandle> GetWaitCommandLists()const { return Span(mWaitCommandLists.data(), mWaitCommandLists.size()); }
+
+		// merge commands of secondary command lists in order at the position, commands are 
+		// still owned by secondary command lists, which must be alive until this is compiled
+		void MergeSecondaries(I32 position, Span<CommandList*> secondaries);
 
 		void UpdateBuffer(ResHandle handle, const void* data, I32 offset = 0, I32 size = -1);
 
@@ -42,6 +62,8 @@ namespace GPU {
 		void DrawIndexed(UINT indexCount, UINT startIndexLocation, UINT baseVertexLocation);
 		void DrawInstanced(U32 vertexCountPerInstance, U32 instanceCount, U32 startVertexLocation, U32 startInstanceLocation);
 		void DrawIndexedInstanced(U32 indexCount, U32 instanceCount, U32 startIndexLocation, U32 baseVertexLocation, U32 startInstanceLocation);	
+		void DrawInstancedIndirect(ResHandle buffer, U32 offset);
+		void DrawIndexedInstancedIndirect(ResHandle buffer, U32 offset);
 		void Dispatch(U32 threadGroupCountX, U32 threadGroupCountY, U32 threadGroupCountZ);
 		void DispatchIndirect(ResHandle buffer, U32 offset);
 
@@ -132,7 +154,8 @@ namespace GPU {
 			return Span(dest, datas.length());
 		}
 
-		GPUAllocation GPUAlloc(size_t size);
+		// upload data of the current frame, see UploadAllocator for typed allocations
+		GPUAllocation GPUAlloc(size_t size, U32 alignment = UPLOAD_ALIGNMENT);
 
 		const DynamicArray<Command*>& GetCommands()const { return mCommands; }
 		DynamicArray<Command*>& GetCommands() { return mCommands; }
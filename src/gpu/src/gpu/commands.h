@@ -28,7 +28,7 @@ namespace GPU {
 		BARRIER,
 		BEGIN_RENDER_PASS,
 		END_RENDER_PASS,
-
+		COUNT
 	};
 
 	enum class CommandDrawType : I8
@@ -97,6 +97,13 @@ namespace GPU {
 		CommandDrawType mDrawType = CommandDrawType::DRAW;
 	};
 
+	struct CommandDrawIndirect : CommandTyped<CommandType::DRAW_INDIRECT>
+	{
+		ResHandle mHandle;
+		I32 mOffset = 0;
+		bool mIsIndexed = false;
+	};
+
 	struct CommandBeginEvent : CommandTyped<CommandType::BEGIN_EVENT> 
 	{
 		const char* mText = nullptr;
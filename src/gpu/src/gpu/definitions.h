@@ -21,18 +21,21 @@ namespace GPU {
 
 	static const I32 MAX_BOUND_RTVS = 8;
 	static const I32 MAX_VERTEX_STREAMS = 8;
+	static const U32 UPLOAD_ALIGNMENT = 256;
 
 	enum CommandListType
 	{
 		COMMAND_LIST_GRAPHICS,
 		COMMAND_LIST_ASYNC_COMPUTE,
+		COMMAND_LIST_TYPE_COUNT,
 	};
 
 	enum GraphicsDeviceType
 	{
 		GraphicsDeviceType_Unknown,
 		GraphicsDeviceType_Dx11,
-		GraphicsDeviceType_Dx12
+		GraphicsDeviceType_Dx12,
+		GraphicsDeviceType_Null
 	};
 
 	enum SHADERSTAGES
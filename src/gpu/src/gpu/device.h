@@ -16,6 +16,7 @@ namespace GPU
 
 		virtual bool CreateCommandlist(ResHandle handle, GPU::CommandListType type) = 0;
 		virtual bool CompileCommandList(ResHandle handle, CommandList& cmd) = 0;
+		// command lists are submitted in order, waits of command lists are cross-queue syncs
 		virtual bool SubmitCommandLists(Span<ResHandle> handles) = 0;
 		virtual void ResetCommandList(ResHandle handle) = 0;
 		virtual void Present(ResHandle handle, bool isVsync) = 0;
@@ -30,7 +31,7 @@ namespace GPU
 		virtual bool CreatePipelineState(ResHandle handle, const PipelineStateDesc* desc) = 0;
 		virtual bool CreatePipelineBindingSet(ResHandle handle, const PipelineBindingSetDesc* desc) = 0;
 		virtual bool CreateTempPipelineBindingSet(ResHandle handle, const PipelineBindingSetDesc* desc) = 0;
-		virtual bool CreateTransientTexture(ResHandle handle, const TextureDesc* desc) = 0;
+		virtual bool CreateTransientTexture(ResHandle handle, const TextureDesc* desc, const TransientPlacement* placement) = 0;
 
 		virtual bool UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingSRV> srvs) = 0;
 		virtual bool UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingUAV> uavs) = 0;
@@ -40,7 +41,6 @@ namespace GPU
 		
 		virtual void DestroyResource(ResHandle handle) = 0;
 		virtual void SetResourceName(ResHandle resource, const char* name) = 0;
-		virtual GPUAllocation GPUAllcate(ResHandle handle, size_t size) = 0;
 		virtual void Map(GPU::ResHandle res, GPUMapping& mapping) = 0;
 		virtual void Unmap(GPU::ResHandle res) = 0;
 
@@ -52,9 +52,9 @@ namespace GPU
 		U32 GetBackBufferCount()const { return BACK_BUFFER_COUNT; }
 		bool CheckCapability(GPU_CAPABILITY capability) { return (U32)capability & mCapabilities; }
 
-	protected:
 		static constexpr U32 BACK_BUFFER_COUNT = 2;
 
+	protected:
 		GraphicsDeviceType mDeviceType;
 		bool mIsDebug = false;
 		U64 mCurrentFrameCount = 0;
@@ -43,6 +43,7 @@ namespace GPU
             GPU_COMMAND_CASE(CommandBindViewport);
             GPU_COMMAND_CASE(CommandBindScissorRect);
             GPU_COMMAND_CASE(CommandDraw);
+            GPU_COMMAND_CASE(CommandDrawIndirect);
             GPU_COMMAND_CASE(CommandDispatch);
             GPU_COMMAND_CASE(CommandDispatchIndirect);
             GPU_COMMAND_CASE(CommandBeginFrameBindingSet);
@@ -276,7 +277,6 @@ namespace GPU
     bool CompileContextDX11::CompileCommand(const CommandDraw* cmd)
     {
         mCommandList.RefreshPipelineState();
-        mCommandList.CommitAllactor();
 
         switch (cmd->mDrawType)
         {
@@ -298,6 +298,23 @@ namespace GPU
         return true;
     }
 
+    bool CompileContextDX11::CompileCommand(const CommandDrawIndirect* cmd)
+    {
+        auto buffer = mDevice.mBuffers.Read(cmd->mHandle);
+        if (!buffer) {
+            return false;
+        }
+
+        mCommandList.RefreshPipelineState();
+        if (cmd->mIsIndexed) {
+            mCommandList.GetContext()->DrawIndexedInstancedIndirect((ID3D11Buffer*)buffer->mResource.Get(), cmd->mOffset);
+        }
+        else {
+            mCommandList.GetContext()->DrawInstancedIndirect((ID3D11Buffer*)buffer->mResource.Get(), cmd->mOffset);
+        }
+        return true;
+    }
+
     bool CompileContextDX11::CompileCommand(const CommandDispatch* cmd)
     {
         mCommandList.GetContext()->Dispatch(
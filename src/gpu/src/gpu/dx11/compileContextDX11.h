@@ -23,6 +23,7 @@ namespace GPU
 		bool CompileCommand(const CommandBindScissorRect* cmd);
 		bool CompileCommand(const CommandDraw* cmd);
 		bool CompileCommand(const CommandDispatch* cmd);
+		bool CompileCommand(const CommandDrawIndirect* cmd);
 		bool CompileCommand(const CommandDispatchIndirect* cmd);
 		bool CompileCommand(const CommandBeginFrameBindingSet* cmd);
 		bool CompileCommand(const CommandEndFrameBindingSet* cmd);
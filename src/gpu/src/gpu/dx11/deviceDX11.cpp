@@ -989,6 +989,8 @@ namespace GPU
 			}
 		}
 
+		// dx11 has only the immediate context, async compute command lists are executed in submission
+		// order, so that cross-queue waits are always satisfied
 		for (auto cmd : commandLists) {
 			if (!cmd->Submit(*mImmediateContext.Get())) {
 				return false;
@@ -1112,8 +1114,10 @@ namespace GPU
 		return CreateTextureImpl(*texture, desc, initialData);
 	}
 
-	bool GraphicsDeviceDx11::CreateTransientTexture(ResHandle handle, const TextureDesc* desc)
+	bool GraphicsDeviceDx11::CreateTransientTexture(ResHandle handle, const TextureDesc* desc, const TransientPlacement* placement)
 	{
+		// dx11 dose not support placed resources, transient textures are pooled 
+		// by mTransientResAllocator and the placement is ignored
 		auto texture = mTextures.Write(handle);
 		texture->mDesc = *desc;
 		texture->mIsTransient = true;
@@ -1581,15 +1585,6 @@ namespace GPU
 		mStaticSamplers.push(sampler);
 	}
 
-	GPUAllocation GraphicsDeviceDx11::GPUAllcate(ResHandle handle, size_t size)
-	{
-		auto ptr = mCommandLists.Write(handle);
-		if (*ptr == nullptr) {
-			return GPUAllocation();
-		}
-		return (*ptr)->GPUAllocate(size);
-	}
-
 	void GraphicsDeviceDx11::Map(GPU::ResHandle res, GPUMapping& mapping)
 	{
 		ID3D11Resource* resD3D = nullptr;
@@ -1634,6 +1629,7 @@ namespace GPU
 			else
 			{
 				mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+				mapFlag = 0;
 			}
 		}
 
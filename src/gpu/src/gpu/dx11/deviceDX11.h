@@ -34,7 +34,7 @@ namespace GPU
 		bool CreateSwapChain(ResHandle handle, const SwapChainDesc* desc, Platform::WindowType window)override;
 		bool CreateFrameBindingSet(ResHandle handle, const FrameBindingSetDesc* desc)override;
 		bool CreateTexture(ResHandle handle, const TextureDesc* desc, const SubresourceData* initialData)override;
-		bool CreateTransientTexture(ResHandle handle, const TextureDesc* desc)override;
+		bool CreateTransientTexture(ResHandle handle, const TextureDesc* desc, const TransientPlacement* placement)override;
 		bool CreateBuffer(ResHandle handle, const BufferDesc* desc, const SubresourceData* initialData)override;
 		bool CreateShader(ResHandle handle, SHADERSTAGES stage, const void* bytecode, size_t length)override;
 		bool CreateSamplerState(ResHandle handle, const SamplerDesc* desc)override;
@@ -53,7 +53,6 @@ namespace GPU
 
 		// add static sampler, it will be valid for the entire rendering passs
 		void AddStaticSampler(const StaticSampler& sampler)override;
-		GPUAllocation GPUAllcate(ResHandle handle, size_t size)override;
 		void Map(GPU::ResHandle res, GPUMapping& mapping)override;
 		void Unmap(GPU::ResHandle res)override;
 
@@ -124,16 +124,6 @@ namespace GPU
 
 	class GraphicsDeviceDx11;
 
-	struct GPUAllocatorDX11
-	{
-		static const U32 DefaultBufferSize = 1024 * 1024;
-		BufferDesc mDesc;
-		ResHandle mBuffer;
-		U32 mOffset = 0;
-		bool mIsDirty = false;
-		I32 mResidentFrame = 0;
-	};
-
 	class CommandListDX11
 	{
 	public:
@@ -149,18 +139,14 @@ namespace GPU
 		bool IsValid()const { return mDeviceContext.Get() != nullptr; }
 		void ActivePipelineState(const PipelineStateDX11* pso);
 		void RefreshPipelineState();
-		GPUAllocation GPUAllocate(size_t size);
-		void CommitAllactor();
 		void ActiveFrameBindingSet(const FrameBindingSetDX11* bindingSet);
 		const FrameBindingSetDX11* GetActiveFrameBindingSet() { return mActiveFrameBindingSet; }
 
 	private:
 		GraphicsDeviceDx11& mDevice;
-		GPUAllocatorDX11 mAllocator;
 		ComPtr<ID3D11DeviceContext> mDeviceContext;
 		ComPtr<ID3D11CommandList> mCommandList;
 		ComPtr<ID3DUserDefinedAnnotation> mUserDefinedAnnotations;
-		GPUAllocatorDX11 mGPUAllocator;
 
 		const FrameBindingSetDX11* mActiveFrameBindingSet = nullptr;
 		const PipelineStateDX11* mActivePSO = nullptr;
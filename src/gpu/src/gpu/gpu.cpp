@@ -10,11 +10,20 @@
 #elif  CJING3D_RENDERER_DX12
 #include "gpu\dx12\deviceDX12.h"
 #endif
+#include "gpu\null\deviceNull.h"
 
 namespace Cjing3D {
 namespace GPU
 {
-	static const I32 MaxGPUFrames = 4;
+	// handles destroyed in a frame are released after BACK_BUFFER_COUNT frames,
+	// when the frame is not in flight anymore
+	static const I32 DeferredReleaseFrames = GraphicsDevice::BACK_BUFFER_COUNT;
+
+	struct DeferredReleaseQueue
+	{
+		Concurrency::SpinLock mLock;
+		DynamicArray<ResHandle> mHandles;
+	};
 
 	//////////////////////////////////////////////////////////////////////////
 	// Member
@@ -23,11 +32,19 @@ namespace GPU
 	{
 	public:
 		SharedPtr<GPU::GraphicsDevice> mDevice = nullptr;
-		HandleAllocator mHandleAllocator = HandleAllocator((I32)RESOURCETYPE_COUNT);
-		StaticArray<DynamicArray<ResHandle>, 4> mReleasedHandles;
-		Concurrency::Mutex mMutex;
+		HandleAllocator mHandleAllocator{ (I32)RESOURCETYPE_COUNT };
+		StaticArray<DeferredReleaseQueue, DeferredReleaseFrames> mReleaseQueues;
 		U64 mCurrentFrameCount = 0;
+		Concurrency::SpinLock mTransientLock;
 		DynamicArray<ResHandle> mTransientHandle;
+		UploadRing mUploadRing;
+		PipelineStateCache mPipelineStateCache;
+
+		// command compaction
+		bool mIsCommandCompactionEnabled = true;
+		Concurrency::SpinLock mCompactStatsLock;
+		CommandCompactStats mCurrentCompactStats;
+		CommandCompactStats mLastCompactStats;
 
 		// command lists
 		StaticArray<CommandList, MAX_COMMANDLIST_COUNT> mAllCmdList;
@@ -39,41 +56,84 @@ namespace GPU
 		Platform::WindowType mWindow;
 
 	public:
+		bool CompileCommandList(CommandList& cmd)
+		{
+			// redundant commands are removed before compiling, command lists may be compiled concurrently
+			if (mIsCommandCompactionEnabled)
+			{
+				CommandCompactor compactor;
+				compactor.Compact(cmd.GetCommands());
+
+				Concurrency::ScopedSpinLock lock(mCompactStatsLock);
+				mCurrentCompactStats.Merge(compactor.GetStats());
+			}
+			return mDevice->CompileCommandList(cmd.GetHanlde(), cmd);
+		}
+
+		ResHandle CreatePipelineState(const PipelineStateDesc& desc, bool isPrecompiling)
+		{
+			const U64 hash = PipelineStateCache::HashDesc(desc);
+			ResHandle handle = mPipelineStateCache.Acquire(hash, desc, isPrecompiling);
+			if (handle != ResHandle::INVALID_HANDLE) {
+				return handle;
+			}
+
+			handle = AllocHandle(ResourceType::RESOURCETYPE_PIPELINE);
+			if (!CheckHandle(handle, mDevice->CreatePipelineState(handle, &desc))) {
+				return handle;
+			}
+
+			// the same desc may be created concurrently, then the cached one is used
+			ResHandle cachedHandle = mPipelineStateCache.Add(hash, desc, handle, isPrecompiling);
+			if (cachedHandle != handle)
+			{
+				mDevice->DestroyResource(handle);
+				mHandleAllocator.Free(handle);
+			}
+			return cachedHandle;
+		}
+
+		// handle allocator is lock-free, so handles could be allocated from any thread without contention
 		ResHandle AllocHandle(ResourceType type)
 		{
-			Concurrency::ScopedMutex lock(mMutex);
 			return ResHandle(mHandleAllocator.Alloc((I32)type));
 		}
 		
 		ResHandle AllocTransientHandle(ResourceType type)
 		{
-			Concurrency::ScopedMutex lock(mMutex);
 			auto handle = ResHandle(mHandleAllocator.Alloc((I32)type));
+			Concurrency::ScopedSpinLock lock(mTransientLock);
 			mTransientHandle.push(handle);
 			return handle;
 		}
 
 		void ClearTransientHandles()
 		{
-			Concurrency::ScopedMutex lock(mMutex);
-			for (ResHandle handle : mTransientHandle)
+			DynamicArray<ResHandle> transientHandles;
+			{
+				Concurrency::ScopedSpinLock lock(mTransientLock);
+				std::swap(transientHandles, mTransientHandle);
+			}
+			for (ResHandle handle : transientHandles)
 			{
 				mDevice->DestroyResource(handle);
 				mHandleAllocator.Free(handle);
 			}
-			mTransientHandle.clear();
 		}
 
 		void ProcessReleasedHandles()
 		{
-			Concurrency::ScopedMutex lock(mMutex);
-			auto& releasedHandles = mReleasedHandles[mCurrentFrameCount % MaxGPUFrames];
+			DynamicArray<ResHandle> releasedHandles;
+			{
+				auto& releaseQueue = mReleaseQueues[mCurrentFrameCount % DeferredReleaseFrames];
+				Concurrency::ScopedSpinLock lock(releaseQueue.mLock);
+				std::swap(releasedHandles, releaseQueue.mHandles);
+			}
 			for (ResHandle handle : releasedHandles)
 			{
 				mDevice->DestroyResource(handle);
 				mHandleAllocator.Free(handle);
 			}
-			releasedHandles.clear();
 		}
 
 		bool CheckHandle(ResHandle& handle, bool ret)
@@ -88,9 +148,9 @@ namespace GPU
 
 		void DestroyHandle(ResHandle handle)
 		{
-			Concurrency::ScopedMutex lock(mMutex);
-			auto& releasedHandles = mReleasedHandles[mCurrentFrameCount % MaxGPUFrames];
-			releasedHandles.push(handle);
+			auto& releaseQueue = mReleaseQueues[mCurrentFrameCount % DeferredReleaseFrames];
+			Concurrency::ScopedSpinLock lock(releaseQueue.mLock);
+			releaseQueue.mHandles.push(handle);
 		}
 	};
 	ManagerImpl* mImpl = nullptr;
@@ -152,20 +212,38 @@ namespace GPU
 #else
 		bool debug = false;
 #endif
+		SharedPtr<GPU::GraphicsDevice> device = nullptr;
+		if (params.mIsHeadless)
+		{
+			device = CJING_MAKE_SHARED<GPU::GraphicsDeviceNull>(debug);
+		}
+		else
+		{
 #ifdef CJING3D_RENDERER_DX11
-		SharedPtr<GPU::GraphicsDevice> device = CJING_MAKE_SHARED<GPU::GraphicsDeviceDx11>(debug);
+			device = CJING_MAKE_SHARED<GPU::GraphicsDeviceDx11>(debug);
 #else
-		Logger::Error("Unsupport graphics device");
+			Logger::Error("Unsupport graphics device, fallback to null device");
+			device = CJING_MAKE_SHARED<GPU::GraphicsDeviceNull>(debug);
+			params.mIsHeadless = true;
 #endif
+		}
 		mImpl = CJING_NEW(ManagerImpl);
 		mImpl->mDevice = device;
 		mImpl->mWindow = params.mWindow;
 
 		// create swapChain
-		auto clientBounds = Platform::GetClientBounds(params.mWindow);
 		SwapChainDesc desc = {};
-		desc.mWidth  = clientBounds.mRight - clientBounds.mLeft;
-		desc.mHeight = clientBounds.mBottom - clientBounds.mTop;
+		if (params.mIsHeadless)
+		{
+			desc.mWidth  = params.mHeadlessWidth;
+			desc.mHeight = params.mHeadlessHeight;
+		}
+		else
+		{
+			auto clientBounds = Platform::GetClientBounds(params.mWindow);
+			desc.mWidth  = clientBounds.mRight - clientBounds.mLeft;
+			desc.mHeight = clientBounds.mBottom - clientBounds.mTop;
+		}
 		desc.mBufferCount = 2;
 		desc.mFormat = FORMAT_R8G8B8A8_UNORM;
 
@@ -201,12 +279,20 @@ namespace GPU
 		}
 		mImpl->mUsedCmdCount = 0;
 		mImpl->ClearTransientHandles();
+		mImpl->mUploadRing.Release();
+
+		// release precompiled pipeline states
+		DynamicArray<ResHandle> pipelineStates;
+		mImpl->mPipelineStateCache.ReleasePrecompiled(pipelineStates);
+		for (ResHandle handle : pipelineStates) {
+			mImpl->DestroyHandle(handle);
+		}
 
 		// clear swapChain
 		mImpl->DestroyHandle(mImpl->mSwapChain);
 
 		// process release handles
-		for (int i = 0; i < MaxGPUFrames; i++) 
+		for (int i = 0; i < DeferredReleaseFrames; i++) 
 		{
 			mImpl->mCurrentFrameCount++;
 			mImpl->ProcessReleasedHandles();
@@ -262,6 +348,12 @@ namespace GPU
 	void EndFrame()
 	{
 		// do ending frame jobs
+		mImpl->mUploadRing.EndFrame(mImpl->mCurrentFrameCount);
+		{
+			Concurrency::ScopedSpinLock lock(mImpl->mCompactStatsLock);
+			mImpl->mLastCompactStats = mImpl->mCurrentCompactStats;
+			mImpl->mCurrentCompactStats = CommandCompactStats();
+		}
 		mImpl->mCurrentFrameCount++;
 		mImpl->mDevice->EndFrame();
 		mImpl->ProcessReleasedHandles();
@@ -308,6 +400,8 @@ namespace GPU
 			cmd->Reset();
 		}
 
+		// command lists are reused from the pool, the queue may be different from last use
+		cmd->SetType(type);
 		mImpl->mDevice->ResetCommandList(cmd->GetHanlde());
 
 		return cmd;
@@ -319,7 +413,7 @@ namespace GPU
 		if (!cmd.IsCompiled())
 		{
 			cmd.SetCompiled(true);
-			return mImpl->mDevice->CompileCommandList(cmd.GetHanlde(), cmd);
+			return mImpl->CompileCommandList(cmd);
 		}
 		return false;
 	}
@@ -331,6 +425,9 @@ namespace GPU
 		mImpl->mUsedCmdCount = 0;
 		if (count > 0)
 		{
+			// uploaded data must be unmapped before command lists are executed
+			mImpl->mUploadRing.Flush();
+
 			DynamicArray<ResHandle> handles;
 			for (U32 i = 0; i < count; i++)
 			{
@@ -339,7 +436,7 @@ namespace GPU
 				if (handle != ResHandle::INVALID_HANDLE)
 				{
 					if (!cmd.IsCompiled()) {
-						mImpl->mDevice->CompileCommandList(handle, cmd);
+						mImpl->CompileCommandList(cmd);
 					}
 					handles.push(handle);
 				}
@@ -395,9 +492,40 @@ namespace GPU
 
 	ResHandle CreatePipelineState(const PipelineStateDesc* desc)
 	{
-		ResHandle handle = mImpl->AllocHandle(ResourceType::RESOURCETYPE_PIPELINE);
-		mImpl->CheckHandle(handle, mImpl->mDevice->CreatePipelineState(handle, desc));
-		return handle;
+		return mImpl->CreatePipelineState(*desc, false);
+	}
+
+	void PrecompilePipelineStates(Span<const PipelineStateDesc> descs, JobSystem::JobHandle* jobHandle)
+	{
+		if (descs.length() == 0) {
+			return;
+		}
+
+		// pipeline states are compiled on the calling thread without job system
+		if (!JobSystem::IsInitialized())
+		{
+			for (const PipelineStateDesc& desc : descs) {
+				mImpl->CreatePipelineState(desc, true);
+			}
+			return;
+		}
+
+		JobSystem::JobHandle precompileHandle = JobSystem::INVALID_HANDLE;
+		JobSystem::RunJobs((I32)descs.length(), 1, [descs](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+			if (!mImpl->CreatePipelineState(descs[jobIndex], true)) {
+				Logger::Warning("[GPU] Failed to precompile pipeline state %d", jobIndex);
+			}
+			return false;
+		}, 0, jobHandle != nullptr ? jobHandle : &precompileHandle);
+
+		if (jobHandle == nullptr) {
+			JobSystem::Wait(&precompileHandle);
+		}
+	}
+
+	PipelineStateCacheStats GetPipelineStateCacheStats()
+	{
+		return mImpl->mPipelineStateCache.GetStats();
 	}
 
 	ResHandle CreatePipelineBindingSet(const PipelineBindingSetDesc* desc)
@@ -417,16 +545,21 @@ namespace GPU
 	}
 
 
-	ResHandle CreateTransientTexture(const TextureDesc* desc)
+	ResHandle CreateTransientTexture(const TextureDesc* desc, const TransientPlacement* placement)
 	{
 		ResHandle handle = mImpl->AllocTransientHandle(ResourceType::RESOURCETYPE_TEXTURE);
-		mImpl->CheckHandle(handle, mImpl->mDevice->CreateTransientTexture(handle, desc));
+		mImpl->CheckHandle(handle, mImpl->mDevice->CreateTransientTexture(handle, desc, placement));
 		return handle;
 	}
 
 	void DestroyResource(ResHandle handle)
 	{
-		if (handle && IsHandleValid(handle)) {
+		if (handle && IsHandleValid(handle))
+		{
+			// cached pipeline states are destroyed when all references are released
+			if (handle.GetType() == RESOURCETYPE_PIPELINE && !mImpl->mPipelineStateCache.Release(handle)) {
+				return;
+			}
 			mImpl->DestroyHandle(handle);
 		}
 	}
@@ -467,10 +600,36 @@ namespace GPU
 		mImpl->mDevice->AddStaticSampler(sampler);
 	}
 
-	GPUAllocation GPUAllcate(CommandList& cmd, size_t size)
+	GPUAllocation GPUAllcate(size_t size, U32 alignment)
 	{
-		Debug::CheckAssertion(cmd.GetHanlde() != ResHandle::INVALID_HANDLE);
-		return mImpl->mDevice->GPUAllcate(cmd.GetHanlde(), size);
+		return mImpl->mUploadRing.Allocate(size, alignment);
+	}
+
+	UploadStats GetCurrentFrameUploadStats()
+	{
+		return mImpl->mUploadRing.GetCurrentFrameStats();
+	}
+
+	UploadStats GetLastFrameUploadStats()
+	{
+		return mImpl->mUploadRing.GetLastFrameStats();
+	}
+
+	void SetCommandCompactionEnabled(bool isEnabled)
+	{
+		mImpl->mIsCommandCompactionEnabled = isEnabled;
+	}
+
+	CommandCompactStats GetCurrentFrameCompactStats()
+	{
+		Concurrency::ScopedSpinLock lock(mImpl->mCompactStatsLock);
+		return mImpl->mCurrentCompactStats;
+	}
+
+	CommandCompactStats GetLastFrameCompactStats()
+	{
+		Concurrency::ScopedSpinLock lock(mImpl->mCompactStatsLock);
+		return mImpl->mLastCompactStats;
 	}
 
 	void Map(GPU::ResHandle res, GPUMapping& mapping)
@@ -4,7 +4,11 @@
 #include "resource.h"
 #include "device.h"
 #include "commandList.h"
+#include "uploadAllocator.h"
+#include "commandCompactor.h"
+#include "pipelineStateCache.h"
 #include "core\platform\platform.h"
+#include "core\concurrency\jobsystem.h"
 
 namespace Cjing3D
 {
@@ -14,6 +18,11 @@ namespace GPU
 	{
 		Platform::WindowType mWindow;
 		bool mIsFullscreen;
+
+		// headless mode uses the null device without window, the swapchain is sized by mHeadlessWidth/Height
+		bool mIsHeadless = false;
+		U32 mHeadlessWidth = 1280;
+		U32 mHeadlessHeight = 720;
 	};
 
 	void Initialize(GPUSetupParams params);
@@ -35,10 +44,15 @@ namespace GPU
 	ResHandle CreateBuffer(const BufferDesc* desc, const SubresourceData* initialData, const char* name = nullptr);
 	ResHandle CreateShader(SHADERSTAGES stage, const void* bytecode, size_t length);
 	ResHandle CreateSampler(const SamplerDesc* desc, const char* name = nullptr);
+	// pipeline states of the same desc are shared, see PipelineStateCache
 	ResHandle CreatePipelineState(const PipelineStateDesc* desc);
+	// precompile pipeline states into the cache on job threads, descs must be alive until the job finished,
+	// the job is waited if jobHandle is nullptr
+	void PrecompilePipelineStates(Span<const PipelineStateDesc> descs, JobSystem::JobHandle* jobHandle = nullptr);
+	PipelineStateCacheStats GetPipelineStateCacheStats();
 	ResHandle CreatePipelineBindingSet(const PipelineBindingSetDesc* desc);
 	ResHandle CreateTempPipelineBindingSet(const PipelineBindingSetDesc* desc);
-	ResHandle CreateTransientTexture(const TextureDesc* desc);
+	ResHandle CreateTransientTexture(const TextureDesc* desc, const TransientPlacement* placement = nullptr);
 	void      DestroyResource(ResHandle handle);
 
 	bool UpdatePipelineBindings(ResHandle handle, I32 index, I32 slot, Span<const BindingSRV> srvs);
@@ -48,7 +62,14 @@ namespace GPU
 	void CopyPipelineBindings(const PipelineBinding& dst, const PipelineBinding& src);
 
 	void AddStaticSampler(const StaticSampler& sampler);
-	GPUAllocation GPUAllcate(CommandList& cmd, size_t size);
+	// allocate upload data of the current frame from the upload ring
+	GPUAllocation GPUAllcate(size_t size, U32 alignment = UploadRing::DEFAULT_ALIGNMENT);
+	UploadStats GetCurrentFrameUploadStats();
+	UploadStats GetLastFrameUploadStats();
+	// redundant binds, updates and barriers are removed from command lists before compiling
+	void SetCommandCompactionEnabled(bool isEnabled);
+	CommandCompactStats GetCurrentFrameCompactStats();
+	CommandCompactStats GetLastFrameCompactStats();
 	void Map(GPU::ResHandle res, GPUMapping& mapping);
 	void Unmap(GPU::ResHandle res);
 
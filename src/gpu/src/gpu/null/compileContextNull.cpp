@@ -0,0 +1,462 @@
+#include "compileContextNull.h"
+#include "gpu\gpu.h"
+
+#include <stdarg.h>
+
+namespace Cjing3D
+{
+namespace GPU
+{
+
+#define GPU_COMMAND_CASE(COMMAND_TYPE)                                                      \
+	case COMMAND_TYPE::TYPE:                                                                \
+		CompileCommand(static_cast<const COMMAND_TYPE*>(command));                          \
+		break;
+
+	CompileContextNull::CompileContextNull(GraphicsDeviceNull& device, CommandListNull& cmd) :
+		mDevice(device),
+		mCommandList(cmd)
+	{
+	}
+
+	CompileContextNull::~CompileContextNull()
+	{
+	}
+
+	bool CompileContextNull::Compile(CommandList& cmd)
+	{
+		// all commands are validated even if some commands are invalid, so that
+		// all errors of the command list are reported at once
+		const DynamicArray<Command*>& commands = cmd.GetCommands();
+		for (const auto& command : commands)
+		{
+			if (command->mType <= CommandType::INVALID || command->mType >= CommandType::COUNT)
+			{
+				ReportError("invalid command type %d", (I32)command->mType);
+				mCommandIndex++;
+				continue;
+			}
+
+			mStats.mCommandCounts[(I32)command->mType]++;
+
+			switch (command->mType)
+			{
+			GPU_COMMAND_CASE(CommandBindVertexBuffer);
+			GPU_COMMAND_CASE(CommandBindIndexBuffer);
+			GPU_COMMAND_CASE(CommandBindPipelineState);
+			GPU_COMMAND_CASE(CommandBindPipelineBindingSet);
+			GPU_COMMAND_CASE(CommandBindViewport);
+			GPU_COMMAND_CASE(CommandBindScissorRect);
+			GPU_COMMAND_CASE(CommandDraw);
+			GPU_COMMAND_CASE(CommandDrawIndirect);
+			GPU_COMMAND_CASE(CommandDispatch);
+			GPU_COMMAND_CASE(CommandDispatchIndirect);
+			GPU_COMMAND_CASE(CommandBeginFrameBindingSet);
+			GPU_COMMAND_CASE(CommandEndFrameBindingSet);
+			GPU_COMMAND_CASE(CommandUpdateBuffer);
+			GPU_COMMAND_CASE(CommandBindResource);
+			GPU_COMMAND_CASE(CommandBarrier);
+			GPU_COMMAND_CASE(CommandBeginRenderPass);
+			GPU_COMMAND_CASE(CommandEndRenderPass);
+
+			case CommandBeginEvent::TYPE:
+				mEventDepth++;
+				break;
+			case CommandEndEvent::TYPE:
+				if (mEventDepth <= 0) {
+					ReportError("end event without begin event");
+				}
+				else {
+					mEventDepth--;
+				}
+				break;
+			default:
+				break;
+			}
+
+			mCommandIndex++;
+		}
+
+		// states should be closed at the end of command list
+		if (mEventDepth != 0) {
+			ReportError("%d events are not ended", mEventDepth);
+		}
+		if (mActiveFrameBindingSet != ResHandle::INVALID_HANDLE) {
+			ReportError("frame binding set is not ended");
+		}
+		if (mIsInRenderPass)
+		{
+			ReportError("render pass is not ended");
+			CompileCommand((const CommandEndRenderPass*)nullptr);
+		}
+
+		mStats.mCompiledCommandLists++;
+		return mStats.mValidationErrors == 0;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBindVertexBuffer* cmd)
+	{
+		const I32 endSlot = cmd->mStartSlot + (I32)cmd->mVertexBuffer.length();
+		if (cmd->mStartSlot < 0 || endSlot > MAX_VERTEX_STREAMS) {
+			return ReportError("vertex buffer slots [%d, %d) out of range", cmd->mStartSlot, endSlot);
+		}
+
+		bool ret = true;
+		for (const auto& vertexBuffer : cmd->mVertexBuffer) {
+			ret &= CheckBuffer(vertexBuffer.mResource, "vertex buffer");
+		}
+		return ret;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBindIndexBuffer* cmd)
+	{
+		mIsIndexBufferBound = CheckBuffer(cmd->mIndexBuffer.mResource, "index buffer");
+		return mIsIndexBufferBound;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBindPipelineState* cmd)
+	{
+		mIsPipelineBound = mDevice.IsResourceAlive(cmd->mHandle) && cmd->mHandle.GetType() == RESOURCETYPE_PIPELINE;
+		if (!mIsPipelineBound) {
+			return ReportError("invalid pipeline state %u", cmd->mHandle.GetHash());
+		}
+		return true;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBindPipelineBindingSet* cmd)
+	{
+		auto bindingSet = mDevice.mPipelineBindingSets.Read(cmd->mHandle);
+		if (!bindingSet || bindingSet->mHash == 0 || bindingSet->mHash != cmd->mHandle.GetHash()) {
+			return ReportError("invalid pipeline binding set %u", cmd->mHandle.GetHash());
+		}
+
+		// unset bindings are null bindings, but bound resources must be alive
+		bool ret = true;
+		for (const auto& srv : bindingSet->mSRVs)
+		{
+			if (srv.mResource != ResHandle::INVALID_HANDLE) {
+				ret &= CheckBufferOrTexture(srv.mResource, "srv");
+			}
+		}
+		for (const auto& cbv : bindingSet->mCBVs)
+		{
+			if (cbv.mResource != ResHandle::INVALID_HANDLE) {
+				ret &= CheckBuffer(cbv.mResource, "cbv");
+			}
+		}
+		for (const auto& uav : bindingSet->mUAVs)
+		{
+			if (uav.mResource != ResHandle::INVALID_HANDLE) {
+				ret &= CheckBufferOrTexture(uav.mResource, "uav");
+			}
+		}
+		for (const auto& sam : bindingSet->mSAMs)
+		{
+			if (sam.mResource != ResHandle::INVALID_HANDLE && !mDevice.IsResourceAlive(sam.mResource)) {
+				ret &= ReportError("invalid sampler %u", sam.mResource.GetHash());
+			}
+		}
+		return ret;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBindViewport* cmd)
+	{
+		if (cmd->mViewport.mWidth <= 0.0f || cmd->mViewport.mHeight <= 0.0f) {
+			return ReportError("empty viewport");
+		}
+		return true;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBindScissorRect* cmd)
+	{
+		return true;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandDraw* cmd)
+	{
+		return CheckDrawStates(cmd->mDrawType == CommandDrawType::DRAW_INDEX || cmd->mDrawType == CommandDrawType::DRAW_INSTANCE_INDEX);
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandDrawIndirect* cmd)
+	{
+		// D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS and D3D11_DRAW_INSTANCED_INDIRECT_ARGS
+		bool ret = CheckDrawStates(cmd->mIsIndexed);
+		ret &= CheckIndirectArgs(cmd->mHandle, cmd->mOffset, cmd->mIsIndexed ? 5 * sizeof(U32) : 4 * sizeof(U32));
+		return ret;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandDispatch* cmd)
+	{
+		return true;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandDispatchIndirect* cmd)
+	{
+		// thread group counts x, y, z
+		return CheckIndirectArgs(cmd->mHandle, cmd->mOffset, 3 * sizeof(U32));
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBeginFrameBindingSet* cmd)
+	{
+		if (mActiveFrameBindingSet != ResHandle::INVALID_HANDLE) {
+			return ReportError("frame binding set %u is not ended", mActiveFrameBindingSet.GetHash());
+		}
+
+		auto bindingSet = mDevice.mFrameBindingSets.Read(cmd->mHandle);
+		if (!bindingSet || bindingSet->mHash == 0 || bindingSet->mHash != cmd->mHandle.GetHash()) {
+			return ReportError("invalid frame binding set %u", cmd->mHandle.GetHash());
+		}
+		mActiveFrameBindingSet = cmd->mHandle;
+
+		bool ret = true;
+		for (const auto& attachment : bindingSet->mDesc.mAttachments)
+		{
+			const ResHandle& res = attachment.mResource;
+			if (res.GetType() == RESOURCETYPE_SWAP_CHAIN && attachment.mType == BindingFrameAttachment::RENDERTARGET)
+			{
+				if (!mDevice.IsResourceAlive(res)) {
+					ret &= ReportError("invalid swap chain %u", res.GetHash());
+				}
+				continue;
+			}
+
+			auto texture = mDevice.mTextures.Read(res);
+			if (!texture || texture->mHash == 0 || texture->mHash != res.GetHash())
+			{
+				ret &= ReportError("invalid attachment %u", res.GetHash());
+				continue;
+			}
+
+			// transient textures only have memory in render passes
+			if (texture->mIsTransient && !texture->mIsResident) {
+				ret &= ReportError("transient attachment %u is not resident", res.GetHash());
+			}
+
+			const U32 bindFlag = attachment.mType == BindingFrameAttachment::RENDERTARGET ? BIND_RENDER_TARGET : BIND_DEPTH_STENCIL;
+			if ((texture->mDesc.mBindFlags & bindFlag) == 0) {
+				ret &= ReportError("attachment %u without bind flag %u", res.GetHash(), bindFlag);
+			}
+		}
+		return ret;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandEndFrameBindingSet* cmd)
+	{
+		if (mActiveFrameBindingSet == ResHandle::INVALID_HANDLE) {
+			return ReportError("end frame binding set without begin");
+		}
+		mActiveFrameBindingSet = ResHandle::INVALID_HANDLE;
+		return true;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandUpdateBuffer* cmd)
+	{
+		auto buffer = mDevice.mBuffers.Read(cmd->mHandle);
+		if (!buffer || buffer->mHash == 0 || buffer->mHash != cmd->mHandle.GetHash()) {
+			return ReportError("update invalid buffer %u", cmd->mHandle.GetHash());
+		}
+		if (cmd->mData == nullptr || cmd->mSize == 0) {
+			return ReportError("update buffer %u without data", cmd->mHandle.GetHash());
+		}
+		if (cmd->mSize > 0 && cmd->mOffset + cmd->mSize > (I32)buffer->mDesc.mByteWidth) {
+			return ReportError("update buffer %u out of range %d", cmd->mHandle.GetHash(), cmd->mOffset + cmd->mSize);
+		}
+		if (buffer->mDesc.mUsage == USAGE_IMMUTABLE) {
+			return ReportError("update immutable buffer %u", cmd->mHandle.GetHash());
+		}
+		return true;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBindResource* cmd)
+	{
+		return CheckBufferOrTexture(cmd->mHandle, "resource");
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBarrier* cmd)
+	{
+		if (mActiveFrameBindingSet != ResHandle::INVALID_HANDLE) {
+			return ReportError("barrier in frame binding set");
+		}
+
+		bool ret = true;
+		for (const auto& barrier : cmd->mBarriers)
+		{
+			switch (barrier.mType)
+			{
+			case GPUBarrier::MEMORY_BARRIER:
+				// memory barrier without resource is a global barrier
+				if (barrier.mMemory.mResHash != 0) {
+					ret &= CheckBufferOrTexture(ResHandle(barrier.mMemory.mResHash), "memory barrier");
+				}
+				break;
+			case GPUBarrier::IMAGE_BARRIER:
+				ret &= CheckTexture(ResHandle(barrier.mImage.mResHash), "image barrier");
+				break;
+			case GPUBarrier::BUFFER_BARRIER:
+				ret &= CheckBuffer(ResHandle(barrier.mBuffer.mResHash), "buffer barrier");
+				break;
+			default:
+				ret &= ReportError("invalid barrier type %d", (I32)barrier.mType);
+				break;
+			}
+		}
+		return ret;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandBeginRenderPass* cmd)
+	{
+		if (mCommandList.mType == COMMAND_LIST_ASYNC_COMPUTE) {
+			return ReportError("render pass on async compute queue");
+		}
+		if (mIsInRenderPass) {
+			return ReportError("render pass is not ended");
+		}
+		mIsInRenderPass = true;
+
+		if (cmd->mRenderPassInfo == nullptr) {
+			return true;
+		}
+
+		// transient textures become resident, the memory is counted as transient memory
+		I64 memory = 0;
+		for (auto& texHandle : cmd->mRenderPassInfo->mTextures)
+		{
+			auto texture = mDevice.mTextures.Write(texHandle);
+			if (!texture || texture->mHash == 0 || texture->mHash != texHandle.GetHash())
+			{
+				ReportError("invalid render pass texture %u", texHandle.GetHash());
+				continue;
+			}
+			if (!texture->mIsTransient || texture->mIsResident) {
+				continue;
+			}
+
+			// placed textures resident at the same time must not be aliased
+			if (texture->mIsPlaced)
+			{
+				for (auto& residentHandle : mTransientTextures)
+				{
+					auto resident = mDevice.mTextures.Read(residentHandle);
+					if (!resident->mIsPlaced || resident->mPlacement.mHeap != texture->mPlacement.mHeap) {
+						continue;
+					}
+
+					const auto& a = texture->mPlacement;
+					const auto& b = resident->mPlacement;
+					if (a.mOffset < b.mOffset + b.mSize && b.mOffset < a.mOffset + a.mSize) {
+						ReportError("transient texture %u is aliased with resident texture %u", texHandle.GetHash(), residentHandle.GetHash());
+					}
+				}
+			}
+
+			texture->mIsResident = true;
+			if (!texture->mIsPlaced) {
+				memory += (I64)texture->mMemorySize;
+			}
+			mTransientTextures.push(texHandle);
+		}
+		mDevice.AddTransientMemory(memory);
+		return true;
+	}
+
+	bool CompileContextNull::CompileCommand(const CommandEndRenderPass* cmd)
+	{
+		if (!mIsInRenderPass) {
+			return ReportError("end render pass without begin");
+		}
+		mIsInRenderPass = false;
+
+		I64 memory = 0;
+		for (auto& texHandle : mTransientTextures)
+		{
+			auto texture = mDevice.mTextures.Write(texHandle);
+			if (!texture || !texture->mIsResident) {
+				continue;
+			}
+
+			texture->mIsResident = false;
+			if (!texture->mIsPlaced) {
+				memory += (I64)texture->mMemorySize;
+			}
+		}
+		mTransientTextures.clear();
+		mDevice.AddTransientMemory(-memory);
+		return true;
+	}
+
+	bool CompileContextNull::ReportError(const char* format, ...)
+	{
+		char buffer[256];
+		va_list args;
+		va_start(args, format);
+		vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+
+		mStats.mValidationErrors++;
+		if (mDevice.mIsDebug) {
+			Logger::Warning("[GPU] Invalid command %d: %s", mCommandIndex, buffer);
+		}
+		return false;
+	}
+
+	bool CompileContextNull::CheckBuffer(ResHandle handle, const char* usage)
+	{
+		if (handle.GetType() != RESOURCETYPE_BUFFER || !mDevice.IsResourceAlive(handle)) {
+			return ReportError("invalid %s %u", usage, handle.GetHash());
+		}
+		return true;
+	}
+
+	bool CompileContextNull::CheckTexture(ResHandle handle, const char* usage)
+	{
+		if (handle.GetType() != RESOURCETYPE_TEXTURE || !mDevice.IsResourceAlive(handle)) {
+			return ReportError("invalid %s %u", usage, handle.GetHash());
+		}
+		return true;
+	}
+
+	bool CompileContextNull::CheckBufferOrTexture(ResHandle handle, const char* usage)
+	{
+		if (handle.GetType() == RESOURCETYPE_TEXTURE) {
+			return CheckTexture(handle, usage);
+		}
+		return CheckBuffer(handle, usage);
+	}
+
+	bool CompileContextNull::CheckDrawStates(bool isIndexed)
+	{
+		if (mCommandList.mType == COMMAND_LIST_ASYNC_COMPUTE) {
+			return ReportError("draw on async compute queue");
+		}
+		if (!mIsPipelineBound) {
+			return ReportError("draw without pipeline state");
+		}
+		if (mActiveFrameBindingSet == ResHandle::INVALID_HANDLE) {
+			return ReportError("draw without frame binding set");
+		}
+		if (isIndexed && !mIsIndexBufferBound) {
+			return ReportError("indexed draw without index buffer");
+		}
+		return true;
+	}
+
+	bool CompileContextNull::CheckIndirectArgs(ResHandle handle, I32 offset, U32 argsSize)
+	{
+		if (!CheckBuffer(handle, "indirect args buffer")) {
+			return false;
+		}
+
+		auto buffer = mDevice.mBuffers.Read(handle);
+		if (!(buffer->mDesc.mMiscFlags & RESOURCE_MISC_DRAWINDIRECT_ARGS)) {
+			return ReportError("indirect args buffer %u without drawindirect args flag", handle.GetHash());
+		}
+		if (offset < 0 || (offset & 3) != 0) {
+			return ReportError("indirect args offset %d is not aligned to 4 bytes", offset);
+		}
+		if ((U64)offset + argsSize > buffer->mDesc.mByteWidth) {
+			return ReportError("indirect args buffer %u out of range %d", handle.GetHash(), offset + (I32)argsSize);
+		}
+		return true;
+	}
+}
+}
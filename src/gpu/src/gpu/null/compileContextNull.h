@@ -0,0 +1,62 @@
+#pragma once
+
+#include "deviceNull.h"
+
+namespace Cjing3D
+{
+namespace GPU
+{
+	class CompileContextNull
+	{
+	public:
+		CompileContextNull(GraphicsDeviceNull& device, CommandListNull& cmd);
+		~CompileContextNull();
+
+		// validate all commands, return false if any command is invalid
+		bool Compile(CommandList& cmd);
+
+		const GraphicsDeviceNull::FrameStats& GetStats()const { return mStats; }
+
+		// compile gpu commands
+		bool CompileCommand(const CommandBindVertexBuffer* cmd);
+		bool CompileCommand(const CommandBindIndexBuffer* cmd);
+		bool CompileCommand(const CommandBindPipelineState* cmd);
+		bool CompileCommand(const CommandBindPipelineBindingSet* cmd);
+		bool CompileCommand(const CommandBindViewport* cmd);
+		bool CompileCommand(const CommandBindScissorRect* cmd);
+		bool CompileCommand(const CommandDraw* cmd);
+		bool CompileCommand(const CommandDrawIndirect* cmd);
+		bool CompileCommand(const CommandDispatch* cmd);
+		bool CompileCommand(const CommandDispatchIndirect* cmd);
+		bool CompileCommand(const CommandBeginFrameBindingSet* cmd);
+		bool CompileCommand(const CommandEndFrameBindingSet* cmd);
+		bool CompileCommand(const CommandUpdateBuffer* cmd);
+		bool CompileCommand(const CommandBindResource* cmd);
+		bool CompileCommand(const CommandBarrier* cmd);
+		bool CompileCommand(const CommandBeginRenderPass* cmd);
+		bool CompileCommand(const CommandEndRenderPass* cmd);
+
+	private:
+		bool ReportError(const char* format, ...);
+		bool CheckBuffer(ResHandle handle, const char* usage);
+		bool CheckTexture(ResHandle handle, const char* usage);
+		bool CheckBufferOrTexture(ResHandle handle, const char* usage);
+		bool CheckDrawStates(bool isIndexed);
+		bool CheckIndirectArgs(ResHandle handle, I32 offset, U32 argsSize);
+
+	private:
+		GraphicsDeviceNull& mDevice;
+		CommandListNull& mCommandList;
+		GraphicsDeviceNull::FrameStats mStats;
+		I32 mCommandIndex = 0;
+
+		// states
+		I32 mEventDepth = 0;
+		bool mIsPipelineBound = false;
+		bool mIsIndexBufferBound = false;
+		bool mIsInRenderPass = false;
+		ResHandle mActiveFrameBindingSet;
+		DynamicArray<ResHandle> mTransientTextures;
+	};
+}
+}
@@ -0,0 +1,678 @@
+#include "deviceNull.h"
+#include "compileContextNull.h"
+#include "gpu\gpu.h"
+#include "core\memory\memory.h"
+
+namespace Cjing3D {
+namespace GPU
+{
+	namespace
+	{
+		U64 GetTextureMemorySize(const TextureDesc& desc)
+		{
+			const I32 depth = desc.mType == TEXTURE_3D ? std::max(desc.mDepth, 1u) : 1;
+			U64 size = GPU::GetTextureSize(desc.mFormat, desc.mWidth, desc.mHeight, depth, std::max(desc.mMipLevels, 1u));
+			return size * std::max(desc.mArraySize, 1u) * std::max(desc.mSampleCount, 1u);
+		}
+
+		bool IsBufferCPUAccessible(const BufferDesc& desc)
+		{
+			return desc.mUsage == USAGE_DYNAMIC || desc.mUsage == USAGE_STAGING || desc.mCPUAccessFlags != 0;
+		}
+
+		bool IsResourceValid(const ResourceNull& res, ResHandle handle)
+		{
+			return res.mHash != 0 && res.mHash == handle.GetHash();
+		}
+
+		template<typename T>
+		bool UpdateBindings(DynamicArray<T>& dst, I32 index, Span<const T> bindings)
+		{
+			if (index < 0 || index + (I32)bindings.length() > dst.size())
+			{
+				Logger::Warning("[GPU] Binding range [%d, %d) out of pipeline binding set (%d)", index, index + (I32)bindings.length(), dst.size());
+				return false;
+			}
+
+			for (I32 i = 0; i < (I32)bindings.length(); i++) {
+				dst[index + i] = bindings[i];
+			}
+			return true;
+		}
+
+		template<typename T>
+		bool CopyBindings(DynamicArray<T>& dst, const DynamicArray<T>& src, const PipelineBinding::Range& dstRange, const PipelineBinding::Range& srcRange)
+		{
+			if (dstRange.mNum <= 0) {
+				return true;
+			}
+			if (dstRange.mDstOffset + dstRange.mNum > dst.size() || srcRange.mSrcOffset + dstRange.mNum > src.size()) {
+				return false;
+			}
+
+			for (I32 i = 0; i < dstRange.mNum; i++) {
+				dst[dstRange.mDstOffset + i] = src[srcRange.mSrcOffset + i];
+			}
+			return true;
+		}
+	}
+
+	U32 GraphicsDeviceNull::FrameStats::GetTotalCommandCount() const
+	{
+		U32 count = 0;
+		for (U32 commandCount : mCommandCounts) {
+			count += commandCount;
+		}
+		return count;
+	}
+
+	void GraphicsDeviceNull::FrameStats::Merge(const FrameStats& stats)
+	{
+		for (I32 i = 0; i < (I32)CommandType::COUNT; i++) {
+			mCommandCounts[i] += stats.mCommandCounts[i];
+		}
+		mCompiledCommandLists += stats.mCompiledCommandLists;
+		mSubmittedCommandLists += stats.mSubmittedCommandLists;
+		mQueueWaits += stats.mQueueWaits;
+		mValidationErrors += stats.mValidationErrors;
+	}
+
+	GraphicsDeviceNull::GraphicsDeviceNull(bool isDebug) :
+		GraphicsDevice(GraphicsDeviceType::GraphicsDeviceType_Null)
+	{
+		mIsDebug = isDebug;
+		mCapabilities |= GPU_CAPABILITY_TESSELLATION;
+
+		Logger::Info("Graphics device null Iinitialized");
+	}
+
+	GraphicsDeviceNull::~GraphicsDeviceNull()
+	{
+		Logger::Info("Uninitialize graphics device null");
+	}
+
+	bool GraphicsDeviceNull::CreateCommandlist(ResHandle handle, GPU::CommandListType type)
+	{
+		auto cmd = mCommandLists.Write(handle);
+		if (IsResourceValid(*cmd, handle)) {
+			return true;
+		}
+
+		*cmd = CommandListNull();
+		cmd->mHash = handle.GetHash();
+		cmd->mType = type;
+		AddResource(RESOURCETYPE_COMMAND_LIST, 0, 0);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CompileCommandList(ResHandle handle, CommandList& cmd)
+	{
+		auto ptr = mCommandLists.Write(handle);
+		if (!IsResourceValid(*ptr, handle)) {
+			return false;
+		}
+
+		ptr->mType = cmd.GetType();
+		CompileContextNull context(*this, *ptr);
+		bool ret = context.Compile(cmd);
+		MergeFrameStats(context.GetStats());
+
+		ptr->mCommandCount = (U32)cmd.GetCommands().size();
+		ptr->mWaits.clear();
+		for (const ResHandle& wait : cmd.GetWaitCommandLists()) {
+			ptr->mWaits.push(wait);
+		}
+		return ret;
+	}
+
+	bool GraphicsDeviceNull::SubmitCommandLists(Span<ResHandle> handles)
+	{
+		FrameStats stats;
+		{
+			Concurrency::ScopedMutex lock(mQueueMutex);
+			for (const ResHandle& handle : handles)
+			{
+				auto cmd = mCommandLists.Write(handle);
+				if (!IsResourceValid(*cmd, handle)) {
+					stats.mValidationErrors++;
+					continue;
+				}
+	
+				// waited command lists must be submitted before, otherwise the queue is deadlocked
+				QueueTimelineEntry entry;
+				entry.mCommandList = handle;
+				entry.mQueue = cmd->mType;
+				entry.mBegin = mQueueTimes[cmd->mType];
+				for (const ResHandle& wait : cmd->mWaits)
+				{
+					auto waitCmd = mCommandLists.Read(wait);
+					if (!IsResourceValid(*waitCmd, wait) || !waitCmd->mIsSubmitted)
+					{
+						Logger::Warning("[GPU] Command list waits for a command list which is not submitted.");
+						stats.mValidationErrors++;
+						continue;
+					}
+					entry.mBegin = std::max(entry.mBegin, waitCmd->mTimelineEnd);
+					stats.mQueueWaits++;
+				}
+				entry.mEnd = entry.mBegin + std::max(cmd->mCommandCount, 1u);
+	
+				mQueueTimes[cmd->mType] = entry.mEnd;
+				mCurrentTimeline.push(entry);
+				cmd->mTimelineEnd = entry.mEnd;
+				cmd->mIsSubmitted = true;
+				stats.mSubmittedCommandLists++;
+			}
+		}
+		MergeFrameStats(stats);
+		return stats.mValidationErrors == 0;
+	}
+
+	void GraphicsDeviceNull::ResetCommandList(ResHandle handle)
+	{
+		auto cmd = mCommandLists.Write(handle);
+		if (IsResourceValid(*cmd, handle)) 
+		{
+			cmd->mIsSubmitted = false;
+		}
+	}
+
+	void GraphicsDeviceNull::Present(ResHandle handle, bool isVsync)
+	{
+	}
+
+	void GraphicsDeviceNull::EndFrame()
+	{
+		{
+			Concurrency::ScopedMutex lock(mStatsMutex);
+			mLastFrameStats = mCurrentFrameStats;
+			mCurrentFrameStats = FrameStats();
+			mCurrentFrameCount++;
+		}
+
+		// all queues are idle at the end of frame
+		Concurrency::ScopedMutex lock(mQueueMutex);
+		std::swap(mLastTimeline, mCurrentTimeline);
+		mCurrentTimeline.clear();
+		for (U64& time : mQueueTimes) {
+			time = 0;
+		}
+	}
+
+	bool GraphicsDeviceNull::CreateSwapChain(ResHandle handle, const SwapChainDesc* desc, Platform::WindowType window)
+	{
+		auto swapChain = mSwapChains.Write(handle);
+		if (!IsResourceValid(*swapChain, handle))
+		{
+			swapChain->mHash = handle.GetHash();
+			AddResource(RESOURCETYPE_SWAP_CHAIN, 0, 0);
+		}
+		swapChain->mDesc = *desc;
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreateFrameBindingSet(ResHandle handle, const FrameBindingSetDesc* desc)
+	{
+		auto bindingSet = mFrameBindingSets.Write(handle);
+		bindingSet->mHash = handle.GetHash();
+		bindingSet->mDesc = *desc;
+		AddResource(RESOURCETYPE_FRAME_BINDING_SET, 0, 0);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreateTexture(ResHandle handle, const TextureDesc* desc, const SubresourceData* initialData)
+	{
+		if (desc->mWidth == 0 || desc->mHeight == 0 || desc->mFormat == FORMAT_UNKNOWN)
+		{
+			Logger::Warning("[GPU] Invalid texture desc");
+			return false;
+		}
+
+		auto texture = mTextures.Write(handle);
+		texture->mHash = handle.GetHash();
+		texture->mDesc = *desc;
+		texture->mMemorySize = GetTextureMemorySize(*desc);
+		texture->mIsTransient = false;
+		texture->mIsResident = true;
+		AddResource(RESOURCETYPE_TEXTURE, 0, texture->mMemorySize);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreateTransientTexture(ResHandle handle, const TextureDesc* desc, const TransientPlacement* placement)
+	{
+		const U64 memorySize = GetTextureMemorySize(*desc);
+		if (placement != nullptr && placement->mSize < memorySize)
+		{
+			Logger::Warning("[GPU] Transient placement is too small, %llu < %llu", placement->mSize, memorySize);
+			return false;
+		}
+
+		auto texture = mTextures.Write(handle);
+		texture->mHash = handle.GetHash();
+		texture->mDesc = *desc;
+		texture->mMemorySize = memorySize;
+		texture->mIsTransient = true;
+		texture->mIsResident = false;
+		texture->mIsPlaced = placement != nullptr;
+		if (placement != nullptr)
+		{
+			texture->mPlacement = *placement;
+			AddTransientPlacement(*placement);
+		}
+		AddResource(RESOURCETYPE_TEXTURE, 0, 0);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreateBuffer(ResHandle handle, const BufferDesc* desc, const SubresourceData* initialData)
+	{
+		if (desc->mByteWidth == 0)
+		{
+			Logger::Warning("[GPU] Invalid buffer desc");
+			return false;
+		}
+		if (desc->mUsage == USAGE_IMMUTABLE && (initialData == nullptr || initialData->mSysMem == nullptr))
+		{
+			Logger::Warning("[GPU] Immutable buffer without initial data");
+			return false;
+		}
+
+		auto buffer = mBuffers.Write(handle);
+		*buffer = BufferNull();
+		buffer->mHash = handle.GetHash();
+		buffer->mDesc = *desc;
+		if (IsBufferCPUAccessible(*desc))
+		{
+			buffer->mData.resize(desc->mByteWidth);
+			if (initialData != nullptr && initialData->mSysMem != nullptr) {
+				Memory::Memcpy(buffer->mData.data(), initialData->mSysMem, desc->mByteWidth);
+			}
+		}
+		AddResource(RESOURCETYPE_BUFFER, desc->mByteWidth, 0);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreateShader(ResHandle handle, SHADERSTAGES stage, const void* bytecode, size_t length)
+	{
+		if (bytecode == nullptr || length == 0) {
+			return false;
+		}
+
+		auto shader = mShaders.Write(handle);
+		shader->mHash = handle.GetHash();
+		shader->mStage = stage;
+		shader->mByteCodeSize = length;
+		AddResource(RESOURCETYPE_SHADER, 0, 0);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreateSamplerState(ResHandle handle, const SamplerDesc* desc)
+	{
+		auto sampler = mSamplers.Write(handle);
+		sampler->mHash = handle.GetHash();
+		sampler->mDesc = *desc;
+		AddResource(RESOURCETYPE_SAMPLER_STATE, 0, 0);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreatePipelineState(ResHandle handle, const PipelineStateDesc* desc)
+	{
+		const ResHandle shaders[SHADERSTAGES_COUNT] = { desc->mVS, desc->mGS, desc->mHS, desc->mDS, desc->mPS, ResHandle::INVALID_HANDLE };
+		for (I32 stage = 0; stage < SHADERSTAGES_COUNT; stage++)
+		{
+			const ResHandle& shaderHandle = shaders[stage];
+			if (shaderHandle == ResHandle::INVALID_HANDLE) {
+				continue;
+			}
+
+			auto shader = mShaders.Read(shaderHandle);
+			if (!IsResourceValid(*shader, shaderHandle) || shader->mStage != (SHADERSTAGES)stage)
+			{
+				Logger::Warning("[GPU] Invalid shader of pipeline state, stage:%d", stage);
+				return false;
+			}
+		}
+
+		auto pipelineState = mPipelineStates.Write(handle);
+		pipelineState->mHash = handle.GetHash();
+		for (I32 stage = 0; stage < SHADERSTAGES_COUNT; stage++) {
+			pipelineState->mShaders[stage] = shaders[stage];
+		}
+		pipelineState->mPrimitiveTopology = desc->mPrimitiveTopology;
+		AddResource(RESOURCETYPE_PIPELINE, 0, 0);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreatePipelineBindingSet(ResHandle handle, const PipelineBindingSetDesc* desc)
+	{
+		auto bindingSet = mPipelineBindingSets.Write(handle);
+		*bindingSet = PipelineBindingSetNull();
+		bindingSet->mHash = handle.GetHash();
+		bindingSet->mSRVs.resize(desc->mNumSRVs);
+		bindingSet->mCBVs.resize(desc->mNumCBVs);
+		bindingSet->mUAVs.resize(desc->mNumUAVs);
+		bindingSet->mSAMs.resize(desc->mNumSamplers);
+		AddResource(RESOURCETYPE_PIPELINE_BINDING_SET, 0, 0);
+		return true;
+	}
+
+	bool GraphicsDeviceNull::CreateTempPipelineBindingSet(ResHandle handle, const PipelineBindingSetDesc* desc)
+	{
+		return CreatePipelineBindingSet(handle, desc);
+	}
+
+	bool GraphicsDeviceNull::UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingSRV> srvs)
+	{
+		for (const auto& srv : srvs)
+		{
+			const auto resType = srv.mResource.GetType();
+			if ((resType != RESOURCETYPE_BUFFER && resType != RESOURCETYPE_TEXTURE) || !IsResourceAlive(srv.mResource)) {
+				return false;
+			}
+		}
+
+		auto bindingSet = mPipelineBindingSets.Write(handle);
+		return IsResourceValid(*bindingSet, handle) && UpdateBindings(bindingSet->mSRVs, index, srvs);
+	}
+
+	bool GraphicsDeviceNull::UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingUAV> uavs)
+	{
+		for (const auto& uav : uavs)
+		{
+			const auto resType = uav.mResource.GetType();
+			if ((resType != RESOURCETYPE_BUFFER && resType != RESOURCETYPE_TEXTURE) || !IsResourceAlive(uav.mResource)) {
+				return false;
+			}
+		}
+
+		auto bindingSet = mPipelineBindingSets.Write(handle);
+		return IsResourceValid(*bindingSet, handle) && UpdateBindings(bindingSet->mUAVs, index, uavs);
+	}
+
+	bool GraphicsDeviceNull::UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingBuffer> cbvs)
+	{
+		for (const auto& cbv : cbvs)
+		{
+			if (cbv.mResource.GetType() != RESOURCETYPE_BUFFER || !IsResourceAlive(cbv.mResource)) {
+				return false;
+			}
+		}
+
+		auto bindingSet = mPipelineBindingSets.Write(handle);
+		return IsResourceValid(*bindingSet, handle) && UpdateBindings(bindingSet->mCBVs, index, cbvs);
+	}
+
+	bool GraphicsDeviceNull::UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingSAM> sams)
+	{
+		for (const auto& sam : sams)
+		{
+			if (sam.mResource.GetType() != RESOURCETYPE_SAMPLER_STATE || !IsResourceAlive(sam.mResource)) {
+				return false;
+			}
+		}
+
+		auto bindingSet = mPipelineBindingSets.Write(handle);
+		return IsResourceValid(*bindingSet, handle) && UpdateBindings(bindingSet->mSAMs, index, sams);
+	}
+
+	bool GraphicsDeviceNull::CopyPipelineBindings(const PipelineBinding& dst, const PipelineBinding& src)
+	{
+		if (dst.mPipelineBindingSet == src.mPipelineBindingSet) {
+			return true;
+		}
+
+		auto dstPbs = mPipelineBindingSets.Write(dst.mPipelineBindingSet);
+		auto srcPbs = mPipelineBindingSets.Read(src.mPipelineBindingSet);
+		if (!IsResourceValid(*dstPbs, dst.mPipelineBindingSet) || !IsResourceValid(*srcPbs, src.mPipelineBindingSet)) {
+			return false;
+		}
+
+		return CopyBindings(dstPbs->mCBVs, srcPbs->mCBVs, dst.mRangeCBVs, src.mRangeCBVs) &&
+			CopyBindings(dstPbs->mSRVs, srcPbs->mSRVs, dst.mRangeSRVs, src.mRangeSRVs) &&
+			CopyBindings(dstPbs->mUAVs, srcPbs->mUAVs, dst.mRangeUAVs, src.mRangeUAVs) &&
+			CopyBindings(dstPbs->mSAMs, srcPbs->mSAMs, dst.mRangeSamplers, src.mRangeSamplers);
+	}
+
+	void GraphicsDeviceNull::DestroyResource(ResHandle handle)
+	{
+		if (!IsResourceAlive(handle))
+		{
+			if (mIsDebug) {
+				Logger::Warning("[GPU] Destroy invalid resource %u", handle.GetHash());
+			}
+			return;
+		}
+
+		const ResourceType type = handle.GetType();
+		U64 bufferMemory = 0;
+		U64 textureMemory = 0;
+		switch (type)
+		{
+		case RESOURCETYPE_BUFFER:
+		{
+			auto buffer = mBuffers.Write(handle);
+			bufferMemory = buffer->mDesc.mByteWidth;
+			*buffer = BufferNull();
+		}
+		break;
+		case RESOURCETYPE_TEXTURE:
+		{
+			auto texture = mTextures.Write(handle);
+			if (!texture->mIsTransient) {
+				textureMemory = texture->mMemorySize;
+			}
+			*texture = TextureNull();
+		}
+		break;
+		case RESOURCETYPE_SHADER:
+			*mShaders.Write(handle) = ShaderNull();
+			break;
+		case RESOURCETYPE_COMMAND_LIST:
+			*mCommandLists.Write(handle) = CommandListNull();
+			break;
+		case RESOURCETYPE_SAMPLER_STATE:
+			*mSamplers.Write(handle) = SamplerStateNull();
+			break;
+		case RESOURCETYPE_PIPELINE:
+			*mPipelineStates.Write(handle) = PipelineStateNull();
+			break;
+		case RESOURCETYPE_PIPELINE_BINDING_SET:
+			*mPipelineBindingSets.Write(handle) = PipelineBindingSetNull();
+			break;
+		case RESOURCETYPE_FRAME_BINDING_SET:
+			*mFrameBindingSets.Write(handle) = FrameBindingSetNull();
+			break;
+		case RESOURCETYPE_SWAP_CHAIN:
+			*mSwapChains.Write(handle) = SwapChainNull();
+			break;
+		default:
+			return;
+		}
+		RemoveResource(type, bufferMemory, textureMemory);
+	}
+
+	void GraphicsDeviceNull::SetResourceName(ResHandle resource, const char* name)
+	{
+	}
+
+	void GraphicsDeviceNull::AddStaticSampler(const StaticSampler& sampler)
+	{
+		mStaticSamplers.push(sampler);
+	}
+
+	void GraphicsDeviceNull::Map(GPU::ResHandle res, GPUMapping& mapping)
+	{
+		mapping.mData = nullptr;
+		mapping.mRowPitch = 0;
+		if (res.GetType() != RESOURCETYPE_BUFFER) {
+			return;
+		}
+
+		auto buffer = mBuffers.Write(res);
+		if (!IsResourceValid(*buffer, res) || buffer->mData.empty() || buffer->mIsMapped) {
+			return;
+		}
+		if (mapping.mOffset + mapping.mSize > (size_t)buffer->mData.size()) {
+			return;
+		}
+
+		buffer->mIsMapped = true;
+		mapping.mData = buffer->mData.data() + mapping.mOffset;
+		mapping.mRowPitch = buffer->mDesc.mByteWidth;
+	}
+
+	void GraphicsDeviceNull::Unmap(GPU::ResHandle res)
+	{
+		if (res.GetType() != RESOURCETYPE_BUFFER) {
+			return;
+		}
+
+		auto buffer = mBuffers.Write(res);
+		if (IsResourceValid(*buffer, res)) {
+			buffer->mIsMapped = false;
+		}
+	}
+
+	GraphicsDeviceNull::FrameStats GraphicsDeviceNull::GetLastFrameStats()
+	{
+		Concurrency::ScopedMutex lock(mStatsMutex);
+		return mLastFrameStats;
+	}
+
+	DynamicArray<GraphicsDeviceNull::QueueTimelineEntry> GraphicsDeviceNull::GetLastFrameTimeline()
+	{
+		Concurrency::ScopedMutex lock(mQueueMutex);
+		return mLastTimeline;
+	}
+
+	U64 GraphicsDeviceNull::GetQueueOverlap(Span<const QueueTimelineEntry> timeline)
+	{
+		// command lists on the same queue are never overlapped
+		U64 overlap = 0;
+		for (const QueueTimelineEntry& graphics : timeline)
+		{
+			if (graphics.mQueue != COMMAND_LIST_GRAPHICS) {
+				continue;
+			}
+			for (const QueueTimelineEntry& compute : timeline)
+			{
+				if (compute.mQueue != COMMAND_LIST_ASYNC_COMPUTE) {
+					continue;
+				}
+				const U64 begin = std::max(graphics.mBegin, compute.mBegin);
+				const U64 end = std::min(graphics.mEnd, compute.mEnd);
+				if (begin < end) {
+					overlap += end - begin;
+				}
+			}
+		}
+		return overlap;
+	}
+
+	GraphicsDeviceNull::FrameStats GraphicsDeviceNull::GetCurrentFrameStats()
+	{
+		Concurrency::ScopedMutex lock(mStatsMutex);
+		return mCurrentFrameStats;
+	}
+
+	GraphicsDeviceNull::MemoryStats GraphicsDeviceNull::GetMemoryStats()
+	{
+		Concurrency::ScopedMutex lock(mStatsMutex);
+		return mMemoryStats;
+	}
+
+	bool GraphicsDeviceNull::IsResourceAlive(ResHandle handle)
+	{
+		switch (handle.GetType())
+		{
+		case RESOURCETYPE_BUFFER:
+			return IsResourceValid(*mBuffers.Read(handle), handle);
+		case RESOURCETYPE_TEXTURE:
+			return IsResourceValid(*mTextures.Read(handle), handle);
+		case RESOURCETYPE_SHADER:
+			return IsResourceValid(*mShaders.Read(handle), handle);
+		case RESOURCETYPE_COMMAND_LIST:
+			return IsResourceValid(*mCommandLists.Read(handle), handle);
+		case RESOURCETYPE_SAMPLER_STATE:
+			return IsResourceValid(*mSamplers.Read(handle), handle);
+		case RESOURCETYPE_PIPELINE:
+			return IsResourceValid(*mPipelineStates.Read(handle), handle);
+		case RESOURCETYPE_PIPELINE_BINDING_SET:
+			return IsResourceValid(*mPipelineBindingSets.Read(handle), handle);
+		case RESOURCETYPE_FRAME_BINDING_SET:
+			return IsResourceValid(*mFrameBindingSets.Read(handle), handle);
+		case RESOURCETYPE_SWAP_CHAIN:
+			return IsResourceValid(*mSwapChains.Read(handle), handle);
+		default:
+			break;
+		}
+		return false;
+	}
+
+	void GraphicsDeviceNull::AddResource(ResourceType type, U64 bufferMemory, U64 textureMemory)
+	{
+		Concurrency::ScopedMutex lock(mStatsMutex);
+		mMemoryStats.mResourceCounts[type]++;
+		mMemoryStats.mBufferMemory += bufferMemory;
+		mMemoryStats.mTextureMemory += textureMemory;
+	}
+
+	void GraphicsDeviceNull::RemoveResource(ResourceType type, U64 bufferMemory, U64 textureMemory)
+	{
+		Concurrency::ScopedMutex lock(mStatsMutex);
+		mMemoryStats.mResourceCounts[type]--;
+		mMemoryStats.mBufferMemory -= bufferMemory;
+		mMemoryStats.mTextureMemory -= textureMemory;
+	}
+
+	void GraphicsDeviceNull::AddTransientMemory(I64 memory)
+	{
+		if (memory == 0) {
+			return;
+		}
+
+		Concurrency::ScopedMutex lock(mStatsMutex);
+		mMemoryStats.mTransientMemory += (U64)memory;
+		mMemoryStats.mPeakTransientMemory = std::max(mMemoryStats.mPeakTransientMemory, mMemoryStats.mTransientMemory);
+	}
+
+	void GraphicsDeviceNull::AddTransientPlacement(const TransientPlacement& placement)
+	{
+		// heaps are never shrunk, so that the heap memory is the peak of placements
+		Concurrency::ScopedMutex lock(mStatsMutex);
+		while (placement.mHeap >= (U32)mTransientHeapSizes.size()) {
+			mTransientHeapSizes.push(0);
+		}
+
+		U64& heapSize = mTransientHeapSizes[placement.mHeap];
+		const U64 end = placement.mOffset + placement.mSize;
+		if (end > heapSize)
+		{
+			mMemoryStats.mTransientHeapMemory += end - heapSize;
+			heapSize = end;
+		}
+	}
+
+	void GraphicsDeviceNull::MergeFrameStats(const FrameStats& stats)
+	{
+		Concurrency::ScopedMutex lock(mStatsMutex);
+		mCurrentFrameStats.Merge(stats);
+	}
+
+	ScopedHeadlessDevice::ScopedHeadlessDevice(U32 width, U32 height)
+	{
+		GPUSetupParams params = {};
+		params.mIsHeadless = true;
+		params.mHeadlessWidth = width;
+		params.mHeadlessHeight = height;
+		GPU::Initialize(params);
+
+		Debug::CheckAssertion(GPU::GetDevice()->GetGraphicsDeviceType() == GraphicsDeviceType_Null);
+		mDevice = static_cast<GraphicsDeviceNull*>(GPU::GetDevice());
+	}
+
+	ScopedHeadlessDevice::~ScopedHeadlessDevice()
+	{
+		GPU::Uninitialize();
+	}
+}
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "gpu\device.h"
+#include "gpu\null\resourceNull.h"
+#include "core\concurrency\concurrency.h"
+
+namespace Cjing3D {
+namespace GPU
+{
+	class CompileContextNull;
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// GraphicsDeviceNull
+	/// Headless device without any graphics api. Resources only keep their descs, command lists are
+	/// validated during compiling and counted into frame stats, so that the CPU cost of render graph
+	/// and renderer could be measured on any platform.
+	class GraphicsDeviceNull : public GraphicsDevice
+	{
+	public:
+		friend class CompileContextNull;
+
+		struct FrameStats
+		{
+			U32 mCommandCounts[(I32)CommandType::COUNT] = {};
+			U32 mCompiledCommandLists = 0;
+			U32 mSubmittedCommandLists = 0;
+			U32 mQueueWaits = 0;			// cross-queue waits of submitted command lists
+			U32 mValidationErrors = 0;
+
+			U32 GetCommandCount(CommandType type)const { return mCommandCounts[(I32)type]; }
+			U32 GetTotalCommandCount()const;
+			void Merge(const FrameStats& stats);
+		};
+
+		struct MemoryStats
+		{
+			I32 mResourceCounts[RESOURCETYPE_COUNT] = {};
+			U64 mTextureMemory = 0;
+			U64 mBufferMemory = 0;
+			U64 mTransientMemory = 0;		// transient textures resident in render passes
+			U64 mPeakTransientMemory = 0;
+			U64 mTransientHeapMemory = 0;	// placed transient textures share the memory of heaps
+		};
+
+		// queues are simulated on submitting, a command list starts after the previous one on the same
+		// queue and the command lists it waits for, and lasts as many time units as its commands
+		struct QueueTimelineEntry
+		{
+			ResHandle mCommandList;
+			CommandListType mQueue = COMMAND_LIST_GRAPHICS;
+			U64 mBegin = 0;
+			U64 mEnd = 0;
+		};
+
+		// time units in which the graphics queue and the async compute queue are both busy
+		static U64 GetQueueOverlap(Span<const QueueTimelineEntry> timeline);
+
+		GraphicsDeviceNull(bool isDebug = false);
+		virtual ~GraphicsDeviceNull();
+
+		bool CreateCommandlist(ResHandle handle, GPU::CommandListType type)override;
+		bool CompileCommandList(ResHandle handle, CommandList& cmd)override;
+		bool SubmitCommandLists(Span<ResHandle> handles)override;
+		void ResetCommandList(ResHandle handle)override;
+		void Present(ResHandle handle, bool isVsync)override;
+		void EndFrame() override;
+
+		bool CreateSwapChain(ResHandle handle, const SwapChainDesc* desc, Platform::WindowType window)override;
+		bool CreateFrameBindingSet(ResHandle handle, const FrameBindingSetDesc* desc)override;
+		bool CreateTexture(ResHandle handle, const TextureDesc* desc, const SubresourceData* initialData)override;
+		bool CreateTransientTexture(ResHandle handle, const TextureDesc* desc, const TransientPlacement* placement)override;
+		bool CreateBuffer(ResHandle handle, const BufferDesc* desc, const SubresourceData* initialData)override;
+		bool CreateShader(ResHandle handle, SHADERSTAGES stage, const void* bytecode, size_t length)override;
+		bool CreateSamplerState(ResHandle handle, const SamplerDesc* desc)override;
+		bool CreatePipelineState(ResHandle handle, const PipelineStateDesc* desc)override;
+		bool CreatePipelineBindingSet(ResHandle handle, const PipelineBindingSetDesc* desc)override;
+		bool CreateTempPipelineBindingSet(ResHandle handle, const PipelineBindingSetDesc* desc)override;
+
+		bool UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingSRV> srvs)override;
+		bool UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingUAV> uavs)override;
+		bool UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingBuffer> cbvs)override;
+		bool UpdatePipelineBindingSet(ResHandle handle, I32 index, I32 slot, Span<const BindingSAM> sams)override;
+		bool CopyPipelineBindings(const PipelineBinding& dst, const PipelineBinding& src)override;
+
+		void DestroyResource(ResHandle handle)override;
+		void SetResourceName(ResHandle resource, const char* name)override;
+
+		void AddStaticSampler(const StaticSampler& sampler)override;
+		void Map(GPU::ResHandle res, GPUMapping& mapping)override;
+		void Unmap(GPU::ResHandle res)override;
+
+		// stats of the last ended frame
+		FrameStats GetLastFrameStats();
+		FrameStats GetCurrentFrameStats();
+		MemoryStats GetMemoryStats();
+		DynamicArray<QueueTimelineEntry> GetLastFrameTimeline();
+
+		// is the resource created and not destroyed, stale handles are invalid
+		bool IsResourceAlive(ResHandle handle);
+
+	private:
+		void AddResource(ResourceType type, U64 bufferMemory, U64 textureMemory);
+		void RemoveResource(ResourceType type, U64 bufferMemory, U64 textureMemory);
+		void AddTransientMemory(I64 memory);
+		void AddTransientPlacement(const TransientPlacement& placement);
+		void MergeFrameStats(const FrameStats& stats);
+
+	private:
+		ResourcePool<SwapChainNull> mSwapChains;
+		ResourcePool<TextureNull> mTextures;
+		ResourcePool<BufferNull> mBuffers;
+		ResourcePool<ShaderNull> mShaders;
+		ResourcePool<SamplerStateNull> mSamplers;
+		ResourcePool<PipelineStateNull> mPipelineStates;
+		ResourcePool<PipelineBindingSetNull> mPipelineBindingSets;
+		ResourcePool<CommandListNull> mCommandLists;
+		ResourcePool<FrameBindingSetNull> mFrameBindingSets;
+
+		DynamicArray<StaticSampler> mStaticSamplers;
+
+		Concurrency::Mutex mStatsMutex;
+		FrameStats mCurrentFrameStats;
+		FrameStats mLastFrameStats;
+		MemoryStats mMemoryStats;
+		DynamicArray<U64> mTransientHeapSizes;
+		Concurrency::Mutex mQueueMutex;
+		U64 mQueueTimes[COMMAND_LIST_TYPE_COUNT] = {};
+		DynamicArray<QueueTimelineEntry> mCurrentTimeline;
+		DynamicArray<QueueTimelineEntry> mLastTimeline;
+	};
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// ScopedHeadlessDevice
+	/// GPU is initialized with the headless null device in the scope, used by tests and benchmarks.
+	class ScopedHeadlessDevice
+	{
+	public:
+		ScopedHeadlessDevice(U32 width = 1280, U32 height = 720);
+		~ScopedHeadlessDevice();
+
+		GraphicsDeviceNull* GetDevice() { return mDevice; }
+		GraphicsDeviceNull* operator->() { return mDevice; }
+
+	private:
+		GraphicsDeviceNull* mDevice = nullptr;
+	};
+}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "gpu\resource.h"
+
+namespace Cjing3D
+{
+namespace GPU
+{
+	// mHash is the hash of the handle which created the resource, it is zero
+	// if the resource is destroyed, so that stale handles could be detected
+	struct ResourceNull
+	{
+		ResHandleHash mHash = 0;
+	};
+
+	struct SwapChainNull : ResourceNull
+	{
+		SwapChainDesc mDesc;
+	};
+
+	struct TextureNull : ResourceNull
+	{
+		TextureDesc mDesc;
+		U64 mMemorySize = 0;
+		bool mIsTransient = false;
+		bool mIsResident = false;	// transient textures are resident in render passes
+		bool mIsPlaced = false;
+		TransientPlacement mPlacement;
+	};
+
+	struct BufferNull : ResourceNull
+	{
+		BufferDesc mDesc;
+		DynamicArray<U8> mData;		// only cpu accessible buffers have data
+		bool mIsMapped = false;
+	};
+
+	struct SamplerStateNull : ResourceNull
+	{
+		SamplerDesc mDesc;
+	};
+
+	struct ShaderNull : ResourceNull
+	{
+		SHADERSTAGES mStage = SHADERSTAGES::SHADERSTAGES_COUNT;
+		size_t mByteCodeSize = 0;
+	};
+
+	struct PipelineStateNull : ResourceNull
+	{
+		ResHandle mShaders[SHADERSTAGES_COUNT];
+		PRIMITIVE_TOPOLOGY mPrimitiveTopology = TRIANGLELIST;
+	};
+
+	struct PipelineBindingSetNull : ResourceNull
+	{
+		DynamicArray<BindingSRV> mSRVs;
+		DynamicArray<BindingBuffer> mCBVs;
+		DynamicArray<BindingUAV> mUAVs;
+		DynamicArray<BindingSAM> mSAMs;
+	};
+
+	struct FrameBindingSetNull : ResourceNull
+	{
+		FrameBindingSetDesc mDesc;
+	};
+
+	struct CommandListNull : ResourceNull
+	{
+		CommandListType mType = COMMAND_LIST_GRAPHICS;
+
+		// queue simulation
+		DynamicArray<ResHandle> mWaits;
+		U32 mCommandCount = 0;
+		bool mIsSubmitted = false;
+		U64 mTimelineEnd = 0;
+	};
+}
+}
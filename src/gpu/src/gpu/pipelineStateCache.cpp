@@ -0,0 +1,382 @@
+#include "pipelineStateCache.h"
+
+namespace Cjing3D {
+namespace GPU
+{
+	namespace
+	{
+		// fields are hashed separately, paddings of structs are undefined
+		template<typename T>
+		void HashValue(U64& hash, const T& value)
+		{
+			hash = FNV1aHash(hash, &value, sizeof(T));
+		}
+
+		void HashBlendState(U64& hash, const BlendStateDesc& desc)
+		{
+			HashValue(hash, desc.mAlphaToCoverageEnable);
+			HashValue(hash, desc.mIndependentBlendEnable);
+			for (const RenderTargetBlendStateDesc& target : desc.mRenderTarget)
+			{
+				HashValue(hash, target.mBlendEnable);
+				HashValue(hash, target.mSrcBlend);
+				HashValue(hash, target.mDstBlend);
+				HashValue(hash, target.mBlendOp);
+				HashValue(hash, target.mSrcBlendAlpha);
+				HashValue(hash, target.mDstBlendAlpha);
+				HashValue(hash, target.mBlendOpAlpha);
+				HashValue(hash, target.mRenderTargetWriteMask);
+			}
+		}
+
+		void HashRasterizerState(U64& hash, const RasterizerStateDesc& desc)
+		{
+			HashValue(hash, desc.mFillMode);
+			HashValue(hash, desc.mCullMode);
+			HashValue(hash, desc.mFrontCounterClockwise);
+			HashValue(hash, desc.mDepthBias);
+			HashValue(hash, desc.mDepthBiasClamp);
+			HashValue(hash, desc.mSlopeScaleDepthBias);
+			HashValue(hash, desc.mDepthClipEnable);
+			HashValue(hash, desc.mMultisampleEnable);
+			HashValue(hash, desc.mAntialiaseLineEnable);
+			HashValue(hash, desc.mConservativeRasterizationEnable);
+			HashValue(hash, desc.mForcedSampleCount);
+		}
+
+		void HashDepthStencilOp(U64& hash, const DepthStencilOpDesc& desc)
+		{
+			HashValue(hash, desc.mStencilFailOp);
+			HashValue(hash, desc.mStencilDepthFailOp);
+			HashValue(hash, desc.mStencilPassOp);
+			HashValue(hash, desc.mStencilFunc);
+		}
+
+		void HashDepthStencilState(U64& hash, const DepthStencilStateDesc& desc)
+		{
+			HashValue(hash, desc.mDepthEnable);
+			HashValue(hash, desc.mDepthWriteMask);
+			HashValue(hash, desc.mDepthFunc);
+			HashValue(hash, desc.mStencilEnable);
+			HashValue(hash, desc.mStencilReadMask);
+			HashValue(hash, desc.mStencilWriteMask);
+			HashDepthStencilOp(hash, desc.mFrontFace);
+			HashDepthStencilOp(hash, desc.mBackFace);
+		}
+
+		void HashInputLayout(U64& hash, const InputLayoutDesc& desc)
+		{
+			HashValue(hash, (U32)desc.mElements.size());
+			for (const VertexElement& element : desc.mElements)
+			{
+				// semantic names are compared by contents
+				if (element.mSemanticName != nullptr) {
+					hash = HashFunc(hash, element.mSemanticName);
+				}
+				HashValue(hash, element.mSemanticIndex);
+				HashValue(hash, element.mFormat);
+				HashValue(hash, element.mInputSlot);
+				HashValue(hash, element.mAlignedByteOffset);
+				HashValue(hash, element.mInputSlotClass);
+				HashValue(hash, element.mInstanceDataStepRate);
+			}
+		}
+
+		// fields are compared separately as hashing
+		bool IsBlendStateEqual(const BlendStateDesc& lhs, const BlendStateDesc& rhs)
+		{
+			if (lhs.mAlphaToCoverageEnable != rhs.mAlphaToCoverageEnable ||
+				lhs.mIndependentBlendEnable != rhs.mIndependentBlendEnable) {
+				return false;
+			}
+
+			const RenderTargetBlendStateDesc* target = rhs.mRenderTarget;
+			for (const RenderTargetBlendStateDesc& a : lhs.mRenderTarget)
+			{
+				const RenderTargetBlendStateDesc& b = *target++;
+				if (a.mBlendEnable != b.mBlendEnable ||
+					a.mSrcBlend != b.mSrcBlend ||
+					a.mDstBlend != b.mDstBlend ||
+					a.mBlendOp != b.mBlendOp ||
+					a.mSrcBlendAlpha != b.mSrcBlendAlpha ||
+					a.mDstBlendAlpha != b.mDstBlendAlpha ||
+					a.mBlendOpAlpha != b.mBlendOpAlpha ||
+					a.mRenderTargetWriteMask != b.mRenderTargetWriteMask) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool IsRasterizerStateEqual(const RasterizerStateDesc& lhs, const RasterizerStateDesc& rhs)
+		{
+			return lhs.mFillMode == rhs.mFillMode &&
+				lhs.mCullMode == rhs.mCullMode &&
+				lhs.mFrontCounterClockwise == rhs.mFrontCounterClockwise &&
+				lhs.mDepthBias == rhs.mDepthBias &&
+				lhs.mDepthBiasClamp == rhs.mDepthBiasClamp &&
+				lhs.mSlopeScaleDepthBias == rhs.mSlopeScaleDepthBias &&
+				lhs.mDepthClipEnable == rhs.mDepthClipEnable &&
+				lhs.mMultisampleEnable == rhs.mMultisampleEnable &&
+				lhs.mAntialiaseLineEnable == rhs.mAntialiaseLineEnable &&
+				lhs.mConservativeRasterizationEnable == rhs.mConservativeRasterizationEnable &&
+				lhs.mForcedSampleCount == rhs.mForcedSampleCount;
+		}
+
+		bool IsDepthStencilOpEqual(const DepthStencilOpDesc& lhs, const DepthStencilOpDesc& rhs)
+		{
+			return lhs.mStencilFailOp == rhs.mStencilFailOp &&
+				lhs.mStencilDepthFailOp == rhs.mStencilDepthFailOp &&
+				lhs.mStencilPassOp == rhs.mStencilPassOp &&
+				lhs.mStencilFunc == rhs.mStencilFunc;
+		}
+
+		bool IsDepthStencilStateEqual(const DepthStencilStateDesc& lhs, const DepthStencilStateDesc& rhs)
+		{
+			return lhs.mDepthEnable == rhs.mDepthEnable &&
+				lhs.mDepthWriteMask == rhs.mDepthWriteMask &&
+				lhs.mDepthFunc == rhs.mDepthFunc &&
+				lhs.mStencilEnable == rhs.mStencilEnable &&
+				lhs.mStencilReadMask == rhs.mStencilReadMask &&
+				lhs.mStencilWriteMask == rhs.mStencilWriteMask &&
+				IsDepthStencilOpEqual(lhs.mFrontFace, rhs.mFrontFace) &&
+				IsDepthStencilOpEqual(lhs.mBackFace, rhs.mBackFace);
+		}
+	}
+
+	void PipelineStateCache::CachedDesc::Set(const PipelineStateDesc& desc)
+	{
+		mShaders[0] = desc.mVS;
+		mShaders[1] = desc.mPS;
+		mShaders[2] = desc.mHS;
+		mShaders[3] = desc.mDS;
+		mShaders[4] = desc.mGS;
+
+		mHasBlendState = desc.mBlendState != nullptr;
+		if (mHasBlendState) {
+			mBlendState = *desc.mBlendState;
+		}
+		mHasRasterizerState = desc.mRasterizerState != nullptr;
+		if (mHasRasterizerState) {
+			mRasterizerState = *desc.mRasterizerState;
+		}
+		mHasDepthStencilState = desc.mDepthStencilState != nullptr;
+		if (mHasDepthStencilState) {
+			mDepthStencilState = *desc.mDepthStencilState;
+		}
+
+		// semantic names are owned by the cache
+		mHasInputLayout = desc.mInputLayout != nullptr;
+		if (mHasInputLayout)
+		{
+			mInputLayout = *desc.mInputLayout;
+			for (VertexElement& element : mInputLayout.mElements)
+			{
+				mSemanticNames.push(element.mSemanticName != nullptr ? element.mSemanticName : "");
+				element.mSemanticName = nullptr;
+			}
+		}
+		mPrimitiveTopology = desc.mPrimitiveTopology;
+	}
+
+	bool PipelineStateCache::CachedDesc::Equals(const PipelineStateDesc& desc)const
+	{
+		const ResHandle shaders[] = { desc.mVS, desc.mPS, desc.mHS, desc.mDS, desc.mGS };
+		I32 shaderIndex = 0;
+		for (const ResHandle& shader : shaders)
+		{
+			if (mShaders[shaderIndex++] != shader) {
+				return false;
+			}
+		}
+
+		if (mHasBlendState != (desc.mBlendState != nullptr) ||
+			(mHasBlendState && !IsBlendStateEqual(mBlendState, *desc.mBlendState))) {
+			return false;
+		}
+		if (mHasRasterizerState != (desc.mRasterizerState != nullptr) ||
+			(mHasRasterizerState && !IsRasterizerStateEqual(mRasterizerState, *desc.mRasterizerState))) {
+			return false;
+		}
+		if (mHasDepthStencilState != (desc.mDepthStencilState != nullptr) ||
+			(mHasDepthStencilState && !IsDepthStencilStateEqual(mDepthStencilState, *desc.mDepthStencilState))) {
+			return false;
+		}
+
+		if (mHasInputLayout != (desc.mInputLayout != nullptr)) {
+			return false;
+		}
+		if (mHasInputLayout)
+		{
+			const auto& elements = desc.mInputLayout->mElements;
+			if (mInputLayout.mElements.size() != elements.size()) {
+				return false;
+			}
+
+			for (I32 i = 0; i < elements.size(); i++)
+			{
+				const VertexElement& a = mInputLayout.mElements[i];
+				const VertexElement& b = elements[i];
+				const char* semanticName = b.mSemanticName != nullptr ? b.mSemanticName : "";
+				if (mSemanticNames[i] != semanticName ||
+					a.mSemanticIndex != b.mSemanticIndex ||
+					a.mFormat != b.mFormat ||
+					a.mInputSlot != b.mInputSlot ||
+					a.mAlignedByteOffset != b.mAlignedByteOffset ||
+					a.mInputSlotClass != b.mInputSlotClass ||
+					a.mInstanceDataStepRate != b.mInstanceDataStepRate) {
+					return false;
+				}
+			}
+		}
+		return mPrimitiveTopology == desc.mPrimitiveTopology;
+	}
+
+	U64 PipelineStateCache::HashDesc(const PipelineStateDesc& desc)
+	{
+		U64 hash = FNV1A_64_INIT;
+		const ResHandle shaders[] = { desc.mVS, desc.mPS, desc.mHS, desc.mDS, desc.mGS };
+		for (const ResHandle& shader : shaders) {
+			HashValue(hash, shader.GetHash());
+		}
+
+		// null states are different from default states
+		HashValue(hash, desc.mBlendState != nullptr);
+		if (desc.mBlendState != nullptr) {
+			HashBlendState(hash, *desc.mBlendState);
+		}
+		HashValue(hash, desc.mRasterizerState != nullptr);
+		if (desc.mRasterizerState != nullptr) {
+			HashRasterizerState(hash, *desc.mRasterizerState);
+		}
+		HashValue(hash, desc.mDepthStencilState != nullptr);
+		if (desc.mDepthStencilState != nullptr) {
+			HashDepthStencilState(hash, *desc.mDepthStencilState);
+		}
+		HashValue(hash, desc.mInputLayout != nullptr);
+		if (desc.mInputLayout != nullptr) {
+			HashInputLayout(hash, *desc.mInputLayout);
+		}
+		HashValue(hash, desc.mPrimitiveTopology);
+		return hash;
+	}
+
+	ResHandle PipelineStateCache::Acquire(U64 hash, const PipelineStateDesc& desc, bool isPrecompiling)
+	{
+		Concurrency::ScopedSpinLock lock(mLock);
+		Entry* entry = mEntries.find(hash);
+		if (entry == nullptr || !entry->mDesc.Equals(desc))
+		{
+			if (!isPrecompiling) {
+				mStats.mMissCount++;
+			}
+			return ResHandle::INVALID_HANDLE;
+		}
+		return AcquireEntry(*entry, isPrecompiling);
+	}
+
+	ResHandle PipelineStateCache::Add(U64 hash, const PipelineStateDesc& desc, ResHandle handle, bool isPrecompiling)
+	{
+		Concurrency::ScopedSpinLock lock(mLock);
+		Entry* entry = mEntries.find(hash);
+		if (entry != nullptr && !entry->mDesc.Equals(desc))
+		{
+			// hash collided with another desc, the pipeline state is not shared
+			Logger::Warning("[GPU] The hash of pipeline state is collided, the pipeline state is not cached.");
+			return handle;
+		}
+		else if (entry != nullptr)
+		{
+			// created concurrently, the miss is already counted
+			if (!isPrecompiling) {
+				mStats.mMissCount--;
+			}
+			return AcquireEntry(*entry, isPrecompiling);
+		}
+
+		Entry newEntry;
+		newEntry.mDesc.Set(desc);
+		newEntry.mHandle = handle;
+		newEntry.mRefCount = 1;
+		newEntry.mIsPrecompiled = isPrecompiling;
+		mEntries.insert(hash, newEntry);
+		mHandleHashes.insert(handle.GetHash(), hash);
+		if (isPrecompiling) {
+			mStats.mPrecompiledCount++;
+		}
+		return handle;
+	}
+
+	bool PipelineStateCache::Release(ResHandle handle)
+	{
+		Concurrency::ScopedSpinLock lock(mLock);
+		const U64* hash = mHandleHashes.find(handle.GetHash());
+		if (hash == nullptr) {
+			return true;
+		}
+
+		Entry* entry = mEntries.find(*hash);
+		Debug::CheckAssertion(entry != nullptr && entry->mHandle == handle);
+		if (--entry->mRefCount > 0) {
+			return false;
+		}
+
+		mEntries.erase(*hash);
+		mHandleHashes.erase(handle.GetHash());
+		return true;
+	}
+
+	void PipelineStateCache::ReleasePrecompiled(DynamicArray<ResHandle>& releasedHandles)
+	{
+		Concurrency::ScopedSpinLock lock(mLock);
+		DynamicArray<U64> releasedHashes;
+		for (auto kvp : mEntries)
+		{
+			Entry& entry = kvp.second;
+			if (!entry.mIsPrecompiled) {
+				continue;
+			}
+
+			entry.mIsPrecompiled = false;
+			if (--entry.mRefCount <= 0)
+			{
+				releasedHashes.push(kvp.first);
+				releasedHandles.push(entry.mHandle);
+			}
+		}
+
+		for (U64 hash : releasedHashes)
+		{
+			Entry* entry = mEntries.find(hash);
+			mHandleHashes.erase(entry->mHandle.GetHash());
+			mEntries.erase(hash);
+		}
+	}
+
+	PipelineStateCacheStats PipelineStateCache::GetStats()
+	{
+		Concurrency::ScopedSpinLock lock(mLock);
+		PipelineStateCacheStats stats = mStats;
+		stats.mCachedCount = mEntries.size();
+		return stats;
+	}
+
+	ResHandle PipelineStateCache::AcquireEntry(Entry& entry, bool isPrecompiling)
+	{
+		if (isPrecompiling)
+		{
+			// the cache holds a reference of precompiled pipeline state
+			if (!entry.mIsPrecompiled)
+			{
+				entry.mIsPrecompiled = true;
+				entry.mRefCount++;
+			}
+			return entry.mHandle;
+		}
+
+		entry.mRefCount++;
+		mStats.mHitCount++;
+		return entry.mHandle;
+	}
+}
+}
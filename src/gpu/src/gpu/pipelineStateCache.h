@@ -0,0 +1,88 @@
+#pragma once
+
+#include "definitions.h"
+#include "resource.h"
+#include "core\container\hashMap.h"
+#include "core\concurrency\concurrency.h"
+#include "core\string\string.h"
+
+namespace Cjing3D {
+namespace GPU
+{
+	struct PipelineStateCacheStats
+	{
+		U32 mHitCount = 0;
+		U32 mMissCount = 0;
+		U32 mPrecompiledCount = 0;
+		U32 mCachedCount = 0;			// pipeline states alive in the cache
+
+		F32 GetHitRate()const {
+			const U32 count = mHitCount + mMissCount;
+			return count > 0 ? (F32)mHitCount / (F32)count : 0.0f;
+		}
+	};
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// PipelineStateCache
+	/// Pipeline states are shared by the hash of PipelineStateDesc (shaders, blend, rasterizer and depth
+	/// stencil states, input layout and topology), creating the same desc again returns the cached handle
+	/// with a new reference. The handle is destroyed when all references are released, precompiled
+	/// pipeline states hold a reference until the cache is cleared. Descs are copied into the cache and
+	/// compared on hits, a desc colliding with a cached one of the same hash is not cached.
+	class PipelineStateCache
+	{
+	public:
+		PipelineStateCache() = default;
+		~PipelineStateCache() = default;
+
+		static U64 HashDesc(const PipelineStateDesc& desc);
+
+		// find the pipeline state and add a reference, INVALID_HANDLE is returned if not cached
+		ResHandle Acquire(U64 hash, const PipelineStateDesc& desc, bool isPrecompiling);
+		// add the created pipeline state, if the same desc is added concurrently, the cached one is
+		// returned and the created handle should be destroyed
+		ResHandle Add(U64 hash, const PipelineStateDesc& desc, ResHandle handle, bool isPrecompiling);
+		// release a reference, return true if the pipeline state should be destroyed
+		bool Release(ResHandle handle);
+		// release references of precompiled pipeline states, handles which should be destroyed are returned
+		void ReleasePrecompiled(DynamicArray<ResHandle>& releasedHandles);
+
+		PipelineStateCacheStats GetStats();
+
+	private:
+		// states are copied since pointers of desc are owned by the caller
+		struct CachedDesc
+		{
+			ResHandle mShaders[5];
+			bool mHasBlendState = false;
+			BlendStateDesc mBlendState;
+			bool mHasRasterizerState = false;
+			RasterizerStateDesc mRasterizerState;
+			bool mHasDepthStencilState = false;
+			DepthStencilStateDesc mDepthStencilState;
+			bool mHasInputLayout = false;
+			InputLayoutDesc mInputLayout;
+			DynamicArray<String> mSemanticNames;
+			PRIMITIVE_TOPOLOGY mPrimitiveTopology = TRIANGLELIST;
+
+			void Set(const PipelineStateDesc& desc);
+			bool Equals(const PipelineStateDesc& desc)const;
+		};
+
+		struct Entry
+		{
+			CachedDesc mDesc;
+			ResHandle mHandle;
+			I32 mRefCount = 0;
+			bool mIsPrecompiled = false;
+		};
+
+		ResHandle AcquireEntry(Entry& entry, bool isPrecompiling);
+
+		Concurrency::SpinLock mLock;
+		HashMap<U64, Entry> mEntries;
+		HashMap<U32, U64> mHandleHashes;
+		PipelineStateCacheStats mStats;
+	};
+}
+}
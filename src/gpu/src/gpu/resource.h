@@ -180,17 +180,13 @@ namespace GPU
 
 		ResourceRead<T> Read(ResHandle handle)
 		{
-			Concurrency::ScopedReadLock lock(mLock);
-			I32 index = handle.GetIndex();
-			Resource& res = GetResource(index);
+			Resource& res = GetResourceLocked(handle.GetIndex());
 			return ResourceRead<T>(res.mLock, res.mInst);
 		}
 
 		ResourceWrite<T> Write(ResHandle handle)
 		{
-			Concurrency::ScopedWriteLock lock(mLock);
-			I32 index = handle.GetIndex();
-			Resource& res = GetResource(index);
+			Resource& res = GetResourceLocked(handle.GetIndex());
 			return ResourceWrite<T>(res.mLock, res.mInst);
 		}
 
@@ -203,6 +199,19 @@ namespace GPU
 		}
 
 	private:
+		// blocks are never released until reset, the pool is only locked exclusively to grow
+		Resource& GetResourceLocked(I32 index)
+		{
+			{
+				Concurrency::ScopedReadLock lock(mLock);
+				if ((index >> INDEX_BITS) < mBlockResources.size()) {
+					return GetResource(index);
+				}
+			}
+			Concurrency::ScopedWriteLock lock(mLock);
+			return GetResource(index);
+		}
+
 		Concurrency::RWLock mLock;
 		GPUAllocator mAllocator;
 	};
@@ -346,6 +355,7 @@ namespace GPU
 		{
 			GPUBarrier barrier;
 			barrier.mType = MEMORY_BARRIER;
+			barrier.mMemory.mResHash = resource.GetHash();
 
 			return barrier;
 		}
@@ -354,6 +364,7 @@ namespace GPU
 		{
 			GPUBarrier barrier;
 			barrier.mType = IMAGE_BARRIER;
+			barrier.mImage.mResHash = resource.GetHash();
 
 			return barrier;
 		}
@@ -362,11 +373,21 @@ namespace GPU
 		{
 			GPUBarrier barrier;
 			barrier.mType = BUFFER_BARRIER;
+			barrier.mBuffer.mResHash = resource.GetHash();
 
 			return barrier;
 		}
 	};
 
+	// placement of a transient resource in a transient heap, resources placed in the
+	// overlapped range of the same heap must not be resident at the same time
+	struct TransientPlacement
+	{
+		U32 mHeap = 0;
+		U64 mOffset = 0;
+		U64 mSize = 0;
+	};
+
 	struct RenderPassInfo
 	{
 		DynamicArray<GPU::ResHandle> mTextures;
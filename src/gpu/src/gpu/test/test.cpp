@@ -0,0 +1,761 @@
+//#define CJING_TEST_GPU
+#ifdef CJING_TEST_GPU
+
+#include "gpu\gpu.h"
+#include "gpu\null\deviceNull.h"
+#include "core\concurrency\concurrency.h"
+#include "core\concurrency\jobsystem.h"
+#include "core\helper\handle.h"
+#include "core\helper\timer.h"
+
+#define CATCH_CONFIG_RUNNER
+#include "catch\catch.hpp"
+
+using namespace Cjing3D;
+
+static StdoutLoggerSink mTestStdoutLoggerSink;
+
+TEST_CASE("CommandList merge secondaries", "[GPU]")
+{
+	GPU::CommandList cmd(1024);
+	GPU::CommandList secondaries[2] = { GPU::CommandList(1024), GPU::CommandList(1024) };
+	GPU::CommandList* secondaryPtrs[2] = { &secondaries[0], &secondaries[1] };
+	for (auto& secondary : secondaries) {
+		secondary.SetParent(&cmd);
+	}
+
+	cmd.Draw(0, 0);
+	secondaries[1].Draw(3, 0);
+	secondaries[0].Draw(1, 0);
+	secondaries[0].Draw(2, 0);
+	cmd.MergeSecondaries(cmd.GetCommands().size(), Span(secondaryPtrs, 2));
+	cmd.Draw(4, 0);
+
+	auto& commands = cmd.GetCommands();
+	REQUIRE(commands.size() == 5);
+	for (I32 i = 0; i < commands.size(); i++) {
+		REQUIRE(static_cast<GPU::CommandDraw*>(commands[i])->mVertexCount == i);
+	}
+
+	cmd.Reset();
+	REQUIRE(cmd.GetParent() == nullptr);
+}
+
+TEST_CASE("GraphicsDeviceNull", "[GPU]")
+{
+	GPU::ScopedHeadlessDevice device(256, 256);
+
+	REQUIRE(device->GetGraphicsDeviceType() == GPU::GraphicsDeviceType_Null);
+
+	// resources
+	GPU::TextureDesc colorDesc;
+	colorDesc.mWidth = 256;
+	colorDesc.mHeight = 256;
+	colorDesc.mFormat = GPU::FORMAT_R8G8B8A8_UNORM;
+	colorDesc.mBindFlags = GPU::BIND_RENDER_TARGET | GPU::BIND_SHADER_RESOURCE;
+	GPU::ResHandle color = GPU::CreateTexture(&colorDesc, nullptr, "Color");
+
+	GPU::TextureDesc depthDesc = colorDesc;
+	depthDesc.mFormat = GPU::FORMAT_D32_FLOAT;
+	depthDesc.mBindFlags = GPU::BIND_DEPTH_STENCIL;
+	GPU::ResHandle depth = GPU::CreateTexture(&depthDesc, nullptr, "Depth");
+
+	GPU::BufferDesc bufferDesc;
+	bufferDesc.mByteWidth = 1024;
+	bufferDesc.mBindFlags = GPU::BIND_VERTEX_BUFFER;
+	GPU::ResHandle vertexBuffer = GPU::CreateBuffer(&bufferDesc, nullptr, "VertexBuffer");
+
+	const U8 byteCode[4] = {};
+	GPU::ResHandle vs = GPU::CreateShader(GPU::SHADERSTAGES_VS, byteCode, sizeof(byteCode));
+	GPU::ResHandle ps = GPU::CreateShader(GPU::SHADERSTAGES_PS, byteCode, sizeof(byteCode));
+	GPU::PipelineStateDesc pipelineDesc;
+	pipelineDesc.mVS = vs;
+	pipelineDesc.mPS = ps;
+	GPU::ResHandle pipeline = GPU::CreatePipelineState(&pipelineDesc);
+
+	GPU::FrameBindingSetDesc frameBindingSetDesc;
+	frameBindingSetDesc.mAttachments.push(GPU::BindingFrameAttachment::RenderTarget(color));
+	frameBindingSetDesc.mAttachments.push(GPU::BindingFrameAttachment::DepthStencil(depth));
+	GPU::ResHandle frameBindingSet = GPU::CreateFrameBindingSet(&frameBindingSetDesc);
+
+	REQUIRE(color);
+	REQUIRE(depth);
+	REQUIRE(vertexBuffer);
+	REQUIRE(pipeline);
+	REQUIRE(frameBindingSet);
+
+	auto memoryStats = device->GetMemoryStats();
+	REQUIRE(memoryStats.mTextureMemory == GPU::GetTextureSize(GPU::FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 1) + GPU::GetTextureSize(GPU::FORMAT_D32_FLOAT, 256, 256, 1, 1));
+	REQUIRE(memoryStats.mBufferMemory == 1024);
+	REQUIRE(memoryStats.mResourceCounts[GPU::RESOURCETYPE_TEXTURE] == 2);
+
+	// valid command list
+	GPU::CommandList* cmd = GPU::CreateCommandlist();
+	cmd->EventBegin("Valid");
+	cmd->BeginFrameBindingSet(frameBindingSet);
+	cmd->BindPipelineState(pipeline);
+	GPU::BindingBuffer vertexBinding = GPU::Binding::VertexBuffer(vertexBuffer, 0, 16);
+	cmd->BindVertexBuffer(Span(&vertexBinding, 1));
+	for (I32 i = 0; i < 100; i++) {
+		cmd->Draw(3, 0);
+	}
+	cmd->EndFrameBindingSet();
+	cmd->EventEnd();
+	REQUIRE(GPU::CompileCommandList(*cmd));
+
+	// draw without pipeline state and unbalanced event
+	GPU::CommandList* invalidCmd = GPU::CreateCommandlist();
+	invalidCmd->BeginFrameBindingSet(frameBindingSet);
+	invalidCmd->Draw(3, 0);
+	invalidCmd->EndFrameBindingSet();
+	invalidCmd->EventBegin("Invalid");
+	REQUIRE_FALSE(GPU::CompileCommandList(*invalidCmd));
+
+	GPU::SubmitCommandLists();
+	auto frameStats = device->GetCurrentFrameStats();
+	REQUIRE(frameStats.GetCommandCount(GPU::CommandType::DRAW) == 101);
+	REQUIRE(frameStats.GetTotalCommandCount() == 106 + 4);
+	REQUIRE(frameStats.mCompiledCommandLists == 2);
+	REQUIRE(frameStats.mSubmittedCommandLists == 2);
+	REQUIRE(frameStats.mValidationErrors == 2);
+
+	GPU::EndFrame();
+	REQUIRE(device->GetLastFrameStats().GetTotalCommandCount() == frameStats.GetTotalCommandCount());
+	REQUIRE(device->GetCurrentFrameStats().GetTotalCommandCount() == 0);
+
+	// transient textures are resident in render passes
+	GPU::ResHandle transient = GPU::CreateTransientTexture(&colorDesc);
+	GPU::RenderPassInfo passInfo;
+	passInfo.mTextures.push(transient);
+	GPU::FrameBindingSetDesc transientBindingSetDesc;
+	transientBindingSetDesc.mAttachments.push(GPU::BindingFrameAttachment::RenderTarget(transient));
+	GPU::ResHandle transientBindingSet = GPU::CreateFrameBindingSet(&transientBindingSetDesc);
+
+	cmd = GPU::CreateCommandlist();
+	cmd->BeginRenderPass(passInfo);
+	cmd->BeginFrameBindingSet(transientBindingSet);
+	cmd->EndFrameBindingSet();
+	cmd->EndRenderPass();
+	REQUIRE(GPU::CompileCommandList(*cmd));
+
+	// transient texture is not resident out of render pass
+	invalidCmd = GPU::CreateCommandlist();
+	invalidCmd->BeginFrameBindingSet(transientBindingSet);
+	invalidCmd->EndFrameBindingSet();
+	REQUIRE_FALSE(GPU::CompileCommandList(*invalidCmd));
+	GPU::SubmitCommandLists();
+
+	memoryStats = device->GetMemoryStats();
+	REQUIRE(memoryStats.mTransientMemory == 0);
+	REQUIRE(memoryStats.mPeakTransientMemory == GPU::GetTextureSize(GPU::FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 1));
+
+	// indirect args buffers are validated with offsets and sizes of args
+	GPU::BufferDesc argsDesc;
+	argsDesc.mByteWidth = 32;
+	argsDesc.mMiscFlags = GPU::RESOURCE_MISC_DRAWINDIRECT_ARGS;
+	GPU::ResHandle argsBuffer = GPU::CreateBuffer(&argsDesc, nullptr, "IndirectArgs");
+	REQUIRE(argsBuffer);
+
+	cmd = GPU::CreateCommandlist();
+	cmd->BeginFrameBindingSet(frameBindingSet);
+	cmd->BindPipelineState(pipeline);
+	cmd->DrawInstancedIndirect(argsBuffer, 16);
+	cmd->EndFrameBindingSet();
+	cmd->DispatchIndirect(argsBuffer, 20);
+	REQUIRE(GPU::CompileCommandList(*cmd));
+
+	const U32 validationErrors = device->GetCurrentFrameStats().mValidationErrors;
+	invalidCmd = GPU::CreateCommandlist();
+	invalidCmd->BeginFrameBindingSet(frameBindingSet);
+	invalidCmd->BindPipelineState(pipeline);
+	invalidCmd->DrawIndexedInstancedIndirect(argsBuffer, 0);	// without index buffer
+	invalidCmd->DrawInstancedIndirect(argsBuffer, 2);			// unaligned offset
+	invalidCmd->DrawInstancedIndirect(argsBuffer, 20);			// out of range
+	invalidCmd->DrawInstancedIndirect(vertexBuffer, 0);			// without drawindirect args flag
+	invalidCmd->EndFrameBindingSet();
+	invalidCmd->DispatchIndirect(GPU::ResHandle::INVALID_HANDLE, 0);
+	REQUIRE_FALSE(GPU::CompileCommandList(*invalidCmd));
+	GPU::SubmitCommandLists();
+	REQUIRE(device->GetCurrentFrameStats().GetCommandCount(GPU::CommandType::DRAW_INDIRECT) == 5);
+	REQUIRE(device->GetCurrentFrameStats().mValidationErrors == validationErrors + 5);
+
+	// destroyed resources are released after max gpu frames
+	GPU::DestroyResource(argsBuffer);
+	GPU::DestroyResource(transientBindingSet);
+	GPU::DestroyResource(frameBindingSet);
+	GPU::DestroyResource(pipeline);
+	GPU::DestroyResource(vs);
+	GPU::DestroyResource(ps);
+	GPU::DestroyResource(vertexBuffer);
+	GPU::DestroyResource(depth);
+	GPU::DestroyResource(color);
+	for (I32 i = 0; i < 4; i++) {
+		GPU::EndFrame();
+	}
+
+	REQUIRE_FALSE(device->IsResourceAlive(color));
+	REQUIRE_FALSE(device->IsResourceAlive(transient));
+	memoryStats = device->GetMemoryStats();
+	REQUIRE(memoryStats.mTextureMemory == 0);
+	REQUIRE(memoryStats.mBufferMemory == 0);
+	REQUIRE(memoryStats.mResourceCounts[GPU::RESOURCETYPE_TEXTURE] == 0);
+	REQUIRE(memoryStats.mResourceCounts[GPU::RESOURCETYPE_PIPELINE] == 0);
+}
+
+TEST_CASE("GraphicsDeviceNull 100K draws", "[.][GPU]")
+{
+	GPU::ScopedHeadlessDevice device;
+
+	GPU::TextureDesc colorDesc;
+	colorDesc.mWidth = 1280;
+	colorDesc.mHeight = 720;
+	colorDesc.mFormat = GPU::FORMAT_R8G8B8A8_UNORM;
+	colorDesc.mBindFlags = GPU::BIND_RENDER_TARGET;
+	GPU::ResHandle color = GPU::CreateTexture(&colorDesc, nullptr, "Color");
+
+	GPU::BufferDesc bufferDesc;
+	bufferDesc.mByteWidth = 1024;
+	bufferDesc.mBindFlags = GPU::BIND_VERTEX_BUFFER;
+	GPU::ResHandle vertexBuffer = GPU::CreateBuffer(&bufferDesc, nullptr, "VertexBuffer");
+
+	const U8 byteCode[4] = {};
+	GPU::ResHandle vs = GPU::CreateShader(GPU::SHADERSTAGES_VS, byteCode, sizeof(byteCode));
+	GPU::PipelineStateDesc pipelineDesc;
+	pipelineDesc.mVS = vs;
+	GPU::ResHandle pipeline = GPU::CreatePipelineState(&pipelineDesc);
+
+	GPU::FrameBindingSetDesc frameBindingSetDesc;
+	frameBindingSetDesc.mAttachments.push(GPU::BindingFrameAttachment::RenderTarget(color));
+	GPU::ResHandle frameBindingSet = GPU::CreateFrameBindingSet(&frameBindingSetDesc);
+
+	// record and compile command lists concurrently
+	const I32 cmdCount = 8;
+	const I32 drawCount = 100000 / cmdCount;
+	const F64 time = Timer::GetAbsoluteTime();
+	JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+	JobSystem::RunJobs(cmdCount, 1, [&](I32 index, JobSystem::JobGroupArgs* args, void* sharedMem) {
+		GPU::CommandList* cmd = GPU::CreateCommandlist();
+		GPU::BindingBuffer vertexBinding = GPU::Binding::VertexBuffer(vertexBuffer, 0, 16);
+		cmd->BeginFrameBindingSet(frameBindingSet);
+		cmd->BindPipelineState(pipeline);
+		for (I32 i = 0; i < drawCount; i++)
+		{
+			cmd->BindVertexBuffer(Span(&vertexBinding, 1));
+			cmd->Draw(3, 0);
+		}
+		cmd->EndFrameBindingSet();
+		GPU::CompileCommandList(*cmd);
+		return true;
+	}, 0, &jobHandle);
+	JobSystem::Wait(&jobHandle);
+	GPU::SubmitCommandLists();
+	const F64 elapsed = Timer::GetAbsoluteTime() - time;
+
+	auto frameStats = device->GetCurrentFrameStats();
+	REQUIRE(frameStats.mValidationErrors == 0);
+	REQUIRE(frameStats.GetCommandCount(GPU::CommandType::DRAW) == cmdCount * drawCount);
+	Logger::Print("[GPU] Null device: %d commands, %.2fms, %.1fns/command",
+		frameStats.GetTotalCommandCount(), elapsed * 1000.0, elapsed * 1e9 / frameStats.GetTotalCommandCount());
+
+	GPU::DestroyResource(frameBindingSet);
+	GPU::DestroyResource(pipeline);
+	GPU::DestroyResource(vs);
+	GPU::DestroyResource(vertexBuffer);
+	GPU::DestroyResource(color);
+	GPU::EndFrame();
+}
+
+TEST_CASE("HandleAllocator", "[GPU]")
+{
+	HandleAllocator allocator(2);
+
+	// stale handles are invalid after the index is reused
+	Handle handle = allocator.Alloc(0);
+	REQUIRE(allocator.IsValid(handle));
+	allocator.Free(handle);
+	REQUIRE_FALSE(allocator.IsValid(handle));
+
+	Handle reused = allocator.Alloc(0);
+	REQUIRE(reused.GetIndex() == handle.GetIndex());
+	REQUIRE(reused != handle);
+	REQUIRE(allocator.IsValid(reused));
+	allocator.Free(handle);
+	REQUIRE(allocator.IsValid(reused));
+	REQUIRE(allocator.GetTotalHandleCount(0) == 1);
+	REQUIRE(allocator.GetTotalHandleCount(1) == 0);
+	allocator.Free(reused);
+	REQUIRE(allocator.GetTotalHandleCount(0) == 0);
+
+	// concurrent allocating and freeing never returns an alive handle twice
+	const I32 jobCount = 8;
+	const I32 handleCount = 4096;
+	DynamicArray<Handle> handles;
+	handles.resize(jobCount * handleCount);
+	JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+	JobSystem::RunJobs(jobCount, 1, [&](I32 index, JobSystem::JobGroupArgs* args, void* sharedMem) {
+		Handle* jobHandles = handles.data() + index * handleCount;
+		for (I32 i = 0; i < handleCount; i++) {
+			jobHandles[i] = allocator.Alloc(1);
+		}
+		for (I32 i = 0; i < handleCount; i += 2) {
+			allocator.Free(jobHandles[i]);
+		}
+		for (I32 i = 0; i < handleCount; i += 2) {
+			jobHandles[i] = allocator.Alloc(1);
+		}
+		return true;
+	}, 0, &jobHandle);
+	JobSystem::Wait(&jobHandle);
+
+	REQUIRE(allocator.GetTotalHandleCount(1) == jobCount * handleCount);
+	DynamicArray<U32> indices;
+	for (const Handle& allocated : handles)
+	{
+		REQUIRE(allocator.IsValid(allocated));
+		indices.push(allocated.GetIndex());
+	}
+	std::sort(indices.begin(), indices.end());
+	REQUIRE(std::adjacent_find(indices.begin(), indices.end()) == indices.end());
+}
+
+TEST_CASE("GPU deferred destruction", "[GPU]")
+{
+	GPU::ScopedHeadlessDevice device;
+
+	GPU::BufferDesc bufferDesc;
+	bufferDesc.mByteWidth = 1024;
+	bufferDesc.mBindFlags = GPU::BIND_VERTEX_BUFFER;
+	GPU::ResHandle buffer = GPU::CreateBuffer(&bufferDesc, nullptr);
+	GPU::DestroyResource(buffer);
+
+	// the buffer may be used by frames in flight
+	for (U32 frame = 0; frame < GPU::GraphicsDevice::BACK_BUFFER_COUNT; frame++)
+	{
+		REQUIRE(GPU::IsHandleValid(buffer));
+		REQUIRE(device->IsResourceAlive(buffer));
+		GPU::EndFrame();
+	}
+	REQUIRE_FALSE(GPU::IsHandleValid(buffer));
+	REQUIRE_FALSE(device->IsResourceAlive(buffer));
+}
+
+TEST_CASE("GPU upload ring", "[GPU]")
+{
+	GPU::ScopedHeadlessDevice device;
+
+	struct Vertex
+	{
+		F32 mPos[3];
+		U32 mColor;
+	};
+	const U32 ringSize = GPU::UploadRing::DEFAULT_RING_SIZE;
+
+	// typed allocations are aligned and written into the ring
+	GPU::CommandList* cmd = GPU::CreateCommandlist();
+	GPU::UploadAllocator uploadAllocator(*cmd);
+	const U16 indices[] = { 0, 1, 2 };
+	auto indexSpan = uploadAllocator.Upload(indices, 3);
+	auto vertexSpan = uploadAllocator.Alloc<Vertex>(64);
+	REQUIRE(indexSpan);
+	REQUIRE(vertexSpan);
+	REQUIRE(indexSpan.mBuffer == vertexSpan.mBuffer);
+	REQUIRE(vertexSpan.mOffset % 16 == 0);
+	REQUIRE(vertexSpan.mOffset >= indexSpan.mOffset + (I32)sizeof(indices));
+	REQUIRE(indexSpan[2] == 2);
+	for (U32 i = 0; i < vertexSpan.mCount; i++) {
+		vertexSpan[i].mColor = i;
+	}
+
+	// large allocations use dedicated buffers
+	auto largeSpan = uploadAllocator.Alloc<U8>(ringSize / 2);
+	REQUIRE(largeSpan);
+	REQUIRE(largeSpan.mBuffer != vertexSpan.mBuffer);
+
+	GPU::UploadStats stats = GPU::GetCurrentFrameUploadStats();
+	REQUIRE(stats.mAllocationCount == 2);
+	REQUIRE(stats.mRingBytes == sizeof(indices) + sizeof(Vertex) * 64);
+	REQUIRE(stats.mFallbackCount == 1);
+	REQUIRE(stats.mFallbackBytes == ringSize / 2);
+
+	GPU::SubmitCommandLists();
+	GPU::EndFrame();
+	REQUIRE(GPU::GetLastFrameUploadStats().GetUploadedBytes() == stats.GetUploadedBytes());
+	REQUIRE(GPU::GetCurrentFrameUploadStats().GetUploadedBytes() == 0);
+	for (U32 frame = 1; frame < GPU::GraphicsDevice::BACK_BUFFER_COUNT; frame++) {
+		GPU::EndFrame();
+	}
+	REQUIRE_FALSE(device->IsResourceAlive(largeSpan.mBuffer));
+
+	// ranges of frames are reclaimed when the frames are not in flight
+	const U32 chunkSize = ringSize / 8;
+	for (I32 frame = 0; frame < 16; frame++)
+	{
+		cmd = GPU::CreateCommandlist();
+		for (I32 i = 0; i < 3; i++) {
+			REQUIRE(cmd->GPUAlloc(chunkSize));
+		}
+		GPU::SubmitCommandLists();
+		GPU::EndFrame();
+
+		stats = GPU::GetLastFrameUploadStats();
+		REQUIRE(stats.mRingBytes == chunkSize * 3);
+		REQUIRE(stats.mFallbackCount == 0);
+		REQUIRE(stats.mRingSize == ringSize);
+	}
+
+	// allocations which do not fit fall back to dedicated buffers, then the ring grows
+	cmd = GPU::CreateCommandlist();
+	for (I32 i = 0; i < 8; i++) {
+		REQUIRE(cmd->GPUAlloc(ringSize / 4));
+	}
+	GPU::SubmitCommandLists();
+	GPU::EndFrame();
+	stats = GPU::GetLastFrameUploadStats();
+	REQUIRE(stats.mFallbackCount > 0);
+	REQUIRE(stats.mRingSize > ringSize);
+
+	cmd = GPU::CreateCommandlist();
+	for (I32 i = 0; i < 8; i++) {
+		REQUIRE(cmd->GPUAlloc(ringSize / 4));
+	}
+	GPU::SubmitCommandLists();
+	GPU::EndFrame();
+	stats = GPU::GetLastFrameUploadStats();
+	REQUIRE(stats.mFallbackCount == 0);
+	REQUIRE(stats.mRingBytes == (U64)ringSize * 2);
+}
+
+TEST_CASE("CommandList compaction", "[GPU]")
+{
+	GPU::ScopedHeadlessDevice device(256, 256);
+
+	GPU::TextureDesc colorDesc;
+	colorDesc.mWidth = 256;
+	colorDesc.mHeight = 256;
+	colorDesc.mFormat = GPU::FORMAT_R8G8B8A8_UNORM;
+	colorDesc.mBindFlags = GPU::BIND_RENDER_TARGET | GPU::BIND_SHADER_RESOURCE;
+	GPU::ResHandle color = GPU::CreateTexture(&colorDesc, nullptr, "Color");
+	GPU::ResHandle texture = GPU::CreateTexture(&colorDesc, nullptr, "Texture");
+
+	GPU::BufferDesc bufferDesc;
+	bufferDesc.mByteWidth = 256;
+	bufferDesc.mBindFlags = GPU::BIND_VERTEX_BUFFER;
+	GPU::ResHandle vertexBuffer = GPU::CreateBuffer(&bufferDesc, nullptr, "VertexBuffer");
+
+	const U8 byteCode[4] = {};
+	GPU::PipelineStateDesc pipelineDesc;
+	pipelineDesc.mVS = GPU::CreateShader(GPU::SHADERSTAGES_VS, byteCode, sizeof(byteCode));
+	pipelineDesc.mPS = GPU::CreateShader(GPU::SHADERSTAGES_PS, byteCode, sizeof(byteCode));
+	GPU::ResHandle pipelineA = GPU::CreatePipelineState(&pipelineDesc);
+	pipelineDesc.mPrimitiveTopology = GPU::TRIANGLESTRIP;
+	GPU::ResHandle pipelineB = GPU::CreatePipelineState(&pipelineDesc);
+
+	GPU::FrameBindingSetDesc frameBindingSetDesc;
+	frameBindingSetDesc.mAttachments.push(GPU::BindingFrameAttachment::RenderTarget(color));
+	GPU::ResHandle frameBindingSet = GPU::CreateFrameBindingSet(&frameBindingSetDesc);
+
+	GPU::ViewPort viewport;
+	viewport.mWidth = 256.0f;
+	viewport.mHeight = 256.0f;
+	GPU::BindingBuffer vertexBinding = GPU::Binding::VertexBuffer(vertexBuffer, 0, 16);
+
+	// adjacent updates with contiguous data are merged
+	GPU::CommandList* cmd = GPU::CreateCommandlist();
+	const U8* data = cmd->Alloc<U8>(64);
+	cmd->UpdateBuffer(vertexBuffer, data, 0, 16);
+	cmd->UpdateBuffer(vertexBuffer, data + 16, 16, 16);
+	cmd->UpdateBuffer(vertexBuffer, data + 32, 32, 32);
+
+	// consecutive barriers are merged, the same barriers are submitted once
+	GPU::GPUBarrier barriers[] = { GPU::GPUBarrier::Memory(vertexBuffer), GPU::GPUBarrier::Memory(texture) };
+	cmd->Barrier(barriers, 1);
+	cmd->Barrier(barriers, 2);
+
+	cmd->BeginFrameBindingSet(frameBindingSet);
+	// overwritten before draw
+	cmd->BindPipelineState(pipelineA);
+	cmd->BindPipelineState(pipelineB);
+	cmd->BindViewport(viewport);
+	cmd->BindVertexBuffer(Span(&vertexBinding, 1));
+	cmd->BindResource(GPU::SHADERSTAGES_PS, texture, 0);
+	cmd->Draw(3, 0);
+	// already bound
+	cmd->BindPipelineState(pipelineB);
+	cmd->BindViewport(viewport);
+	cmd->BindVertexBuffer(Span(&vertexBinding, 1));
+	cmd->BindResource(GPU::SHADERSTAGES_PS, texture, 0);
+	cmd->Draw(3, 0);
+	cmd->BindPipelineState(pipelineA);
+	cmd->Draw(3, 0);
+	cmd->EndFrameBindingSet();
+	REQUIRE(GPU::CompileCommandList(*cmd));
+
+	GPU::CommandCompactStats stats = GPU::GetCurrentFrameCompactStats();
+	REQUIRE(stats.mInputCommands == 20);
+	REQUIRE(stats.mOutputCommands == 12);
+	REQUIRE(stats.mOverwrittenBinds == 1);
+	REQUIRE(stats.mRedundantBinds == 4);
+	REQUIRE(stats.mMergedUpdates == 2);
+	REQUIRE(stats.mMergedBarriers == 1);
+
+	auto& commands = cmd->GetCommands();
+	REQUIRE(commands.size() == 12);
+	REQUIRE(static_cast<GPU::CommandUpdateBuffer*>(commands[0])->mSize == 64);
+	REQUIRE(static_cast<GPU::CommandBarrier*>(commands[1])->mBarriers.size() == 2);
+
+	GPU::SubmitCommandLists();
+	auto frameStats = device->GetCurrentFrameStats();
+	REQUIRE(frameStats.mValidationErrors == 0);
+	REQUIRE(frameStats.GetCommandCount(GPU::CommandType::DRAW) == 3);
+	REQUIRE(frameStats.GetCommandCount(GPU::CommandType::BIND_PIPELINE_STATE) == 2);
+	REQUIRE(frameStats.GetTotalCommandCount() == 12);
+
+	GPU::EndFrame();
+	REQUIRE(GPU::GetLastFrameCompactStats().GetRemovedCommands() == 8);
+	REQUIRE(GPU::GetCurrentFrameCompactStats().mInputCommands == 0);
+
+	// bound states are unknown after the frame binding set ends
+	cmd = GPU::CreateCommandlist();
+	for (I32 i = 0; i < 2; i++)
+	{
+		cmd->BeginFrameBindingSet(frameBindingSet);
+		cmd->BindPipelineState(pipelineA);
+		cmd->Draw(3, 0);
+		cmd->EndFrameBindingSet();
+	}
+	GPU::SubmitCommandLists();
+	REQUIRE(device->GetCurrentFrameStats().GetCommandCount(GPU::CommandType::BIND_PIPELINE_STATE) == 2);
+	GPU::EndFrame();
+
+	// disabled compaction keeps all commands
+	GPU::SetCommandCompactionEnabled(false);
+	cmd = GPU::CreateCommandlist();
+	cmd->BeginFrameBindingSet(frameBindingSet);
+	cmd->BindPipelineState(pipelineA);
+	cmd->BindPipelineState(pipelineA);
+	cmd->Draw(3, 0);
+	cmd->EndFrameBindingSet();
+	GPU::SubmitCommandLists();
+	REQUIRE(device->GetCurrentFrameStats().GetCommandCount(GPU::CommandType::BIND_PIPELINE_STATE) == 2);
+	REQUIRE(GPU::GetCurrentFrameCompactStats().mInputCommands == 0);
+	GPU::SetCommandCompactionEnabled(true);
+	GPU::EndFrame();
+}
+
+TEST_CASE("GPU pipeline state cache", "[GPU]")
+{
+	GPU::ScopedHeadlessDevice device;
+
+	const U8 byteCode[4] = {};
+	GPU::ResHandle vs = GPU::CreateShader(GPU::SHADERSTAGES_VS, byteCode, sizeof(byteCode));
+	GPU::ResHandle ps = GPU::CreateShader(GPU::SHADERSTAGES_PS, byteCode, sizeof(byteCode));
+
+	// states are hashed by contents
+	GPU::BlendStateDesc blendState;
+	GPU::RasterizerStateDesc rasterizerState;
+	GPU::InputLayoutDesc inputLayout;
+	inputLayout.mElements.push(GPU::VertexElement::VertexData("POSITION", 0, GPU::FORMAT_R32G32B32_FLOAT, 0));
+	GPU::PipelineStateDesc desc;
+	desc.mVS = vs;
+	desc.mPS = ps;
+	desc.mBlendState = &blendState;
+	desc.mRasterizerState = &rasterizerState;
+	desc.mInputLayout = &inputLayout;
+	GPU::ResHandle pipeline = GPU::CreatePipelineState(&desc);
+	REQUIRE(pipeline);
+
+	GPU::BlendStateDesc sameBlendState = blendState;
+	GPU::InputLayoutDesc sameInputLayout;
+	sameInputLayout.mElements.push(GPU::VertexElement::VertexData("POSITION", 0, GPU::FORMAT_R32G32B32_FLOAT, 0));
+	GPU::PipelineStateDesc sameDesc = desc;
+	sameDesc.mBlendState = &sameBlendState;
+	sameDesc.mInputLayout = &sameInputLayout;
+	GPU::ResHandle samePipeline = GPU::CreatePipelineState(&sameDesc);
+	REQUIRE(samePipeline == pipeline);
+
+	GPU::RasterizerStateDesc cullBackState;
+	cullBackState.mCullMode = GPU::CULL_BACK;
+	GPU::PipelineStateDesc cullBackDesc = desc;
+	cullBackDesc.mRasterizerState = &cullBackState;
+	GPU::ResHandle cullBackPipeline = GPU::CreatePipelineState(&cullBackDesc);
+	REQUIRE(cullBackPipeline);
+	REQUIRE(cullBackPipeline != pipeline);
+
+	GPU::PipelineStateCacheStats stats = GPU::GetPipelineStateCacheStats();
+	REQUIRE(stats.mHitCount == 1);
+	REQUIRE(stats.mMissCount == 2);
+	REQUIRE(stats.mCachedCount == 2);
+	REQUIRE(device->GetMemoryStats().mResourceCounts[GPU::RESOURCETYPE_PIPELINE] == 2);
+
+	// the pipeline state is destroyed when all references are released
+	GPU::DestroyResource(samePipeline);
+	GPU::DestroyResource(cullBackPipeline);
+	for (U32 frame = 0; frame < GPU::GraphicsDevice::BACK_BUFFER_COUNT; frame++) {
+		GPU::EndFrame();
+	}
+	REQUIRE(device->IsResourceAlive(pipeline));
+	REQUIRE_FALSE(device->IsResourceAlive(cullBackPipeline));
+	REQUIRE(GPU::GetPipelineStateCacheStats().mCachedCount == 1);
+
+	GPU::DestroyResource(pipeline);
+	for (U32 frame = 0; frame < GPU::GraphicsDevice::BACK_BUFFER_COUNT; frame++) {
+		GPU::EndFrame();
+	}
+	REQUIRE_FALSE(device->IsResourceAlive(pipeline));
+	REQUIRE(GPU::GetPipelineStateCacheStats().mCachedCount == 0);
+
+	// precompiled pipeline states are hit at first use
+	const I32 precompileCount = 64;
+	DynamicArray<GPU::RasterizerStateDesc> rasterizerStates;
+	DynamicArray<GPU::PipelineStateDesc> descs;
+	rasterizerStates.resize(precompileCount);
+	for (I32 i = 0; i < precompileCount; i++)
+	{
+		rasterizerStates[i].mDepthBias = (U32)i;
+		GPU::PipelineStateDesc precompileDesc = desc;
+		precompileDesc.mRasterizerState = &rasterizerStates[i];
+		descs.push(precompileDesc);
+	}
+	JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+	GPU::PrecompilePipelineStates(Span<const GPU::PipelineStateDesc>(descs.data(), descs.size()), &jobHandle);
+	JobSystem::Wait(&jobHandle);
+	REQUIRE(GPU::GetPipelineStateCacheStats().mPrecompiledCount == precompileCount);
+
+	stats = GPU::GetPipelineStateCacheStats();
+	DynamicArray<GPU::ResHandle> pipelines;
+	for (const auto& precompiledDesc : descs) {
+		pipelines.push(GPU::CreatePipelineState(&precompiledDesc));
+	}
+	REQUIRE(GPU::GetPipelineStateCacheStats().mHitCount == stats.mHitCount + precompileCount);
+	REQUIRE(GPU::GetPipelineStateCacheStats().mMissCount == stats.mMissCount);
+
+	// precompiled pipeline states are kept alive by the cache
+	for (auto handle : pipelines) {
+		GPU::DestroyResource(handle);
+	}
+	for (U32 frame = 0; frame < GPU::GraphicsDevice::BACK_BUFFER_COUNT; frame++) {
+		GPU::EndFrame();
+	}
+	REQUIRE(device->IsResourceAlive(pipelines[0]));
+	REQUIRE(GPU::GetPipelineStateCacheStats().mCachedCount == precompileCount);
+
+	// descs are compared on hits, so that a desc collided with the cached one is not shared
+	{
+		GPU::PipelineStateCache cache;
+		REQUIRE(cache.Add(0, desc, vs, false) == vs);
+		REQUIRE(cache.Acquire(0, cullBackDesc, false) == GPU::ResHandle::INVALID_HANDLE);
+		REQUIRE(cache.Add(0, cullBackDesc, ps, false) == ps);
+		REQUIRE(cache.Release(ps));
+		REQUIRE(cache.Acquire(0, sameDesc, false) == vs);
+		REQUIRE(cache.GetStats().mCachedCount == 1);
+	}
+
+	GPU::DestroyResource(vs);
+	GPU::DestroyResource(ps);
+}
+
+namespace
+{
+	// run the function on threads, return the elapsed time
+	F64 RunOnThreads(I32 threadCount, const Concurrency::Thread::EntryPointFunc& func)
+	{
+		const F64 time = Timer::GetAbsoluteTime();
+		DynamicArray<Concurrency::Thread*> threads;
+		for (I32 i = 0; i < threadCount; i++) {
+			threads.push(CJING_NEW(Concurrency::Thread)(func, (void*)(intptr_t)i, 65536, "HandleTest"));
+		}
+		for (auto thread : threads)
+		{
+			thread->Join();
+			CJING_DELETE(thread);
+		}
+		return Timer::GetAbsoluteTime() - time;
+	}
+}
+
+TEST_CASE("GPU handles 100K 16 threads", "[.][GPU]")
+{
+	const I32 handleCount = 100000;
+	const I32 threadCount = 16;
+	const I32 batchSize = 64;
+
+	// lock-free allocator compared with the allocator under a global mutex
+	for (bool useMutex : { true, false })
+	{
+		HandleAllocator allocator(1);
+		Concurrency::Mutex mutex;
+		const F64 elapsed = RunOnThreads(threadCount, [&](void* data) {
+			Handle handles[batchSize];
+			for (I32 i = 0; i < handleCount / threadCount; i += batchSize)
+			{
+				for (Handle& handle : handles)
+				{
+					if (useMutex)
+					{
+						Concurrency::ScopedMutex lock(mutex);
+						handle = allocator.Alloc(0);
+					}
+					else {
+						handle = allocator.Alloc(0);
+					}
+				}
+				for (Handle& handle : handles)
+				{
+					if (useMutex)
+					{
+						Concurrency::ScopedMutex lock(mutex);
+						allocator.Free(handle);
+					}
+					else {
+						allocator.Free(handle);
+					}
+				}
+			}
+			return 0;
+		});
+		REQUIRE(allocator.GetTotalHandleCount(0) == 0);
+		Logger::Print("[GPU] %s allocator, %d handles, %d threads: %.2fms",
+			useMutex ? "Mutex" : "Lock-free", handleCount, threadCount, elapsed * 1000.0);
+	}
+
+	// create and destroy buffers, destroyed handles are released after frames in flight
+	GPU::ScopedHeadlessDevice device;
+
+	const I32 roundCount = 10;
+	F64 elapsed = 0.0;
+	for (I32 round = 0; round < roundCount; round++)
+	{
+		elapsed += RunOnThreads(threadCount, [&](void* data) {
+			GPU::BufferDesc bufferDesc;
+			bufferDesc.mByteWidth = 256;
+			bufferDesc.mBindFlags = GPU::BIND_CONSTANT_BUFFER;
+			GPU::ResHandle buffers[batchSize];
+			for (I32 i = 0; i < handleCount / roundCount / threadCount; i += batchSize)
+			{
+				for (auto& buffer : buffers) {
+					buffer = GPU::CreateBuffer(&bufferDesc, nullptr);
+				}
+				for (auto& buffer : buffers) {
+					GPU::DestroyResource(buffer);
+				}
+			}
+			return 0;
+		});
+
+		for (U32 frame = 0; frame < GPU::GraphicsDevice::BACK_BUFFER_COUNT; frame++) {
+			GPU::EndFrame();
+		}
+	}
+	Logger::Print("[GPU] Create and destroy %d buffers, %d threads: %.2fms", handleCount, threadCount, elapsed * 1000.0);
+}
+
+int main(int argc, char* argv[])
+{
+	Logger::RegisterSink(mTestStdoutLoggerSink);
+	Logger::SetIsDisplayTime(false);
+
+	JobSystem::ScopedManager scoped(4, JobSystem::MAX_FIBER_COUNT, JobSystem::FIBER_STACK_SIZE);
+	return Catch::Session().run(argc, argv);
+}
+
+#endif
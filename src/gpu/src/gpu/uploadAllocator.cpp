@@ -0,0 +1,228 @@
+#include "uploadAllocator.h"
+#include "gpu.h"
+
+namespace Cjing3D {
+namespace GPU
+{
+	UploadRing::UploadRing(U32 ringSize) :
+		mRingSize(ringSize)
+	{
+		Debug::CheckAssertion((ringSize & (ringSize - 1)) == 0, "The size of upload ring must be power of 2.");
+	}
+
+	UploadRing::~UploadRing()
+	{
+		Debug::CheckAssertion(mBuffer == ResHandle::INVALID_HANDLE, "Upload ring must be released before destroying.");
+	}
+
+	GPUAllocation UploadRing::Allocate(size_t size, U32 alignment)
+	{
+		GPUAllocation allocation;
+		if (size == 0) {
+			return allocation;
+		}
+
+		Debug::CheckAssertion(alignment > 0 && (alignment & (alignment - 1)) == 0);
+		{
+			Concurrency::ScopedSpinLock lock(mLock);
+			// large allocations would take up the ring of frames in flight
+			if (size <= mRingSize / 4)
+			{
+				mFrameDemand += size;
+
+				if (mBuffer == ResHandle::INVALID_HANDLE && !CreateRing()) {
+					return allocation;
+				}
+
+				// skip the remaining space at the end of ring, ring size is multiple of alignment
+				U64 offset = PotRoundUp(mHead, (U64)alignment);
+				const U64 position = offset & (mRingSize - 1);
+				if (position + size > mRingSize) {
+					offset += mRingSize - position;
+				}
+
+				if (offset + size - mTail <= mRingSize)
+				{
+					if (mMappedData == nullptr)
+					{
+						// the first mapping of the buffer must discard, then allocated ranges are never
+						// overwritten until their frames are not in flight
+						GPUMapping mapping;
+						mapping.mFlags = GPUMapping::FLAG_WRITE;
+						if (mIsDiscardNeeded) {
+							mapping.mFlags |= GPUMapping::FLAG_DISCARD;
+						}
+						GPU::Map(mBuffer, mapping);
+						if (!mapping)
+						{
+							Logger::Error("[GPU] Failed to map the upload ring.");
+							return allocation;
+						}
+						mMappedData = (U8*)mapping.mData;
+						mIsDiscardNeeded = false;
+					}
+
+					mHead = offset + size;
+					mCurrentStats.mRingBytes += size;
+					mCurrentStats.mAllocationCount++;
+
+					allocation.mData = mMappedData + (offset & (mRingSize - 1));
+					allocation.mBuffer = mBuffer;
+					allocation.mOffset = (I32)(offset & (mRingSize - 1));
+					return allocation;
+				}
+				mIsOverflowed = true;
+			}
+		}
+		return AllocateDedicated(size);
+	}
+
+	void UploadRing::Flush()
+	{
+		// buffers are mapped on the immediate context, all Map/Unmap are done under the lock
+		DynamicArray<ResHandle> dedicatedBuffers;
+		{
+			Concurrency::ScopedSpinLock lock(mLock);
+			if (mMappedData != nullptr)
+			{
+				GPU::Unmap(mBuffer);
+				mMappedData = nullptr;
+			}
+			for (ResHandle buffer : mDedicatedBuffers) {
+				GPU::Unmap(buffer);
+			}
+			std::swap(dedicatedBuffers, mDedicatedBuffers);
+		}
+
+		// dedicated buffers are released after frames in flight
+		for (ResHandle buffer : dedicatedBuffers) {
+			GPU::DestroyResource(buffer);
+		}
+	}
+
+	void UploadRing::EndFrame(U64 frameIndex)
+	{
+		Flush();
+
+		Concurrency::ScopedSpinLock lock(mLock);
+		mFrameHeads[frameIndex % FRAME_COUNT] = mHead;
+		// the oldest frame in flight will be reused by the next frame
+		mTail = mFrameHeads[(frameIndex + 1) % FRAME_COUNT];
+
+		// grow the ring to fit the frames in flight, the old ring is released after frames in flight
+		if (mIsOverflowed && mRingSize < MAX_RING_SIZE)
+		{
+			const U64 requiredSize = mFrameDemand * FRAME_COUNT;
+			U64 ringSize = (U64)mRingSize * 2;
+			while (ringSize < requiredSize && ringSize < MAX_RING_SIZE) {
+				ringSize *= 2;
+			}
+			mRingSize = (U32)std::min(ringSize, (U64)MAX_RING_SIZE);
+
+			if (mBuffer != ResHandle::INVALID_HANDLE)
+			{
+				GPU::DestroyResource(mBuffer);
+				mBuffer = ResHandle::INVALID_HANDLE;
+			}
+		}
+
+		mCurrentStats.mRingSize = mRingSize;
+		mLastStats = mCurrentStats;
+		mCurrentStats = UploadStats();
+		mFrameDemand = 0;
+		mIsOverflowed = false;
+	}
+
+	void UploadRing::Release()
+	{
+		Flush();
+
+		Concurrency::ScopedSpinLock lock(mLock);
+		if (mBuffer != ResHandle::INVALID_HANDLE)
+		{
+			GPU::DestroyResource(mBuffer);
+			mBuffer = ResHandle::INVALID_HANDLE;
+		}
+	}
+
+	UploadStats UploadRing::GetCurrentFrameStats()
+	{
+		Concurrency::ScopedSpinLock lock(mLock);
+		UploadStats stats = mCurrentStats;
+		stats.mRingSize = mRingSize;
+		return stats;
+	}
+
+	UploadStats UploadRing::GetLastFrameStats()
+	{
+		Concurrency::ScopedSpinLock lock(mLock);
+		return mLastStats;
+	}
+
+	bool UploadRing::CreateRing()
+	{
+		BufferDesc desc = {};
+		desc.mByteWidth = mRingSize;
+		desc.mUsage = USAGE_DYNAMIC;
+		desc.mBindFlags = BIND_VERTEX_BUFFER | BIND_INDEX_BUFFER | BIND_SHADER_RESOURCE;
+		desc.mCPUAccessFlags = CPU_ACCESS_WRITE;
+		desc.mMiscFlags = RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+
+		mBuffer = GPU::CreateBuffer(&desc, nullptr, "UploadRing");
+		if (mBuffer == ResHandle::INVALID_HANDLE)
+		{
+			Logger::Error("[GPU] Failed to create the upload ring.");
+			return false;
+		}
+
+		// allocations of the old ring are kept alive by the old buffer
+		mIsDiscardNeeded = true;
+		mHead = 0;
+		mTail = 0;
+		for (U64& frameHead : mFrameHeads) {
+			frameHead = 0;
+		}
+		return true;
+	}
+
+	GPUAllocation UploadRing::AllocateDedicated(size_t size)
+	{
+		GPUAllocation allocation;
+
+		BufferDesc desc = {};
+		desc.mByteWidth = (U32)size;
+		desc.mUsage = USAGE_DYNAMIC;
+		desc.mBindFlags = BIND_VERTEX_BUFFER | BIND_INDEX_BUFFER | BIND_SHADER_RESOURCE;
+		desc.mCPUAccessFlags = CPU_ACCESS_WRITE;
+		desc.mMiscFlags = RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+
+		ResHandle buffer = GPU::CreateBuffer(&desc, nullptr, "UploadRingDedicated");
+		if (buffer == ResHandle::INVALID_HANDLE)
+		{
+			Logger::Error("[GPU] Failed to create the dedicated upload buffer.");
+			return allocation;
+		}
+
+		// immediate context is not thread-safe, map under the same lock as the ring
+		Concurrency::ScopedSpinLock lock(mLock);
+		GPUMapping mapping;
+		mapping.mFlags = GPUMapping::FLAG_WRITE | GPUMapping::FLAG_DISCARD;
+		GPU::Map(buffer, mapping);
+		if (!mapping)
+		{
+			Logger::Error("[GPU] Failed to map the dedicated upload buffer.");
+			GPU::DestroyResource(buffer);
+			return allocation;
+		}
+
+		mDedicatedBuffers.push(buffer);
+		mCurrentStats.mFallbackBytes += size;
+		mCurrentStats.mFallbackCount++;
+
+		allocation.mData = mapping.mData;
+		allocation.mBuffer = buffer;
+		allocation.mOffset = 0;
+		return allocation;
+	}
+}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "definitions.h"
+#include "resource.h"
+#include "device.h"
+#include "commandList.h"
+#include "core\container\span.h"
+#include "core\concurrency\concurrency.h"
+
+namespace Cjing3D {
+namespace GPU
+{
+	struct UploadStats
+	{
+		U64 mRingBytes = 0;				// bytes uploaded through the ring
+		U64 mFallbackBytes = 0;			// bytes uploaded through dedicated buffers
+		U32 mAllocationCount = 0;
+		U32 mFallbackCount = 0;
+		U32 mRingSize = 0;
+
+		U64 GetUploadedBytes()const { return mRingBytes + mFallbackBytes; }
+	};
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// UploadRing
+	/// Ring of dynamic upload data shared by all command lists. The ring stays mapped while command lists
+	/// are recorded and is unmapped before they are submitted. Allocations of a frame are reclaimed when
+	/// the frame is not in flight anymore (after BACK_BUFFER_COUNT frames, the same as destroyed handles).
+	/// Large allocations and allocations which do not fit into the ring use dedicated buffers, then the
+	/// ring grows at the end of frame to fit the frames in flight.
+	class UploadRing
+	{
+	public:
+		static const U32 DEFAULT_RING_SIZE = 4 * 1024 * 1024;
+		static const U32 MAX_RING_SIZE = 256 * 1024 * 1024;
+		static const U32 DEFAULT_ALIGNMENT = UPLOAD_ALIGNMENT;
+		static const U32 FRAME_COUNT = GraphicsDevice::BACK_BUFFER_COUNT;
+
+		UploadRing(U32 ringSize = DEFAULT_RING_SIZE);
+		~UploadRing();
+
+		// alignment must be power of 2
+		GPUAllocation Allocate(size_t size, U32 alignment = DEFAULT_ALIGNMENT);
+		// unmap all mapped buffers, must be called before command lists are submitted
+		void Flush();
+		// end the frame, allocations of the frame which is not in flight anymore are reclaimed
+		void EndFrame(U64 frameIndex);
+		void Release();
+
+		UploadStats GetCurrentFrameStats();
+		UploadStats GetLastFrameStats();
+		U32 GetRingSize()const { return mRingSize; }
+
+	private:
+		bool CreateRing();
+		GPUAllocation AllocateDedicated(size_t size);
+
+	private:
+		Concurrency::SpinLock mLock;
+		ResHandle mBuffer;
+		U8* mMappedData = nullptr;
+		bool mIsDiscardNeeded = true;
+		U32 mRingSize = 0;
+
+		// offsets are increased monotonically, the offset in the buffer is offset % mRingSize
+		U64 mHead = 0;
+		U64 mTail = 0;
+		U64 mFrameHeads[FRAME_COUNT] = {};
+		U64 mFrameDemand = 0;			// ring bytes required by the current frame
+		bool mIsOverflowed = false;
+
+		DynamicArray<ResHandle> mDedicatedBuffers;
+		UploadStats mCurrentStats;
+		UploadStats mLastStats;
+	};
+
+	template<typename T>
+	struct UploadSpan
+	{
+		T* mData = nullptr;
+		U32 mCount = 0;
+		ResHandle mBuffer;
+		I32 mOffset = 0;
+
+		T& operator[](U32 index) { return mData[index]; }
+		Span<T> ToSpan() { return Span(mData, mCount); }
+
+		BindingBuffer ToVertexBuffer()const { return Binding::VertexBuffer(mBuffer, mOffset, sizeof(T)); }
+		BindingBuffer ToIndexBuffer()const { return Binding::IndexBuffer(mBuffer, mOffset); }
+
+		explicit operator bool() const {
+			return mData != nullptr && mBuffer != ResHandle::INVALID_HANDLE;
+		}
+	};
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// UploadAllocator
+	/// Typed allocations of the upload ring for the command list, the data must be written before
+	/// the command list is submitted and is valid only in the current frame.
+	class UploadAllocator
+	{
+	public:
+		explicit UploadAllocator(CommandList& cmd) : mCmd(cmd) {}
+
+		template<typename T>
+		UploadSpan<T> Alloc(U32 count)
+		{
+			UploadSpan<T> ret;
+			if (count == 0) {
+				return ret;
+			}
+
+			GPUAllocation allocation = mCmd.GPUAlloc(sizeof(T) * count, alignof(T) > 16 ? (U32)alignof(T) : 16);
+			if (allocation)
+			{
+				ret.mData = static_cast<T*>(allocation.mData);
+				ret.mCount = count;
+				ret.mBuffer = allocation.mBuffer;
+				ret.mOffset = allocation.mOffset;
+			}
+			return ret;
+		}
+
+		template<typename T>
+		UploadSpan<T> Upload(const T* data, U32 count)
+		{
+			UploadSpan<T> ret = Alloc<T>(count);
+			if (ret) {
+				Memory::Memcpy(ret.mData, data, sizeof(T) * count);
+			}
+			return ret;
+		}
+
+	private:
+		CommandList& mCmd;
+	};
+}
+}
@@ -23,7 +23,8 @@ namespace Cjing3D
 		return hash;
 	}
 
-	// FNV-1a Hash
+	// FNV-1a Hash, FNV1A_64_INIT is the offset basis
+	static const U64 FNV1A_64_INIT = 0xcbf29ce484222325ULL;
 	U64 FNV1aHash(U64 input, char c);
 	U64 FNV1aHash(U64 input, const void* data, size_t size);
 
@@ -63,6 +63,17 @@ namespace Cjing3D
 		return true;
 	}
 
+	bool Frustum::Overlaps(const Sphere& sphere) const
+	{
+		for (int i = 0; i < std::size(mPlanes); i++)
+		{
+			if (PlaneDotCoord(mPlanes[i], sphere.mCenter).x() < -sphere.mRadius) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 	const F32x3 AABB::GetMaxPointAlongNormal(const F32x4& n) const
 	{
 		// ط߷ֵ
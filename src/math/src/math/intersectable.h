@@ -133,6 +133,7 @@ namespace Cjing3D
 		void SetupFrustum(const F32x4x4& view, const F32x4x4& projection, float screenDepth);
 		void SetupFrustum(const F32x4x4& transform);
 		bool Overlaps(const AABB& aabb)const;
+		bool Overlaps(const Sphere& sphere)const;
 
 	private:
 		union {
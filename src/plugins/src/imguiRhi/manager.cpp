@@ -21,8 +21,6 @@ namespace ImGuiRHI
 		};
 
 		bool mIsInitialized = false;
-		GPU::ResHandle mHandleVB;
-		GPU::ResHandle mHandleIB;
 		GPU::ResHandle mHandleVS;
 		GPU::ResHandle mHandlePS;
 		GPU::ResHandle mHandleBindingSet;
@@ -37,7 +35,6 @@ namespace ImGuiRHI
 		GPU::RasterizerStateDesc mRasterizerState;
 		GPU::InputLayoutDesc mInputLayout;
 
-		I32 mVertexBufferSize = 5000, mIndexBufferSize = 10000;
 		ImGuiMouseCursor mLastMouseCursor = ImGuiMouseCursor_COUNT;
 
 		I32 mImGuiKeyMap[ImGuiKey_COUNT];
@@ -156,8 +153,6 @@ namespace ImGuiRHI
 			GPU::DestroyResource(mHandlePbs);
 			GPU::DestroyResource(mHandleVS);
 			GPU::DestroyResource(mHandlePS);
-			GPU::DestroyResource(mHandleVB);
-			GPU::DestroyResource(mHandleIB);
 
 			GPU::DestroyResource(mFontTexture);
 			GPU::DestroyResource(mFontSampler);
@@ -384,61 +379,23 @@ namespace ImGuiRHI
 			return;
 		}
 
-		if (mHandleVB == GPU::ResHandle::INVALID_HANDLE || mVertexBufferSize < drawData->TotalVtxCount)
-		{
-			if (mHandleVB != GPU::ResHandle::INVALID_HANDLE) {
-				GPU::DestroyResource(mHandleVB);
-			}
-
-			mVertexBufferSize = drawData->TotalVtxCount + 5000;
-			GPU::BufferDesc desc = {};
-			desc.mBindFlags = GPU::BIND_VERTEX_BUFFER;
-			desc.mByteWidth = static_cast<U32>(mVertexBufferSize * sizeof(ImDrawVert));
-			desc.mUsage = GPU::USAGE_DYNAMIC;
-			desc.mCPUAccessFlags = GPU::CPU_ACCESS_WRITE;
-
-			mHandleVB = GPU::CreateBuffer(&desc, nullptr, "ImguiVertexBuffer");
-		}
-
-		if (mHandleIB == GPU::ResHandle::INVALID_HANDLE || mIndexBufferSize < drawData->TotalIdxCount)
-		{
-			if (mHandleIB != GPU::ResHandle::INVALID_HANDLE) {
-				GPU::DestroyResource(mHandleIB);
-			}
-
-			mIndexBufferSize = drawData->TotalIdxCount + 10000;
-
-			GPU::BufferDesc desc = {};
-			desc.mBindFlags = GPU::BIND_INDEX_BUFFER;
-			desc.mByteWidth = static_cast<U32>(mIndexBufferSize * sizeof(ImDrawIdx));
-			desc.mUsage = GPU::USAGE_DYNAMIC;
-			desc.mCPUAccessFlags = GPU::CPU_ACCESS_WRITE;
-
-			mHandleIB = GPU::CreateBuffer(&desc, nullptr, "ImguiIndexBuffer");
+		// upload vertex/index data into the upload ring of the current frame
+		GPU::UploadAllocator uploadAllocator(cmd);
+		auto vertices = uploadAllocator.Alloc<ImDrawVert>(drawData->TotalVtxCount);
+		auto indices = uploadAllocator.Alloc<ImDrawIdx>(drawData->TotalIdxCount);
+		if (!vertices || !indices) {
+			return;
 		}
 
-		// Upload vertex/index data into a single contiguous GPU buffer
-		GPU::GPUMapping vertexMapping, indexMapping;
-		vertexMapping.mFlags = indexMapping.mFlags = GPU::GPUMapping::FLAG_WRITE | GPU::GPUMapping::FLAG_DISCARD;
-
-		GPU::Map(mHandleVB, vertexMapping);
-		GPU::Map(mHandleIB, indexMapping);
-		if (vertexMapping && indexMapping)
+		ImDrawVert* vtxDst = vertices.mData;
+		ImDrawIdx* idxDst = indices.mData;
+		for (auto i = 0; i < drawData->CmdListsCount; i++)
 		{
-			ImDrawVert* vtxDst = (ImDrawVert*)vertexMapping.mData;
-			ImDrawIdx* idxDst = (ImDrawIdx*)indexMapping.mData;
-
-			for (auto i = 0; i < drawData->CmdListsCount; i++)
-			{
-				const ImDrawList* cmd_list = drawData->CmdLists[i];
-				memcpy(vtxDst, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
-				memcpy(idxDst, cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
-				vtxDst += cmd_list->VtxBuffer.Size;
-				idxDst += cmd_list->IdxBuffer.Size;
-			}
-
-			GPU::Unmap(mHandleIB);
-			GPU::Unmap(mHandleVB);
+			const ImDrawList* cmd_list = drawData->CmdLists[i];
+			memcpy(vtxDst, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+			memcpy(idxDst, cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+			vtxDst += cmd_list->VtxBuffer.Size;
+			idxDst += cmd_list->IdxBuffer.Size;
 		}
 
 		// bindingSet
@@ -466,9 +423,9 @@ namespace ImGuiRHI
 
 		// drawing
 		DynamicArray<GPU::BindingBuffer> buffers;
-		buffers.push(GPU::Binding::VertexBuffer(mHandleVB, 0, sizeof(ImDrawVert)));
+		buffers.push(vertices.ToVertexBuffer());
 		cmd.BindVertexBuffer(Span(buffers.data(), buffers.size()), 0);
-		cmd.BindIndexBuffer(GPU::Binding::IndexBuffer(mHandleIB, 0), GPU::IndexFormat::INDEX_FORMAT_16BIT);
+		cmd.BindIndexBuffer(indices.ToIndexBuffer(), GPU::IndexFormat::INDEX_FORMAT_16BIT);
 		cmd.BindPipelineState(mHandlePbs);
 
 		// Render command lists
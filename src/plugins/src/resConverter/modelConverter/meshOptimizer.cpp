@@ -0,0 +1,979 @@
+#include "meshOptimizer.h"
+#include "core\container\dynamicArray.h"
+#include "core\memory\memory.h"
+#include "core\helper\profiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Cjing3D
+{
+namespace MeshOptimizer
+{
+	namespace
+	{
+		// Forsyth scoring parameters, the cache size is only used for scoring and
+		// works well for different hardware cache sizes
+		static const U32 FORSYTH_CACHE_SIZE = 32;
+		static const U32 FORSYTH_MAX_VALENCE = 32;
+		static const F32 CACHE_DECAY_POWER = 1.5f;
+		static const F32 LAST_TRI_SCORE = 0.75f;
+		static const F32 VALENCE_BOOST_SCALE = 2.0f;
+		static const F32 VALENCE_BOOST_POWER = 0.5f;
+
+		struct ForsythScoreTable
+		{
+			F32 mCacheScores[FORSYTH_CACHE_SIZE];
+			F32 mValenceScores[FORSYTH_MAX_VALENCE];
+
+			ForsythScoreTable()
+			{
+				for (U32 i = 0; i < FORSYTH_CACHE_SIZE; i++)
+				{
+					// vertices of the last triangle get a fixed score, so that
+					// the strip is not simply continued with the last edge
+					if (i < 3)
+					{
+						mCacheScores[i] = LAST_TRI_SCORE;
+					}
+					else
+					{
+						const F32 scaler = 1.0f - (F32)(i - 3) / (F32)(FORSYTH_CACHE_SIZE - 3);
+						mCacheScores[i] = std::pow(scaler, CACHE_DECAY_POWER);
+					}
+				}
+
+				// boost vertices with few remaining triangles to avoid leaving lone triangles
+				mValenceScores[0] = 0.0f;
+				for (U32 i = 1; i < FORSYTH_MAX_VALENCE; i++) {
+					mValenceScores[i] = VALENCE_BOOST_SCALE * std::pow((F32)i, -VALENCE_BOOST_POWER);
+				}
+			}
+
+			F32 GetVertexScore(I32 cachePos, U32 valence)const
+			{
+				// no triangles remaining
+				if (valence == 0) {
+					return -1.0f;
+				}
+
+				F32 score = cachePos >= 0 ? mCacheScores[cachePos] : 0.0f;
+				score += mValenceScores[valence < FORSYTH_MAX_VALENCE ? valence : FORSYTH_MAX_VALENCE - 1];
+				return score;
+			}
+		};
+
+		// FIFO cache simulation by timestamps, a vertex is in the cache if it was
+		// transformed in the last cacheSize transforms
+		class CacheSimulator
+		{
+		public:
+			CacheSimulator(U32 vertexCount, U32 cacheSize) :
+				mCacheSize(cacheSize),
+				mTimestamp(cacheSize + 1)
+			{
+				mTimestamps.resize(vertexCount);
+				Memory::Memset(mTimestamps.data(), 0, sizeof(U32) * vertexCount);
+			}
+
+			U32 Transform(U32 vertex)
+			{
+				if (mTimestamp - mTimestamps[vertex] > mCacheSize)
+				{
+					mTimestamps[vertex] = mTimestamp++;
+					return 1;
+				}
+				return 0;
+			}
+
+			U32 TransformTriangle(const U32* indices)
+			{
+				return Transform(indices[0]) + Transform(indices[1]) + Transform(indices[2]);
+			}
+
+			void Reset()
+			{
+				mTimestamp += mCacheSize + 1;
+			}
+
+		private:
+			U32 mCacheSize = 0;
+			U32 mTimestamp = 0;
+			DynamicArray<U32> mTimestamps;
+		};
+
+		void GetPosition(const U8* vertices, U32 vertexSize, U32 vertex, F32* out)
+		{
+			Memory::Memcpy(out, vertices + (size_t)vertex * vertexSize, sizeof(F32) * 3);
+		}
+
+		// symmetric 4x4 matrix of the squared distance to planes, weighted by area
+		struct Quadric
+		{
+			F64 a00 = 0.0, a11 = 0.0, a22 = 0.0;
+			F64 a01 = 0.0, a02 = 0.0, a12 = 0.0;
+			F64 b0 = 0.0, b1 = 0.0, b2 = 0.0;
+			F64 c = 0.0;
+			F64 w = 0.0;
+
+			void AddPlane(const F64* n, F64 d, F64 weight)
+			{
+				a00 += weight * n[0] * n[0];
+				a11 += weight * n[1] * n[1];
+				a22 += weight * n[2] * n[2];
+				a01 += weight * n[0] * n[1];
+				a02 += weight * n[0] * n[2];
+				a12 += weight * n[1] * n[2];
+				b0 += weight * n[0] * d;
+				b1 += weight * n[1] * d;
+				b2 += weight * n[2] * d;
+				c += weight * d * d;
+				w += weight;
+			}
+
+			void Add(const Quadric& rhs)
+			{
+				a00 += rhs.a00; a11 += rhs.a11; a22 += rhs.a22;
+				a01 += rhs.a01; a02 += rhs.a02; a12 += rhs.a12;
+				b0 += rhs.b0; b1 += rhs.b1; b2 += rhs.b2;
+				c += rhs.c;
+				w += rhs.w;
+			}
+
+			// mean squared distance of p to planes
+			F64 Evaluate(const F32* p)const
+			{
+				const F64 x = p[0], y = p[1], z = p[2];
+				const F64 error =
+					a00 * x * x + a11 * y * y + a22 * z * z +
+					2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+					2.0 * (b0 * x + b1 * y + b2 * z) + c;
+				return w > 0.0 ? std::abs(error) / w : 0.0;
+			}
+		};
+
+		struct Collapse
+		{
+			U32 mFrom;
+			U32 mTo;
+			F64 mError;
+		};
+
+		void ComputeNormal(const F32* p0, const F32* p1, const F32* p2, F64* n)
+		{
+			const F64 e0[3] = { (F64)p1[0] - p0[0], (F64)p1[1] - p0[1], (F64)p1[2] - p0[2] };
+			const F64 e1[3] = { (F64)p2[0] - p0[0], (F64)p2[1] - p0[1], (F64)p2[2] - p0[2] };
+			n[0] = e0[1] * e1[2] - e0[2] * e1[1];
+			n[1] = e0[2] * e1[0] - e0[0] * e1[2];
+			n[2] = e0[0] * e1[1] - e0[1] * e1[0];
+		}
+	}
+
+	VertexCacheStats AnalyzeVertexCache(const U32* indices, U32 indexCount, U32 vertexCount, U32 cacheSize)
+	{
+		VertexCacheStats stats;
+		if (indexCount < 3 || vertexCount == 0) {
+			return stats;
+		}
+
+		CacheSimulator cache(vertexCount, cacheSize);
+		for (U32 i = 0; i < indexCount; i++) {
+			stats.mVerticesTransformed += cache.Transform(indices[i]);
+		}
+
+		stats.mACMR = (F32)stats.mVerticesTransformed / (F32)(indexCount / 3);
+		stats.mATVR = (F32)stats.mVerticesTransformed / (F32)vertexCount;
+		return stats;
+	}
+
+	void OptimizeVertexCache(U32* dst, const U32* indices, U32 indexCount, U32 vertexCount)
+	{
+		PROFILE_FUNCTION();
+		const U32 triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		static const ForsythScoreTable scoreTable;
+
+		// dst could be the same as indices
+		DynamicArray<U32> srcIndices;
+		srcIndices.resize(indexCount);
+		Memory::Memcpy(srcIndices.data(), indices, sizeof(U32) * indexCount);
+
+		// build triangle adjacency of vertices, remaining triangles are kept
+		// at the front of the adjacency list and valence is the count of them
+		DynamicArray<U32> valences;
+		valences.resize(vertexCount);
+		Memory::Memset(valences.data(), 0, sizeof(U32) * vertexCount);
+		for (U32 i = 0; i < indexCount; i++) {
+			valences[srcIndices[i]]++;
+		}
+
+		DynamicArray<U32> adjacencyOffsets;
+		adjacencyOffsets.resize(vertexCount);
+		U32 offset = 0;
+		for (U32 i = 0; i < vertexCount; i++)
+		{
+			adjacencyOffsets[i] = offset;
+			offset += valences[i];
+			valences[i] = 0;
+		}
+
+		DynamicArray<U32> adjacency;
+		adjacency.resize(indexCount);
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			const U32 vertex = srcIndices[i];
+			adjacency[adjacencyOffsets[vertex] + valences[vertex]++] = i / 3;
+		}
+
+		// initial scores
+		DynamicArray<F32> vertexScores;
+		DynamicArray<I32> cachePositions;
+		vertexScores.resize(vertexCount);
+		cachePositions.resize(vertexCount);
+		for (U32 i = 0; i < vertexCount; i++)
+		{
+			cachePositions[i] = -1;
+			vertexScores[i] = scoreTable.GetVertexScore(-1, valences[i]);
+		}
+
+		DynamicArray<F32> triangleScores;
+		DynamicArray<U8> emitted;
+		triangleScores.resize(triangleCount);
+		emitted.resize(triangleCount);
+		I32 bestTriangle = -1;
+		F32 bestScore = -1.0f;
+		for (U32 i = 0; i < triangleCount; i++)
+		{
+			const U32* tri = &srcIndices[i * 3];
+			triangleScores[i] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+			emitted[i] = 0;
+			if (triangleScores[i] > bestScore)
+			{
+				bestScore = triangleScores[i];
+				bestTriangle = (I32)i;
+			}
+		}
+
+		U32 cache[FORSYTH_CACHE_SIZE + 3];
+		U32 cacheCount = 0;
+		U32 inputCursor = 0;
+		for (U32 outTri = 0; outTri < triangleCount; outTri++)
+		{
+			// dead end, no triangles are adjacent to the cache, continue in input order
+			if (bestTriangle < 0)
+			{
+				while (emitted[inputCursor]) {
+					inputCursor++;
+				}
+				bestTriangle = (I32)inputCursor;
+			}
+
+			const U32* tri = &srcIndices[bestTriangle * 3];
+			dst[outTri * 3 + 0] = tri[0];
+			dst[outTri * 3 + 1] = tri[1];
+			dst[outTri * 3 + 2] = tri[2];
+			emitted[bestTriangle] = 1;
+
+			// remove the triangle from the adjacency of its vertices
+			for (U32 corner = 0; corner < 3; corner++)
+			{
+				const U32 vertex = tri[corner];
+				U32* triangles = &adjacency[adjacencyOffsets[vertex]];
+				U32& valence = valences[vertex];
+				for (U32 i = 0; i < valence; i++)
+				{
+					if (triangles[i] == (U32)bestTriangle)
+					{
+						triangles[i] = triangles[valence - 1];
+						valence--;
+						break;
+					}
+				}
+			}
+
+			// move vertices of the triangle to the front of the LRU cache
+			U32 newCache[FORSYTH_CACHE_SIZE + 3];
+			U32 newCacheCount = 0;
+			for (U32 corner = 0; corner < 3; corner++)
+			{
+				const U32 vertex = tri[corner];
+				if (std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount) {
+					newCache[newCacheCount++] = vertex;
+				}
+			}
+			for (U32 i = 0; i < cacheCount; i++)
+			{
+				const U32 vertex = cache[i];
+				if (vertex != tri[0] && vertex != tri[1] && vertex != tri[2]) {
+					newCache[newCacheCount++] = vertex;
+				}
+			}
+
+			// update scores of cached and evicted vertices
+			for (U32 i = 0; i < newCacheCount; i++)
+			{
+				const U32 vertex = newCache[i];
+				const I32 cachePos = i < FORSYTH_CACHE_SIZE ? (I32)i : -1;
+				const F32 score = scoreTable.GetVertexScore(cachePos, valences[vertex]);
+				const F32 delta = score - vertexScores[vertex];
+				cachePositions[vertex] = cachePos;
+				vertexScores[vertex] = score;
+
+				const U32* triangles = &adjacency[adjacencyOffsets[vertex]];
+				for (U32 j = 0; j < valences[vertex]; j++) {
+					triangleScores[triangles[j]] += delta;
+				}
+			}
+
+			// find the best triangle adjacent to the cache
+			cacheCount = std::min(newCacheCount, FORSYTH_CACHE_SIZE);
+			bestTriangle = -1;
+			bestScore = -1.0f;
+			for (U32 i = 0; i < cacheCount; i++)
+			{
+				const U32 vertex = newCache[i];
+				cache[i] = vertex;
+
+				const U32* triangles = &adjacency[adjacencyOffsets[vertex]];
+				for (U32 j = 0; j < valences[vertex]; j++)
+				{
+					const U32 triangle = triangles[j];
+					if (triangleScores[triangle] > bestScore)
+					{
+						bestScore = triangleScores[triangle];
+						bestTriangle = (I32)triangle;
+					}
+				}
+			}
+		}
+	}
+
+	void OptimizeOverdraw(U32* dst, const U32* indices, U32 indexCount, const U8* vertices, U32 vertexCount, U32 vertexSize, F32 threshold)
+	{
+		PROFILE_FUNCTION();
+		const U32 triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		// dst could be the same as indices
+		DynamicArray<U32> srcIndices;
+		srcIndices.resize(indexCount);
+		Memory::Memcpy(srcIndices.data(), indices, sizeof(U32) * indexCount);
+
+		// 1. hard boundaries, where all vertices of a triangle miss the cache
+		CacheSimulator cache(vertexCount, DEFAULT_CACHE_SIZE);
+		DynamicArray<U32> hardBoundaries;
+		for (U32 i = 0; i < triangleCount; i++)
+		{
+			if (cache.TransformTriangle(&srcIndices[i * 3]) == 3 || i == 0) {
+				hardBoundaries.push(i);
+			}
+		}
+		hardBoundaries.push(triangleCount);
+
+		// 2. soft boundaries, split hard clusters as soon as the ACMR of the running
+		// cluster is lower than the threshold of the hard cluster, each cluster
+		// starts with an empty cache, so that it could be drawn in any order
+		DynamicArray<U32> boundaries;
+		for (U32 cluster = 0; cluster + 1 < hardBoundaries.size(); cluster++)
+		{
+			const U32 start = hardBoundaries[cluster];
+			const U32 end = hardBoundaries[cluster + 1];
+
+			cache.Reset();
+			U32 clusterMisses = 0;
+			for (U32 i = start; i < end; i++) {
+				clusterMisses += cache.TransformTriangle(&srcIndices[i * 3]);
+			}
+			const F32 clusterThreshold = threshold * (F32)clusterMisses / (F32)(end - start);
+
+			cache.Reset();
+			boundaries.push(start);
+			U32 runningMisses = 0;
+			U32 runningTriangles = 0;
+			for (U32 i = start; i < end; i++)
+			{
+				runningMisses += cache.TransformTriangle(&srcIndices[i * 3]);
+				runningTriangles++;
+
+				if (i + 1 < end && (F32)runningMisses <= clusterThreshold * (F32)runningTriangles)
+				{
+					boundaries.push(i + 1);
+					cache.Reset();
+					runningMisses = 0;
+					runningTriangles = 0;
+				}
+			}
+		}
+		boundaries.push(triangleCount);
+
+		// 3. compute area weighted centroids and normals of clusters
+		const U32 clusterCount = boundaries.size() - 1;
+		DynamicArray<F32> clusterDatas;
+		clusterDatas.resize(clusterCount * 7);
+		F32 meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+		F32 meshArea = 0.0f;
+		for (U32 cluster = 0; cluster < clusterCount; cluster++)
+		{
+			F32 centroid[3] = { 0.0f, 0.0f, 0.0f };
+			F32 normal[3] = { 0.0f, 0.0f, 0.0f };
+			F32 clusterArea = 0.0f;
+			for (U32 i = boundaries[cluster]; i < boundaries[cluster + 1]; i++)
+			{
+				F32 p0[3], p1[3], p2[3];
+				GetPosition(vertices, vertexSize, srcIndices[i * 3 + 0], p0);
+				GetPosition(vertices, vertexSize, srcIndices[i * 3 + 1], p1);
+				GetPosition(vertices, vertexSize, srcIndices[i * 3 + 2], p2);
+
+				const F32 e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const F32 e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				const F32 n[3] = {
+					e0[1] * e1[2] - e0[2] * e1[1],
+					e0[2] * e1[0] - e0[0] * e1[2],
+					e0[0] * e1[1] - e0[1] * e1[0]
+				};
+				const F32 area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				for (U32 k = 0; k < 3; k++)
+				{
+					centroid[k] += (p0[k] + p1[k] + p2[k]) * (area / 3.0f);
+					normal[k] += n[k];
+				}
+				clusterArea += area;
+			}
+
+			for (U32 k = 0; k < 3; k++) {
+				meshCentroid[k] += centroid[k];
+			}
+			meshArea += clusterArea;
+
+			F32* data = &clusterDatas[cluster * 7];
+			const F32 invArea = clusterArea > 0.0f ? 1.0f / clusterArea : 0.0f;
+			const F32 normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			const F32 invNormalLength = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+			for (U32 k = 0; k < 3; k++)
+			{
+				data[k] = centroid[k] * invArea;
+				data[k + 3] = normal[k] * invNormalLength;
+			}
+		}
+
+		const F32 invMeshArea = meshArea > 0.0f ? 1.0f / meshArea : 0.0f;
+		for (U32 k = 0; k < 3; k++) {
+			meshCentroid[k] *= invMeshArea;
+		}
+
+		// 4. sort clusters, clusters facing outwards are more likely to occlude others, draw them first
+		DynamicArray<U32> clusterOrder;
+		clusterOrder.resize(clusterCount);
+		for (U32 cluster = 0; cluster < clusterCount; cluster++)
+		{
+			F32* data = &clusterDatas[cluster * 7];
+			data[6] =
+				(data[0] - meshCentroid[0]) * data[3] +
+				(data[1] - meshCentroid[1]) * data[4] +
+				(data[2] - meshCentroid[2]) * data[5];
+			clusterOrder[cluster] = cluster;
+		}
+
+		std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterDatas](U32 a, U32 b) {
+			return clusterDatas[a * 7 + 6] > clusterDatas[b * 7 + 6];
+		});
+
+		// 5. write triangles in order of clusters
+		U32 offset = 0;
+		for (U32 cluster : clusterOrder)
+		{
+			const U32 start = boundaries[cluster] * 3;
+			const U32 count = (boundaries[cluster + 1] - boundaries[cluster]) * 3;
+			Memory::Memcpy(dst + offset, srcIndices.data() + start, sizeof(U32) * count);
+			offset += count;
+		}
+	}
+
+	U32 OptimizeVertexFetch(U8* dstVertices, U32* indices, U32 indexCount, const U8* vertices, U32 vertexCount, U32 vertexSize)
+	{
+		PROFILE_FUNCTION();
+		const U32 INVALID_INDEX = ~0u;
+		DynamicArray<U32> remap;
+		remap.resize(vertexCount);
+		Memory::Memset(remap.data(), 0xff, sizeof(U32) * vertexCount);
+
+		U32 nextVertex = 0;
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			const U32 vertex = indices[i];
+			if (remap[vertex] == INVALID_INDEX)
+			{
+				remap[vertex] = nextVertex;
+				Memory::Memcpy(
+					dstVertices + (size_t)nextVertex * vertexSize,
+					vertices + (size_t)vertex * vertexSize,
+					vertexSize
+				);
+				nextVertex++;
+			}
+			indices[i] = remap[vertex];
+		}
+		return nextVertex;
+	}
+
+	U32 SimplifyMesh(U32* dst, const U32* indices, U32 indexCount, const U8* vertices, U32 vertexCount, U32 vertexSize, U32 targetIndexCount, F32 targetError, F32* resultError)
+	{
+		PROFILE_FUNCTION();
+		DynamicArray<U32> result;
+		result.resize(indexCount);
+		Memory::Memcpy(result.data(), indices, sizeof(U32) * indexCount);
+
+		DynamicArray<F32> positions;
+		positions.resize(vertexCount * 3);
+		for (U32 i = 0; i < vertexCount; i++) {
+			GetPosition(vertices, vertexSize, i, &positions[i * 3]);
+		}
+
+		// 1. lock vertices on attribute seams, which positions are shared by other vertices
+		DynamicArray<U8> locked;
+		locked.resize(vertexCount);
+		Memory::Memset(locked.data(), 0, vertexCount);
+		{
+			DynamicArray<U32> sortedVertices;
+			sortedVertices.resize(vertexCount);
+			for (U32 i = 0; i < vertexCount; i++) {
+				sortedVertices[i] = i;
+			}
+			auto ComparePosition = [&positions](U32 a, U32 b) {
+				return memcmp(&positions[a * 3], &positions[b * 3], sizeof(F32) * 3);
+			};
+			std::sort(sortedVertices.begin(), sortedVertices.end(), [&ComparePosition](U32 a, U32 b) {
+				return ComparePosition(a, b) < 0;
+			});
+			for (U32 i = 1; i < vertexCount; i++)
+			{
+				if (ComparePosition(sortedVertices[i - 1], sortedVertices[i]) == 0)
+				{
+					locked[sortedVertices[i - 1]] = 1;
+					locked[sortedVertices[i]] = 1;
+				}
+			}
+		}
+
+		// 2. lock vertices on borders, which edges are used by only one triangle
+		{
+			DynamicArray<U64> edges;
+			edges.resize(indexCount);
+			for (U32 i = 0; i < indexCount; i++)
+			{
+				const U32 v0 = result[i];
+				const U32 v1 = result[i - i % 3 + (i + 1) % 3];
+				edges[i] = v0 < v1 ? ((U64)v0 << 32 | v1) : ((U64)v1 << 32 | v0);
+			}
+			std::sort(edges.begin(), edges.end());
+			for (U32 i = 0; i < indexCount; )
+			{
+				U32 next = i + 1;
+				while (next < indexCount && edges[next] == edges[i]) {
+					next++;
+				}
+				if (next - i == 1)
+				{
+					locked[(U32)(edges[i] >> 32)] = 1;
+					locked[(U32)(edges[i] & 0xffffffff)] = 1;
+				}
+				i = next;
+			}
+		}
+
+		// 3. quadrics of vertices
+		DynamicArray<Quadric> quadrics;
+		quadrics.resize(vertexCount);
+		for (U32 i = 0; i + 2 < indexCount; i += 3)
+		{
+			const F32* p0 = &positions[result[i + 0] * 3];
+			F64 n[3];
+			ComputeNormal(p0, &positions[result[i + 1] * 3], &positions[result[i + 2] * 3], n);
+			const F64 area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (area <= 0.0) {
+				continue;
+			}
+
+			n[0] /= area;
+			n[1] /= area;
+			n[2] /= area;
+			const F64 d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+			for (U32 corner = 0; corner < 3; corner++) {
+				quadrics[result[i + corner]].AddPlane(n, d, area);
+			}
+		}
+
+		// 4. collapse edges in passes, vertices around a collapse are not touched
+		// again in the same pass, so that costs and flip checks remain valid
+		const F64 errorLimit = (F64)targetError * targetError;
+		F64 maxError = 0.0;
+		U32 resultCount = indexCount - indexCount % 3;
+		DynamicArray<Collapse> collapses;
+		DynamicArray<U32> remap;
+		DynamicArray<U8> touched;
+		DynamicArray<U32> adjacencyOffsets;
+		DynamicArray<U32> adjacency;
+		remap.resize(vertexCount);
+		touched.resize(vertexCount);
+		adjacencyOffsets.resize(vertexCount + 1);
+		while (resultCount > targetIndexCount)
+		{
+			// collect collapses of edges
+			collapses.clear();
+			for (U32 i = 0; i < resultCount; i++)
+			{
+				const U32 v0 = result[i];
+				const U32 v1 = result[i - i % 3 + (i + 1) % 3];
+				if (!locked[v0]) {
+					collapses.push({ v0, v1, quadrics[v0].Evaluate(&positions[v1 * 3]) });
+				}
+				if (!locked[v1]) {
+					collapses.push({ v1, v0, quadrics[v1].Evaluate(&positions[v0 * 3]) });
+				}
+			}
+			if (collapses.empty()) {
+				break;
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+				return a.mError < b.mError;
+			});
+
+			// triangle adjacency of vertices
+			Memory::Memset(adjacencyOffsets.data(), 0, sizeof(U32) * (vertexCount + 1));
+			for (U32 i = 0; i < resultCount; i++) {
+				adjacencyOffsets[result[i] + 1]++;
+			}
+			for (U32 i = 0; i < vertexCount; i++) {
+				adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+			}
+			adjacency.resize(resultCount);
+			for (U32 i = 0; i < resultCount; i++) {
+				adjacency[adjacencyOffsets[result[i]]++] = i / 3;
+			}
+			for (U32 i = vertexCount; i > 0; i--) {
+				adjacencyOffsets[i] = adjacencyOffsets[i - 1];
+			}
+			adjacencyOffsets[0] = 0;
+
+			for (U32 i = 0; i < vertexCount; i++) {
+				remap[i] = i;
+			}
+			Memory::Memset(touched.data(), 0, vertexCount);
+
+			// each collapse removes about 2 triangles
+			const U32 collapseLimit = (resultCount - targetIndexCount) / 6 + 1;
+			U32 collapseCount = 0;
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.mError > errorLimit || collapseCount >= collapseLimit) {
+					break;
+				}
+
+				const U32 from = collapse.mFrom;
+				const U32 to = collapse.mTo;
+				if (touched[from] || touched[to]) {
+					continue;
+				}
+
+				// reject collapses flipping triangles
+				const F32* toPos = &positions[to * 3];
+				bool isFlipped = false;
+				for (U32 j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1] && !isFlipped; j++)
+				{
+					const U32* tri = &result[adjacency[j] * 3];
+					if (tri[0] == to || tri[1] == to || tri[2] == to) {
+						continue;
+					}
+
+					const F32* p[3];
+					const F32* q[3];
+					for (U32 corner = 0; corner < 3; corner++)
+					{
+						p[corner] = &positions[tri[corner] * 3];
+						q[corner] = tri[corner] == from ? toPos : p[corner];
+					}
+
+					F64 n0[3], n1[3];
+					ComputeNormal(p[0], p[1], p[2], n0);
+					ComputeNormal(q[0], q[1], q[2], n1);
+					isFlipped = (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2]) <= 0.0;
+				}
+				if (isFlipped) {
+					continue;
+				}
+
+				remap[from] = to;
+				quadrics[to].Add(quadrics[from]);
+				maxError = std::max(maxError, collapse.mError);
+				collapseCount++;
+
+				for (U32 j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1]; j++)
+				{
+					const U32* tri = &result[adjacency[j] * 3];
+					touched[tri[0]] = 1;
+					touched[tri[1]] = 1;
+					touched[tri[2]] = 1;
+				}
+			}
+
+			if (collapseCount == 0) {
+				break;
+			}
+
+			// remap indices and remove degenerated triangles
+			U32 writeCount = 0;
+			for (U32 i = 0; i < resultCount; i += 3)
+			{
+				const U32 v0 = remap[result[i + 0]];
+				const U32 v1 = remap[result[i + 1]];
+				const U32 v2 = remap[result[i + 2]];
+				if (v0 != v1 && v0 != v2 && v1 != v2)
+				{
+					result[writeCount + 0] = v0;
+					result[writeCount + 1] = v1;
+					result[writeCount + 2] = v2;
+					writeCount += 3;
+				}
+			}
+			resultCount = writeCount;
+		}
+
+		Memory::Memcpy(dst, result.data(), sizeof(U32) * resultCount);
+		if (resultError != nullptr) {
+			*resultError = (F32)std::sqrt(maxError);
+		}
+		return resultCount;
+	}
+
+	U32 BuildMeshlets(DynamicArray<Meshlet>& meshlets, const U32* indices, U32 indexCount, const U8* vertices, U32 vertexCount, U32 vertexSize, U32 maxVertices, U32 maxTriangles)
+	{
+		PROFILE_FUNCTION();
+		meshlets.clear();
+		if (indexCount < 3 || maxVertices < 3 || maxTriangles == 0) {
+			return 0;
+		}
+
+		// vertex => meshlet index + 1 of the last use, so that the marks are never cleared
+		DynamicArray<U32> usedMeshlets;
+		usedMeshlets.resize(vertexCount);
+		Memory::Memset(usedMeshlets.data(), 0, sizeof(U32) * vertexCount);
+
+		// count distinct vertices of the triangle which are not in the meshlet
+		auto CountNewVertices = [&](const U32* tri, U32 meshletMark) {
+			U32 count = usedMeshlets[tri[0]] != meshletMark ? 1 : 0;
+			count += (usedMeshlets[tri[1]] != meshletMark && tri[1] != tri[0]) ? 1 : 0;
+			count += (usedMeshlets[tri[2]] != meshletMark && tri[2] != tri[0] && tri[2] != tri[1]) ? 1 : 0;
+			return count;
+		};
+
+		Meshlet meshlet;
+		U32 meshletMark = 1;
+		for (U32 i = 0; i + 2 < indexCount; i += 3)
+		{
+			const U32* tri = &indices[i];
+			U32 newVertices = CountNewVertices(tri, meshletMark);
+
+			// flush current meshlet if the triangle could not be added
+			if (meshlet.mIndexCount > 0 &&
+				(meshlet.mVertexCount + newVertices > maxVertices || meshlet.mIndexCount / 3 >= maxTriangles))
+			{
+				ComputeMeshletBounds(meshlet, indices + meshlet.mIndexOffset, meshlet.mIndexCount, vertices, vertexSize);
+				meshlets.push(meshlet);
+
+				meshlet = Meshlet();
+				meshlet.mIndexOffset = i;
+				meshletMark++;
+				newVertices = CountNewVertices(tri, meshletMark);
+			}
+
+			usedMeshlets[tri[0]] = meshletMark;
+			usedMeshlets[tri[1]] = meshletMark;
+			usedMeshlets[tri[2]] = meshletMark;
+			meshlet.mVertexCount += newVertices;
+			meshlet.mIndexCount += 3;
+		}
+
+		if (meshlet.mIndexCount > 0)
+		{
+			ComputeMeshletBounds(meshlet, indices + meshlet.mIndexOffset, meshlet.mIndexCount, vertices, vertexSize);
+			meshlets.push(meshlet);
+		}
+		return meshlets.size();
+	}
+
+	void ComputeMeshletBounds(Meshlet& meshlet, const U32* indices, U32 indexCount, const U8* vertices, U32 vertexSize)
+	{
+		if (indexCount < 3) {
+			return;
+		}
+
+		// bounding sphere at the center of the bounding box
+		F32 minPos[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		F32 maxPos[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			F32 p[3];
+			GetPosition(vertices, vertexSize, indices[i], p);
+			for (U32 k = 0; k < 3; k++)
+			{
+				minPos[k] = std::min(minPos[k], p[k]);
+				maxPos[k] = std::max(maxPos[k], p[k]);
+			}
+		}
+
+		F32 center[3];
+		for (U32 k = 0; k < 3; k++) {
+			center[k] = (minPos[k] + maxPos[k]) * 0.5f;
+		}
+
+		F32 radiusSq = 0.0f;
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			F32 p[3];
+			GetPosition(vertices, vertexSize, indices[i], p);
+			const F32 dx = p[0] - center[0], dy = p[1] - center[1], dz = p[2] - center[2];
+			radiusSq = std::max(radiusSq, dx * dx + dy * dy + dz * dz);
+		}
+
+		meshlet.mCenter = F32x3(center[0], center[1], center[2]);
+		meshlet.mRadius = std::sqrt(radiusSq);
+		meshlet.mConeApex = meshlet.mCenter;
+		meshlet.mConeAxis = F32x3(0.0f, 0.0f, 1.0f);
+		meshlet.mConeCutoff = 1.0f;
+
+		// normal cone, the axis is the average of unit normals of front faces
+		const U32 triangleCount = indexCount / 3;
+		DynamicArray<F64> normals;
+		normals.resize(triangleCount * 3);
+
+		F64 axis[3] = { 0.0, 0.0, 0.0 };
+		for (U32 i = 0; i < triangleCount; i++)
+		{
+			F32 p[3][3];
+			for (U32 k = 0; k < 3; k++) {
+				GetPosition(vertices, vertexSize, indices[i * 3 + k], p[k]);
+			}
+
+			// front faces are counter-clockwise in the left-handed view space,
+			// so that normals of front faces are cross(p2 - p0, p1 - p0)
+			F64* n = &normals[i * 3];
+			ComputeNormal(p[0], p[2], p[1], n);
+			const F64 length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			const F64 invLength = length > 0.0 ? 1.0 / length : 0.0;
+			for (U32 k = 0; k < 3; k++)
+			{
+				n[k] *= invLength;
+				axis[k] += n[k];
+			}
+		}
+
+		const F64 axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		if (axisLength <= 0.0) {
+			return;
+		}
+		for (U32 k = 0; k < 3; k++) {
+			axis[k] /= axisLength;
+		}
+
+		F64 minDot = 1.0;
+		for (U32 i = 0; i < triangleCount; i++)
+		{
+			const F64* n = &normals[i * 3];
+			if (n[0] == 0.0 && n[1] == 0.0 && n[2] == 0.0) {
+				continue;
+			}
+			minDot = std::min(minDot, n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]);
+		}
+
+		meshlet.mConeAxis = F32x3((F32)axis[0], (F32)axis[1], (F32)axis[2]);
+
+		// normals are spread over a hemisphere, the meshlet is never back-facing
+		if (minDot <= 0.0) {
+			return;
+		}
+
+		// move the apex along the axis behind all triangle planes, so that the cone test 
+		// is conservative for the whole meshlet
+		F64 maxT = 0.0;
+		for (U32 i = 0; i < triangleCount; i++)
+		{
+			const F64* n = &normals[i * 3];
+			const F64 nDotAxis = n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2];
+			if (nDotAxis <= 0.0) {
+				continue;
+			}
+
+			F32 p0[3];
+			GetPosition(vertices, vertexSize, indices[i * 3], p0);
+			const F64 dist = (center[0] - p0[0]) * n[0] + (center[1] - p0[1]) * n[1] + (center[2] - p0[2]) * n[2];
+			maxT = std::max(maxT, dist / nDotAxis);
+		}
+
+		meshlet.mConeApex = F32x3(
+			(F32)(center[0] - axis[0] * maxT),
+			(F32)(center[1] - axis[1] * maxT),
+			(F32)(center[2] - axis[2] * maxT));
+		meshlet.mConeCutoff = (F32)std::sqrt(1.0 - minDot * minDot);
+	}
+
+	U16 QuantizeUnorm16(F32 value)
+	{
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return (U16)(value * 65535.0f + 0.5f);
+	}
+
+	I16 QuantizeSnorm16(F32 value)
+	{
+		value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return (I16)(value * 32767.0f + (value >= 0.0f ? 0.5f : -0.5f));
+	}
+
+	U16 QuantizeHalf(F32 value)
+	{
+		return XMConvertFloatToHalf(value);
+	}
+
+	F32x2 EncodeOctahedral(const F32x3& normal)
+	{
+		// project to the octahedron, then fold the lower hemisphere
+		const F32 length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+		if (length <= 0.0f) {
+			return F32x2(0.0f, 0.0f);
+		}
+
+		F32 x = normal[0] / length;
+		F32 y = normal[1] / length;
+		if (normal[2] < 0.0f)
+		{
+			const F32 foldX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			const F32 foldY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldX;
+			y = foldY;
+		}
+		return F32x2(x, y);
+	}
+
+	F32x3 DecodeOctahedral(const F32x2& oct)
+	{
+		F32 x = oct[0];
+		F32 y = oct[1];
+		const F32 z = 1.0f - std::abs(x) - std::abs(y);
+		if (z < 0.0f)
+		{
+			const F32 foldX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			const F32 foldY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldX;
+			y = foldY;
+		}
+
+		const F32 length = std::sqrt(x * x + y * y + z * z);
+		return F32x3(x / length, y / length, z / length);
+	}
+}
+}
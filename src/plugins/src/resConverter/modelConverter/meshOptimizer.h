@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core\common\common.h"
+#include "core\container\dynamicArray.h"
+
+namespace Cjing3D
+{
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// MeshOptimizer
+	/// Offline optimizations of indexed triangle lists. Indices could be optimized in place, positions
+	/// are read as F32x3 at the beginning of each vertex.
+	namespace MeshOptimizer
+	{
+		// post transform cache size used to compute statistics
+		static const U32 DEFAULT_CACHE_SIZE = 16;
+
+		struct VertexCacheStats
+		{
+			U32 mVerticesTransformed = 0;
+			F32 mACMR = 0.0f;	// transformed vertices / triangles, 0.5 is optimal for large grids
+			F32 mATVR = 0.0f;	// transformed vertices / vertices, 1.0 is optimal
+		};
+
+		// simulate a FIFO post transform cache
+		VertexCacheStats AnalyzeVertexCache(const U32* indices, U32 indexCount, U32 vertexCount, U32 cacheSize = DEFAULT_CACHE_SIZE);
+
+		// reorder triangles for the post transform cache (Forsyth, linear speed vertex cache optimisation)
+		void OptimizeVertexCache(U32* dst, const U32* indices, U32 indexCount, U32 vertexCount);
+
+		// reorder clusters of triangles to reduce overdraw (Tipsy), indices should be optimized for the
+		// vertex cache first, threshold is the max ACMR degradation (1.05 allows 5% worse ACMR)
+		void OptimizeOverdraw(U32* dst, const U32* indices, U32 indexCount, const U8* vertices, U32 vertexCount, U32 vertexSize, F32 threshold);
+
+		// reorder vertices in order of first use and remap indices in place, dstVertices must not
+		// overlap vertices, return the count of referenced vertices
+		U32 OptimizeVertexFetch(U8* dstVertices, U32* indices, U32 indexCount, const U8* vertices, U32 vertexCount, U32 vertexSize);
+
+		// simplify by quadric edge collapses (Garland-Heckbert), vertices are collapsed into existing vertices,
+		// so that the result shares the vertex buffer. Vertices on borders and attribute seams are locked.
+		// Collapsing is stopped at targetIndexCount or when the error is larger than targetError in object
+		// space, return the index count of the result, resultError is the max error of collapses.
+		U32 SimplifyMesh(U32* dst, const U32* indices, U32 indexCount, const U8* vertices, U32 vertexCount, U32 vertexSize, U32 targetIndexCount, F32 targetError, F32* resultError = nullptr);
+
+		struct Meshlet
+		{
+			U32 mIndexOffset = 0;
+			U32 mIndexCount = 0;
+			U32 mVertexCount = 0;
+
+			// bounding sphere
+			F32x3 mCenter = F32x3(0.0f, 0.0f, 0.0f);
+			F32 mRadius = 0.0f;
+
+			// normal cone, the meshlet is back-facing if dot(normalize(apex - eye), axis) >= cutoff,
+			// the cutoff is 1.0 if normals are spread over a hemisphere
+			F32x3 mConeApex = F32x3(0.0f, 0.0f, 0.0f);
+			F32x3 mConeAxis = F32x3(0.0f, 0.0f, 1.0f);
+			F32 mConeCutoff = 1.0f;
+		};
+
+		// partition triangles into meshlets of contiguous index ranges in order of indices, so that
+		// meshlets could be drawn directly from the index buffer. Indices should be optimized for
+		// the vertex cache first to get compact meshlets, return the count of meshlets
+		U32 BuildMeshlets(DynamicArray<Meshlet>& meshlets, const U32* indices, U32 indexCount, const U8* vertices, U32 vertexCount, U32 vertexSize, U32 maxVertices, U32 maxTriangles);
+
+		// compute bounding sphere and normal cone of triangles, front faces are counter-clockwise
+		// in the left-handed view space, which is the convention of the renderer
+		void ComputeMeshletBounds(Meshlet& meshlet, const U32* indices, U32 indexCount, const U8* vertices, U32 vertexSize);
+
+		// quantization of vertex attributes, values are clamped to the range of the format
+		U16 QuantizeUnorm16(F32 value);
+		I16 QuantizeSnorm16(F32 value);
+		U16 QuantizeHalf(F32 value);
+
+		// octahedral mapping of unit vectors, the result is in [-1, 1]
+		F32x2 EncodeOctahedral(const F32x3& normal);
+		F32x3 DecodeOctahedral(const F32x2& oct);
+	}
+}
@@ -12,33 +12,72 @@ namespace Cjing3D
 {
 	void ModelMetaObject::Serialize(JsonArchive& archive)const
 	{
-
+		archive.Write("optimizeVertexCache", mOptimizeVertexCache);
+		archive.Write("optimizeOverdraw", mOptimizeOverdraw);
+		archive.Write("overdrawThreshold", mOverdrawThreshold);
+		archive.Write("optimizeVertexFetch", mOptimizeVertexFetch);
+		archive.Write("printMeshStats", mPrintMeshStats);
+		archive.Write("quantizePositions", mQuantizePositions);
+		archive.Write("quantizeNormals", mQuantizeNormals);
+		archive.Write("quantizeUVs", mQuantizeUVs);
+		archive.Write("compactIndices", mCompactIndices);
+		archive.Write("lodRatios", mLodRatios);
+		archive.Write("lodErrors", mLodErrors);
+		archive.Write("buildMeshlets", mBuildMeshlets);
+		archive.Write("meshletMaxVertices", mMeshletMaxVertices);
+		archive.Write("meshletMaxTriangles", mMeshletMaxTriangles);
 	}
 
 	void ModelMetaObject::Unserialize(JsonArchive& archive) 
 	{
-
+		archive.Read("optimizeVertexCache", mOptimizeVertexCache);
+		archive.Read("optimizeOverdraw", mOptimizeOverdraw);
+		archive.Read("overdrawThreshold", mOverdrawThreshold);
+		archive.Read("optimizeVertexFetch", mOptimizeVertexFetch);
+		archive.Read("printMeshStats", mPrintMeshStats);
+		archive.Read("quantizePositions", mQuantizePositions);
+		archive.Read("quantizeNormals", mQuantizeNormals);
+		archive.Read("quantizeUVs", mQuantizeUVs);
+		archive.Read("compactIndices", mCompactIndices);
+		archive.Read("lodRatios", mLodRatios);
+		archive.Read("lodErrors", mLodErrors);
+		archive.Read("buildMeshlets", mBuildMeshlets);
+		archive.Read("meshletMaxVertices", mMeshletMaxVertices);
+		archive.Read("meshletMaxTriangles", mMeshletMaxTriangles);
 	}
 
 	ModelResConverter::ModelResConverter()
 	{
-		RegisterImporter("obj", CJING_NEW(ModelImporterOBJ));
+		RegisterImporter("obj", []() -> ModelImporter* {
+			return CJING_NEW(ModelImporterOBJ);
+		});
 	}
 
 	bool ModelResConverter::Convert(ResConverterContext& context, const ResourceType& type, const char* src, const char* dest)
 	{
 		ModelMetaObject data = context.GetMetaData<ModelMetaObject>();
-		BaseFileSystem& fileSystem = context.GetFileSystem();
 
 		// 1. get taget model importer
 		MaxPathString srcExt;
 		MaxPathString dirPath;
 		Path::GetPathExtension(Span(src, StringLength(src)), srcExt.toSpan());
 		Path::GetPathParentPath(src, dirPath.toSpan());
-		ModelImporter* importer = GetImporter(srcExt);
+		ModelImporter* importer = CreateImporter(srcExt);
 		if (!importer) {
 			return false;
 		}
+		bool ret = ConvertImpl(context, *importer, data, src, dest, dirPath.c_str());
+		CJING_DELETE(importer);
+
+		if (ret) {
+			context.SetMetaData<ModelMetaObject>(data);
+		}
+		return ret;
+	}
+
+	bool ModelResConverter::ConvertImpl(ResConverterContext& context, ModelImporter& importer, const ModelMetaObject& metaData, const char* src, const char* dest, const char* dirPath)
+	{
+		BaseFileSystem& fileSystem = context.GetFileSystem();
 
 		// 2. import model
 		DynamicArray<char> source;
@@ -47,7 +86,7 @@ namespace Cjing3D
 		}
 		context.AddSource(src);
 
-		if (!importer->Import(context, Span(source.data(), source.size()), src)) {
+		if (!importer.Import(context, Span(source.data(), source.size()), src)) {
 			return false;
 		}
 
@@ -56,12 +95,12 @@ namespace Cjing3D
 		// Material data
 		// Animation data
 		MemoryStream stream;
-		if (!importer->WriteModel(context, stream))
+		if (!importer.WriteModel(context, metaData, stream))
 		{
 			Logger::Warning("Failed to write model:%s", dest);
 			return false;
 		}
-		if (!importer->WriteMaterials(context, dirPath.c_str()))
+		if (!importer.WriteMaterials(context, dirPath))
 		{
 			Logger::Warning("Failed to write materials:%s", dest);
 			return false;
@@ -73,8 +112,6 @@ namespace Cjing3D
 		}
 
 		context.AddOutput(dest);
-		context.SetMetaData<ModelMetaObject>(data);
-
 		return true;
 	}
 
@@ -12,37 +12,69 @@ namespace Cjing3D
 	public:
 		virtual void Serialize(JsonArchive& archive)const;
 		virtual void Unserialize(JsonArchive& archive);
+
+		// mesh optimizations
+		bool mOptimizeVertexCache = true;
+		bool mOptimizeOverdraw = true;
+		F32 mOverdrawThreshold = 1.05f;
+		bool mOptimizeVertexFetch = true;
+		bool mPrintMeshStats = true;
+
+		// vertex attribute quantization, disabled by default since vertices are not decoded at runtime yet,
+		// so that quantized models could only be used by custom shaders
+		bool mQuantizePositions = false;	// unorm16 with per-mesh scale/offset
+		bool mQuantizeNormals = false;		// octahedral snorm16
+		bool mQuantizeUVs = false;			// half float
+		bool mCompactIndices = true;		// 16bit indices if vertices are not more than 65536
+
+		// lod chain, each lod is simplified from lod 0 until the ratio of triangles is reached or
+		// the error is larger than the threshold, errors are relative to the bounding radius of mesh
+		DynamicArray<F32> mLodRatios = { 0.5f, 0.25f, 0.125f };
+		DynamicArray<F32> mLodErrors = { 0.005f, 0.01f, 0.02f };
+
+		// meshlets of lod 0 with bounds for cluster culling
+		bool mBuildMeshlets = true;
+		U32 mMeshletMaxVertices = 64;
+		U32 mMeshletMaxTriangles = 124;
 	};
 
 	class ModelResConverter : public IResConverter
 	{
+	public:
+		// importers are stateful, create a new one for each converting,
+		// so that models could be converted concurrently
+		using CreateImporterFunc = ModelImporter* (*)();
+
 	private:
-		HashMap<String, ModelImporter*> mImporters;
+		HashMap<String, CreateImporterFunc> mImporters;
 
 	public:
+		static const U32 VERSION = 5;
+
 		ModelResConverter();
 		~ModelResConverter()
 		{
-			for (auto kvp : mImporters) {
-				CJING_SAFE_DELETE(kvp.second);
-			}
 			mImporters.clear();
 		}
 
-		void RegisterImporter(const char* ext, ModelImporter* importer)
+		void RegisterImporter(const char* ext, CreateImporterFunc func)
 		{
-			mImporters.insert(ext, importer);
+			mImporters.insert(ext, func);
 		}
 
-		ModelImporter* GetImporter(const char* ext)
+		ModelImporter* CreateImporter(const char* ext)
 		{
 			auto it = mImporters.find(ext);
-			return it != nullptr ? *it : nullptr;
+			return it != nullptr ? (*it)() : nullptr;
 		}
 
 		void OnEditorGUI(ResConverterContext& context, const ResourceType& type, Resource* res)override;
 		bool SupportsFileExt(const char* ext);
 		bool SupportsType(const char* ext, const ResourceType& type)override;
 		bool Convert(ResConverterContext& context, const ResourceType& type, const char* src, const char* dest) override;
+		U32 GetVersion(const ResourceType& type)override { return VERSION; }
+
+	private:
+		bool ConvertImpl(ResConverterContext& context, ModelImporter& importer, const ModelMetaObject& metaData, const char* src, const char* dest, const char* dirPath);
 	};
 }
\ No newline at end of file
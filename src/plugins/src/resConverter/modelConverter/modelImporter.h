@@ -6,6 +6,7 @@
 namespace Cjing3D
 {
 	class ModelResConverter;
+	class ModelMetaObject;
 
 	class ModelImporter
 	{
@@ -14,7 +15,7 @@ namespace Cjing3D
 		virtual ~ModelImporter() {}
 
 		virtual bool Import(ResConverterContext& context, Span<char> memBuffer, const char* src) = 0;
-		virtual bool WriteModel(ResConverterContext& context, MemoryStream& stream) = 0;
+		virtual bool WriteModel(ResConverterContext& context, const ModelMetaObject& metaData, MemoryStream& stream) = 0;
 		virtual bool WriteMaterials(ResConverterContext& context, const char* dirPath) = 0;
 		virtual bool SupportsFileExt(const char* ext) = 0;
 	};
@@ -1,11 +1,15 @@
 #include "modelImporterOBJ.h"
 #include "modelConverter.h"
+#include "meshOptimizer.h"
 #include "renderer\modelImpl.h"
 #include "core\filesystem\filesystem.h"
-#include "core\container\set.h"
 #include "core\serialization\jsonArchive.h"
+#include "core\concurrency\jobsystem.h"
+#include "math\hash.h"
 
 #include <streambuf>
+#include <cmath>
+#include <cfloat>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny\tinyobjloader.h"
@@ -24,12 +28,14 @@ namespace Cjing3D
 	{
 	private:
 		MaxPathString mBaseDir;
+		ResConverterContext& mContext;
 		BaseFileSystem& mFileSystem;
 
 	public:
-		explicit MaterialFileReader(const MaxPathString& baseDir, BaseFileSystem& fileSystem) :
+		explicit MaterialFileReader(const MaxPathString& baseDir, ResConverterContext& context) :
 			mBaseDir(baseDir),
-			mFileSystem(fileSystem)
+			mContext(context),
+			mFileSystem(context.GetFileSystem())
 		{}
 		virtual ~MaterialFileReader() {}
 
@@ -68,6 +74,9 @@ namespace Cjing3D
 				return false;
 			}
 
+			// mtl is a source of the model
+			mContext.AddSource(path.c_str());
+
 			// load mtl
 			MemStreamBuffer sbuf(fileData.data(), fileData.size());
 			std::istream matIStream(&sbuf);
@@ -87,6 +96,147 @@ namespace Cjing3D
 		}
 	};
 
+	/// ///////////////////////////////////////////////////////////////////////
+	/// Obj parsing
+	namespace
+	{
+		// zero based indices of a face corner, -1 if not existed
+		struct ObjIndex
+		{
+			I32 mPosition = -1;
+			I32 mTexcoord = -1;
+			I32 mNormal = -1;
+
+			bool operator==(const ObjIndex& rhs)const
+			{
+				return mPosition == rhs.mPosition &&
+					mTexcoord == rhs.mTexcoord &&
+					mNormal == rhs.mNormal;
+			}
+		};
+
+		// vertices are deduplicated by comparing full keys, the hash is only used to find the slot
+		struct ObjIndexHasher
+		{
+			U32 operator()(U32 input, const ObjIndex& key)const { return SDBHash(input, &key, sizeof(key)); }
+			U64 operator()(U64 input, const ObjIndex& key)const { return FNV1aHash(input, &key, sizeof(key)); }
+		};
+
+		inline bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		inline bool IsDigit(char c)
+		{
+			return c >= '0' && c <= '9';
+		}
+
+		inline const char* SkipSpaces(const char* ptr, const char* end)
+		{
+			while (ptr < end && IsSpace(*ptr)) {
+				ptr++;
+			}
+			return ptr;
+		}
+
+		inline bool IsKeyword(const char* key, const char* keyEnd, const char* keyword)
+		{
+			const size_t length = StringLength(keyword);
+			return (size_t)(keyEnd - key) == length && memcmp(key, keyword, length) == 0;
+		}
+
+		const char* ParseInt(const char* ptr, const char* end, I32& out)
+		{
+			bool negative = false;
+			if (ptr < end && (*ptr == '-' || *ptr == '+'))
+			{
+				negative = *ptr == '-';
+				ptr++;
+			}
+
+			I32 value = 0;
+			while (ptr < end && IsDigit(*ptr))
+			{
+				value = value * 10 + (*ptr - '0');
+				ptr++;
+			}
+			out = negative ? -value : value;
+			return ptr;
+		}
+
+		// locale independent and much faster than strtof for large files
+		const char* ParseFloat(const char* ptr, const char* end, F32& out)
+		{
+			ptr = SkipSpaces(ptr, end);
+
+			bool negative = false;
+			if (ptr < end && (*ptr == '-' || *ptr == '+'))
+			{
+				negative = *ptr == '-';
+				ptr++;
+			}
+
+			F64 value = 0.0;
+			while (ptr < end && IsDigit(*ptr))
+			{
+				value = value * 10.0 + (*ptr - '0');
+				ptr++;
+			}
+
+			if (ptr < end && *ptr == '.')
+			{
+				ptr++;
+				F64 fraction = 0.0;
+				F64 divisor = 1.0;
+				while (ptr < end && IsDigit(*ptr))
+				{
+					fraction = fraction * 10.0 + (*ptr - '0');
+					divisor *= 10.0;
+					ptr++;
+				}
+				value += fraction / divisor;
+			}
+
+			if (ptr < end && (*ptr == 'e' || *ptr == 'E'))
+			{
+				I32 exponent = 0;
+				ptr = ParseInt(ptr + 1, end, exponent);
+				value *= std::pow(10.0, (F64)exponent);
+			}
+
+			out = (F32)(negative ? -value : value);
+			return ptr;
+		}
+
+		// parse face corner "v", "v/vt", "v//vn" or "v/vt/vn", negative indices are relative to the end
+		const char* ParseObjIndex(const char* ptr, const char* end, I32 positionCount, I32 texcoordCount, I32 normalCount, ObjIndex& out)
+		{
+			auto ResolveIndex = [](I32 index, I32 count) {
+				return index > 0 ? index - 1 : (index < 0 ? count + index : -1);
+			};
+
+			I32 value = 0;
+			ptr = ParseInt(ptr, end, value);
+			out.mPosition = ResolveIndex(value, positionCount);
+			if (ptr < end && *ptr == '/')
+			{
+				ptr++;
+				if (ptr < end && *ptr != '/')
+				{
+					ptr = ParseInt(ptr, end, value);
+					out.mTexcoord = ResolveIndex(value, texcoordCount);
+				}
+				if (ptr < end && *ptr == '/')
+				{
+					ptr = ParseInt(ptr + 1, end, value);
+					out.mNormal = ResolveIndex(value, normalCount);
+				}
+			}
+			return ptr;
+		}
+	}
+
 	/// ///////////////////////////////////////////////////////////////////////
 	/// Impl
 	class ModelImporterOBJImpl
@@ -122,125 +272,620 @@ namespace Cjing3D
 			I32 mVertices = 0;
 			MemoryStream mVertexData;
 			DynamicArray<I32> mIndices;
+			GPU::IndexFormat mIndexFormat = GPU::INDEX_FORMAT_32BIT;
+
+			// submeshes of lods after lod 0, indices are appended to lod 0
+			DynamicArray<ModelSubMesh> mLodSubMeshes;
+			DynamicArray<F32> mLodErrors;
+			F32x3 mPositionOffset = F32x3(0.0f, 0.0f, 0.0f);
+			F32x3 mPositionScale = F32x3(1.0f, 1.0f, 1.0f);
 			DynamicArray<ModelSubMesh> mSubMeshes;
+			DynamicArray<I32> mSubMeshMaterials;
+			DynamicArray<ModelMeshlet> mMeshlets;
+
+			// triangulated faces of the parsed obj
+			DynamicArray<ObjIndex> mCorners;
+			DynamicArray<I32> mTriangleMaterials;
 
-			tinyobj::shape_t* mTinyObjShape = nullptr;
+			// vertex cache stats before and after optimizations
+			MeshOptimizer::VertexCacheStats mOriginStats;
+			MeshOptimizer::VertexCacheStats mOptimizedStats;
+			I32 mOriginVertexSize = 0;
 		};
 		DynamicArray<ImportMesh> mMeshes;
 		DynamicArray<ImportMaterial> mMaterials;
 		DynamicArray<MeshInstData> mMeshInstDatas;
 
-		// tiny obj objects
-		tinyobj::attrib_t objAttrib;
-		std::vector<tinyobj::shape_t> objShapes;
+		// parsed obj attributes
+		DynamicArray<F32x3> mPositions;
+		DynamicArray<F32x3> mNormals;
+		DynamicArray<F32x2> mTexcoords;
 		std::vector<tinyobj::material_t> objMaterials;
 
 	public:
 		bool Import(ResConverterContext& context, Span<char> memBuffer, const char* src);
-		void PostprocessMeshes();
-		bool WriteModel(ResConverterContext& context, MemoryStream& stream);
+		bool ParseObj(Span<char> memBuffer, MaterialFileReader& matFileReader, const char* src);
+		void PostprocessMeshes(const ModelMetaObject& metaData);
+		void PostprocessMesh(ImportMesh& importMesh, const ModelMetaObject& metaData);
+		void OptimizeMesh(ImportMesh& importMesh, const ModelMetaObject& metaData);
+		void BuildMeshlets(ImportMesh& importMesh, const ModelMetaObject& metaData);
+		void GenerateLods(ImportMesh& importMesh, const ModelMetaObject& metaData);
+		void QuantizeMesh(ImportMesh& importMesh, const ModelMetaObject& metaData);
+		void WriteVertex(MemoryStream& stream, const ObjIndex& index)const;
+		bool WriteModel(ResConverterContext& context, const ModelMetaObject& metaData, MemoryStream& stream);
 		bool WriteMaterials(ResConverterContext& context, const char* dirPath);
 	};
 
-	void ModelImporterOBJImpl::PostprocessMeshes()
+	bool ModelImporterOBJImpl::ParseObj(Span<char> memBuffer, MaterialFileReader& matFileReader, const char* src)
 	{
-		// TODO: use jobsystem
-		for (ImportMesh& importMesh : mMeshes)
+		PROFILE_FUNCTION();
+
+		// parse lines in place, faces are triangulated and recorded into the current mesh directly
+		std::map<std::string, int> materialMap;
+		ImportMesh* currentMesh = nullptr;
+		I32 currentMaterial = 0;
+		DynamicArray<ObjIndex> polygon;
+
+		auto BeginMesh = [&](const char* name, const char* nameEnd) {
+			// reuse the current mesh if it has no faces
+			if (currentMesh == nullptr || !currentMesh->mCorners.empty()) {
+				currentMesh = &mMeshes.emplace();
+			}
+			currentMesh->mName = String(name, nameEnd);
+		};
+
+		const char* ptr = memBuffer.data();
+		const char* end = ptr + memBuffer.length();
+		I32 lineNumber = 0;
+		while (ptr < end)
 		{
-			tinyobj::shape_t& shape = *importMesh.mTinyObjShape;
-			MemoryStream& vertexData = importMesh.mVertexData;
+			const char* lineEnd = ptr;
+			while (lineEnd < end && *lineEnd != '\n') {
+				lineEnd++;
+			}
+			const char* line = SkipSpaces(ptr, lineEnd);
+			ptr = lineEnd + 1;
+			lineNumber++;
+
+			while (lineEnd > line && IsSpace(lineEnd[-1])) {
+				lineEnd--;
+			}
+			if (line >= lineEnd || *line == '#') {
+				continue;
+			}
 
-			HashMap<U32, U32> uniqueVertices;
-			Set<I32> registeredMaterialIndices;
+			const char* keyEnd = line;
+			while (keyEnd < lineEnd && !IsSpace(*keyEnd)) {
+				keyEnd++;
+			}
+			const char* args = SkipSpaces(keyEnd, lineEnd);
 
-			for (I32 i = 0; i < shape.mesh.indices.size(); i += 3)
+			if (IsKeyword(line, keyEnd, "v"))
 			{
-				tinyobj::index_t reorderedIndices[] = {
-					shape.mesh.indices[i + 0],
-					shape.mesh.indices[i + 1],
-					shape.mesh.indices[i + 2],
-				};
-
-				for (auto& index : reorderedIndices)
+				// vertex colors are ignored
+				F32 x = 0.0f, y = 0.0f, z = 0.0f;
+				args = ParseFloat(args, lineEnd, x);
+				args = ParseFloat(args, lineEnd, y);
+				args = ParseFloat(args, lineEnd, z);
+				mPositions.push(F32x3(x, y, z));
+			}
+			else if (IsKeyword(line, keyEnd, "vn"))
+			{
+				F32 x = 0.0f, y = 0.0f, z = 0.0f;
+				args = ParseFloat(args, lineEnd, x);
+				args = ParseFloat(args, lineEnd, y);
+				args = ParseFloat(args, lineEnd, z);
+				mNormals.push(F32x3(x, y, z));
+			}
+			else if (IsKeyword(line, keyEnd, "vt"))
+			{
+				F32 u = 0.0f, v = 0.0f;
+				args = ParseFloat(args, lineEnd, u);
+				args = ParseFloat(args, lineEnd, v);
+				mTexcoords.push(F32x2(u, 1.0f - v));
+			}
+			else if (IsKeyword(line, keyEnd, "f"))
+			{
+				polygon.clear();
+				while (args < lineEnd)
 				{
-					int materialIndex = std::max(0, shape.mesh.material_ids[i / 3]);
-					if (!registeredMaterialIndices.find(materialIndex))
+					ObjIndex index;
+					args = ParseObjIndex(args, lineEnd, mPositions.size(), mTexcoords.size(), mNormals.size(), index);
+					if (index.mPosition < 0 || index.mPosition >= mPositions.size() ||
+						index.mTexcoord >= mTexcoords.size() ||
+						index.mNormal >= mNormals.size())
 					{
-						registeredMaterialIndices.insert(materialIndex);
-
-						importMesh.mSubMeshes.push(ModelSubMesh());
-						importMesh.mSubMeshes.back().mIndexOffset = importMesh.mIndices.size();
+						Logger::Warning("[ModelImporterOBJ] Invalid face index at line %d of %s", lineNumber, src);
+						return false;
+					}
+					polygon.push(index);
 
-						// add new meshInstData
-						MeshInstData& meshInst = mMeshInstDatas.emplace();
-						meshInst.mMeshIndex = importMesh.mIndex;
-						meshInst.mSubMeshIndex = importMesh.mSubMeshes.size() - 1;
-						CopyString(meshInst.mMaterial, mMaterials[materialIndex].mPath.c_str());
+					while (args < lineEnd && !IsSpace(*args)) {
+						args++;
 					}
+					args = SkipSpaces(args, lineEnd);
+				}
+
+				if (polygon.size() < 3) {
+					continue;
+				}
+
+				if (currentMesh == nullptr)
+				{
+					const char* defaultName = "default";
+					BeginMesh(defaultName, defaultName + StringLength(defaultName));
+				}
+
+				// triangulate as a fan
+				for (I32 i = 1; i + 1 < polygon.size(); i++)
+				{
+					currentMesh->mCorners.push(polygon[0]);
+					currentMesh->mCorners.push(polygon[i]);
+					currentMesh->mCorners.push(polygon[i + 1]);
+					currentMesh->mTriangleMaterials.push(currentMaterial);
+				}
+			}
+			else if (IsKeyword(line, keyEnd, "o") || IsKeyword(line, keyEnd, "g"))
+			{
+				BeginMesh(args, lineEnd);
+			}
+			else if (IsKeyword(line, keyEnd, "usemtl"))
+			{
+				auto it = materialMap.find(std::string(args, lineEnd));
+				currentMaterial = it != materialMap.end() ? it->second : 0;
+			}
+			else if (IsKeyword(line, keyEnd, "mtllib"))
+			{
+				std::string errors;
+				if (!matFileReader(std::string(args, lineEnd), &objMaterials, &materialMap, &errors)) {
+					Logger::Warning("[ModelImporterOBJ] %s", errors.c_str());
+				}
+			}
+		}
+
+		// only the last mesh could be empty
+		if (currentMesh != nullptr && currentMesh->mCorners.empty()) {
+			mMeshes.pop();
+		}
+
+		return true;
+	}
+
+	void ModelImporterOBJImpl::PostprocessMeshes(const ModelMetaObject& metaData)
+	{
+		PROFILE_FUNCTION();
+
+		// meshes are independent, process them concurrently
+		JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+		JobSystem::RunJobs(mMeshes.size(), 1, [this, &metaData](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+			PostprocessMesh(mMeshes[jobIndex], metaData);
+			return false;
+		}, 0, &jobHandle);
+		JobSystem::Wait(&jobHandle);
 
-					// obj only support vertex/normal/texcoord
-					U32 vertexHash = 0;
-					HashCombine(vertexHash, index.vertex_index);
-					HashCombine(vertexHash, index.normal_index);
-					HashCombine(vertexHash, index.texcoord_index);
-					HashCombine(vertexHash, materialIndex);
+		if (metaData.mPrintMeshStats)
+		{
+			for (const ImportMesh& importMesh : mMeshes)
+			{
+				const I32 vertexSize = importMesh.mVertices > 0 ? importMesh.mVertexData.Size() / importMesh.mVertices : 0;
+				I32 lod0IndexCount = 0;
+				for (const ModelSubMesh& subMesh : importMesh.mSubMeshes) {
+					lod0IndexCount += subMesh.mIndices;
+				}
+				Logger::Info("[ModelImporterOBJ] Mesh:%s vertices:%d triangles:%d ACMR:%.3f->%.3f ATVR:%.3f->%.3f vertex size:%d->%d index size:%d",
+					importMesh.mName.c_str(),
+					importMesh.mVertices,
+					lod0IndexCount / 3,
+					importMesh.mOriginStats.mACMR,
+					importMesh.mOptimizedStats.mACMR,
+					importMesh.mOriginStats.mATVR,
+					importMesh.mOptimizedStats.mATVR,
+					importMesh.mOriginVertexSize,
+					vertexSize,
+					GetModelIndexStride(importMesh.mIndexFormat));
+
+				const I32 subMeshCount = importMesh.mSubMeshes.size();
+				for (I32 lod = 0; lod < importMesh.mLodErrors.size(); lod++)
+				{
+					I32 indexCount = 0;
+					for (I32 i = 0; i < subMeshCount; i++) {
+						indexCount += importMesh.mLodSubMeshes[lod * subMeshCount + i].mIndices;
+					}
+					Logger::Info("[ModelImporterOBJ] Mesh:%s lod:%d triangles:%d error:%.4f",
+						importMesh.mName.c_str(), lod + 1, indexCount / 3, importMesh.mLodErrors[lod]);
+				}
 
-					if (uniqueVertices.find(vertexHash) == nullptr)
+				if (!importMesh.mMeshlets.empty())
+				{
+					I32 meshletVertices = 0;
+					I32 meshletTriangles = 0;
+					for (const ModelMeshlet& meshlet : importMesh.mMeshlets)
 					{
-						uniqueVertices.insert(vertexHash, (U32)importMesh.mVertices++);
-							
-						// position
-						F32x3 pos = F32x3(
-							objAttrib.vertices[index.vertex_index * 3 + 0],
-							objAttrib.vertices[index.vertex_index * 3 + 1],
-							objAttrib.vertices[index.vertex_index * 3 + 2]
-						);
-						vertexData.Write(pos);
-
-						// normal
-						if (!objAttrib.normals.empty())
-						{
-							F32x3 nor = F32x3(
-								objAttrib.normals[index.normal_index * 3 + 0],
-								objAttrib.normals[index.normal_index * 3 + 1],
-								objAttrib.normals[index.normal_index * 3 + 2]
-							);
-							vertexData.Write(nor);
-						}
-						// texcoord
-						if (index.texcoord_index >= 0 && !objAttrib.texcoords.empty())
-						{
-							F32x2 tex = F32x2(
-								objAttrib.texcoords[index.texcoord_index * 2 + 0],
-								1 - objAttrib.texcoords[index.texcoord_index * 2 + 1]
-							);
-							vertexData.Write(tex);
-						}
+						meshletVertices += meshlet.mVertices;
+						meshletTriangles += meshlet.mIndices / 3;
 					}
-					importMesh.mIndices.push(uniqueVertices[vertexHash]);
-					importMesh.mSubMeshes.back().mIndices++;
+					const F32 meshletCount = (F32)importMesh.mMeshlets.size();
+					Logger::Info("[ModelImporterOBJ] Mesh:%s meshlets:%d avg vertices:%.1f avg triangles:%.1f",
+						importMesh.mName.c_str(), importMesh.mMeshlets.size(), meshletVertices / meshletCount, meshletTriangles / meshletCount);
+				}
+			}
+		}
+
+		// add meshInstDatas in order of meshes
+		for (const ImportMesh& importMesh : mMeshes)
+		{
+			for (I32 i = 0; i < importMesh.mSubMeshes.size(); i++)
+			{
+				MeshInstData& meshInst = mMeshInstDatas.emplace();
+				meshInst.mMeshIndex = importMesh.mIndex;
+				meshInst.mSubMeshIndex = i;
+
+				const I32 materialIndex = importMesh.mSubMeshMaterials[i];
+				if (materialIndex < mMaterials.size()) {
+					CopyString(meshInst.mMaterial, mMaterials[materialIndex].mPath.c_str());
 				}
 			}
 		}
 	}
 
-	bool ModelImporterOBJImpl::Import(ResConverterContext& context, Span<char> memBuffer, const char* src)
+	void ModelImporterOBJImpl::PostprocessMesh(ImportMesh& importMesh, const ModelMetaObject& metaData)
 	{
-		// tiny objects
-		std::string objErrors;
+		PROFILE_CPU_BLOCK("PostprocessMesh");
+		const I32 triangleCount = importMesh.mTriangleMaterials.size();
+
+		// group triangles by materials, submeshes are ordered by the first appearance of materials
+		DynamicArray<I32> triangleSubMeshes;
+		triangleSubMeshes.resize(triangleCount);
+		I32 lastMaterial = -1;
+		I32 subMeshIndex = -1;
+		for (I32 i = 0; i < triangleCount; i++)
+		{
+			const I32 materialIndex = importMesh.mTriangleMaterials[i];
+			if (materialIndex != lastMaterial)
+			{
+				lastMaterial = materialIndex;
+				subMeshIndex = importMesh.mSubMeshMaterials.indexOf(materialIndex);
+				if (subMeshIndex < 0)
+				{
+					subMeshIndex = importMesh.mSubMeshMaterials.size();
+					importMesh.mSubMeshMaterials.push(materialIndex);
+					importMesh.mSubMeshes.emplace();
+				}
+			}
+			importMesh.mSubMeshes[subMeshIndex].mIndices += 3;
+			triangleSubMeshes[i] = subMeshIndex;
+		}
+
+		DynamicArray<I32> writeOffsets;
+		I32 indexCount = 0;
+		for (ModelSubMesh& subMesh : importMesh.mSubMeshes)
+		{
+			subMesh.mIndexOffset = indexCount;
+			writeOffsets.push(indexCount);
+			indexCount += subMesh.mIndices;
+		}
+		importMesh.mIndices.resize(indexCount);
 
-		// mem buffer
-		MemStreamBuffer buffer(memBuffer.data(), memBuffer.length());
-		std::istream in(&buffer);
+		// deduplicate vertices
+		I32 vertexSize = 0;
+		for (const auto& element : importMesh.mVertexElements) {
+			vertexSize += GPU::GetFormatInfo(element.mFormat).mBlockBits / 8;
+		}
+		importMesh.mVertexData.Reserve(vertexSize * triangleCount);
+
+		HashMap<ObjIndex, U32, ObjIndexHasher> uniqueVertices;
+		uniqueVertices.reserve(triangleCount);
+		for (I32 i = 0; i < triangleCount; i++)
+		{
+			I32& writeOffset = writeOffsets[triangleSubMeshes[i]];
+			for (I32 corner = 0; corner < 3; corner++)
+			{
+				const ObjIndex& index = importMesh.mCorners[i * 3 + corner];
+				U32 vertexIndex = 0;
+				const U32* it = uniqueVertices.find(index);
+				if (it != nullptr)
+				{
+					vertexIndex = *it;
+				}
+				else
+				{
+					vertexIndex = (U32)importMesh.mVertices++;
+					uniqueVertices.insert(index, vertexIndex);
+					WriteVertex(importMesh.mVertexData, index);
+				}
+				importMesh.mIndices[writeOffset++] = (I32)vertexIndex;
+			}
+		}
+
+		// parsed faces are no longer needed
+		DynamicArray<ObjIndex>().swap(importMesh.mCorners);
+		DynamicArray<I32>().swap(importMesh.mTriangleMaterials);
+
+		OptimizeMesh(importMesh, metaData);
+		BuildMeshlets(importMesh, metaData);
+		GenerateLods(importMesh, metaData);
+		QuantizeMesh(importMesh, metaData);
+	}
+
+	void ModelImporterOBJImpl::OptimizeMesh(ImportMesh& importMesh, const ModelMetaObject& metaData)
+	{
+		PROFILE_CPU_BLOCK("OptimizeMesh");
+		U32* indices = (U32*)importMesh.mIndices.data();
+		const U32 indexCount = importMesh.mIndices.size();
+		const U32 vertexCount = (U32)importMesh.mVertices;
+		const U32 vertexSize = vertexCount > 0 ? importMesh.mVertexData.Size() / vertexCount : 0;
+		importMesh.mOriginStats = MeshOptimizer::AnalyzeVertexCache(indices, indexCount, vertexCount);
+
+		// triangles are reordered in submeshes, vertices are shared by submeshes
+		for (const ModelSubMesh& subMesh : importMesh.mSubMeshes)
+		{
+			U32* subMeshIndices = indices + subMesh.mIndexOffset;
+			if (metaData.mOptimizeVertexCache) {
+				MeshOptimizer::OptimizeVertexCache(subMeshIndices, subMeshIndices, subMesh.mIndices, vertexCount);
+			}
+			if (metaData.mOptimizeOverdraw) 
+			{
+				MeshOptimizer::OptimizeOverdraw(subMeshIndices, subMeshIndices, subMesh.mIndices, 
+					importMesh.mVertexData.data(), vertexCount, vertexSize, metaData.mOverdrawThreshold);
+			}
+		}
+
+		if (metaData.mOptimizeVertexFetch && vertexCount > 0)
+		{
+			MemoryStream vertexData;
+			vertexData.Resize(importMesh.mVertexData.Size());
+			importMesh.mVertices = (I32)MeshOptimizer::OptimizeVertexFetch(
+				vertexData.data(), indices, indexCount, importMesh.mVertexData.data(), vertexCount, vertexSize);
+			vertexData.Resize(importMesh.mVertices * vertexSize);
+			importMesh.mVertexData = std::move(vertexData);
+		}
 
+		importMesh.mOptimizedStats = MeshOptimizer::AnalyzeVertexCache(indices, indexCount, importMesh.mVertices);
+	}
+
+	void ModelImporterOBJImpl::BuildMeshlets(ImportMesh& importMesh, const ModelMetaObject& metaData)
+	{
+		PROFILE_CPU_BLOCK("BuildMeshlets");
+		const U32 vertexCount = (U32)importMesh.mVertices;
+		if (!metaData.mBuildMeshlets || vertexCount == 0) {
+			return;
+		}
+
+		// meshlets are built before quantization, bounds are computed from float positions
+		const U32 vertexSize = importMesh.mVertexData.Size() / vertexCount;
+		const U32* indices = (const U32*)importMesh.mIndices.data();
+		DynamicArray<MeshOptimizer::Meshlet> meshlets;
+		for (ModelSubMesh& subMesh : importMesh.mSubMeshes)
+		{
+			MeshOptimizer::BuildMeshlets(meshlets, indices + subMesh.mIndexOffset, subMesh.mIndices,
+				importMesh.mVertexData.data(), vertexCount, vertexSize, metaData.mMeshletMaxVertices, metaData.mMeshletMaxTriangles);
+
+			subMesh.mStartMeshlets = importMesh.mMeshlets.size();
+			subMesh.mNumMeshlets = meshlets.size();
+			for (const MeshOptimizer::Meshlet& meshlet : meshlets)
+			{
+				ModelMeshlet& modelMeshlet = importMesh.mMeshlets.emplace();
+				modelMeshlet.mIndexOffset = subMesh.mIndexOffset + (I32)meshlet.mIndexOffset;
+				modelMeshlet.mIndices = (I32)meshlet.mIndexCount;
+				modelMeshlet.mVertices = (I32)meshlet.mVertexCount;
+				modelMeshlet.mCenter = meshlet.mCenter;
+				modelMeshlet.mRadius = meshlet.mRadius;
+				modelMeshlet.mConeApex = meshlet.mConeApex;
+				modelMeshlet.mConeAxis = meshlet.mConeAxis;
+				modelMeshlet.mConeCutoff = meshlet.mConeCutoff;
+			}
+		}
+	}
+
+	void ModelImporterOBJImpl::GenerateLods(ImportMesh& importMesh, const ModelMetaObject& metaData)
+	{
+		PROFILE_CPU_BLOCK("GenerateLods");
+		const U32 vertexCount = (U32)importMesh.mVertices;
+		if (metaData.mLodRatios.empty() || vertexCount == 0) {
+			return;
+		}
+
+		// bounding radius of the mesh, position is the first element
+		const U32 vertexSize = importMesh.mVertexData.Size() / vertexCount;
+		const U8* vertexData = importMesh.mVertexData.data();
+		F32x3 minPos(FLT_MAX, FLT_MAX, FLT_MAX);
+		F32x3 maxPos(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (U32 i = 0; i < vertexCount; i++)
+		{
+			F32x3 pos;
+			Memory::Memcpy(&pos, vertexData + i * vertexSize, sizeof(F32x3));
+			for (I32 k = 0; k < 3; k++)
+			{
+				minPos[k] = std::min(minPos[k], pos[k]);
+				maxPos[k] = std::max(maxPos[k], pos[k]);
+			}
+		}
+		const F32 radius = Distance(minPos, maxPos) * 0.5f;
+		if (radius <= 0.0f) {
+			return;
+		}
+
+		// each lod is simplified from lod 0
+		const I32 lod0IndexCount = importMesh.mIndices.size();
+		const I32 maxLods = std::min(metaData.mLodRatios.size(), (U32)MODEL_MAX_LODS - 1);
+		I32 lastIndexCount = lod0IndexCount;
+		DynamicArray<U32> lodIndices;
+		for (I32 lod = 0; lod < maxLods; lod++)
+		{
+			const F32 ratio = metaData.mLodRatios[lod];
+			const F32 maxError = metaData.mLodErrors.empty() ? 1.0f :
+				metaData.mLodErrors[std::min(lod, (I32)metaData.mLodErrors.size() - 1)];
+
+			F32 lodError = 0.0f;
+			I32 lodIndexCount = 0;
+			const I32 lodStart = importMesh.mIndices.size();
+			importMesh.mIndices.resize(lodStart + lod0IndexCount);
+			for (const ModelSubMesh& subMesh : importMesh.mSubMeshes)
+			{
+				const U32* indices = (const U32*)importMesh.mIndices.data() + subMesh.mIndexOffset;
+				const U32 targetCount = (U32)(subMesh.mIndices * ratio) / 3 * 3;
+				U32* dst = (U32*)importMesh.mIndices.data() + lodStart + lodIndexCount;
+
+				F32 error = 0.0f;
+				const U32 indexCount = MeshOptimizer::SimplifyMesh(dst, indices, subMesh.mIndices,
+					vertexData, vertexCount, vertexSize, targetCount, maxError * radius, &error);
+				MeshOptimizer::OptimizeVertexCache(dst, dst, indexCount, vertexCount);
+
+				ModelSubMesh& lodSubMesh = importMesh.mLodSubMeshes.emplace();
+				lodSubMesh.mIndexOffset = lodStart + lodIndexCount;
+				lodSubMesh.mIndices = indexCount;
+				lodIndexCount += indexCount;
+				lodError = std::max(lodError, error / radius);
+			}
+
+			// stop if the lod is not simplified enough
+			if (lodIndexCount <= 0 || lodIndexCount > lastIndexCount * 0.9f)
+			{
+				importMesh.mIndices.resize(lodStart);
+				importMesh.mLodSubMeshes.resize(importMesh.mLodSubMeshes.size() - importMesh.mSubMeshes.size());
+				break;
+			}
+
+			importMesh.mIndices.resize(lodStart + lodIndexCount);
+			importMesh.mLodErrors.push(lodError);
+			lastIndexCount = lodIndexCount;
+		}
+	}
+
+	void ModelImporterOBJImpl::QuantizeMesh(ImportMesh& importMesh, const ModelMetaObject& metaData)
+	{
+		PROFILE_CPU_BLOCK("QuantizeMesh");
+		if (metaData.mCompactIndices && importMesh.mVertices <= 65536) {
+			importMesh.mIndexFormat = GPU::INDEX_FORMAT_16BIT;
+		}
+
+		I32 vertexSize = 0;
+		for (const auto& element : importMesh.mVertexElements) {
+			vertexSize += GPU::GetFormatInfo(element.mFormat).mBlockBits / 8;
+		}
+		importMesh.mOriginVertexSize = vertexSize;
+		if (!metaData.mQuantizePositions && !metaData.mQuantizeNormals && !metaData.mQuantizeUVs) {
+			return;
+		}
+
+		// bounds of positions, position is the first element
+		const U8* vertexData = importMesh.mVertexData.data();
+		F32x3 invScale;
+		if (metaData.mQuantizePositions && importMesh.mVertices > 0)
+		{
+			F32x3 minPos(FLT_MAX, FLT_MAX, FLT_MAX);
+			F32x3 maxPos(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			for (I32 i = 0; i < importMesh.mVertices; i++)
+			{
+				F32x3 pos;
+				Memory::Memcpy(&pos, vertexData + i * vertexSize, sizeof(F32x3));
+				for (I32 k = 0; k < 3; k++)
+				{
+					minPos[k] = std::min(minPos[k], pos[k]);
+					maxPos[k] = std::max(maxPos[k], pos[k]);
+				}
+			}
+
+			for (I32 k = 0; k < 3; k++)
+			{
+				const F32 extent = maxPos[k] - minPos[k];
+				importMesh.mPositionOffset[k] = minPos[k];
+				importMesh.mPositionScale[k] = extent;
+				invScale[k] = extent > 0.0f ? 1.0f / extent : 0.0f;
+			}
+		}
+
+		// quantized vertex elements, layout is same as before
+		DynamicArray<GPU::VertexElement> elements = importMesh.mVertexElements;
+		I32 quantizedSize = 0;
+		for (auto& element : elements)
+		{
+			if (element.mVertexUsage == GPU::VERTEX_USAGE_POSITION && metaData.mQuantizePositions) {
+				element.mFormat = GPU::FORMAT_R16G16B16A16_UNORM;
+			}
+			else if (element.mVertexUsage == GPU::VERTEX_USAGE_NORMAL && metaData.mQuantizeNormals) {
+				element.mFormat = GPU::FORMAT_R16G16_SNORM;
+			}
+			else if (element.mVertexUsage == GPU::VERTEX_USAGE_UV && metaData.mQuantizeUVs) {
+				element.mFormat = GPU::FORMAT_R16G16_FLOAT;
+			}
+			quantizedSize += GPU::GetFormatInfo(element.mFormat).mBlockBits / 8;
+		}
+
+		MemoryStream quantizedData;
+		quantizedData.Reserve(quantizedSize * importMesh.mVertices);
+		for (I32 i = 0; i < importMesh.mVertices; i++)
+		{
+			const U8* vertex = vertexData + i * vertexSize;
+			for (I32 elementIndex = 0; elementIndex < elements.size(); elementIndex++)
+			{
+				const GPU::VertexElement& srcElement = importMesh.mVertexElements[elementIndex];
+				const GPU::VertexElement& dstElement = elements[elementIndex];
+				const U32 srcSize = GPU::GetFormatInfo(srcElement.mFormat).mBlockBits / 8;
+				if (srcElement.mFormat == dstElement.mFormat)
+				{
+					quantizedData.Write(vertex, srcSize);
+				}
+				else if (dstElement.mFormat == GPU::FORMAT_R16G16B16A16_UNORM)
+				{
+					F32x3 pos;
+					Memory::Memcpy(&pos, vertex, sizeof(F32x3));
+					for (I32 k = 0; k < 3; k++) {
+						quantizedData.Write(MeshOptimizer::QuantizeUnorm16((pos[k] - importMesh.mPositionOffset[k]) * invScale[k]));
+					}
+					// w is unused padding
+					quantizedData.Write((U16)0);
+				}
+				else if (dstElement.mFormat == GPU::FORMAT_R16G16_SNORM)
+				{
+					F32x3 normal;
+					Memory::Memcpy(&normal, vertex, sizeof(F32x3));
+					const F32x2 oct = MeshOptimizer::EncodeOctahedral(normal);
+					quantizedData.Write(MeshOptimizer::QuantizeSnorm16(oct[0]));
+					quantizedData.Write(MeshOptimizer::QuantizeSnorm16(oct[1]));
+				}
+				else if (dstElement.mFormat == GPU::FORMAT_R16G16_FLOAT)
+				{
+					F32x2 uv;
+					Memory::Memcpy(&uv, vertex, sizeof(F32x2));
+					quantizedData.Write(MeshOptimizer::QuantizeHalf(uv[0]));
+					quantizedData.Write(MeshOptimizer::QuantizeHalf(uv[1]));
+				}
+				vertex += srcSize;
+			}
+		}
+
+		importMesh.mVertexElements = elements;
+		importMesh.mVertexData = std::move(quantizedData);
+	}
+
+	void ModelImporterOBJImpl::WriteVertex(MemoryStream& stream, const ObjIndex& index) const
+	{
+		// obj only support vertex/normal/texcoord, layout is same as vertex elements
+		stream.Write(mPositions[index.mPosition]);
+		if (!mNormals.empty()) {
+			stream.Write(index.mNormal >= 0 ? mNormals[index.mNormal] : F32x3(0.0f, 0.0f, 0.0f));
+		}
+		if (!mTexcoords.empty()) {
+			stream.Write(index.mTexcoord >= 0 ? mTexcoords[index.mTexcoord] : F32x2(0.0f, 0.0f));
+		}
+	}
+
+	bool ModelImporterOBJImpl::Import(ResConverterContext& context, Span<char> memBuffer, const char* src)
+	{
 		// load obj
 		MaxPathString dirPath;
 		Path::GetPathParentPath(src, dirPath.toSpan());
-		MaterialFileReader matFileReader(dirPath, context.GetFileSystem());
-		bool success = tinyobj::LoadObj(&objAttrib, &objShapes, &objMaterials, &objErrors, &in, &matFileReader, true);
-		if (success == false)
+		MaterialFileReader matFileReader(dirPath, context);
+		if (!ParseObj(memBuffer, matFileReader, src))
+		{
+			Logger::Warning("Failed to import model obj:%s", src);
+			return false;
+		}
+
+		if (mMeshes.empty())
 		{
-			Logger::Warning("Failed to import model obj:%s, %s", src, objErrors.c_str());
+			Logger::Warning("Failed to import model obj:%s, no faces found", src);
 			return false;
 		}
 
@@ -250,16 +895,12 @@ namespace Cjing3D
 		// positoin
 		elements[numElements++] = GPU::VertexElement::VertexData(GPU::VERTEX_USAGE_POSITION, GPU::FORMAT::FORMAT_R32G32B32_FLOAT);
 		// normals
-		if (!objAttrib.normals.empty()) {
-			elements[numElements++] = GPU::VertexElement::VertexData(GPU::VERTEX_USAGE_NORMAL, GPU::FORMAT::FORMAT_R8G8B8A8_SNORM);
+		if (!mNormals.empty()) {
+			elements[numElements++] = GPU::VertexElement::VertexData(GPU::VERTEX_USAGE_NORMAL, GPU::FORMAT::FORMAT_R32G32B32_FLOAT);
 		}
 		// texcoords
-		if (objAttrib.texcoords.empty()) {
-			elements[numElements++] = GPU::VertexElement::VertexData(GPU::VERTEX_USAGE_UV, GPU::FORMAT::FORMAT_R16G16_FLOAT);
-		}
-		// colors
-		if (!objAttrib.colors.empty()) {
-			elements[numElements++] = GPU::VertexElement::VertexData(GPU::VERTEX_USAGE_COLOR, GPU::FORMAT::FORMAT_R8G8B8A8_UNORM);
+		if (!mTexcoords.empty()) {
+			elements[numElements++] = GPU::VertexElement::VertexData(GPU::VERTEX_USAGE_UV, GPU::FORMAT::FORMAT_R32G32_FLOAT);
 		}
 
 		// load materials
@@ -303,22 +944,22 @@ namespace Cjing3D
 		}
 
 		// load meshes
-		for (auto& shape : objShapes)
+		for (I32 i = 0; i < mMeshes.size(); i++)
 		{
-			ImportMesh& mesh = mMeshes.emplace();
-			mesh.mTinyObjShape = &shape;
+			ImportMesh& mesh = mMeshes[i];
+			mesh.mIndex = i;
 			mesh.mVertexElements.insert(elements.data(), elements.data() + numElements);
 		}
 
 		return true;
 	}
 
-	bool ModelImporterOBJImpl::WriteModel(ResConverterContext& context, MemoryStream& stream)
+	bool ModelImporterOBJImpl::WriteModel(ResConverterContext& context, const ModelMetaObject& metaData, MemoryStream& stream)
 	{
 		PROFILE_FUNCTION();
 
 		// 1. postprocess meshes
-		PostprocessMeshes();
+		PostprocessMeshes(metaData);
 
 		// 2. write model datas
 		// header
@@ -335,7 +976,9 @@ namespace Cjing3D
 		// meshes
 		I32 numVertexElements = 0;
 		I32 numSubMeshes = 0;
+		I32 numMeshlets = 0;
 		I32 vertexDataOffset = 0;
+		I32 indexDataOffset = 0;
 		for (const auto& mesh : mMeshes)
 		{
 			ModelMeshData meshData;
@@ -355,12 +998,24 @@ namespace Cjing3D
 			meshData.mNumVertexElements = mesh.mVertexElements.size();
 			meshData.mStartSubMeshes = numSubMeshes;
 			meshData.mNumSubMeshes = mesh.mSubMeshes.size();
+			meshData.mIndexFormat = mesh.mIndexFormat;
+			meshData.mIndexDataOffset = indexDataOffset;
+			meshData.mPositionOffset = mesh.mPositionOffset;
+			meshData.mPositionScale = mesh.mPositionScale;
+			meshData.mNumLods = 1 + mesh.mLodErrors.size();
+			for (I32 lod = 0; lod < mesh.mLodErrors.size(); lod++) {
+				meshData.mLodErrors[lod + 1] = mesh.mLodErrors[lod];
+			}
+			meshData.mStartMeshlets = numMeshlets;
+			meshData.mNumMeshlets = mesh.mMeshlets.size();
 
 			stream.Write(&meshData, sizeof(meshData));
 
 			numVertexElements += mesh.mVertexElements.size();
-			numSubMeshes += mesh.mSubMeshes.size();
+			numSubMeshes += mesh.mSubMeshes.size() + mesh.mLodSubMeshes.size();
+			numMeshlets += mesh.mMeshlets.size();
 			vertexDataOffset += mesh.mVertexData.Size();
+			indexDataOffset += GetModelIndexStride(mesh.mIndexFormat) * mesh.mIndices.size();
 		}
 
 		// write vertex elements
@@ -376,19 +1031,41 @@ namespace Cjing3D
 			for (const auto& subMesh : mesh.mSubMeshes) {
 				stream.Write(&subMesh, sizeof(subMesh));
 			}
+			for (const auto& subMesh : mesh.mLodSubMeshes) {
+				stream.Write(&subMesh, sizeof(subMesh));
+			}
+		}
+
+		// write meshlets
+		for (const auto& mesh : mMeshes)
+		{
+			if (!mesh.mMeshlets.empty()) {
+				stream.Write(mesh.mMeshlets.data(), sizeof(ModelMeshlet) * mesh.mMeshlets.size());
+			}
 		}
 
 		// write vertices + indices
 		for (const auto& mesh : mMeshes) {
 			stream.Write(mesh.mVertexData.data(), mesh.mVertexData.Size());
 		}
-		for (const auto& mesh : mMeshes) {
-			stream.Write(mesh.mIndices.data(), sizeof(I32) * mesh.mIndices.size());
+		for (const auto& mesh : mMeshes) 
+		{
+			if (mesh.mIndexFormat == GPU::INDEX_FORMAT_16BIT)
+			{
+				for (I32 index : mesh.mIndices) {
+					stream.Write((U16)index);
+				}
+			}
+			else
+			{
+				stream.Write(mesh.mIndices.data(), sizeof(I32) * mesh.mIndices.size());
+			}
 		}
 
-		// 3. clear tiny objs
-		objShapes.clear();
-		objMaterials.clear();
+		// 3. clear parsed objs
+		mPositions.clear();
+		mNormals.clear();
+		mTexcoords.clear();
 
 		return true;
 	}
@@ -466,9 +1143,9 @@ namespace Cjing3D
 		return mImpl->Import(context, memBuffer, src);
 	}
 
-	bool ModelImporterOBJ::WriteModel(ResConverterContext& context, MemoryStream& stream)
+	bool ModelImporterOBJ::WriteModel(ResConverterContext& context, const ModelMetaObject& metaData, MemoryStream& stream)
 	{
-		return mImpl->WriteModel(context, stream);
+		return mImpl->WriteModel(context, metaData, stream);
 	}
 
 	bool ModelImporterOBJ::WriteMaterials(ResConverterContext& context, const char* dirPath)
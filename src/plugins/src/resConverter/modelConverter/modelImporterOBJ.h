@@ -11,7 +11,7 @@ namespace Cjing3D
 		virtual ~ModelImporterOBJ();
 
 		bool Import(ResConverterContext& context, Span<char> memBuffer, const char* src)override;
-		bool WriteModel(ResConverterContext& context, MemoryStream& stream)override;
+		bool WriteModel(ResConverterContext& context, const ModelMetaObject& metaData, MemoryStream& stream)override;
 		bool WriteMaterials(ResConverterContext& context, const char* dirPath)override;
 		bool SupportsFileExt(const char* ext)override;
 
@@ -56,6 +56,15 @@ namespace Cjing3D
 		return (*it)->Convert(context, type, src, dest);
 	}
 
+	U32 ResConverter::GetVersion(const ResourceType& type)
+	{
+		auto it = mResConverters.find(type.Type());
+		if (!it) {
+			return 0;
+		}
+		return (*it)->GetVersion(type);
+	}
+
 	LUMIX_PLUGIN_ENTRY(resConverter)
 	{
 		ResConverterPlugin* plugin = CJING_NEW(ResConverterPlugin);
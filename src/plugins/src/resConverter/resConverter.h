@@ -16,6 +16,7 @@ namespace Cjing3D
 		void AddConverter(const ResourceType& type, IResConverter* converter);
 		bool SupportsType(const char* ext, const ResourceType& type)override;
 		bool Convert(ResConverterContext& context, const ResourceType& type, const char* src, const char* dest) override;
+		U32 GetVersion(const ResourceType& type)override;
 	
 	private:
 		HashMap<U32, IResConverter*> mResConverters;
@@ -15,8 +15,11 @@ namespace Cjing3D
 	class ShaderResConverter : public IResConverter
 	{
 	public:
+		static const U32 VERSION = 1;
+
 		void OnEditorGUI(ResConverterContext& context, const ResourceType& type, Resource* res)override;
 		bool SupportsType(const char* ext, const ResourceType& type)override;
 		bool Convert(ResConverterContext& context, const ResourceType& type, const char* src, const char* dest) override;
+		U32 GetVersion(const ResourceType& type)override { return VERSION; }
 	};
 }
\ No newline at end of file
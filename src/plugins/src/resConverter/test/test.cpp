@@ -0,0 +1,735 @@
+//#define CJING_TEST_RES_CONVERTER
+#ifdef CJING_TEST_RES_CONVERTER
+
+#include "resConverter\modelConverter\modelImporterOBJ.h"
+#include "resConverter\modelConverter\modelConverter.h"
+#include "resConverter\modelConverter\meshOptimizer.h"
+#include "resConverter\textureConverter\textureCompressor.h"
+#include "resConverter\textureConverter\mipGenerator.h"
+#include "renderer\modelImpl.h"
+#include "renderer\clusterCulling.h"
+#include "renderer\renderScene.h"
+#include "gpu\null\deviceNull.h"
+#include "core\filesystem\filesystem_generic.h"
+#include "core\concurrency\jobsystem.h"
+#include "core\helper\timer.h"
+#include "math\viewport.h"
+
+#define CATCH_CONFIG_RUNNER
+#include "catch\catch.hpp"
+
+using namespace Cjing3D;
+
+static StdoutLoggerSink mTestStdoutLoggerSink;
+
+namespace
+{
+	void AppendLine(DynamicArray<char>& data, const char* line, I32 length)
+	{
+		data.insert(line, line + length);
+	}
+
+	// grid of quads, positions and texcoords are shared by adjacent quads,
+	// the grid is flat if waveHeight is 0
+	void GenerateGridObj(I32 gridSize, DynamicArray<char>& data, F32 waveHeight = 0.0f)
+	{
+		char line[128];
+		const I32 vertexCount = gridSize + 1;
+		for (I32 y = 0; y < vertexCount; y++)
+		{
+			for (I32 x = 0; x < vertexCount; x++)
+			{
+				const F32 z = waveHeight * std::sin(x * 0.7f) * std::cos(y * 0.9f);
+				AppendLine(data, line, sprintf_s(line, "v %d.5 %d.25 %.4f\n", x, y, z));
+			}
+		}
+		for (I32 y = 0; y < vertexCount; y++)
+		{
+			for (I32 x = 0; x < vertexCount; x++) {
+				AppendLine(data, line, sprintf_s(line, "vt %.4f %.4f\n", (F32)x / gridSize, (F32)y / gridSize));
+			}
+		}
+		AppendLine(data, line, sprintf_s(line, "vn 0 0 1\n"));
+		AppendLine(data, line, sprintf_s(line, "o grid\n"));
+		for (I32 y = 0; y < gridSize; y++)
+		{
+			for (I32 x = 0; x < gridSize; x++)
+			{
+				const I32 i0 = y * vertexCount + x + 1;
+				const I32 i1 = i0 + 1;
+				const I32 i2 = i1 + vertexCount;
+				const I32 i3 = i0 + vertexCount;
+				AppendLine(data, line, sprintf_s(line, "f %d/%d/1 %d/%d/1 %d/%d/1 %d/%d/1\n", i0, i0, i1, i1, i2, i2, i3, i3));
+			}
+		}
+	}
+
+	bool ReadModelMeshData(const MemoryStream& stream, ModelGeneralHeader& header, ModelMeshData& meshData)
+	{
+		InputMemoryStream input(stream);
+		if (!input.Read(&header, sizeof(header))) {
+			return false;
+		}
+		input.AddOffset(header.mNumMeshInstDatas * sizeof(MeshInstData));
+		return input.Read(&meshData, sizeof(meshData));
+	}
+
+	// submeshes of all lods of a single mesh model
+	bool ReadModelSubMeshes(const MemoryStream& stream, DynamicArray<ModelSubMesh>& subMeshes)
+	{
+		ModelGeneralHeader header;
+		ModelMeshData meshData;
+		if (!ReadModelMeshData(stream, header, meshData) || header.mNumMeshes != 1) {
+			return false;
+		}
+
+		InputMemoryStream input(stream);
+		input.AddOffset(sizeof(header) + header.mNumMeshInstDatas * sizeof(MeshInstData) + sizeof(meshData));
+		input.AddOffset(meshData.mNumVertexElements * sizeof(GPU::VertexElement));
+		subMeshes.resize(meshData.mNumSubMeshes * meshData.mNumLods);
+		return input.Read(subMeshes.data(), subMeshes.size() * sizeof(ModelSubMesh));
+	}
+
+	// meshlets of a single mesh model
+	bool ReadModelMeshlets(const MemoryStream& stream, DynamicArray<ModelMeshlet>& meshlets)
+	{
+		ModelGeneralHeader header;
+		ModelMeshData meshData;
+		if (!ReadModelMeshData(stream, header, meshData) || header.mNumMeshes != 1) {
+			return false;
+		}
+
+		InputMemoryStream input(stream);
+		input.AddOffset(sizeof(header) + header.mNumMeshInstDatas * sizeof(MeshInstData) + sizeof(meshData));
+		input.AddOffset(meshData.mNumVertexElements * sizeof(GPU::VertexElement));
+		input.AddOffset(meshData.mNumSubMeshes * meshData.mNumLods * sizeof(ModelSubMesh));
+		meshlets.resize(meshData.mNumMeshlets);
+		return input.Read(meshlets.data(), meshlets.size() * sizeof(ModelMeshlet));
+	}
+
+	// indices of the first mesh of a single mesh model
+	bool ReadModelIndices(const MemoryStream& stream, DynamicArray<U32>& indices)
+	{
+		ModelGeneralHeader header;
+		ModelMeshData meshData;
+		if (!ReadModelMeshData(stream, header, meshData) || header.mNumMeshes != 1) {
+			return false;
+		}
+
+		InputMemoryStream input(stream);
+		input.AddOffset(sizeof(header) + header.mNumMeshInstDatas * sizeof(MeshInstData) + sizeof(meshData));
+		input.AddOffset(meshData.mNumVertexElements * sizeof(GPU::VertexElement));
+		input.AddOffset(meshData.mNumSubMeshes * meshData.mNumLods * sizeof(ModelSubMesh));
+		input.AddOffset(meshData.mNumMeshlets * sizeof(ModelMeshlet));
+		input.AddOffset(meshData.mVertices * meshData.mVertexElementSize);
+		indices.resize(meshData.mIndices);
+		if (meshData.mIndexFormat == GPU::INDEX_FORMAT_32BIT) {
+			return input.Read(indices.data(), sizeof(U32) * meshData.mIndices);
+		}
+
+		for (U32& index : indices)
+		{
+			U16 index16 = 0;
+			if (!input.Read(&index16, sizeof(index16))) {
+				return false;
+			}
+			index = index16;
+		}
+		return true;
+	}
+
+	// load the converted model by the model factory, and create the mesh component of the first mesh
+	bool LoadMeshComponent(const MemoryStream& stream, MeshComponent& mesh)
+	{
+		Model::RegisterFactory();
+		ModelFactory* factory = Model::GetFactory();
+		Model* model = static_cast<Model*>(factory->CreateResource());
+		const bool ret = factory->LoadResource(model, "grid.obj", stream.Size(), stream.data()) && mesh.LoadFromModel(*model, 0);
+		factory->DestroyResource(model);
+		Model::UnregisterFactory();
+		return ret;
+	}
+}
+
+TEST_CASE("ModelImporterOBJ vertex dedup", "[ModelImporter]")
+{
+	// positions are shared by the quads, the texcoord of the last corner is different
+	const char* objText =
+		"v 0 0 0\n"
+		"v 1 0 0\n"
+		"v 1 1 0\n"
+		"v 0 1 0\n"
+		"v 2 0 0\n"
+		"v 2 1 0\n"
+		"vt 0 0\n"
+		"vt 1 1\n"
+		"o quads\n"
+		"f 1/1 2/1 3/1 4/1\n"
+		"f -5/1 -2/1 -1/1 -4/2\n";
+
+	FileSystemGeneric fileSystem(".");
+	ResConverterContext context(fileSystem);
+	ModelImporterOBJ importer;
+	DynamicArray<char> objData;
+	objData.insert(objText, objText + StringLength(objText));
+	REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "quads.obj"));
+
+	MemoryStream stream;
+	REQUIRE(importer.WriteModel(context, ModelMetaObject(), stream));
+
+	ModelGeneralHeader header;
+	ModelMeshData meshData;
+	REQUIRE(ReadModelMeshData(stream, header, meshData));
+	REQUIRE(header.mNumMeshes == 1);
+	REQUIRE(meshData.mVertices == 7);
+	REQUIRE(meshData.mIndices == 12);
+}
+
+TEST_CASE("ModelImporterOBJ quantization", "[ModelImporter]")
+{
+	const char* objText =
+		"v -1 0 2\n"
+		"v 3 0 2\n"
+		"v 3 0.5 -2\n"
+		"vn 0 1 0\n"
+		"vn 0.6 0 -0.8\n"
+		"vt 0.25 0.5\n"
+		"f 1/1/1 2/1/2 3/1/2\n";
+
+	FileSystemGeneric fileSystem(".");
+	ResConverterContext context(fileSystem);
+	DynamicArray<char> objData;
+	objData.insert(objText, objText + StringLength(objText));
+
+	// vertices are not quantized by default, float3 position + float3 normal + float2 uv
+	ModelGeneralHeader header;
+	ModelMeshData meshData;
+	{
+		ModelImporterOBJ importer;
+		REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "triangle.obj"));
+
+		MemoryStream stream;
+		REQUIRE(importer.WriteModel(context, ModelMetaObject(), stream));
+		REQUIRE(ReadModelMeshData(stream, header, meshData));
+		REQUIRE(meshData.mVertexElementSize == 32);
+		REQUIRE(meshData.mPositionScale[0] == 1.0f);
+	}
+
+	ModelImporterOBJ importer;
+	REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "triangle.obj"));
+
+	ModelMetaObject metaData;
+	metaData.mQuantizePositions = true;
+	metaData.mQuantizeNormals = true;
+	metaData.mQuantizeUVs = true;
+	MemoryStream stream;
+	REQUIRE(importer.WriteModel(context, metaData, stream));
+	REQUIRE(ReadModelMeshData(stream, header, meshData));
+	REQUIRE(header.mMinor == ModelGeneralHeader::MINOR);
+	REQUIRE(meshData.mIndexFormat == GPU::INDEX_FORMAT_16BIT);
+	// unorm16x4 position + snorm16x2 normal + halfx2 uv
+	REQUIRE(meshData.mVertexElementSize == 16);
+	REQUIRE(meshData.mPositionOffset[0] == -1.0f);
+	REQUIRE(meshData.mPositionScale[0] == 4.0f);
+	REQUIRE(meshData.mPositionScale[2] == 4.0f);
+
+	// octahedral normals
+	const F32x3 normal = Normalize(F32x3(0.3f, -0.5f, -0.8f));
+	const F32x3 decoded = MeshOptimizer::DecodeOctahedral(MeshOptimizer::EncodeOctahedral(normal));
+	for (I32 k = 0; k < 3; k++) {
+		REQUIRE(std::abs(decoded[k] - normal[k]) < 1e-4f);
+	}
+}
+
+TEST_CASE("ModelImporterOBJ mesh optimization", "[ModelImporter]")
+{
+	const I32 gridSize = 64;
+	DynamicArray<char> objData;
+	GenerateGridObj(gridSize, objData);
+
+	FileSystemGeneric fileSystem(".");
+	auto ConvertGrid = [&](const ModelMetaObject& metaData, DynamicArray<U32>& indices) {
+		ResConverterContext context(fileSystem);
+		ModelImporterOBJ importer;
+		MemoryStream stream;
+		REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "grid.obj"));
+		REQUIRE(importer.WriteModel(context, metaData, stream));
+		REQUIRE(ReadModelIndices(stream, indices));
+	};
+
+	ModelMetaObject originMeta;
+	originMeta.mOptimizeVertexCache = false;
+	originMeta.mOptimizeOverdraw = false;
+	originMeta.mOptimizeVertexFetch = false;
+	originMeta.mLodRatios.clear();
+	DynamicArray<U32> originIndices;
+	ConvertGrid(originMeta, originIndices);
+
+	ModelMetaObject optimizedMeta;
+	optimizedMeta.mLodRatios.clear();
+	DynamicArray<U32> optimizedIndices;
+	ConvertGrid(optimizedMeta, optimizedIndices);
+	REQUIRE(optimizedIndices.size() == originIndices.size());
+
+	// vertices are fetched in order of first use
+	U32 maxVertex = 0;
+	for (U32 index : optimizedIndices)
+	{
+		REQUIRE(index <= maxVertex + 1);
+		maxVertex = std::max(maxVertex, index);
+	}
+
+	const U32 vertexCount = (gridSize + 1) * (gridSize + 1);
+	auto originStats = MeshOptimizer::AnalyzeVertexCache(originIndices.data(), originIndices.size(), vertexCount);
+	auto optimizedStats = MeshOptimizer::AnalyzeVertexCache(optimizedIndices.data(), optimizedIndices.size(), vertexCount);
+	Logger::Print("[ModelImporterOBJ] grid ACMR:%.3f->%.3f ATVR:%.3f->%.3f",
+		originStats.mACMR, optimizedStats.mACMR, originStats.mATVR, optimizedStats.mATVR);
+	REQUIRE(optimizedStats.mACMR < originStats.mACMR);
+}
+
+TEST_CASE("ModelImporterOBJ lods", "[ModelImporter]")
+{
+	// interior vertices of a flat grid could be collapsed without errors
+	const I32 gridSize = 32;
+	DynamicArray<char> objData;
+	GenerateGridObj(gridSize, objData);
+
+	FileSystemGeneric fileSystem(".");
+	ResConverterContext context(fileSystem);
+	ModelImporterOBJ importer;
+	REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "grid.obj"));
+
+	ModelMetaObject metaData;
+	metaData.mLodRatios = { 0.5f, 0.25f };
+	MemoryStream stream;
+	REQUIRE(importer.WriteModel(context, metaData, stream));
+
+	ModelGeneralHeader header;
+	ModelMeshData meshData;
+	REQUIRE(ReadModelMeshData(stream, header, meshData));
+	REQUIRE(meshData.mNumLods == 3);
+
+	DynamicArray<ModelSubMesh> subMeshes;
+	REQUIRE(ReadModelSubMeshes(stream, subMeshes));
+	REQUIRE(subMeshes.size() == 3);
+	REQUIRE(subMeshes[0].mIndices == gridSize * gridSize * 6);
+	for (I32 lod = 1; lod < meshData.mNumLods; lod++)
+	{
+		REQUIRE(subMeshes[lod].mIndices > 0);
+		REQUIRE(subMeshes[lod].mIndices <= subMeshes[0].mIndices * metaData.mLodRatios[lod - 1]);
+		REQUIRE(subMeshes[lod].mIndexOffset >= subMeshes[lod - 1].mIndexOffset + subMeshes[lod - 1].mIndices);
+		REQUIRE(meshData.mLodErrors[lod] < 1e-4f);
+	}
+	REQUIRE(subMeshes[2].mIndexOffset + subMeshes[2].mIndices == meshData.mIndices);
+}
+
+TEST_CASE("MeshComponent lods of converted model", "[ModelImporter]")
+{
+	// lods of a wavy grid have errors, coarser lods are selected in the distance
+	const I32 gridSize = 32;
+	DynamicArray<char> objData;
+	GenerateGridObj(gridSize, objData, 1.0f);
+
+	FileSystemGeneric fileSystem(".");
+	ResConverterContext context(fileSystem);
+	ModelImporterOBJ importer;
+	REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "grid.obj"));
+
+	ModelMetaObject metaData;
+	metaData.mLodRatios = { 0.5f, 0.25f };
+	MemoryStream stream;
+	REQUIRE(importer.WriteModel(context, metaData, stream));
+
+	GPU::ScopedHeadlessDevice device;
+	MeshComponent mesh;
+	REQUIRE(LoadMeshComponent(stream, mesh));
+	REQUIRE(mesh.mVertexPositions.size() == (gridSize + 1) * (gridSize + 1));
+	REQUIRE(mesh.mSubsets.size() == 1);
+	REQUIRE(mesh.mSubsets[0].mIndexCount == gridSize * gridSize * 6);
+	REQUIRE(mesh.mLods.size() == 2);
+	for (I32 lod = 1; lod <= mesh.mLods.size(); lod++)
+	{
+		const auto& subsets = mesh.GetSubsets(lod);
+		REQUIRE(subsets.size() == 1);
+		REQUIRE(subsets[0].mIndexCount < mesh.GetSubsets(lod - 1)[0].mIndexCount);
+		REQUIRE(subsets[0].mIndexOffset + subsets[0].mIndexCount <= (U32)mesh.mIndices.size());
+		REQUIRE(mesh.mLods[lod - 1].mError > 0.0f);
+	}
+	REQUIRE(mesh.mLods[1].mError >= mesh.mLods[0].mError);
+
+	AABB aabb;
+	for (const F32x3& pos : mesh.mVertexPositions) {
+		aabb = AABB::Union(aabb, pos);
+	}
+
+	Viewport viewport;
+	viewport.CreatePerspective(1280.0f, 720.0f, 0.1f, 800.0f);
+	viewport.mAt = F32x3(0.0f, 0.0f, 1.0f);
+	viewport.mEye = F32x3(gridSize * 0.5f, gridSize * 0.5f, -gridSize * 1.0f);
+	viewport.Update();
+	REQUIRE(RenderScene::SelectLod(mesh, aabb, viewport, 1.0f) == 0);
+
+	viewport.mEye = F32x3(gridSize * 0.5f, gridSize * 0.5f, -gridSize * 1000.0f);
+	viewport.Update();
+	REQUIRE(RenderScene::SelectLod(mesh, aabb, viewport, 1.0f) == mesh.mLods.size());
+}
+
+TEST_CASE("ModelImporterOBJ meshlets", "[ModelImporter]")
+{
+	const I32 gridSize = 32;
+	DynamicArray<char> objData;
+	GenerateGridObj(gridSize, objData);
+
+	FileSystemGeneric fileSystem(".");
+	ResConverterContext context(fileSystem);
+	ModelImporterOBJ importer;
+	REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "grid.obj"));
+
+	ModelMetaObject metaData;
+	metaData.mLodRatios.clear();
+	MemoryStream stream;
+	REQUIRE(importer.WriteModel(context, metaData, stream));
+
+	DynamicArray<ModelSubMesh> subMeshes;
+	DynamicArray<ModelMeshlet> meshlets;
+	REQUIRE(ReadModelSubMeshes(stream, subMeshes));
+	REQUIRE(ReadModelMeshlets(stream, meshlets));
+	REQUIRE(subMeshes.size() == 1);
+	REQUIRE(subMeshes[0].mStartMeshlets == 0);
+	REQUIRE(subMeshes[0].mNumMeshlets == meshlets.size());
+
+	// meshlets are contiguous ranges of the submesh
+	I32 indexOffset = subMeshes[0].mIndexOffset;
+	for (const ModelMeshlet& meshlet : meshlets)
+	{
+		REQUIRE(meshlet.mIndexOffset == indexOffset);
+		REQUIRE(meshlet.mVertices <= (I32)metaData.mMeshletMaxVertices);
+		REQUIRE(meshlet.mIndices <= (I32)metaData.mMeshletMaxTriangles * 3);
+		REQUIRE(meshlet.mConeCutoff < 0.01f);
+		indexOffset += meshlet.mIndices;
+	}
+	REQUIRE(indexOffset == subMeshes[0].mIndexOffset + subMeshes[0].mIndices);
+
+	// front faces of the grid are visible from -z
+	Viewport viewport;
+	viewport.CreatePerspective(1280.0f, 720.0f, 0.1f, 800.0f);
+	viewport.mEye = F32x3(gridSize * 0.5f, gridSize * 0.5f, -gridSize * 2.0f);
+	viewport.mAt = F32x3(0.0f, 0.0f, 1.0f);
+	viewport.Update();
+
+	DynamicArray<ClusterCulling::ClusterDraw> draws;
+	ClusterCulling::CullingStats stats;
+	ClusterCulling::CullMeshlets(meshlets.data(), meshlets.size(), IDENTITY_MATRIX, viewport.mFrustum, viewport.mEye, draws, &stats);
+	REQUIRE(stats.mVisible == meshlets.size());
+	REQUIRE(draws.size() == 1);
+	REQUIRE(draws[0].mIndexCount == subMeshes[0].mIndices);
+
+	// looking away
+	viewport.mAt = F32x3(0.0f, 0.0f, -1.0f);
+	viewport.Update();
+	ClusterCulling::CullMeshlets(meshlets.data(), meshlets.size(), IDENTITY_MATRIX, viewport.mFrustum, viewport.mEye, draws, &stats);
+	REQUIRE(stats.mFrustumCulled == meshlets.size());
+	REQUIRE(draws.empty());
+
+	// back faces
+	viewport.mEye = F32x3(gridSize * 0.5f, gridSize * 0.5f, gridSize * 2.0f);
+	viewport.Update();
+	ClusterCulling::CullMeshlets(meshlets.data(), meshlets.size(), IDENTITY_MATRIX, viewport.mFrustum, viewport.mEye, draws, &stats);
+	REQUIRE(stats.mBackfaceCulled == meshlets.size());
+	REQUIRE(draws.empty());
+}
+
+TEST_CASE("MeshComponent meshlets of converted model", "[ModelImporter]")
+{
+	const I32 gridSize = 32;
+	DynamicArray<char> objData;
+	GenerateGridObj(gridSize, objData);
+
+	FileSystemGeneric fileSystem(".");
+	ResConverterContext context(fileSystem);
+	ModelImporterOBJ importer;
+	REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "grid.obj"));
+
+	ModelMetaObject metaData;
+	metaData.mLodRatios.clear();
+	MemoryStream stream;
+	REQUIRE(importer.WriteModel(context, metaData, stream));
+
+	GPU::ScopedHeadlessDevice device;
+	MeshComponent mesh;
+	REQUIRE(LoadMeshComponent(stream, mesh));
+	REQUIRE(mesh.mSubsets.size() == 1);
+	REQUIRE(mesh.mMeshlets.size() > 1);
+
+	const MeshComponent::MeshSubset& subset = mesh.mSubsets[0];
+	REQUIRE(subset.mMeshletCount == (U32)mesh.mMeshlets.size());
+	REQUIRE(subset.mMeshletOffset + subset.mMeshletCount <= (U32)mesh.mMeshlets.size());
+
+	// front faces of the grid are visible from -z, and all meshlets are culled from +z
+	Viewport viewport;
+	viewport.CreatePerspective(1280.0f, 720.0f, 0.1f, 800.0f);
+	viewport.mEye = F32x3(gridSize * 0.5f, gridSize * 0.5f, -gridSize * 2.0f);
+	viewport.mAt = F32x3(0.0f, 0.0f, 1.0f);
+	viewport.Update();
+
+	DynamicArray<ClusterCulling::ClusterDraw> draws;
+	ClusterCulling::CullingStats stats;
+	const ModelMeshlet* meshlets = mesh.mMeshlets.data() + subset.mMeshletOffset;
+	ClusterCulling::CullMeshlets(meshlets, subset.mMeshletCount, IDENTITY_MATRIX, viewport.mFrustum, viewport.mEye, draws, &stats);
+	REQUIRE(stats.mVisible == subset.mMeshletCount);
+	REQUIRE(draws.size() == 1);
+	REQUIRE(draws[0].mIndexCount == subset.mIndexCount);
+
+	viewport.mEye = F32x3(gridSize * 0.5f, gridSize * 0.5f, gridSize * 2.0f);
+	viewport.mAt = F32x3(0.0f, 0.0f, -1.0f);
+	viewport.Update();
+	ClusterCulling::CullMeshlets(meshlets, subset.mMeshletCount, IDENTITY_MATRIX, viewport.mFrustum, viewport.mEye, draws, &stats);
+	REQUIRE(stats.mBackfaceCulled == subset.mMeshletCount);
+	REQUIRE(draws.empty());
+}
+
+TEST_CASE("ModelImporterOBJ 10M triangles", "[.][ModelImporter]")
+{
+	// 2 * 2237 * 2237 = 10,008,338 triangles
+	const I32 gridSize = 2237;
+	DynamicArray<char> objData;
+	GenerateGridObj(gridSize, objData);
+
+	FileSystemGeneric fileSystem(".");
+	ResConverterContext context(fileSystem);
+	ModelImporterOBJ importer;
+
+	F64 time = Timer::GetAbsoluteTime();
+	REQUIRE(importer.Import(context, Span(objData.data(), objData.size()), "grid.obj"));
+	const F64 importTime = Timer::GetAbsoluteTime() - time;
+
+	time = Timer::GetAbsoluteTime();
+	ModelMetaObject metaData;
+	metaData.mLodRatios.clear();
+	MemoryStream stream;
+	REQUIRE(importer.WriteModel(context, metaData, stream));
+	const F64 writeTime = Timer::GetAbsoluteTime() - time;
+
+	ModelGeneralHeader header;
+	ModelMeshData meshData;
+	REQUIRE(ReadModelMeshData(stream, header, meshData));
+	REQUIRE(meshData.mVertices == (gridSize + 1) * (gridSize + 1));
+	REQUIRE(meshData.mIndices == gridSize * gridSize * 6);
+
+	const F64 triangles = meshData.mIndices / 3.0;
+	Logger::Print("[ModelImporterOBJ] %.0f triangles, obj %.2f MB", triangles, objData.size() / (1024.0 * 1024.0));
+	Logger::Print("[ModelImporterOBJ] parse:%.2fs postprocess and write:%.2fs, %.2f MTris/s",
+		importTime, writeTime, triangles / (importTime + writeTime) / 1000000.0);
+}
+
+namespace
+{
+	// smooth gradients with noise in the blue channel
+	void GenerateTestImage(U32 width, U32 height, DynamicArray<U8>& pixels)
+	{
+		pixels.resize(width * height * 4);
+		U32 seed = 0x12345678;
+		for (U32 y = 0; y < height; y++)
+		{
+			for (U32 x = 0; x < width; x++)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				U8* pixel = &pixels[(y * width + x) * 4];
+				pixel[0] = (U8)(x * 255 / width);
+				pixel[1] = (U8)(y * 255 / height);
+				pixel[2] = (U8)(128 + ((seed >> 24) & 31));
+				pixel[3] = (U8)((x + y) * 255 / (width + height));
+			}
+		}
+	}
+}
+
+TEST_CASE("TextureCompressor BC1", "[TextureCompressor]")
+{
+	const U32 width = 128;
+	const U32 height = 64;
+	DynamicArray<U8> pixels;
+	GenerateTestImage(width, height, pixels);
+
+	F64 lastPSNR = 0.0;
+	for (auto quality : { TextureCompressor::Quality::FAST, TextureCompressor::Quality::NORMAL, TextureCompressor::Quality::HIGH })
+	{
+		MemoryStream stream;
+		REQUIRE(TextureCompressor::CompressBC1(pixels.data(), pixels.size(), stream, width, height, quality));
+		REQUIRE(stream.Size() == width * height / 2);
+
+		const F64 psnr = TextureCompressor::ComputePSNR(GPU::FORMAT_BC1_UNORM, stream.data(), pixels.data(), width, height);
+		Logger::Print("[TextureCompressor] BC1 quality:%d PSNR:%.2f", (I32)quality, psnr);
+		REQUIRE(psnr > 35.0);
+		REQUIRE(psnr >= lastPSNR - 0.1);
+		lastPSNR = psnr;
+	}
+
+	// blocks out of small mips are clamped to edges
+	MemoryStream stream;
+	REQUIRE(TextureCompressor::CompressBC3(pixels.data(), 6 * 2 * 4, stream, 6, 2));
+	REQUIRE(stream.Size() == 2 * 16);
+}
+
+TEST_CASE("TextureCompressor BC7 BC6H", "[TextureCompressor]")
+{
+	const U32 width = 64;
+	const U32 height = 64;
+	DynamicArray<U8> pixels;
+	GenerateTestImage(width, height, pixels);
+
+	MemoryStream bc3Stream;
+	REQUIRE(TextureCompressor::CompressBC3(pixels.data(), pixels.size(), bc3Stream, width, height));
+	const F64 bc3PSNR = TextureCompressor::ComputePSNR(GPU::FORMAT_BC3_UNORM, bc3Stream.data(), pixels.data(), width, height);
+
+	F64 lastPSNR = 0.0;
+	for (auto quality : { TextureCompressor::Quality::FAST, TextureCompressor::Quality::NORMAL, TextureCompressor::Quality::HIGH })
+	{
+		MemoryStream stream;
+		REQUIRE(TextureCompressor::CompressBC7(pixels.data(), pixels.size(), stream, width, height, quality));
+		REQUIRE(stream.Size() == width * height);
+
+		const F64 psnr = TextureCompressor::ComputePSNR(GPU::FORMAT_BC7_UNORM, stream.data(), pixels.data(), width, height);
+		Logger::Print("[TextureCompressor] BC7 quality:%d PSNR:%.2f, BC3 PSNR:%.2f", (I32)quality, psnr, bc3PSNR);
+		REQUIRE(psnr > 35.0);
+		REQUIRE(psnr >= lastPSNR - 0.1);
+		lastPSNR = psnr;
+	}
+	REQUIRE(lastPSNR > bc3PSNR);
+
+	// hdr gradients over 12 stops
+	DynamicArray<F32> hdrPixels;
+	hdrPixels.resize(width * height * 4);
+	for (U32 y = 0; y < height; y++)
+	{
+		for (U32 x = 0; x < width; x++)
+		{
+			F32* pixel = &hdrPixels[(y * width + x) * 4];
+			pixel[0] = std::pow(2.0f, x * 12.0f / width - 4.0f);
+			pixel[1] = (F32)y / height;
+			pixel[2] = 0.25f;
+			pixel[3] = 1.0f;
+		}
+	}
+
+	MemoryStream stream;
+	REQUIRE(TextureCompressor::CompressBC6H((const U8*)hdrPixels.data(), hdrPixels.size() * sizeof(F32), stream, width, height));
+	REQUIRE(stream.Size() == width * height);
+	const F64 psnr = TextureCompressor::ComputePSNR(GPU::FORMAT_BC6H_UF16, stream.data(), (const U8*)hdrPixels.data(), width, height);
+	Logger::Print("[TextureCompressor] BC6H PSNR:%.2f", psnr);
+	REQUIRE(psnr > 40.0);
+}
+
+TEST_CASE("TextureCompressor 4K", "[.][TextureCompressor]")
+{
+	const U32 size = 4096;
+	DynamicArray<U8> pixels;
+	GenerateTestImage(size, size, pixels);
+
+	struct Encoder
+	{
+		const char* mName;
+		GPU::FORMAT mFormat;
+		bool(*mFunc)(const U8*, U32, MemoryStream&, U32, U32, TextureCompressor::Quality);
+	};
+	const Encoder encoders[] = {
+		{ "BC1", GPU::FORMAT_BC1_UNORM, TextureCompressor::CompressBC1 },
+		{ "BC3", GPU::FORMAT_BC3_UNORM, TextureCompressor::CompressBC3 },
+		{ "BC5", GPU::FORMAT_BC5_UNORM, TextureCompressor::CompressBC5 },
+		{ "BC7", GPU::FORMAT_BC7_UNORM, TextureCompressor::CompressBC7 },
+	};
+	const char* qualityNames[] = { "fast", "normal", "high" };
+
+	for (const Encoder& encoder : encoders)
+	{
+		for (I32 quality = 0; quality < (I32)std::size(qualityNames); quality++)
+		{
+			MemoryStream stream;
+			const F64 time = Timer::GetAbsoluteTime();
+			REQUIRE(encoder.mFunc(pixels.data(), pixels.size(), stream, size, size, (TextureCompressor::Quality)quality));
+			const F64 elapsed = Timer::GetAbsoluteTime() - time;
+			const F64 psnr = TextureCompressor::ComputePSNR(encoder.mFormat, stream.data(), pixels.data(), size, size);
+			Logger::Print("[TextureCompressor] %s %s: %.2fs, %.2f MPix/s, PSNR:%.2f",
+				encoder.mName, qualityNames[quality], elapsed, size * size / elapsed / 1000000.0, psnr);
+		}
+	}
+}
+
+TEST_CASE("MipGenerator", "[TextureCompressor]")
+{
+	// 2x2 checker of black and white
+	const U8 checker[] = {
+		0, 0, 0, 255,		255, 255, 255, 255,
+		255, 255, 255, 255,	0, 0, 0, 255,
+	};
+
+	MipGenerator::Options options;
+	options.mFilter = MipGenerator::Filter::BOX;
+	MipGenerator::MipChain mips;
+	MipGenerator::GenerateMips(checker, 2, 2, 2, options, mips);
+	REQUIRE(mips.size() == 1);
+	REQUIRE(mips[0].size() == 4);
+	REQUIRE(mips[0][0] == 128);
+	REQUIRE(mips[0][3] == 255);
+
+	// sRGB is averaged in linear space, 0.5 in linear space is 188 in sRGB
+	options.mIsSRGB = true;
+	MipGenerator::GenerateMips(checker, 2, 2, 2, options, mips);
+	REQUIRE(std::abs((I32)mips[0][0] - 188) <= 1);
+
+	// sizes of mip chains
+	const U32 width = 64;
+	const U32 height = 16;
+	DynamicArray<U8> pixels;
+	GenerateTestImage(width, height, pixels);
+	REQUIRE(MipGenerator::GetMipCount(width, height) == 7);
+	for (auto filter : { MipGenerator::Filter::BOX, MipGenerator::Filter::KAISER, MipGenerator::Filter::LANCZOS })
+	{
+		options.mFilter = filter;
+		MipGenerator::GenerateMips(pixels.data(), width, height, 7, options, mips);
+		REQUIRE(mips.size() == 6);
+		for (U32 mip = 1; mip < 7; mip++) {
+			REQUIRE(mips[mip - 1].size() == std::max(width >> mip, 1u) * std::max(height >> mip, 1u) * 4);
+		}
+	}
+
+	// alpha coverage of cutouts, a grid of discs with blended edges
+	const U32 size = 64;
+	pixels.resize(size * size * 4);
+	for (U32 y = 0; y < size; y++)
+	{
+		for (U32 x = 0; x < size; x++)
+		{
+			const F32 dx = (x % 8) - 3.5f;
+			const F32 dy = (y % 8) - 3.5f;
+			const F32 dist = std::sqrt(dx * dx + dy * dy);
+			U8* pixel = &pixels[(y * size + x) * 4];
+			pixel[0] = pixel[1] = pixel[2] = 255;
+			pixel[3] = dist < 2.5f ? 255 : (dist < 3.5f ? 128 : 0);
+		}
+	}
+
+	const F32 coverage = MipGenerator::ComputeAlphaCoverage(pixels.data(), size, size, 0.5f);
+	options.mFilter = MipGenerator::Filter::KAISER;
+	options.mAlphaCutoff = 0.5f;
+	options.mPreserveAlphaCoverage = false;
+	MipGenerator::GenerateMips(pixels.data(), size, size, 3, options, mips);
+	const F32 coverageLost = MipGenerator::ComputeAlphaCoverage(mips[1].data(), size / 4, size / 4, 0.5f);
+
+	options.mPreserveAlphaCoverage = true;
+	MipGenerator::GenerateMips(pixels.data(), size, size, 3, options, mips);
+	const F32 coveragePreserved = MipGenerator::ComputeAlphaCoverage(mips[1].data(), size / 4, size / 4, 0.5f);
+	REQUIRE(std::abs(coveragePreserved - coverage) < std::abs(coverageLost - coverage));
+	REQUIRE(std::abs(coveragePreserved - coverage) <= 0.1f);
+}
+
+int main(int argc, char* argv[])
+{
+	Logger::RegisterSink(mTestStdoutLoggerSink);
+	Logger::SetIsDisplayTime(false);
+
+	JobSystem::ScopedManager scoped(4, JobSystem::MAX_FIBER_COUNT, JobSystem::FIBER_STACK_SIZE);
+	return Catch::Session().run(argc, argv);
+}
+
+#endif
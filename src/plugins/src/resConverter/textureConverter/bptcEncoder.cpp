@@ -0,0 +1,634 @@
+#include "bptcEncoder.h"
+#include "core\memory\memory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace Cjing3D
+{
+namespace BPTC
+{
+	namespace
+	{
+		static const U32 WEIGHTS2[4] = { 0, 21, 43, 64 };
+		static const U32 WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		static const U32 BLOCK_PIXELS = 16;
+		static const U32 MAX_HALF = 0x7BFF;
+
+		const U32* GetWeights(U32 indexBits)
+		{
+			return indexBits == 2 ? WEIGHTS2 : WEIGHTS4;
+		}
+
+		class BlockWriter
+		{
+		public:
+			BlockWriter(U8* dst) : mDst(dst) {
+				Memory::Memset(mDst, 0, 16);
+			}
+
+			void Write(U32 value, U32 bits)
+			{
+				for (U32 i = 0; i < bits; i++, mBit++)
+				{
+					if ((value >> i) & 1) {
+						mDst[mBit >> 3] |= (U8)(1 << (mBit & 7));
+					}
+				}
+			}
+
+		private:
+			U8* mDst;
+			U32 mBit = 0;
+		};
+
+		class BlockReader
+		{
+		public:
+			BlockReader(const U8* src) : mSrc(src) {}
+
+			U32 Read(U32 bits)
+			{
+				U32 value = 0;
+				for (U32 i = 0; i < bits; i++, mBit++) {
+					value |= ((mSrc[mBit >> 3] >> (mBit & 7)) & 1) << i;
+				}
+				return value;
+			}
+
+		private:
+			const U8* mSrc;
+			U32 mBit = 0;
+		};
+
+		// quantization of endpoints. Values are 8 bits unorm of BC7, or bits of half floats of BC6H.
+		// Endpoints are interpolated in the unquantized domain, then converted to the final value
+		struct EndpointFormat
+		{
+			U32 mBits = 7;
+			bool mPBit = false;
+			bool mUnsignedHalf = false;
+		};
+
+		I32 Unquantize(const EndpointFormat& format, U32 q, U32 pbit)
+		{
+			if (format.mUnsignedHalf)
+			{
+				if (q == 0) {
+					return 0;
+				}
+				if (q == (1u << format.mBits) - 1) {
+					return 0xFFFF;
+				}
+				return (I32)(((q << 16) + 0x8000) >> format.mBits);
+			}
+
+			const U32 bits = format.mBits + (format.mPBit ? 1 : 0);
+			const U32 value = format.mPBit ? ((q << 1) | pbit) : q;
+			return bits >= 8 ? (I32)value : (I32)((value << (8 - bits)) | (value >> (2 * bits - 8)));
+		}
+
+		I32 FinishUnquantize(const EndpointFormat& format, I32 value)
+		{
+			return format.mUnsignedHalf ? (value * 31) >> 6 : value;
+		}
+
+		I32 Interpolate(I32 e0, I32 e1, U32 weight)
+		{
+			return ((64 - (I32)weight) * e0 + (I32)weight * e1 + 32) >> 6;
+		}
+
+		U32 Quantize(const EndpointFormat& format, F32 value, U32 pbit)
+		{
+			const I32 maxQ = (1 << format.mBits) - 1;
+			F32 estimate = 0.0f;
+			if (format.mUnsignedHalf) {
+				estimate = (value - 15.0f) / 31.0f;
+			}
+			else if (format.mPBit) {
+				estimate = (value - pbit) * 0.5f;
+			}
+			else {
+				estimate = value * maxQ / 255.0f;
+			}
+
+			// search neighbours of the estimate for the nearest value
+			const I32 center = (I32)std::floor(estimate + 0.5f);
+			U32 bestQ = 0;
+			F32 bestError = FLT_MAX;
+			for (I32 q = center - 1; q <= center + 1; q++)
+			{
+				const U32 clampedQ = (U32)std::min(std::max(q, 0), maxQ);
+				const F32 error = std::abs(FinishUnquantize(format, Unquantize(format, clampedQ, pbit)) - value);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestQ = clampedQ;
+				}
+			}
+			return bestQ;
+		}
+
+		struct SubsetEncoding
+		{
+			U32 mQ0[4] = {};
+			U32 mQ1[4] = {};
+			U32 mP0 = 0;
+			U32 mP1 = 0;
+			U8 mIndices[BLOCK_PIXELS] = {};
+			F32 mError = FLT_MAX;
+		};
+
+		// select indices of quantized endpoints, return the squared error
+		F32 SelectIndices(const F32 (*pixels)[4], U32 channels, const EndpointFormat& format, U32 indexBits, SubsetEncoding& encoding)
+		{
+			const U32 indexCount = 1u << indexBits;
+			const U32* weights = GetWeights(indexBits);
+
+			F32 palette[16][4];
+			for (U32 c = 0; c < channels; c++)
+			{
+				const I32 e0 = Unquantize(format, encoding.mQ0[c], encoding.mP0);
+				const I32 e1 = Unquantize(format, encoding.mQ1[c], encoding.mP1);
+				for (U32 i = 0; i < indexCount; i++) {
+					palette[i][c] = (F32)FinishUnquantize(format, Interpolate(e0, e1, weights[i]));
+				}
+			}
+
+			// project pixels on the segment of endpoints, then search neighbours of the nearest index
+			F32 dir[4];
+			F32 dirLengthSq = 0.0f;
+			for (U32 c = 0; c < channels; c++)
+			{
+				dir[c] = palette[indexCount - 1][c] - palette[0][c];
+				dirLengthSq += dir[c] * dir[c];
+			}
+			const F32 invDirLengthSq = dirLengthSq > 0.0f ? 1.0f / dirLengthSq : 0.0f;
+
+			F32 totalError = 0.0f;
+			for (U32 p = 0; p < BLOCK_PIXELS; p++)
+			{
+				F32 t = 0.0f;
+				for (U32 c = 0; c < channels; c++) {
+					t += (pixels[p][c] - palette[0][c]) * dir[c];
+				}
+				t = std::min(std::max(t * invDirLengthSq, 0.0f), 1.0f);
+				const I32 center = (I32)(t * (indexCount - 1) + 0.5f);
+
+				F32 bestError = FLT_MAX;
+				for (I32 i = std::max(center - 1, 0); i <= std::min(center + 1, (I32)indexCount - 1); i++)
+				{
+					F32 error = 0.0f;
+					for (U32 c = 0; c < channels; c++)
+					{
+						const F32 diff = palette[i][c] - pixels[p][c];
+						error += diff * diff;
+					}
+					if (error < bestError)
+					{
+						bestError = error;
+						encoding.mIndices[p] = (U8)i;
+					}
+				}
+				totalError += bestError;
+			}
+			return totalError;
+		}
+
+		// quantize endpoints with all combinations of p-bits, keep the best encoding
+		void QuantizeEndpoints(const F32 (*pixels)[4], U32 channels, const EndpointFormat& format, U32 indexBits, const F32* e0, const F32* e1, SubsetEncoding& best)
+		{
+			const U32 pbitCount = format.mPBit ? 2 : 1;
+			for (U32 p0 = 0; p0 < pbitCount; p0++)
+			{
+				for (U32 p1 = 0; p1 < pbitCount; p1++)
+				{
+					SubsetEncoding encoding;
+					encoding.mP0 = p0;
+					encoding.mP1 = p1;
+					for (U32 c = 0; c < channels; c++)
+					{
+						encoding.mQ0[c] = Quantize(format, e0[c], p0);
+						encoding.mQ1[c] = Quantize(format, e1[c], p1);
+					}
+					encoding.mError = SelectIndices(pixels, channels, format, indexBits, encoding);
+					if (encoding.mError < best.mError) {
+						best = encoding;
+					}
+				}
+			}
+		}
+
+		void ComputeBoundingBox(const F32 (*pixels)[4], U32 channels, F32* e0, F32* e1)
+		{
+			for (U32 c = 0; c < channels; c++)
+			{
+				e0[c] = FLT_MAX;
+				e1[c] = -FLT_MAX;
+				for (U32 p = 0; p < BLOCK_PIXELS; p++)
+				{
+					e0[c] = std::min(e0[c], pixels[p][c]);
+					e1[c] = std::max(e1[c], pixels[p][c]);
+				}
+			}
+		}
+
+		// endpoints are the extents of pixels projected on the principal axis
+		void ComputePrincipalAxis(const F32 (*pixels)[4], U32 channels, F32* e0, F32* e1)
+		{
+			F32 mean[4] = {};
+			for (U32 p = 0; p < BLOCK_PIXELS; p++)
+			{
+				for (U32 c = 0; c < channels; c++) {
+					mean[c] += pixels[p][c] / BLOCK_PIXELS;
+				}
+			}
+
+			F32 covariance[4][4] = {};
+			for (U32 p = 0; p < BLOCK_PIXELS; p++)
+			{
+				for (U32 i = 0; i < channels; i++)
+				{
+					for (U32 j = 0; j < channels; j++) {
+						covariance[i][j] += (pixels[p][i] - mean[i]) * (pixels[p][j] - mean[j]);
+					}
+				}
+			}
+
+			// power iteration
+			F32 axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			for (U32 iteration = 0; iteration < 8; iteration++)
+			{
+				F32 next[4] = {};
+				F32 length = 0.0f;
+				for (U32 i = 0; i < channels; i++)
+				{
+					for (U32 j = 0; j < channels; j++) {
+						next[i] += covariance[i][j] * axis[j];
+					}
+					length = std::max(length, std::abs(next[i]));
+				}
+				if (length < 1e-6f) {
+					break;
+				}
+				for (U32 i = 0; i < channels; i++) {
+					axis[i] = next[i] / length;
+				}
+			}
+
+			F32 minT = FLT_MAX;
+			F32 maxT = -FLT_MAX;
+			F32 axisLengthSq = 0.0f;
+			for (U32 c = 0; c < channels; c++) {
+				axisLengthSq += axis[c] * axis[c];
+			}
+			for (U32 p = 0; p < BLOCK_PIXELS; p++)
+			{
+				F32 t = 0.0f;
+				for (U32 c = 0; c < channels; c++) {
+					t += (pixels[p][c] - mean[c]) * axis[c];
+				}
+				t /= axisLengthSq;
+				minT = std::min(minT, t);
+				maxT = std::max(maxT, t);
+			}
+
+			for (U32 c = 0; c < channels; c++)
+			{
+				e0[c] = mean[c] + axis[c] * minT;
+				e1[c] = mean[c] + axis[c] * maxT;
+			}
+		}
+
+		// solve endpoints of current indices by least squares, return false if it is singular
+		bool RefineEndpoints(const F32 (*pixels)[4], U32 channels, U32 indexBits, const SubsetEncoding& encoding, F32* e0, F32* e1)
+		{
+			const U32* weights = GetWeights(indexBits);
+			F32 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+			F32 ax[4] = {};
+			F32 bx[4] = {};
+			for (U32 p = 0; p < BLOCK_PIXELS; p++)
+			{
+				const F32 t = weights[encoding.mIndices[p]] / 64.0f;
+				const F32 s = 1.0f - t;
+				aa += s * s;
+				ab += s * t;
+				bb += t * t;
+				for (U32 c = 0; c < channels; c++)
+				{
+					ax[c] += s * pixels[p][c];
+					bx[c] += t * pixels[p][c];
+				}
+			}
+
+			const F32 det = aa * bb - ab * ab;
+			if (std::abs(det) < 1e-6f) {
+				return false;
+			}
+
+			const F32 invDet = 1.0f / det;
+			for (U32 c = 0; c < channels; c++)
+			{
+				e0[c] = (bb * ax[c] - ab * bx[c]) * invDet;
+				e1[c] = (aa * bx[c] - ab * ax[c]) * invDet;
+			}
+			return true;
+		}
+
+		SubsetEncoding EncodeSubset(const F32 (*pixels)[4], U32 channels, const EndpointFormat& format, U32 indexBits, U32 level)
+		{
+			const F32 maxValue = format.mUnsignedHalf ? (F32)MAX_HALF : 255.0f;
+			F32 e0[4], e1[4];
+			if (level == 0) {
+				ComputeBoundingBox(pixels, channels, e0, e1);
+			}
+			else {
+				ComputePrincipalAxis(pixels, channels, e0, e1);
+			}
+
+			SubsetEncoding best;
+			const U32 refineIterations = level == 0 ? 0 : (level == 1 ? 1 : 3);
+			for (U32 iteration = 0; iteration <= refineIterations; iteration++)
+			{
+				for (U32 c = 0; c < channels; c++)
+				{
+					e0[c] = std::min(std::max(e0[c], 0.0f), maxValue);
+					e1[c] = std::min(std::max(e1[c], 0.0f), maxValue);
+				}
+				QuantizeEndpoints(pixels, channels, format, indexBits, e0, e1, best);
+
+				if (iteration == refineIterations || best.mError == 0.0f) {
+					break;
+				}
+				if (!RefineEndpoints(pixels, channels, indexBits, best, e0, e1)) {
+					break;
+				}
+			}
+			return best;
+		}
+
+		// the msb of the anchor index is implicitly zero, endpoints are swapped if it is set
+		void FixAnchorIndex(SubsetEncoding& encoding, U32 channels, U32 indexBits)
+		{
+			const U32 maxIndex = (1u << indexBits) - 1;
+			if (encoding.mIndices[0] <= (maxIndex >> 1)) {
+				return;
+			}
+
+			for (U32 c = 0; c < channels; c++) {
+				std::swap(encoding.mQ0[c], encoding.mQ1[c]);
+			}
+			std::swap(encoding.mP0, encoding.mP1);
+			for (U32 p = 0; p < BLOCK_PIXELS; p++) {
+				encoding.mIndices[p] = (U8)(maxIndex - encoding.mIndices[p]);
+			}
+		}
+
+		void WriteIndices(BlockWriter& writer, const U8* indices, U32 indexBits)
+		{
+			writer.Write(indices[0], indexBits - 1);
+			for (U32 p = 1; p < BLOCK_PIXELS; p++) {
+				writer.Write(indices[p], indexBits);
+			}
+		}
+
+		void ReadIndices(BlockReader& reader, U8* indices, U32 indexBits)
+		{
+			indices[0] = (U8)reader.Read(indexBits - 1);
+			for (U32 p = 1; p < BLOCK_PIXELS; p++) {
+				indices[p] = (U8)reader.Read(indexBits);
+			}
+		}
+
+		void WriteBC7Mode6(U8* dst, SubsetEncoding& encoding)
+		{
+			FixAnchorIndex(encoding, 4, 4);
+
+			BlockWriter writer(dst);
+			writer.Write(1 << 6, 7);
+			for (U32 c = 0; c < 4; c++)
+			{
+				writer.Write(encoding.mQ0[c], 7);
+				writer.Write(encoding.mQ1[c], 7);
+			}
+			writer.Write(encoding.mP0, 1);
+			writer.Write(encoding.mP1, 1);
+			WriteIndices(writer, encoding.mIndices, 4);
+		}
+
+		void WriteBC7Mode5(U8* dst, U32 rotation, SubsetEncoding& color, SubsetEncoding& alpha)
+		{
+			FixAnchorIndex(color, 3, 2);
+			FixAnchorIndex(alpha, 1, 2);
+
+			BlockWriter writer(dst);
+			writer.Write(1 << 5, 6);
+			writer.Write(rotation, 2);
+			for (U32 c = 0; c < 3; c++)
+			{
+				writer.Write(color.mQ0[c], 7);
+				writer.Write(color.mQ1[c], 7);
+			}
+			writer.Write(alpha.mQ0[0], 8);
+			writer.Write(alpha.mQ1[0], 8);
+			WriteIndices(writer, color.mIndices, 2);
+			WriteIndices(writer, alpha.mIndices, 2);
+		}
+	}
+
+	void EncodeBC7(U8* dst, const U8* pixels, U32 level)
+	{
+		F32 values[BLOCK_PIXELS][4];
+		for (U32 p = 0; p < BLOCK_PIXELS; p++)
+		{
+			for (U32 c = 0; c < 4; c++) {
+				values[p][c] = pixels[p * 4 + c];
+			}
+		}
+
+		// mode 6: rgba, 7 bits endpoints with p-bits, 4 bits indices
+		EndpointFormat mode6Format;
+		mode6Format.mBits = 7;
+		mode6Format.mPBit = true;
+		SubsetEncoding mode6 = EncodeSubset(values, 4, mode6Format, 4, level);
+		if (level < MAX_LEVEL || mode6.mError == 0.0f)
+		{
+			WriteBC7Mode6(dst, mode6);
+			return;
+		}
+
+		// mode 5: rgb of 7 bits endpoints and alpha of 8 bits endpoints with separate 2 bits indices,
+		// the alpha channel is swapped with a color channel by the rotation
+		EndpointFormat colorFormat;
+		colorFormat.mBits = 7;
+		EndpointFormat alphaFormat;
+		alphaFormat.mBits = 8;
+
+		U32 bestRotation = 0;
+		SubsetEncoding bestColor;
+		SubsetEncoding bestAlpha;
+		F32 bestError = FLT_MAX;
+		for (U32 rotation = 0; rotation < 4; rotation++)
+		{
+			F32 rotated[BLOCK_PIXELS][4];
+			F32 alphas[BLOCK_PIXELS][4];
+			for (U32 p = 0; p < BLOCK_PIXELS; p++)
+			{
+				for (U32 c = 0; c < 4; c++) {
+					rotated[p][c] = values[p][c];
+				}
+				if (rotation > 0) {
+					std::swap(rotated[p][rotation - 1], rotated[p][3]);
+				}
+				alphas[p][0] = rotated[p][3];
+			}
+
+			SubsetEncoding color = EncodeSubset(rotated, 3, colorFormat, 2, level);
+			SubsetEncoding alpha = EncodeSubset(alphas, 1, alphaFormat, 2, level);
+			if (color.mError + alpha.mError < bestError)
+			{
+				bestError = color.mError + alpha.mError;
+				bestRotation = rotation;
+				bestColor = color;
+				bestAlpha = alpha;
+			}
+		}
+
+		if (bestError < mode6.mError) {
+			WriteBC7Mode5(dst, bestRotation, bestColor, bestAlpha);
+		}
+		else {
+			WriteBC7Mode6(dst, mode6);
+		}
+	}
+
+	bool DecodeBC7(const U8* src, U8* pixels)
+	{
+		EndpointFormat format;
+		BlockReader reader(src);
+		if ((src[0] & 0x7F) == (1 << 6))
+		{
+			reader.Read(7);
+			U32 q0[4], q1[4];
+			for (U32 c = 0; c < 4; c++)
+			{
+				q0[c] = reader.Read(7);
+				q1[c] = reader.Read(7);
+			}
+			const U32 p0 = reader.Read(1);
+			const U32 p1 = reader.Read(1);
+			U8 indices[BLOCK_PIXELS];
+			ReadIndices(reader, indices, 4);
+
+			format.mBits = 7;
+			format.mPBit = true;
+			for (U32 p = 0; p < BLOCK_PIXELS; p++)
+			{
+				for (U32 c = 0; c < 4; c++) {
+					pixels[p * 4 + c] = (U8)Interpolate(Unquantize(format, q0[c], p0), Unquantize(format, q1[c], p1), WEIGHTS4[indices[p]]);
+				}
+			}
+			return true;
+		}
+		else if ((src[0] & 0x3F) == (1 << 5))
+		{
+			reader.Read(6);
+			const U32 rotation = reader.Read(2);
+			U32 q0[4], q1[4];
+			for (U32 c = 0; c < 3; c++)
+			{
+				q0[c] = reader.Read(7);
+				q1[c] = reader.Read(7);
+			}
+			q0[3] = reader.Read(8);
+			q1[3] = reader.Read(8);
+			U8 colorIndices[BLOCK_PIXELS];
+			U8 alphaIndices[BLOCK_PIXELS];
+			ReadIndices(reader, colorIndices, 2);
+			ReadIndices(reader, alphaIndices, 2);
+
+			for (U32 p = 0; p < BLOCK_PIXELS; p++)
+			{
+				U8* pixel = pixels + p * 4;
+				for (U32 c = 0; c < 4; c++)
+				{
+					format.mBits = c < 3 ? 7 : 8;
+					const U32 weight = WEIGHTS2[c < 3 ? colorIndices[p] : alphaIndices[p]];
+					pixel[c] = (U8)Interpolate(Unquantize(format, q0[c], 0), Unquantize(format, q1[c], 0), weight);
+				}
+				if (rotation > 0) {
+					std::swap(pixel[rotation - 1], pixel[3]);
+				}
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void EncodeBC6H(U8* dst, const F32* pixels, U32 level)
+	{
+		// endpoints are fitted on bits of half floats, which are interpolated by hardware
+		F32 values[BLOCK_PIXELS][4];
+		for (U32 p = 0; p < BLOCK_PIXELS; p++)
+		{
+			for (U32 c = 0; c < 3; c++)
+			{
+				const U32 half = XMConvertFloatToHalf(std::max(pixels[p * 4 + c], 0.0f));
+				values[p][c] = (F32)std::min(half, MAX_HALF);
+			}
+			values[p][3] = 0.0f;
+		}
+
+		// mode 11: rgb, 10 bits endpoints, 4 bits indices
+		EndpointFormat format;
+		format.mBits = 10;
+		format.mUnsignedHalf = true;
+		SubsetEncoding encoding = EncodeSubset(values, 3, format, 4, level);
+		FixAnchorIndex(encoding, 3, 4);
+
+		BlockWriter writer(dst);
+		writer.Write(0x03, 5);
+		for (U32 c = 0; c < 3; c++) {
+			writer.Write(encoding.mQ0[c], 10);
+		}
+		for (U32 c = 0; c < 3; c++) {
+			writer.Write(encoding.mQ1[c], 10);
+		}
+		WriteIndices(writer, encoding.mIndices, 4);
+	}
+
+	bool DecodeBC6H(const U8* src, F32* pixels)
+	{
+		BlockReader reader(src);
+		if (reader.Read(5) != 0x03) {
+			return false;
+		}
+
+		U32 q0[3], q1[3];
+		for (U32 c = 0; c < 3; c++) {
+			q0[c] = reader.Read(10);
+		}
+		for (U32 c = 0; c < 3; c++) {
+			q1[c] = reader.Read(10);
+		}
+		U8 indices[BLOCK_PIXELS];
+		ReadIndices(reader, indices, 4);
+
+		EndpointFormat format;
+		format.mBits = 10;
+		format.mUnsignedHalf = true;
+		for (U32 p = 0; p < BLOCK_PIXELS; p++)
+		{
+			for (U32 c = 0; c < 3; c++)
+			{
+				const I32 value = Interpolate(Unquantize(format, q0[c], 0), Unquantize(format, q1[c], 0), WEIGHTS4[indices[p]]);
+				pixels[p * 4 + c] = XMConvertHalfToFloat((HALF)FinishUnquantize(format, value));
+			}
+			pixels[p * 4 + 3] = 1.0f;
+		}
+		return true;
+	}
+}
+}
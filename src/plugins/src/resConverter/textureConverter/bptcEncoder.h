@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core\common\common.h"
+
+namespace Cjing3D
+{
+/// //////////////////////////////////////////////////////////////////////////////////////////////////
+/// BPTC
+/// Block encoders of BC7 and BC6H (BPTC formats), blocks are 16 bytes of 4x4 pixels. Only single
+/// subset modes are used: BC7 mode 6 and mode 5, BC6H mode 11 (10 bits endpoints, UF16).
+/// Decoders support the modes emitted by encoders, they are used to measure errors.
+namespace BPTC
+{
+	// level 0: BC7 mode 6 with bounding box endpoints
+	// level 1: BC7 mode 6 with principal axis endpoints and least squares refinement
+	// level 2: level 1 with more refinement, BC7 mode 5 with channel rotations is also tried
+	static const U32 MAX_LEVEL = 2;
+
+	// pixels are 16 RGBA8 pixels
+	void EncodeBC7(U8* dst, const U8* pixels, U32 level);
+	bool DecodeBC7(const U8* src, U8* pixels);
+
+	// pixels are 16 RGBA F32 pixels, alpha is ignored, negative values are clamped to zero
+	void EncodeBC6H(U8* dst, const F32* pixels, U32 level);
+	bool DecodeBC6H(const U8* src, F32* pixels);
+}
+}
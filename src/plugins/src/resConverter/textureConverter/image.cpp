@@ -83,18 +83,22 @@ namespace Cjing3D
 			I32 width, height, bpp;
 			GPU::FORMAT format = GPU::FORMAT_R8G8B8A8_UNORM;
 
-			// non-hdr
-			U8* rgb = (U8*)stbi_load_from_memory((stbi_uc*)data, length, &width, &height, &bpp, channelCount);
-			if (rgb == nullptr)
+			// hdr images are loaded as float, stbi_load converts them to ldr
+			U8* rgb = nullptr;
+			if (stbi_is_hdr_from_memory((stbi_uc*)data, (I32)length))
 			{
-				// hdr
 				format = GPU::FORMAT_R32G32B32A32_FLOAT;
 				rgb = (U8*)stbi_loadf_from_memory((stbi_uc*)data, length, &width, &height, &bpp, channelCount);
-				if (rgb == nullptr) 
-				{
-					Logger::Warning("Failed to load image from memory");
-					return Image();
-				}
+			}
+			else
+			{
+				rgb = (U8*)stbi_load_from_memory((stbi_uc*)data, length, &width, &height, &bpp, channelCount);
+			}
+
+			if (rgb == nullptr)
+			{
+				Logger::Warning("Failed to load image from memory");
+				return Image();
 			}
 
 			return Image(
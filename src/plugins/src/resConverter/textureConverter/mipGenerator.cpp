@@ -0,0 +1,371 @@
+#include "mipGenerator.h"
+#include "core\concurrency\jobsystem.h"
+#include "core\memory\memory.h"
+#include "core\helper\profiler.h"
+
+#include <cmath>
+
+namespace Cjing3D
+{
+namespace MipGenerator
+{
+	namespace
+	{
+		static const F32 KAISER_ALPHA = 4.0f;
+		static const U32 ALPHA_SCALE_SEARCH_STEPS = 16;
+
+		F32 Sinc(F32 x)
+		{
+			x *= XM_PI;
+			return std::abs(x) < 1e-5f ? 1.0f : std::sin(x) / x;
+		}
+
+		// modified bessel function of the first kind, order 0
+		F32 BesselI0(F32 x)
+		{
+			F32 sum = 1.0f;
+			F32 term = 1.0f;
+			const F32 halfX = x * 0.5f;
+			for (I32 k = 1; k < 16; k++)
+			{
+				term *= (halfX / k) * (halfX / k);
+				sum += term;
+			}
+			return sum;
+		}
+
+		F32 GetFilterRadius(Filter filter)
+		{
+			return filter == Filter::BOX ? 0.5f : 3.0f;
+		}
+
+		F32 EvaluateFilter(Filter filter, F32 x)
+		{
+			switch (filter)
+			{
+			case Filter::BOX:
+				return std::abs(x) <= 0.5f ? 1.0f : 0.0f;
+			case Filter::KAISER:
+			{
+				const F32 t = x / 3.0f;
+				if (std::abs(t) >= 1.0f) {
+					return 0.0f;
+				}
+				return Sinc(x) * BesselI0(KAISER_ALPHA * std::sqrt(1.0f - t * t)) / BesselI0(KAISER_ALPHA);
+			}
+			case Filter::LANCZOS:
+				return std::abs(x) < 3.0f ? Sinc(x) * Sinc(x / 3.0f) : 0.0f;
+			default:
+				return 0.0f;
+			}
+		}
+
+		// taps of a 1D downsampling, source indices are clamped to edges
+		struct FilterTaps
+		{
+			U32 mTapCount = 0;
+			DynamicArray<U32> mIndices;	// dstSize * tapCount
+			DynamicArray<F32> mWeights;	// dstSize * tapCount
+		};
+
+		void BuildFilterTaps(U32 srcSize, U32 dstSize, Filter filter, FilterTaps& taps)
+		{
+			// the kernel is stretched by the scale of downsampling
+			const F32 scale = (F32)srcSize / (F32)dstSize;
+			const F32 radius = GetFilterRadius(filter) * scale;
+			taps.mTapCount = (U32)std::ceil(radius * 2.0f) + 1;
+			taps.mIndices.resize(dstSize * taps.mTapCount);
+			taps.mWeights.resize(dstSize * taps.mTapCount);
+
+			for (U32 dst = 0; dst < dstSize; dst++)
+			{
+				const F32 center = (dst + 0.5f) * scale;
+				const I32 start = (I32)std::floor(center - radius);
+				U32* indices = &taps.mIndices[dst * taps.mTapCount];
+				F32* weights = &taps.mWeights[dst * taps.mTapCount];
+
+				F32 weightSum = 0.0f;
+				for (U32 tap = 0; tap < taps.mTapCount; tap++)
+				{
+					const I32 src = start + (I32)tap;
+					indices[tap] = (U32)std::min(std::max(src, 0), (I32)srcSize - 1);
+					weights[tap] = EvaluateFilter(filter, (src + 0.5f - center) / scale);
+					weightSum += weights[tap];
+				}
+
+				const F32 invWeightSum = weightSum != 0.0f ? 1.0f / weightSum : 0.0f;
+				for (U32 tap = 0; tap < taps.mTapCount; tap++) {
+					weights[tap] *= invWeightSum;
+				}
+			}
+		}
+
+		F32 SRGBToLinear(F32 value)
+		{
+			return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		F32 LinearToSRGB(F32 value)
+		{
+			return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		}
+
+		U8 ToUnorm8(F32 value)
+		{
+			value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+			return (U8)(value * 255.0f + 0.5f);
+		}
+
+		// float pixels are stored as XMFLOAT4 to be processed by vector instructions
+		using FloatImage = DynamicArray<XMFLOAT4>;
+
+		void ConvertToFloat(const U8* data, U32 pixelCount, bool isSRGB, FloatImage& outImage)
+		{
+			F32 table[256];
+			for (U32 i = 0; i < 256; i++) {
+				table[i] = isSRGB ? SRGBToLinear(i / 255.0f) : i / 255.0f;
+			}
+
+			outImage.resize(pixelCount);
+			for (U32 i = 0; i < pixelCount; i++)
+			{
+				const U8* pixel = data + i * 4;
+				outImage[i] = XMFLOAT4(table[pixel[0]], table[pixel[1]], table[pixel[2]], pixel[3] / 255.0f);
+			}
+		}
+
+		void Downsample(const FloatImage& src, U32 srcW, U32 srcH, FloatImage& dst, U32 dstW, U32 dstH, Filter filter)
+		{
+			FilterTaps tapsX;
+			FilterTaps tapsY;
+			BuildFilterTaps(srcW, dstW, filter, tapsX);
+			BuildFilterTaps(srcH, dstH, filter, tapsY);
+
+			// horizontal pass: srcW x srcH => dstW x srcH
+			FloatImage temp;
+			temp.resize(dstW * srcH);
+			JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+			JobSystem::RunJobs((I32)srcH, 16, [&](I32 y, JobSystem::JobGroupArgs* args, void* sharedMem) {
+				const XMFLOAT4* srcRow = &src[y * srcW];
+				XMFLOAT4* dstRow = &temp[y * dstW];
+				for (U32 x = 0; x < dstW; x++)
+				{
+					const U32* indices = &tapsX.mIndices[x * tapsX.mTapCount];
+					const F32* weights = &tapsX.mWeights[x * tapsX.mTapCount];
+					XMVECTOR sum = XMVectorZero();
+					for (U32 tap = 0; tap < tapsX.mTapCount; tap++) {
+						sum = XMVectorMultiplyAdd(XMLoadFloat4(&srcRow[indices[tap]]), XMVectorReplicate(weights[tap]), sum);
+					}
+					XMStoreFloat4(&dstRow[x], sum);
+				}
+				return false;
+			}, 0, &jobHandle);
+			JobSystem::Wait(&jobHandle);
+
+			// vertical pass: dstW x srcH => dstW x dstH
+			dst.resize(dstW * dstH);
+			JobSystem::RunJobs((I32)dstH, 8, [&](I32 y, JobSystem::JobGroupArgs* args, void* sharedMem) {
+				const U32* indices = &tapsY.mIndices[y * tapsY.mTapCount];
+				const F32* weights = &tapsY.mWeights[y * tapsY.mTapCount];
+				XMFLOAT4* dstRow = &dst[y * dstW];
+				for (U32 x = 0; x < dstW; x++)
+				{
+					XMVECTOR sum = XMVectorZero();
+					for (U32 tap = 0; tap < tapsY.mTapCount; tap++) {
+						sum = XMVectorMultiplyAdd(XMLoadFloat4(&temp[indices[tap] * dstW + x]), XMVectorReplicate(weights[tap]), sum);
+					}
+					XMStoreFloat4(&dstRow[x], sum);
+				}
+				return false;
+			}, 0, &jobHandle);
+			JobSystem::Wait(&jobHandle);
+		}
+
+		F32 ComputeAlphaCoverage(const FloatImage& image, F32 alphaCutoff, F32 alphaScale)
+		{
+			if (image.empty()) {
+				return 0.0f;
+			}
+
+			U32 count = 0;
+			for (const XMFLOAT4& pixel : image)
+			{
+				if (pixel.w * alphaScale > alphaCutoff) {
+					count++;
+				}
+			}
+			return (F32)count / (F32)image.size();
+		}
+
+		// binary search of the alpha scale, so that the coverage is close to the target
+		F32 FindAlphaScale(const FloatImage& image, F32 alphaCutoff, F32 targetCoverage)
+		{
+			F32 minScale = 0.0f;
+			F32 maxScale = 4.0f;
+			F32 scale = 1.0f;
+			for (U32 i = 0; i < ALPHA_SCALE_SEARCH_STEPS; i++)
+			{
+				const F32 coverage = ComputeAlphaCoverage(image, alphaCutoff, scale);
+				if (coverage < targetCoverage) {
+					minScale = scale;
+				}
+				else if (coverage > targetCoverage) {
+					maxScale = scale;
+				}
+				else {
+					break;
+				}
+				scale = (minScale + maxScale) * 0.5f;
+			}
+			return scale;
+		}
+
+		void ConvertToUnorm8(const FloatImage& image, const Options& options, F32 alphaScale, DynamicArray<U8>& outData)
+		{
+			outData.resize(image.size() * 4);
+			for (U32 i = 0; i < image.size(); i++)
+			{
+				XMFLOAT4 pixel = image[i];
+				if (options.mIsNormalMap)
+				{
+					const XMVECTOR normal = XMVectorSubtract(XMVectorScale(XMLoadFloat4(&pixel), 2.0f), XMVectorReplicate(1.0f));
+					XMFLOAT3 normalized;
+					XMStoreFloat3(&normalized, XMVectorMultiplyAdd(XMVector3Normalize(normal), XMVectorReplicate(0.5f), XMVectorReplicate(0.5f)));
+					pixel.x = normalized.x;
+					pixel.y = normalized.y;
+					pixel.z = normalized.z;
+				}
+				else if (options.mIsSRGB)
+				{
+					pixel.x = LinearToSRGB(pixel.x);
+					pixel.y = LinearToSRGB(pixel.y);
+					pixel.z = LinearToSRGB(pixel.z);
+				}
+
+				U8* dst = &outData[i * 4];
+				dst[0] = ToUnorm8(pixel.x);
+				dst[1] = ToUnorm8(pixel.y);
+				dst[2] = ToUnorm8(pixel.z);
+				dst[3] = ToUnorm8(pixel.w * alphaScale);
+			}
+		}
+
+		void ConvertToFloat32(const FloatImage& image, const Options& options, F32 alphaScale, DynamicArray<U8>& outData)
+		{
+			outData.resize(image.size() * sizeof(XMFLOAT4));
+			XMFLOAT4* dst = (XMFLOAT4*)outData.data();
+			for (U32 i = 0; i < image.size(); i++)
+			{
+				XMFLOAT4 pixel = image[i];
+				if (options.mIsNormalMap)
+				{
+					XMFLOAT3 normalized;
+					XMStoreFloat3(&normalized, XMVector3Normalize(XMLoadFloat4(&pixel)));
+					pixel.x = normalized.x;
+					pixel.y = normalized.y;
+					pixel.z = normalized.z;
+				}
+				pixel.w *= alphaScale;
+				dst[i] = pixel;
+			}
+		}
+
+		using OutputConverter = void(*)(const FloatImage& image, const Options& options, F32 alphaScale, DynamicArray<U8>& outData);
+
+		void GenerateMipChain(FloatImage& srcImage, U32 width, U32 height, U32 mips, const Options& options, F32 targetCoverage, MipChain& outMips, OutputConverter converter)
+		{
+			FloatImage dstImage;
+			outMips.resize(mips - 1);
+			U32 srcW = width;
+			U32 srcH = height;
+			for (U32 mip = 1; mip < mips; mip++)
+			{
+				const U32 dstW = std::max(srcW >> 1, 1u);
+				const U32 dstH = std::max(srcH >> 1, 1u);
+				Downsample(srcImage, srcW, srcH, dstImage, dstW, dstH, options.mFilter);
+
+				// alpha of the float chain is not scaled, the scale is only applied to the output
+				const F32 alphaScale = options.mPreserveAlphaCoverage ?
+					FindAlphaScale(dstImage, options.mAlphaCutoff, targetCoverage) : 1.0f;
+				converter(dstImage, options, alphaScale, outMips[mip - 1]);
+
+				srcImage.swap(dstImage);
+				srcW = dstW;
+				srcH = dstH;
+			}
+		}
+	}
+
+	U32 GetMipCount(U32 width, U32 height)
+	{
+		U32 mips = 1;
+		U32 size = std::max(width, height);
+		while (size > 1)
+		{
+			size >>= 1;
+			mips++;
+		}
+		return mips;
+	}
+
+	F32 ComputeAlphaCoverage(const U8* data, U32 width, U32 height, F32 alphaCutoff)
+	{
+		const U32 pixelCount = width * height;
+		if (pixelCount == 0) {
+			return 0.0f;
+		}
+
+		const U32 cutoff = (U32)(alphaCutoff * 255.0f);
+		U32 count = 0;
+		for (U32 i = 0; i < pixelCount; i++)
+		{
+			if (data[i * 4 + 3] > cutoff) {
+				count++;
+			}
+		}
+		return (F32)count / (F32)pixelCount;
+	}
+
+	void GenerateMips(const U8* data, U32 width, U32 height, U32 mips, const Options& options, MipChain& outMips)
+	{
+		PROFILE_FUNCTION();
+		if (data == nullptr || width == 0 || height == 0 || mips <= 1)
+		{
+			outMips.clear();
+			return;
+		}
+
+		// normal maps are always linear
+		Options mipOptions = options;
+		mipOptions.mIsSRGB = options.mIsSRGB && !options.mIsNormalMap;
+
+		const F32 targetCoverage = options.mPreserveAlphaCoverage ?
+			ComputeAlphaCoverage(data, width, height, options.mAlphaCutoff) : 0.0f;
+
+		FloatImage image;
+		ConvertToFloat(data, width * height, mipOptions.mIsSRGB, image);
+		GenerateMipChain(image, width, height, mips, mipOptions, targetCoverage, outMips, ConvertToUnorm8);
+	}
+
+	void GenerateMips(const F32* data, U32 width, U32 height, U32 mips, const Options& options, MipChain& outMips)
+	{
+		PROFILE_FUNCTION();
+		if (data == nullptr || width == 0 || height == 0 || mips <= 1)
+		{
+			outMips.clear();
+			return;
+		}
+
+		Options mipOptions = options;
+		mipOptions.mIsSRGB = false;
+
+		FloatImage image;
+		image.resize(width * height);
+		Memory::Memcpy(image.data(), data, width * height * sizeof(XMFLOAT4));
+
+		const F32 targetCoverage = options.mPreserveAlphaCoverage ?
+			ComputeAlphaCoverage(image, options.mAlphaCutoff, 1.0f) : 0.0f;
+		GenerateMipChain(image, width, height, mips, mipOptions, targetCoverage, outMips, ConvertToFloat32);
+	}
+}
+}
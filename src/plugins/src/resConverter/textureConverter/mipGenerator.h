@@ -0,0 +1,43 @@
+#pragma once
+
+#include "core\common\common.h"
+#include "core\container\dynamicArray.h"
+
+namespace Cjing3D
+{
+/// //////////////////////////////////////////////////////////////////////////////////////////////////
+/// MipGenerator
+/// Generate mip chains of RGBA8 images. Each mip is downsampled from the previous mip in float
+/// precision by separable filters, rows of passes are filtered concurrently on the JobSystem.
+namespace MipGenerator
+{
+	enum class Filter
+	{
+		BOX,
+		KAISER,		// kaiser windowed sinc, radius 3
+		LANCZOS,	// lanczos3
+	};
+
+	struct Options
+	{
+		Filter mFilter = Filter::KAISER;
+		bool mIsSRGB = false;					// rgb is filtered in linear space
+		bool mIsNormalMap = false;				// xyz are renormalized after filtering
+		bool mPreserveAlphaCoverage = false;	// alpha is scaled to keep the coverage of mip 0
+		F32 mAlphaCutoff = 0.5f;
+	};
+
+	using MipChain = DynamicArray<DynamicArray<U8>>;
+
+	U32 GetMipCount(U32 width, U32 height);
+
+	// fraction of pixels whose alpha is larger than the cutoff
+	F32 ComputeAlphaCoverage(const U8* data, U32 width, U32 height, F32 alphaCutoff);
+
+	// generate mips [1, mips) of RGBA8 mip 0, mip i is stored in outMips[i - 1]
+	void GenerateMips(const U8* data, U32 width, U32 height, U32 mips, const Options& options, MipChain& outMips);
+
+	// generate mips of RGBA32F mip 0, mips are RGBA32F and sRGB is ignored
+	void GenerateMips(const F32* data, U32 width, U32 height, U32 mips, const Options& options, MipChain& outMips);
+}
+}
@@ -1,10 +1,17 @@
 #include "textureCompressor.h"
 #include "core\concurrency\jobsystem.h"
+#include "core\helper\timer.h"
+#include "core\helper\enumTraits.h"
 #include "renderer\textureImpl.h"
+#include "bptcEncoder.h"
 
 #define RGBCX_IMPLEMENTATION
 #include "rgbcx\rgbcx.h"
 
+#ifdef _XM_SSE_INTRINSICS_
+#include <emmintrin.h>
+#endif
+
 namespace Cjing3D
 {
 namespace TextureCompressor
@@ -18,6 +25,12 @@ namespace TextureCompressor
 		}
 	};
 
+	// rgbcx::init is not thread safe, it is called once for all encoders
+	void InitializeEncoder()
+	{
+		static OnceInitializer initializer;
+	}
+
 	U32 GetCompressedMipSize(U32 width, U32 height, U32 bytesPerBlock)
 	{
 		return ((width + 3) >> 2) * ((height + 3) >> 2) * bytesPerBlock;
@@ -35,54 +48,114 @@ namespace TextureCompressor
 		return size;
 	}
 
-	void ComputeMip(const U8* src, U32 srcSize, U8* dst, U32 dstSize, U32 srcW, U32 srcH, U32 dstW, U32 dstH, bool isSrgb)
+	U32 GetEncoderLevel(Quality quality)
 	{
-		PROFILE_FUNCTION();
-		Debug::ThrowIfFailed(false, "ComputeMip dose not impl now.");
+		switch (quality)
+		{
+		case Quality::FAST:
+			return rgbcx::MIN_LEVEL;
+		case Quality::HIGH:
+			return rgbcx::MAX_LEVEL;
+		default:
+			return 10;
+		}
 	}
 
-	bool CompressRGBA(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height)
+	U32 GetBPTCLevel(Quality quality)
 	{
-		PROFILE_FUNCTION();
-		outputStream.Write(data, size);
-		return true;
+		switch (quality)
+		{
+		case Quality::FAST:
+			return 0;
+		case Quality::HIGH:
+			return BPTC::MAX_LEVEL;
+		default:
+			return 1;
+		}
 	}
 
-	bool CompressBC5(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height)
+	// gather a 4x4 block of RGBA8 pixels, pixels out of the image are clamped to the edges
+	void GatherBlock(const U32* pixels, U32 width, U32 height, U32 x, U32 y, U32* block)
 	{
-		PROFILE_FUNCTION();
+		if (x + 4 <= width && y + 4 <= height)
+		{
+			const U32* src = pixels + (size_t)y * width + x;
+#ifdef _XM_SSE_INTRINSICS_
+			const __m128i row0 = _mm_loadu_si128((const __m128i*)(src));
+			const __m128i row1 = _mm_loadu_si128((const __m128i*)(src + width));
+			const __m128i row2 = _mm_loadu_si128((const __m128i*)(src + width * 2));
+			const __m128i row3 = _mm_loadu_si128((const __m128i*)(src + width * 3));
+			_mm_store_si128((__m128i*)(block + 0), row0);
+			_mm_store_si128((__m128i*)(block + 4), row1);
+			_mm_store_si128((__m128i*)(block + 8), row2);
+			_mm_store_si128((__m128i*)(block + 12), row3);
+#else
+			for (U32 row = 0; row < 4; row++) {
+				Memory::Memcpy(block + row * 4, src + row * width, sizeof(U32) * 4);
+			}
+#endif
+			return;
+		}
 
-		// compressed block size: 4x4x4
-		const U32 dstBlockSize = 16;
-		const U32 compressedSize = GetCompressedMipSize(width, height, dstBlockSize);
-		U32 offset = outputStream.Size();
-		outputStream.Resize(offset + compressedSize);
-		U8* dst = outputStream.data() + offset;
+		for (U32 row = 0; row < 4; row++)
+		{
+			const U32* src = pixels + (size_t)std::min(y + row, height - 1) * width;
+			for (U32 col = 0; col < 4; col++) {
+				block[row * 4 + col] = src[std::min(x + col, width - 1)];
+			}
+		}
+	}
 
-		JobSystem::JobHandle handle = JobSystem::INVALID_HANDLE;
-		JobSystem::RunJobs((I32)height, 4,
-			[&](I32 heightIndex, JobSystem::JobGroupArgs*, void*)->bool {
+	// gather a 4x4 block of RGBA32F pixels
+	void GatherBlock(const XMFLOAT4* pixels, U32 width, U32 height, U32 x, U32 y, XMFLOAT4* block)
+	{
+		for (U32 row = 0; row < 4; row++)
+		{
+			const XMFLOAT4* src = pixels + (size_t)std::min(y + row, height - 1) * width;
+			for (U32 col = 0; col < 4; col++) {
+				block[row * 4 + col] = src[std::min(x + col, width - 1)];
+			}
+		}
+	}
 
-				U32 blockData[32];
+	// compress pixels in tiles of blocks concurrently, encoder is called with (dst, block pixels)
+	template<typename Pixel, typename BlockEncoder>
+	bool CompressBlocks(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, U32 dstBlockSize, BlockEncoder encoder)
+	{
+		InitializeEncoder();
+		if (width == 0 || height == 0 || size < width * height * sizeof(Pixel)) {
+			return false;
+		}
 
-				const U32 srcBlockHeight = std::min(height - heightIndex, 4u);
-				const U8* srcRowBegin = &data[heightIndex * width * 4];
-				for (int widthIndex = 0; widthIndex < width; widthIndex += 4)
-				{
-					const U8* srcBlockBegin = srcRowBegin + widthIndex * 4;
+		const U32 blocksX = (width + 3) >> 2;
+		const U32 blocksY = (height + 3) >> 2;
+		const U32 tilesX = (blocksX + TILE_BLOCKS - 1) / TILE_BLOCKS;
+		const U32 tilesY = (blocksY + TILE_BLOCKS - 1) / TILE_BLOCKS;
 
-					// get block data
-					const U32 srcBlockWidth = std::min(width - widthIndex, 4u);
-					for (U32 h = 0; h < srcBlockHeight; h++) {
-						Memory::Memcpy(&blockData[h * 4], &srcBlockBegin[h * width * 4], 4 * srcBlockWidth);
-					}
+		const U32 offset = outputStream.Size();
+		outputStream.Resize(offset + blocksX * blocksY * dstBlockSize);
+		U8* dst = outputStream.data() + offset;
 
-					// write compressed block
-					const U32 dstAdd = ((heightIndex >> 2) * ((width + 3) >> 2) + (widthIndex >> 2)) * dstBlockSize;
-					rgbcx::encode_bc5(&dst[dstAdd], (const U8*)blockData, true, false);
+		JobSystem::JobHandle handle = JobSystem::INVALID_HANDLE;
+		JobSystem::RunJobs((I32)(tilesX * tilesY), 1,
+			[&](I32 tileIndex, JobSystem::JobGroupArgs*, void*)->bool {
+				
+				alignas(16) Pixel blockData[16];
+
+				const U32 tileX = (tileIndex % tilesX) * TILE_BLOCKS;
+				const U32 tileY = (tileIndex / tilesX) * TILE_BLOCKS;
+				const U32 tileEndX = std::min(tileX + TILE_BLOCKS, blocksX);
+				const U32 tileEndY = std::min(tileY + TILE_BLOCKS, blocksY);
+				for (U32 blockY = tileY; blockY < tileEndY; blockY++)
+				{
+					U8* dstRow = dst + (size_t)blockY * blocksX * dstBlockSize;
+					for (U32 blockX = tileX; blockX < tileEndX; blockX++)
+					{
+						GatherBlock((const Pixel*)data, width, height, blockX * 4, blockY * 4, blockData);
+						encoder(dstRow + blockX * dstBlockSize, (const U8*)blockData);
+					}
 				}
-
-				return true;
+				return false;
 			},
 			0, &handle);
 		JobSystem::Wait(&handle);
@@ -90,94 +163,156 @@ namespace TextureCompressor
 		return true;
 	}
 
-	bool CompressBC3(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height)
+	bool CompressRGBA(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality)
 	{
 		PROFILE_FUNCTION();
+		outputStream.Write(data, size);
+		return true;
+	}
 
-		// compressed block size: 4x4x4
-		const U32 dstBlockSize = 16;
-		const U32 compressedSize = GetCompressedMipSize(width, height, dstBlockSize);
-		U32 offset = outputStream.Size();
-		outputStream.Resize(offset + compressedSize);
-		U8* dst = outputStream.data() + offset;
+	bool CompressBC5(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality)
+	{
+		PROFILE_FUNCTION();
 
-		JobSystem::JobHandle handle = JobSystem::INVALID_HANDLE;
-		JobSystem::RunJobs((I32)height, 4,
-			[&](I32 heightIndex, JobSystem::JobGroupArgs*, void*)->bool {
+		// rgbcx has no levels of BC4/BC5, the quality is ignored
+		return CompressBlocks<U32>(data, size, outputStream, width, height, 16, [](U8* dst, const U8* pixels) {
+			rgbcx::encode_bc5(dst, pixels, 0, 1, 4);
+		});
+	}
 
-				U32 blockData[32];
+	bool CompressBC3(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality)
+	{
+		PROFILE_FUNCTION();
 
-				const U32 srcBlockHeight = std::min(height - heightIndex, 4u);
-				const U8* srcRowBegin = &data[heightIndex * width * 4];
-				for (int widthIndex = 0; widthIndex < width; widthIndex += 4)
-				{
-					const U8* srcBlockBegin = srcRowBegin + widthIndex * 4;
+		const U32 level = GetEncoderLevel(quality);
+		return CompressBlocks<U32>(data, size, outputStream, width, height, 16, [level](U8* dst, const U8* pixels) {
+			rgbcx::encode_bc3(level, dst, pixels);
+		});
+	}
 
-					// get block data
-					const U32 srcBlockWidth = std::min(width - widthIndex, 4u);
-					for (U32 h = 0; h < srcBlockHeight; h++) {
-						Memory::Memcpy(&blockData[h * 4], &srcBlockBegin[h * width * 4], 4 * srcBlockWidth);
-					}
+	bool CompressBC1(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality)
+	{
+		PROFILE_FUNCTION();
 
-					// write compressed block
-					const U32 dstAdd = ((heightIndex >> 2) * ((width + 3) >> 2) + (widthIndex >> 2)) * dstBlockSize;
-					rgbcx::encode_bc3(10, &dst[dstAdd], (const U8*)blockData);
-				}
+		const U32 level = GetEncoderLevel(quality);
+		return CompressBlocks<U32>(data, size, outputStream, width, height, 8, [level](U8* dst, const U8* pixels) {
+			rgbcx::encode_bc1(level, dst, pixels, true, false);
+		});
+	}
 
-				return true;
-			},
-			0, &handle);
-		JobSystem::Wait(&handle);
+	bool CompressBC7(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality)
+	{
+		PROFILE_FUNCTION();
 
-		return true;
+		const U32 level = GetBPTCLevel(quality);
+		return CompressBlocks<U32>(data, size, outputStream, width, height, 16, [level](U8* dst, const U8* pixels) {
+			BPTC::EncodeBC7(dst, pixels, level);
+		});
 	}
 
-	bool CompressBC1(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height)
+	bool CompressBC6H(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality)
 	{
 		PROFILE_FUNCTION();
 
-		// compressed block size: 4x4x4
-		const U32 dstBlockSize = 8;
-		const U32 compressedSize = GetCompressedMipSize(width, height, dstBlockSize);
-		U32 offset = outputStream.Size();
-		outputStream.Resize(offset + compressedSize);
-		U8* dst = outputStream.data() + offset;
-
-		JobSystem::JobHandle handle = JobSystem::INVALID_HANDLE;
-		JobSystem::RunJobs((I32)height, 4,
-			[&](I32 heightIndex, JobSystem::JobGroupArgs*, void*)->bool {
+		const U32 level = GetBPTCLevel(quality);
+		return CompressBlocks<XMFLOAT4>(data, size, outputStream, width, height, 16, [level](U8* dst, const U8* pixels) {
+			BPTC::EncodeBC6H(dst, (const F32*)pixels, level);
+		});
+	}
 
-				U32 blockData[32];
+	F64 ComputePSNR(GPU::FORMAT format, const U8* blocks, const U8* data, U32 width, U32 height)
+	{
+		const bool isHDR = format == GPU::FORMAT_BC6H_UF16;
+		U32 blockSize = 16;
+		U32 channels = 4;
+		switch (format)
+		{
+		case GPU::FORMAT_BC1_UNORM:
+			blockSize = 8;
+			channels = 3;
+			break;
+		case GPU::FORMAT_BC5_UNORM:
+			channels = 2;
+			break;
+		case GPU::FORMAT_BC6H_UF16:
+			channels = 3;
+			break;
+		case GPU::FORMAT_BC3_UNORM:
+		case GPU::FORMAT_BC7_UNORM:
+			break;
+		default:
+			return MAX_PSNR;
+		}
 
-				const U32 srcBlockHeight = std::min(height - heightIndex, 4u);
-				const U8* srcRowBegin = &data[heightIndex * width * 4];
-				for (int widthIndex = 0; widthIndex < width; widthIndex += 4)
+		const U32 blocksX = (width + 3) >> 2;
+		const U32 blocksY = (height + 3) >> 2;
+		F64 squaredError = 0.0;
+		F64 peak = isHDR ? 0.0 : 255.0;
+		for (U32 blockY = 0; blockY < blocksY; blockY++)
+		{
+			for (U32 blockX = 0; blockX < blocksX; blockX++)
+			{
+				const U8* block = blocks + (blockY * blocksX + blockX) * blockSize;
+				U8 decoded[16 * 4] = {};
+				F32 decodedHDR[16 * 4] = {};
+				switch (format)
 				{
-					const U8* srcBlockBegin = srcRowBegin + widthIndex * 4;
+				case GPU::FORMAT_BC1_UNORM:
+					rgbcx::unpack_bc1(block, decoded);
+					break;
+				case GPU::FORMAT_BC3_UNORM:
+					rgbcx::unpack_bc3(block, decoded);
+					break;
+				case GPU::FORMAT_BC5_UNORM:
+					rgbcx::unpack_bc5(block, decoded, 0, 1, 4);
+					break;
+				case GPU::FORMAT_BC7_UNORM:
+					BPTC::DecodeBC7(block, decoded);
+					break;
+				case GPU::FORMAT_BC6H_UF16:
+					BPTC::DecodeBC6H(block, decodedHDR);
+					break;
+				default:
+					break;
+				}
 
-					// get block data
-					const U32 srcBlockWidth = std::min(width - widthIndex, 4u);
-					for (U32 h = 0; h < srcBlockHeight; h++) {
-						Memory::Memcpy(&blockData[h * 4], &srcBlockBegin[h * width * 4], 4 * srcBlockWidth);
+				// pixels out of the image are ignored
+				for (U32 i = 0; i < 16; i++)
+				{
+					const U32 x = blockX * 4 + i % 4;
+					const U32 y = blockY * 4 + i / 4;
+					if (x >= width || y >= height) {
+						continue;
 					}
 
-					// write compressed block
-					const U32 dstAdd = ((heightIndex >> 2) * ((width + 3) >> 2) + (widthIndex >> 2)) * dstBlockSize;
-					rgbcx::encode_bc1(10, &dst[dstAdd], (const U8*)blockData, true, false);
+					for (U32 c = 0; c < channels; c++)
+					{
+						F64 diff = 0.0;
+						if (isHDR)
+						{
+							const F32 value = ((const F32*)data)[((size_t)y * width + x) * 4 + c];
+							peak = std::max(peak, (F64)value);
+							diff = (F64)decodedHDR[i * 4 + c] - std::max(value, 0.0f);
+						}
+						else
+						{
+							diff = (F64)decoded[i * 4 + c] - data[((size_t)y * width + x) * 4 + c];
+						}
+						squaredError += diff * diff;
+					}
 				}
+			}
+		}
 
-				return true;
-			},	
-			0, &handle);
-		JobSystem::Wait(&handle);
-
-		return true;
+		const F64 mse = squaredError / ((F64)width * height * channels);
+		return mse > 0.0 && peak > 0.0 ? std::min(10.0 * std::log10(peak * peak / mse), MAX_PSNR) : MAX_PSNR;
 	}
 
 	bool Compress(Compressor compressor, const Image& image, const Options& options, MemoryStream& dst, GPU::FORMAT compressedFormat)
 	{
-		const U32 mips = options.mIsGenerateMipmaps ? 1 + (U32)log2(std::max(image.GetWidth(), image.GetHeight())) : image.GetMipLevels();
+		const U32 mips = options.mIsGenerateMipmaps ? MipGenerator::GetMipCount(image.GetWidth(), image.GetHeight()) : image.GetMipLevels();
 		const U32 faces = options.mIsCubeMap ? 6 : 1;
+		const U32 slices = image.GetSlices();
 		U32 srcWidth = image.GetWidth();
 		U32 srcHeight = image.GetHeight();
 		U32 blockSize = GPU::GetFormatInfo(compressedFormat).mBlockBits >> 3;
@@ -185,10 +320,43 @@ namespace TextureCompressor
 		U32 compressedSize = GetCompressedSize(srcWidth, srcHeight, faces, mips, blockSize);
 		dst.Reserve(dst.Size() + compressedSize);
 
-		DynamicArray<U8> mipData;
-		DynamicArray<U8> prevMipData;
+		// generate mip chains of all slices and faces concurrently
+		const bool isHDR = image.GetFormat() == GPU::FORMAT_R32G32B32A32_FLOAT;
+		DynamicArray<MipGenerator::MipChain> mipChains;
+		F64 generateTime = 0.0;
+		if (options.mIsGenerateMipmaps && mips > 1)
+		{
+			MipGenerator::Options mipOptions;
+			mipOptions.mFilter = options.mMipFilter;
+			mipOptions.mIsSRGB = options.mIsRGB;
+			mipOptions.mIsNormalMap = options.mIsNormalMap;
+			mipOptions.mPreserveAlphaCoverage = options.mPreserveAlphaCoverage;
+			mipOptions.mAlphaCutoff = options.mAlphaCutoff;
+
+			const F64 startTime = Timer::GetAbsoluteTime();
+			mipChains.resize(slices * faces);
+			JobSystem::JobHandle handle = JobSystem::INVALID_HANDLE;
+			JobSystem::RunJobs((I32)(slices * faces), 1,
+				[&](I32 imageIndex, JobSystem::JobGroupArgs*, void*)->bool {
+					const auto& imgData = image.GetData(imageIndex / faces, imageIndex % faces, 0);
+					if (isHDR) {
+						MipGenerator::GenerateMips((const F32*)imgData.mMem.data(), srcWidth, srcHeight, mips, mipOptions, mipChains[imageIndex]);
+					}
+					else {
+						MipGenerator::GenerateMips(imgData.mMem.data(), srcWidth, srcHeight, mips, mipOptions, mipChains[imageIndex]);
+					}
+					return false;
+				},
+				0, &handle);
+			JobSystem::Wait(&handle);
+			generateTime = Timer::GetAbsoluteTime() - startTime;
+		}
 
-		for (U32 slice = 0; slice < image.GetSlices(); slice++)
+		// the PSNR is the worst of top mips
+		F64 psnr = MAX_PSNR;
+		F64 psnrTime = 0.0;
+		const F64 startTime = Timer::GetAbsoluteTime();
+		for (U32 slice = 0; slice < slices; slice++)
 		{
 			for (U32 face = 0; face < faces; face++)
 			{
@@ -196,42 +364,32 @@ namespace TextureCompressor
 				{
 					U32 mipWidth  = std::max(srcWidth  >> mip, 1u);
 					U32 mipHeight = std::max(srcHeight >> mip, 1u);
-					if (options.mIsGenerateMipmaps)
+					if (options.mIsGenerateMipmaps && mip > 0)
 					{
-						if (mip == 0)
-						{
-							const auto& imgData = image.GetData(slice, face, mip);
-							compressor(imgData.mMem.data(), imgData.mMem.Size(), dst, mipWidth, mipHeight);
-						}
-						else
-						{
-							mipData.resize(mipWidth * mipHeight * 4);
-							
-							// compute mipmap for (mipWidth, mipHeight)
-							U32 srcMipWidth  = std::max(srcWidth  >> (mip - 1), 1u);
-							U32 srcMipHeight = std::max(srcHeight >> (mip - 1), 1u);
-							if (mip == 1)
-							{
-								const auto& imgData = image.GetData(slice, face, 0);
-								ComputeMip(imgData.mMem.data(), imgData.mMem.Size(), mipData.data(), mipData.size(), srcMipWidth, srcMipHeight, mipWidth, mipHeight, options.mIsRGB);
-							}
-							else
-							{
-								ComputeMip(prevMipData.data(), prevMipData.size(), mipData.data(), mipData.size(), srcMipWidth, srcMipHeight, mipWidth, mipHeight, options.mIsRGB);
-							}
-
-							compressor(mipData.data(), mipData.size(), dst, mipWidth, mipHeight);
-							prevMipData.swap(mipData);
-						}
+						const auto& mipData = mipChains[slice * faces + face][mip - 1];
+						compressor(mipData.data(), mipData.size(), dst, mipWidth, mipHeight, options.mQuality);
 					}
 					else
 					{
 						const auto& imgData = image.GetData(slice, face, mip);
-						compressor(imgData.mMem.data(), imgData.mMem.Size(), dst, mipWidth, mipHeight);
+						const U32 offset = dst.Size();
+						compressor(imgData.mMem.data(), imgData.mMem.Size(), dst, mipWidth, mipHeight, options.mQuality);
+
+						if (mip == 0)
+						{
+							const F64 psnrStartTime = Timer::GetAbsoluteTime();
+							psnr = std::min(psnr, ComputePSNR(compressedFormat, dst.data() + offset, imgData.mMem.data(), mipWidth, mipHeight));
+							psnrTime += Timer::GetAbsoluteTime() - psnrStartTime;
+						}
 					}
 				}
 			}
 		}
+		const F64 compressTime = Timer::GetAbsoluteTime() - startTime - psnrTime;
+
+		Logger::Info("[TextureCompressor] %s %dx%d, %d mips, %d images, generate mips:%.2fms, compress:%.2fms, PSNR:%.2fdB",
+			EnumTraits::EnumToName(compressedFormat).data(), srcWidth, srcHeight, mips, slices * faces,
+			generateTime * 1000.0, compressTime * 1000.0, psnr);
 
 		return true;
 	}
@@ -239,8 +397,6 @@ namespace TextureCompressor
 	bool Compress(const Image& image, const Options& options, MemoryStream& dst)
 	{
 		PROFILE_FUNCTION();
-		static OnceInitializer initializer;
-
 		if (!image) {
 			return false;
 		}
@@ -248,12 +404,18 @@ namespace TextureCompressor
 		bool canCompress = options.mIsCompress;
 		canCompress &= (image.GetWidth() % 4 == 0) && (image.GetHeight() % 4 == 0);
 
-		GPU::FORMAT format = GPU::FORMAT::FORMAT_R8G8B8A8_UNORM;
+		GPU::FORMAT format = image.GetFormat();
 		if (canCompress)
 		{
-			if (options.mIsNormalMap) {
+			if (format == GPU::FORMAT_R32G32B32A32_FLOAT) {
+				format = GPU::FORMAT::FORMAT_BC6H_UF16;
+			}
+			else if (options.mIsNormalMap) {
 				format = GPU::FORMAT::FORMAT_BC5_UNORM;
 			}
+			else if (options.mFormat == GPU::FORMAT_BC7_UNORM) {
+				format = GPU::FORMAT::FORMAT_BC7_UNORM;
+			}
 			else if (image.HasAlpha()) {
 				format = GPU::FORMAT::FORMAT_BC3_UNORM;
 			}
@@ -272,6 +434,7 @@ namespace TextureCompressor
 		switch (format)
 		{
 		case Cjing3D::GPU::FORMAT_R8G8B8A8_UNORM:
+		case Cjing3D::GPU::FORMAT_R32G32B32A32_FLOAT:
 			ret = Compress(CompressRGBA, image, options, dst, format);
 			break;
 		case Cjing3D::GPU::FORMAT_BC5_UNORM:
@@ -283,6 +446,12 @@ namespace TextureCompressor
 		case Cjing3D::GPU::FORMAT_BC1_UNORM:
 			ret = Compress(CompressBC1,  image, options, dst, format);
 			break;
+		case Cjing3D::GPU::FORMAT_BC7_UNORM:
+			ret = Compress(CompressBC7,  image, options, dst, format);
+			break;
+		case Cjing3D::GPU::FORMAT_BC6H_UF16:
+			ret = Compress(CompressBC6H, image, options, dst, format);
+			break;
 		default:
 			break;
 		}
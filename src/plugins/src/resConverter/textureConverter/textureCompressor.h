@@ -3,26 +3,60 @@
 #include "core\common\common.h"
 #include "core\helper\stream.h"
 #include "image.h"
+#include "mipGenerator.h"
 
 namespace Cjing3D
 {
 namespace TextureCompressor
 {
-	using Compressor = Function<bool(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height)>;
+	// quality presets of block compression, BC1/BC3 use rgbcx levels, BC7/BC6H use BPTC levels,
+	// BC4/BC5 have a single encoder and ignore the quality
+	enum class Quality
+	{
+		FAST,		// BC1/BC3: rgbcx level 0, comparable to stb_dxt. BC7/BC6H: bounding box endpoints, no refinement
+		NORMAL,		// BC1/BC3: rgbcx level 10. BC7/BC6H: principal axis endpoints with one least squares refinement
+		HIGH,		// BC1/BC3: rgbcx level 18, the slowest. BC7/BC6H: three refinements, BC7 also tries mode 5 with channel rotations
+	};
+
+	// PSNR of lossless data
+	static const F64 MAX_PSNR = 100.0;
+
+	using Compressor = Function<bool(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality)>;
 
 	struct Options
 	{
+		Quality mQuality = Quality::NORMAL;
 		bool mIsCompress = true;
 		bool mIsGenerateMipmaps = false;
 		bool mIsNormalMap = false;
 		bool mIsRGB = false;
 		bool mIsCubeMap = false;
+
+		// BC7_UNORM to compress color maps with BC7 instead of BC1/BC3, HDR images are always
+		// compressed with BC6H_UF16, other formats are selected automatically
+		GPU::FORMAT mFormat = GPU::FORMAT_UNKNOWN;
+
+		// mip generation, mIsRGB means rgb is in sRGB space
+		MipGenerator::Filter mMipFilter = MipGenerator::Filter::KAISER;
+		bool mPreserveAlphaCoverage = false;
+		F32 mAlphaCutoff = 0.5f;
 	};
 
-	bool CompressRGBA(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height);
-	bool CompressBC5(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height);
-	bool CompressBC3(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height);
-	bool CompressBC1(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height);
+	// blocks are compressed in tiles of TILE_BLOCKS x TILE_BLOCKS on the JobSystem, a tile of
+	// 128x128 pixels is 64KB of source pixels, so that a tile is kept in the L2 cache
+	static const U32 TILE_BLOCKS = 32;
+
+	bool CompressRGBA(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality = Quality::NORMAL);
+	bool CompressBC5(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality = Quality::NORMAL);
+	bool CompressBC3(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality = Quality::NORMAL);
+	bool CompressBC1(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality = Quality::NORMAL);
+	bool CompressBC7(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality = Quality::NORMAL);
+	// data is RGBA32F pixels
+	bool CompressBC6H(const U8* data, U32 size, MemoryStream& outputStream, U32 width, U32 height, Quality quality = Quality::NORMAL);
+
+	// PSNR of compressed blocks against source pixels, BC6H is measured on rgb with the peak of
+	// the source as the max value, BC5 is measured on rg. MAX_PSNR if the data is lossless
+	F64 ComputePSNR(GPU::FORMAT format, const U8* blocks, const U8* data, U32 width, U32 height);
 
 	bool Compress(Compressor compressor, const Image& image, const Options& options, MemoryStream& dst, GPU::FORMAT compressedFormat);
 	bool Compress(const Image& image, const Options& options, MemoryStream& dst);
@@ -18,6 +18,11 @@ namespace Cjing3D
 		archive.Write("format", mFormat);
 		archive.Write("generateMipmap", mGenerateMipmap);
 		archive.Write("normalmap", mIsNormalMap);
+		archive.Write("quality", mQuality);
+		archive.Write("srgb", mIsSRGB);
+		archive.Write("mipFilter", mMipFilter);
+		archive.Write("alphaCoverage", mPreserveAlphaCoverage);
+		archive.Write("alphaCutoff", mAlphaCutoff);
 	}
 
 	void TextureMetaObject::Unserialize(JsonArchive& archive) 
@@ -25,6 +30,11 @@ namespace Cjing3D
 		archive.Read("format", mFormat);
 		archive.Read("generateMipmap", mGenerateMipmap);
 		archive.Read("normalmap", mIsNormalMap);
+		archive.Read("quality", mQuality);
+		archive.Read("srgb", mIsSRGB);
+		archive.Read("mipFilter", mMipFilter);
+		archive.Read("alphaCoverage", mPreserveAlphaCoverage);
+		archive.Read("alphaCutoff", mAlphaCutoff);
 	}
 
 	bool TextureResConverter::Convert(ResConverterContext& context, const ResourceType& type, const char* src, const char* dest)
@@ -61,7 +71,7 @@ namespace Cjing3D
 		texDesc.mWidth = img.GetWidth();
 		texDesc.mHeight = img.GetHeight();
 		texDesc.mDepth = img.GetDepth();
-		texDesc.mMipLevels = img.GetMipLevels();
+		texDesc.mMipLevels = metaData.mGenerateMipmap ? MipGenerator::GetMipCount(img.GetWidth(), img.GetHeight()) : img.GetMipLevels();
 		texDesc.mArraySize = 1;
 		texDesc.mFormat = img.GetFormat();
 		texDesc.mUsage = GPU::USAGE_IMMUTABLE;
@@ -84,6 +94,13 @@ namespace Cjing3D
 		// 2. compile image data
 		TextureCompressor::Options options;
 		options.mIsGenerateMipmaps = metaData.mGenerateMipmap;
+		options.mIsNormalMap = metaData.mIsNormalMap;
+		options.mQuality = metaData.mQuality;
+		options.mFormat = metaData.mFormat;
+		options.mIsRGB = metaData.mIsSRGB;
+		options.mMipFilter = metaData.mMipFilter;
+		options.mPreserveAlphaCoverage = metaData.mPreserveAlphaCoverage;
+		options.mAlphaCutoff = metaData.mAlphaCutoff;
 		if (!TextureCompressor::Compress(img, options, stream))
 		{
 			Logger::Warning("[TextureConverter] failed to compile image:%s.", src);
@@ -149,6 +166,46 @@ namespace Cjing3D
 		// show image meta editor
 		ImGui::Separator();
 
+		ImGuiEx::VLeftLabel("Normal map");
+		ImGui::Checkbox("##normalmap", &mCurrentTextureMeta.mIsNormalMap);
+
+		const char* qualityNames[] = { "Fast", "Normal", "High" };
+		I32 quality = (I32)mCurrentTextureMeta.mQuality;
+		ImGuiEx::VLeftLabel("Quality");
+		if (ImGui::Combo("##quality", &quality, qualityNames, (I32)std::size(qualityNames))) {
+			mCurrentTextureMeta.mQuality = (TextureCompressor::Quality)quality;
+		}
+
+		bool isBC7 = mCurrentTextureMeta.mFormat == GPU::FORMAT_BC7_UNORM;
+		ImGuiEx::VLeftLabel("BC7");
+		if (ImGui::Checkbox("##bc7", &isBC7)) {
+			mCurrentTextureMeta.mFormat = isBC7 ? GPU::FORMAT_BC7_UNORM : GPU::FORMAT_UNKNOWN;
+		}
+
+		ImGuiEx::VLeftLabel("sRGB");
+		ImGui::Checkbox("##srgb", &mCurrentTextureMeta.mIsSRGB);
+
+		ImGuiEx::VLeftLabel("Generate mips");
+		ImGui::Checkbox("##generateMipmap", &mCurrentTextureMeta.mGenerateMipmap);
+
+		if (mCurrentTextureMeta.mGenerateMipmap)
+		{
+			const char* mipFilterNames[] = { "Box", "Kaiser", "Lanczos" };
+			I32 mipFilter = (I32)mCurrentTextureMeta.mMipFilter;
+			ImGuiEx::VLeftLabel("Mip filter");
+			if (ImGui::Combo("##mipFilter", &mipFilter, mipFilterNames, (I32)std::size(mipFilterNames))) {
+				mCurrentTextureMeta.mMipFilter = (MipGenerator::Filter)mipFilter;
+			}
+
+			ImGuiEx::VLeftLabel("Alpha coverage");
+			ImGui::Checkbox("##alphaCoverage", &mCurrentTextureMeta.mPreserveAlphaCoverage);
+			if (mCurrentTextureMeta.mPreserveAlphaCoverage)
+			{
+				ImGuiEx::VLeftLabel("Alpha cutoff");
+				ImGui::SliderFloat("##alphaCutoff", &mCurrentTextureMeta.mAlphaCutoff, 0.0f, 1.0f);
+			}
+		}
+
 		if (ImGui::Button("Apply")) {
 			context.SetMetaData<TextureMetaObject>(mCurrentTextureMeta);
 		}
@@ -160,6 +217,7 @@ namespace Cjing3D
 			(EqualString(ext, "jpg") ||
 			 EqualString(ext, "png") ||
 			 EqualString(ext, "jpeg") ||
+			 EqualString(ext, "hdr") ||
 			 EqualString(ext, "dds"));
 	}
 }
\ No newline at end of file
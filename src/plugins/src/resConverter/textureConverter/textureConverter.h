@@ -3,6 +3,7 @@
 #include "resource\converter.h"
 #include "core\serialization\serializedObject.h"
 #include "gpu\gpu.h"
+#include "textureCompressor.h"
 
 namespace Cjing3D
 {
@@ -15,7 +16,12 @@ namespace Cjing3D
 		GPU::FORMAT mFormat = GPU::FORMAT_UNKNOWN;
 		bool mGenerateMipmap = false;
 		bool mIsNormalMap = false;
+		bool mIsSRGB = true;
 		F32 mMipScale = -1.0f;
+		TextureCompressor::Quality mQuality = TextureCompressor::Quality::NORMAL;
+		MipGenerator::Filter mMipFilter = MipGenerator::Filter::KAISER;
+		bool mPreserveAlphaCoverage = false;
+		F32 mAlphaCutoff = 0.5f;
 
 		enum WrapMode
 		{
@@ -38,9 +44,12 @@ namespace Cjing3D
 	class TextureResConverter : public IResConverter
 	{
 	public:
+		static const U32 VERSION = 4;
+
 		void OnEditorGUI(ResConverterContext& context, const ResourceType& type, Resource* res)override;
 		bool SupportsType(const char* ext, const ResourceType& type)override;
 		bool Convert(ResConverterContext& context, const ResourceType& type, const char* src, const char* dest) override;
+		U32 GetVersion(const ResourceType& type)override { return VERSION; }
 	
 	private:
 		GPU::ResHandle mCurrentTexture;
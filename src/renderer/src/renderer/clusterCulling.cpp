@@ -0,0 +1,74 @@
+#include "clusterCulling.h"
+#include "core\helper\profiler.h"
+
+namespace Cjing3D
+{
+	bool ClusterCulling::IsBackfacing(const ModelMeshlet& meshlet, const F32x3& eye)
+	{
+		// normals are spread over a hemisphere
+		if (meshlet.mConeCutoff >= 1.0f) {
+			return false;
+		}
+
+		const VECTOR dir = XMVectorSubtract(XMLoad(meshlet.mConeApex), XMLoad(eye));
+		const F32 distance = XMVectorGetX(XMVector3Length(dir));
+		return XMVectorGetX(XMVector3Dot(dir, XMLoad(meshlet.mConeAxis))) >= meshlet.mConeCutoff * distance;
+	}
+
+	U32 ClusterCulling::CullMeshlets(const ModelMeshlet* meshlets, U32 count, const F32x4x4& world, const Frustum& frustum, const F32x3& eye, DynamicArray<ClusterDraw>& draws, CullingStats* stats)
+	{
+		PROFILE_FUNCTION();
+		draws.clear();
+		if (meshlets == nullptr || count == 0) {
+			return 0;
+		}
+
+		// cone tests are in object space, which is exact for affine transforms,
+		// the winding is reversed by mirrored transforms, so they are skipped
+		const MATRIX worldMat = XMLoad(world);
+		const bool isMirrored = XMVectorGetX(XMMatrixDeterminant(worldMat)) < 0.0f;
+		const F32x3 localEye = Vector3Transform(eye, XMMatrixInverse(nullptr, worldMat));
+
+		// bounding spheres are scaled by the max axis scale
+		const F32 maxScale = std::max(std::max(
+			XMVectorGetX(XMVector3Length(worldMat.r[0])),
+			XMVectorGetX(XMVector3Length(worldMat.r[1]))),
+			XMVectorGetX(XMVector3Length(worldMat.r[2])));
+
+		CullingStats cullingStats;
+		for (U32 i = 0; i < count; i++)
+		{
+			const ModelMeshlet& meshlet = meshlets[i];
+			if (!isMirrored && IsBackfacing(meshlet, localEye))
+			{
+				cullingStats.mBackfaceCulled++;
+				continue;
+			}
+
+			const Sphere sphere(Vector3Transform(meshlet.mCenter, worldMat), meshlet.mRadius * maxScale);
+			if (!frustum.Overlaps(sphere))
+			{
+				cullingStats.mFrustumCulled++;
+				continue;
+			}
+
+			// merge adjacent meshlets
+			if (!draws.empty() && draws.back().mIndexOffset + draws.back().mIndexCount == (U32)meshlet.mIndexOffset)
+			{
+				draws.back().mIndexCount += (U32)meshlet.mIndices;
+			}
+			else
+			{
+				ClusterDraw& draw = draws.emplace();
+				draw.mIndexOffset = (U32)meshlet.mIndexOffset;
+				draw.mIndexCount = (U32)meshlet.mIndices;
+			}
+			cullingStats.mVisible++;
+		}
+
+		if (stats != nullptr) {
+			*stats = cullingStats;
+		}
+		return cullingStats.mVisible;
+	}
+}
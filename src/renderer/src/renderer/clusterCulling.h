@@ -0,0 +1,34 @@
+#pragma once
+
+#include "model.h"
+#include "math\intersectable.h"
+
+namespace Cjing3D
+{
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// ClusterCulling
+	/// CPU culling of meshlets before draw submission. Meshlets out of the frustum or back-facing to
+	/// the eye are rejected, visible meshlets of contiguous index ranges are merged into draws.
+	namespace ClusterCulling
+	{
+		struct ClusterDraw
+		{
+			U32 mIndexOffset = 0;
+			U32 mIndexCount = 0;
+		};
+
+		struct CullingStats
+		{
+			U32 mVisible = 0;
+			U32 mFrustumCulled = 0;
+			U32 mBackfaceCulled = 0;
+		};
+
+		// test the meshlet in object space, eye is in object space
+		bool IsBackfacing(const ModelMeshlet& meshlet, const F32x3& eye);
+
+		// world is the transform of the object, frustum and eye are in world space,
+		// draws are cleared and the count of visible meshlets is returned
+		U32 CullMeshlets(const ModelMeshlet* meshlets, U32 count, const F32x4x4& world, const Frustum& frustum, const F32x3& eye, DynamicArray<ClusterDraw>& draws, CullingStats* stats = nullptr);
+	}
+}
@@ -7,179 +7,244 @@ namespace Cjing3D
 {
 	const U32 ModelGeneralHeader::MAGIC = 0x149B6314;
 
-	class ModelFactory : public ResourceFactory
+	void ModelFactory::RegisterExtensions()
 	{
-	public:
-		virtual void RegisterExtensions()
+		ResourceManager::RegisterExtension("obj", Model::ResType);
+		ResourceManager::RegisterExtension("fbx", Model::ResType);
+		ResourceManager::RegisterExtension("gltf",Model::ResType);
+	}
+
+	Resource* ModelFactory::CreateResource()
+	{
+		Model* model = CJING_NEW(Model);
+		return model;
+	}
+
+	bool ModelFactory::ParseMesh(ModelImpl& impl, ModelGeneralHeader& header, Model& model, InputMemoryStream& inputStream)
+	{
+		if (!GPU::IsInitialized()) {
+			return false;
+		}
+
+		if (header.mNumMeshes <= 0 || header.mNumMeshInstDatas <= 0) {
+			return false;
+		}
+
+		// meshInstDatas
+		DynamicArray<MeshInstData> meshInstDatas;
+		meshInstDatas.resize(header.mNumMeshInstDatas);
+		if (!inputStream.Read(meshInstDatas.data(), header.mNumMeshInstDatas * sizeof(MeshInstData)))
 		{
-			ResourceManager::RegisterExtension("obj", Model::ResType);
-			ResourceManager::RegisterExtension("fbx", Model::ResType);
-			ResourceManager::RegisterExtension("gltf",Model::ResType);
+			Logger::Warning("Failed to read MeshInstDatas");
+			return false;
 		}
 
-		virtual Resource* CreateResource()
+		// meshes
+		DynamicArray<ModelMeshData> modelMeshDatas;
+		modelMeshDatas.resize(header.mNumMeshes);
+		if (!inputStream.Read(modelMeshDatas.data(), header.mNumMeshes * sizeof(ModelMeshData)))
 		{
-			Model* model = CJING_NEW(Model);
-			return model;
+			Logger::Warning("Failed to read ModelMeshDatas");
+			return false;
 		}
 
-		bool ParseMesh(ModelImpl& impl, ModelGeneralHeader& header, Model& model, InputMemoryStream& inputStream)
+		int numVertexElements = 0;
+		int numSubMeshes = 0;
+		int numMeshlets = 0;
+		int indexDataSize = 0;
+		int vertexDataSize = 0;
+		for (auto& meshData : modelMeshDatas)
 		{
-			if (!GPU::IsInitialized()) {
+			if (meshData.mNumLods < 1 || meshData.mNumLods > MODEL_MAX_LODS)
+			{
+				Logger::Warning("Invalid lod count of mesh:%s", meshData.mName);
 				return false;
 			}
 
-			if (header.mNumMeshes <= 0 || header.mNumMeshInstDatas <= 0) {
-				return false;
-			}
+			numVertexElements += meshData.mNumVertexElements;
+			numSubMeshes += meshData.mNumSubMeshes * meshData.mNumLods;
+			numMeshlets += meshData.mNumMeshlets;
+			vertexDataSize += meshData.mVertexElementSize * meshData.mVertices;
+			indexDataSize += GetModelIndexStride(meshData.mIndexFormat) * meshData.mIndices;
+		}
 
-			// meshInstDatas
-			DynamicArray<MeshInstData> meshInstDatas;
-			meshInstDatas.resize(header.mNumMeshInstDatas);
-			if (!inputStream.Read(meshInstDatas.data(), header.mNumMeshInstDatas * sizeof(MeshInstData)))
+		// vertex elements
+		DynamicArray<GPU::VertexElement> vertexElements;
+		if (numVertexElements > 0)
+		{
+			vertexElements.resize(numVertexElements);
+			if (!inputStream.Read(vertexElements.data(), numVertexElements * sizeof(GPU::VertexElement)))
 			{
-				Logger::Warning("Failed to read MeshInstDatas");
+				Logger::Warning("Failed to read VertexElements");
 				return false;
 			}
+		}
 
-			// meshes
-			DynamicArray<ModelMeshData> modelMeshDatas;
-			if (!inputStream.Read(modelMeshDatas.data(), header.mNumMeshes * sizeof(ModelMeshData)))
+		// sub meshes
+		DynamicArray<ModelSubMesh> subMeshes;
+		if (numSubMeshes > 0)
+		{
+			subMeshes.resize(numSubMeshes);
+			if (!inputStream.Read(subMeshes.data(), numSubMeshes * sizeof(ModelSubMesh)))
 			{
-				Logger::Warning("Failed to read ModelMeshDatas");
+				Logger::Warning("Failed to read ModelSubMeshes");
 				return false;
 			}
+		}
 
-			int numVertexElements = 0;
-			int numSubMeshes = 0;
-			int numIndices = 0;
-			int vertexDataSize = 0;
-			for (auto& meshData : modelMeshDatas)
-			{
-				numVertexElements += meshData.mNumVertexElements;
-				numSubMeshes += meshData.mNumSubMeshes;
-				vertexDataSize += meshData.mVertexElementSize * meshData.mVertices;
-				numIndices += meshData.mIndices;
-			}
-
-			// vertex elements
-			DynamicArray<GPU::VertexElement> vertexElements;
-			if (numVertexElements > 0)
+		// meshlets
+		DynamicArray<ModelMeshlet> meshlets;
+		if (numMeshlets > 0)
+		{
+			meshlets.resize(numMeshlets);
+			if (!inputStream.Read(meshlets.data(), numMeshlets * sizeof(ModelMeshlet)))
 			{
-				vertexElements.resize(numVertexElements);
-				if (!inputStream.Read(vertexElements.data(), numVertexElements * sizeof(GPU::VertexElement)))
-				{
-					Logger::Warning("Failed to read VertexElements");
-					return false;
-				}
+				Logger::Warning("Failed to read ModelMeshlets");
+				return false;
 			}
+		}
 
-			// sub meshes
-			DynamicArray<ModelSubMesh> subMeshes;
-			if (numSubMeshes > 0)
+		// vertices
+		if (vertexDataSize > 0)
+		{
+			impl.mVertexData.resize(vertexDataSize);
+			if (!inputStream.Read(impl.mVertexData.data(), vertexDataSize))
 			{
-				subMeshes.resize(numSubMeshes);
-				if (!inputStream.Read(subMeshes.data(), numSubMeshes * sizeof(ModelSubMesh)))
-				{
-					Logger::Warning("Failed to read ModelSubMeshes");
-					return false;
-				}
+				Logger::Warning("Failed to read vertex data");
+				return false;
 			}
+		}
 
-			// vertices 
-			if (vertexDataSize > 0)
-			{
-				impl.mVertexData.resize(vertexDataSize);
-				if (!inputStream.Read(impl.mVertexData.data(), vertexDataSize))
-				{
-					Logger::Warning("Failed to read vertex data");
-					return false;
-				}
-			}
-			
-			// indices
-			if (numIndices > 0)
+		// indices, 16bit or 32bit for each mesh
+		if (indexDataSize > 0)
+		{
+			impl.mIndexData.resize(indexDataSize);
+			if (!inputStream.Read(impl.mIndexData.data(), indexDataSize))
 			{
-				impl.mIndices.resize(numIndices);
-				if (!inputStream.Read(impl.mIndices.data(), numIndices * sizeof(I32)))
-				{
-					Logger::Warning("Failed to read indices data");
-					return false;
-				}
+				Logger::Warning("Failed to read indices data");
+				return false;
 			}
+		}
 
-			// initialize model
-			impl.mMeshes.resize(modelMeshDatas.size());
-			for (ModelMeshData& meshData : modelMeshDatas)
-			{
+		// initialize model
+		impl.mMeshes.resize(modelMeshDatas.size());
+		for (I32 i = 0; i < modelMeshDatas.size(); i++)
+		{
+			const ModelMeshData& meshData = modelMeshDatas[i];
+			ModelMesh& mesh = impl.mMeshes[i];
+			mesh.mVertexElements.insert(
+				vertexElements.data() + meshData.mStartVertexElements,
+				vertexElements.data() + meshData.mStartVertexElements + meshData.mNumVertexElements);
+			mesh.mVertexElementSize = meshData.mVertexElementSize;
+			mesh.mVertices = meshData.mVertices;
+			mesh.mVertexDataOffset = meshData.mVertexDataOffset;
+			mesh.mIndices = meshData.mIndices;
+			mesh.mIndexDataOffset = meshData.mIndexDataOffset;
+			mesh.mIndexFormat = (GPU::IndexFormat)meshData.mIndexFormat;
+			mesh.mPositionOffset = meshData.mPositionOffset;
+			mesh.mPositionScale = meshData.mPositionScale;
 
-			}
+			mesh.mMeshlets.insert(
+				meshlets.data() + meshData.mStartMeshlets,
+				meshlets.data() + meshData.mStartMeshlets + meshData.mNumMeshlets);
 
-			for (MeshInstData& instData : meshInstDatas)
-			{
-				ModelMesh& mesh = impl.mMeshes[instData.mMeshIndex];
-				ModelSubMesh& subMesh = subMeshes[instData.mSubMeshIndex];
-				mesh.mSubMeshes.push(subMesh);
+			mesh.mLods.resize(meshData.mNumLods - 1);
+			for (I32 lod = 1; lod < meshData.mNumLods; lod++) {
+				mesh.mLods[lod - 1].mError = meshData.mLodErrors[lod];
 			}
-
-			return true;
 		}
 
-		virtual bool LoadResource(Resource* resource, const char* name, U64 size, const U8* data)
+		// submesh index of meshInstData is local to the mesh
+		for (MeshInstData& instData : meshInstDatas)
 		{
-			Model* model = reinterpret_cast<Model*>(resource);
-			if (!model || size <= 0 || data == nullptr) {
-				return false;
-			}
-
-			if (!GPU::IsInitialized()) {
+			if (instData.mMeshIndex < 0 || instData.mMeshIndex >= modelMeshDatas.size())
+			{
+				Logger::Warning("Invalid mesh index of MeshInstData");
 				return false;
 			}
 
-			InputMemoryStream inputStream(data, (U32)size);
-
-			// read shader general header
-			ModelGeneralHeader generalHeader;
-			if (!inputStream.Read(&generalHeader, sizeof(generalHeader)))
+			const ModelMeshData& meshData = modelMeshDatas[instData.mMeshIndex];
+			if (instData.mSubMeshIndex < 0 || instData.mSubMeshIndex >= meshData.mNumSubMeshes)
 			{
-				Logger::Warning("Failed to read model general header");
+				Logger::Warning("Invalid submesh index of MeshInstData");
 				return false;
 			}
 
-			// check magic and version
-			if (generalHeader.mMagic != ModelGeneralHeader::MAGIC ||
-				generalHeader.mMajor != ModelGeneralHeader::MAJOR ||
-				generalHeader.mMinor != ModelGeneralHeader::MINOR)
+			// meshlet index of submesh is local to the mesh
+			const ModelSubMesh& subMesh = subMeshes[meshData.mStartSubMeshes + instData.mSubMeshIndex];
+			if (subMesh.mStartMeshlets < 0 || subMesh.mStartMeshlets + subMesh.mNumMeshlets > meshData.mNumMeshlets)
 			{
-				Logger::Warning("Model version mismatch.");
+				Logger::Warning("Invalid meshlets of submesh");
 				return false;
 			}
 
-			ModelImpl* impl = CJING_NEW(ModelImpl);
-			// parse meshes
-			if (!ParseMesh(*impl, generalHeader, *model, inputStream))
+			ModelMesh& mesh = impl.mMeshes[instData.mMeshIndex];
+			mesh.mSubMeshes.push(subMesh);
+			for (I32 lod = 1; lod < meshData.mNumLods; lod++)
 			{
-				Logger::Warning("Failed to parse model");
-				CJING_SAFE_DELETE(impl);
-				return false;
+				const I32 subMeshIndex = meshData.mStartSubMeshes + lod * meshData.mNumSubMeshes + instData.mSubMeshIndex;
+				mesh.mLods[lod - 1].mSubMeshes.push(subMeshes[subMeshIndex]);
 			}
+		}
+
+		return true;
+	}
+
+	bool ModelFactory::LoadResource(Resource* resource, const char* name, U64 size, const U8* data)
+	{
+		Model* model = reinterpret_cast<Model*>(resource);
+		if (!model || size <= 0 || data == nullptr) {
+			return false;
+		}
 
-			model->mImpl = impl;
-			Logger::Info("[Resource] Model loaded successful:%s.", name);
-			return true;
+		if (!GPU::IsInitialized()) {
+			return false;
 		}
 
-		virtual bool DestroyResource(Resource* resource)
+		InputMemoryStream inputStream(data, (U32)size);
+
+		// read shader general header
+		ModelGeneralHeader generalHeader;
+		if (!inputStream.Read(&generalHeader, sizeof(generalHeader)))
 		{
-			if (resource == nullptr) {
-				return false;
-			}
+			Logger::Warning("Failed to read model general header");
+			return false;
+		}
+
+		// check magic and version
+		if (generalHeader.mMagic != ModelGeneralHeader::MAGIC ||
+			generalHeader.mMajor != ModelGeneralHeader::MAJOR ||
+			generalHeader.mMinor != ModelGeneralHeader::MINOR)
+		{
+			Logger::Warning("Model version mismatch.");
+			return false;
+		}
 
-			Model* model = reinterpret_cast<Model*>(resource);
-			CJING_DELETE(model);
-			return true;
+		ModelImpl* impl = CJING_NEW(ModelImpl);
+		// parse meshes
+		if (!ParseMesh(*impl, generalHeader, *model, inputStream))
+		{
+			Logger::Warning("Failed to parse model");
+			CJING_SAFE_DELETE(impl);
+			return false;
 		}
-	};
+
+		model->mImpl = impl;
+		Logger::Info("[Resource] Model loaded successful:%s.", name);
+		return true;
+	}
+
+	bool ModelFactory::DestroyResource(Resource* resource)
+	{
+		if (resource == nullptr) {
+			return false;
+		}
+
+		Model* model = reinterpret_cast<Model*>(resource);
+		CJING_DELETE(model);
+		return true;
+	}
+
 	DEFINE_RESOURCE(Model, "Model");
 
 	Model::Model()
@@ -188,5 +253,29 @@ namespace Cjing3D
 
 	Model::~Model()
 	{
+		CJING_SAFE_DELETE(mImpl);
+	}
+
+	I32 Model::GetMeshCount() const
+	{
+		return mImpl != nullptr ? mImpl->mMeshes.size() : 0;
+	}
+
+	const ModelMesh* Model::GetMesh(I32 index) const
+	{
+		if (mImpl == nullptr || index < 0 || index >= mImpl->mMeshes.size()) {
+			return nullptr;
+		}
+		return &mImpl->mMeshes[index];
+	}
+
+	Span<const char> Model::GetVertexData() const
+	{
+		return mImpl != nullptr ? Span<const char>(mImpl->mVertexData.data(), mImpl->mVertexData.size()) : Span<const char>();
+	}
+
+	Span<const char> Model::GetIndexData() const
+	{
+		return mImpl != nullptr ? Span<const char>(mImpl->mIndexData.data(), mImpl->mIndexData.size()) : Span<const char>();
 	}
 }
\ No newline at end of file
@@ -10,11 +10,51 @@ namespace Cjing3D
 	{
 		I32 mIndexOffset = 0;
 		I32 mIndices = 0;
+
+		// meshlets of the submesh, only built for lod 0
+		I32 mStartMeshlets = 0;
+		I32 mNumMeshlets = 0;
+	};
+
+	// cluster of triangles in a contiguous index range of the submesh, bounds are in object space
+	struct ModelMeshlet
+	{
+		I32 mIndexOffset = 0;
+		I32 mIndices = 0;
+		I32 mVertices = 0;
+
+		// bounding sphere
+		F32x3 mCenter = F32x3(0.0f, 0.0f, 0.0f);
+		F32 mRadius = 0.0f;
+
+		// normal cone of front faces, the meshlet is back-facing if dot(normalize(apex - eye), axis) >= cutoff
+		F32x3 mConeApex = F32x3(0.0f, 0.0f, 0.0f);
+		F32x3 mConeAxis = F32x3(0.0f, 0.0f, 1.0f);
+		F32 mConeCutoff = 1.0f;
+	};
+
+	struct ModelMeshLod
+	{
+		F32 mError = 0.0f;	// relative to the bounding radius of the mesh
+		DynamicArray<ModelSubMesh> mSubMeshes;
 	};
 
 	struct ModelMesh
 	{
 		DynamicArray<ModelSubMesh> mSubMeshes;
+		DynamicArray<ModelMeshLod> mLods;	// simplified lods, except lod 0
+		DynamicArray<ModelMeshlet> mMeshlets;
+		DynamicArray<GPU::VertexElement> mVertexElements;
+		I32 mVertexElementSize = 0;
+		I32 mVertices = 0;
+		I32 mVertexDataOffset = 0;
+		I32 mIndices = 0;
+		I32 mIndexDataOffset = 0;
+		GPU::IndexFormat mIndexFormat = GPU::INDEX_FORMAT_32BIT;
+
+		// dequantization of positions, position * scale + offset
+		F32x3 mPositionOffset = F32x3(0.0f, 0.0f, 0.0f);
+		F32x3 mPositionScale = F32x3(1.0f, 1.0f, 1.0f);
 	};
 
 	class Model : public Resource
@@ -25,6 +65,11 @@ namespace Cjing3D
 		Model();
 		~Model();
 
+		I32 GetMeshCount()const;
+		const ModelMesh* GetMesh(I32 index)const;
+		Span<const char> GetVertexData()const;
+		Span<const char> GetIndexData()const;
+
 	private:
 		friend class ModelFactory;
 
@@ -7,12 +7,13 @@ namespace Cjing3D
 {
 	static const I32 MODEL_MAX_NAME_LENGTH = 64;
 	static const I32 MODEL_MATERIAL_PATH_LENGTH = 128;
+	static const I32 MODEL_MAX_LODS = 8;
 
 	struct ModelGeneralHeader
 	{
 		static const U32 MAGIC;
 		static const I32 MAJOR = 1;
-		static const I32 MINOR = 2;
+		static const I32 MINOR = 5;
 
 		U32 mMagic = MAGIC;
 		I32 mMajor = MAJOR;
@@ -33,8 +34,28 @@ namespace Cjing3D
 		I32 mNumVertexElements = 0;
 		I32 mStartSubMeshes = 0;
 		I32 mNumSubMeshes = 0;
+		I32 mIndexFormat = GPU::INDEX_FORMAT_32BIT;
+		I32 mIndexDataOffset = 0;
+
+		// quantized positions are decoded as position * scale + offset
+		F32x3 mPositionOffset = F32x3(0.0f, 0.0f, 0.0f);
+		F32x3 mPositionScale = F32x3(1.0f, 1.0f, 1.0f);
+
+		// submeshes of lods are stored in order of lods, lod 0 is the full mesh,
+		// errors are relative to the bounding radius of the mesh
+		I32 mNumLods = 1;
+		F32 mLodErrors[MODEL_MAX_LODS] = { 0.0f };
+
+		// meshlets of lod 0 submeshes
+		I32 mStartMeshlets = 0;
+		I32 mNumMeshlets = 0;
 	};
 
+	inline I32 GetModelIndexStride(I32 indexFormat)
+	{
+		return indexFormat == GPU::INDEX_FORMAT_16BIT ? sizeof(U16) : sizeof(U32);
+	}
+
 	struct MeshInstData
 	{
 		char mMaterial[MODEL_MATERIAL_PATH_LENGTH] = { '\0' };
@@ -46,6 +67,18 @@ namespace Cjing3D
 	{
 		DynamicArray<ModelMesh> mMeshes;
 		DynamicArray<char> mVertexData;
-		DynamicArray<I32> mIndices;
+		DynamicArray<char> mIndexData;
+	};
+
+	class ModelFactory : public ResourceFactory
+	{
+	public:
+		virtual void RegisterExtensions();
+		virtual Resource* CreateResource();
+		virtual bool LoadResource(Resource* resource, const char* name, U64 size, const U8* data);
+		virtual bool DestroyResource(Resource* resource);
+
+	private:
+		bool ParseMesh(ModelImpl& impl, ModelGeneralHeader& header, Model& model, InputMemoryStream& inputStream);
 	};
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "renderGraph.h"
 #include "renderPassImpl.h"
+#include "transientAllocator.h"
 #include "core\memory\memory.h"
 #include "core\memory\linearAllocator.h"
 #include "core\container\dynamicArray.h"
@@ -8,10 +9,11 @@
 #include "core\concurrency\jobsystem.h"
 #include "core\helper\profiler.h"
 #include "gpu\gpu.h"
+#include "math\hash.h"
 
 // TODO: 
 // 1. barriers
-// 2. compile graph only the swapChain is changed, add SceneUpdate callbacks
+// 2. add SceneUpdate callbacks
 
 namespace Cjing3D
 {
@@ -28,6 +30,13 @@ namespace Cjing3D
 		}
 
 
+		U64 GetTextureMemorySize(const GPU::TextureDesc& desc)
+		{
+			const I32 depth = desc.mType == GPU::TEXTURE_3D ? std::max(desc.mDepth, 1u) : 1;
+			U64 size = GPU::GetTextureSize(desc.mFormat, desc.mWidth, desc.mHeight, depth, std::max(desc.mMipLevels, 1u));
+			return size * std::max(desc.mArraySize, 1u) * std::max(desc.mSampleCount, 1u);
+		}
+
 		bool operator==(const RenderGraphResourceDimension& a, const RenderGraphResourceDimension& b)
 		{
 			return a.mType == b.mType &&
@@ -41,6 +50,11 @@ namespace Cjing3D
 	// Definitions
 	////////////////////////////////////////////////////////////////////////////////////////////
 
+	enum TransientHeapType
+	{
+		TRANSIENT_HEAP_TEXTURE = 0,
+	};
+
 	struct AliasTransfer
 	{
 		U32 mFrom;
@@ -65,6 +79,12 @@ namespace Cjing3D
 		DynamicArray<I32> mSubPasses;
 		DynamicArray<AliasTransfer> mAliasTransfer;
 		DynamicArray<U32> mPhysicalTextures;
+
+		// queue scheduling, physical passes on other queues to wait for, and the last physical 
+		// pass which may be still executing concurrently with this pass
+		GPU::CommandListType mQueue = GPU::COMMAND_LIST_GRAPHICS;
+		DynamicArray<U32> mWaitPasses;
+		U32 mLastOverlappedPass = 0;
 	};
 
 	// resource internal inst
@@ -121,6 +141,7 @@ namespace Cjing3D
 		GPU::CommandListType mType = GPU::COMMAND_LIST_GRAPHICS;
 		bool mActive = false;
 		bool mIsGraphics = true;
+		U32 mCommandCount = 0;
 
 		void emitPreBarriers()
 		{
@@ -222,6 +243,7 @@ namespace Cjing3D
 			GPU::TextureDesc mDesc;
 			GPU::ResHandle mHandle;
 			bool mIsUsed = false;
+			bool mIsTransient = false;	// transient handles are released by gpu at the end of frame
 		};
 		DynamicArray<TexturePayload> mTextures;
 
@@ -236,14 +258,20 @@ namespace Cjing3D
 			// clear useless resources
 			for (auto& buffer : mBuffers)
 			{
-				if (!buffer.mIsUsed && buffer.mHandle != GPU::ResHandle::INVALID_HANDLE) {
+				if (!buffer.mIsUsed && buffer.mHandle != GPU::ResHandle::INVALID_HANDLE) 
+				{
 					GPU::DestroyResource(buffer.mHandle);
+					buffer.mHandle = GPU::ResHandle::INVALID_HANDLE;
 				}
 			}
 			for (auto& texture : mTextures)
 			{
-				if (!texture.mIsUsed && texture.mHandle != GPU::ResHandle::INVALID_HANDLE) {
-					GPU::DestroyResource(texture.mHandle);
+				if (!texture.mIsUsed && texture.mHandle != GPU::ResHandle::INVALID_HANDLE) 
+				{
+					if (!texture.mIsTransient) {
+						GPU::DestroyResource(texture.mHandle);
+					}
+					texture.mHandle = GPU::ResHandle::INVALID_HANDLE;
 				}
 			}
 		}
@@ -270,7 +298,7 @@ namespace Cjing3D
 
 			for (auto& texture : mTextures)
 			{
-				if (texture.mHandle != GPU::ResHandle::INVALID_HANDLE) {
+				if (texture.mHandle != GPU::ResHandle::INVALID_HANDLE && !texture.mIsTransient) {
 					GPU::DestroyResource(texture.mHandle);
 				}
 			}
@@ -309,6 +337,12 @@ namespace Cjing3D
 		// aliases
 		DynamicArray<U32> mPhysicalAliases;
 
+		// transient heaps
+		DynamicArray<ResPassRange> mPhysicalLifetimes;
+		DynamicArray<I32> mPhysicalPlacements;
+		TransientHeapAllocator mTransientHeapAllocator;
+		RenderGraphMemoryStats mMemoryStats;
+
 		// physical res and passes
 		RenderGraphResource mFinalRes;
 		DynamicArray<RenderGraphResourceDimension> mPhysicalResourceDimensions;
@@ -317,15 +351,32 @@ namespace Cjing3D
 		// execute states
 		DynamicArray<RenderPassExecuteState> mRenderPassExecuteStates;
 
+		// secondary command lists for parallel recording, reused between frames
+		Concurrency::Mutex mRecorderMutex;
+		DynamicArray<GPU::CommandList*> mRecorders;
+		I32 mUsedRecorderCount = 0;
+
 		// black board
 		RenderGraphBlackboard mBlackboard;
 
+		// compile cache, compiled results are reused if the structure hash is not changed
+		U64 mCompiledHash = 0;
+		DynamicArray<U32> mCompiledPassPhysicalIndices;
+		DynamicArray<U32> mCompiledResPhysicalIndices;
+		RenderGraphCompileStats mCompileStats;
+
 	public:
 		RenderGraphImpl() {
 			mAllocator.Reserve(1024 * 1024);
 		}
-		~RenderGraphImpl() {
+		~RenderGraphImpl() 
+		{
 			mResourceCache.Reset();
+
+			for (auto recorder : mRecorders) {
+				CJING_SAFE_DELETE(recorder);
+			}
+			mRecorders.clear();
 		}
 
 		void Clear();
@@ -340,11 +391,18 @@ namespace Cjing3D
 		void ReorderRenderPass(DynamicArray<I32>& renderPasses);
 		void BuildPhysicalResources();
 		void BuildPhysicalPasses();
+		void BuildQueueSyncs();
 		void BuildTransients();
 		void BuildRenderPassInfos();
 		void BuildBarriers();
 		void BuildPhysicalBarriers();
+		void BuildResourceLifetimes();
 		void BuildAliases();
+		void BuildTransientHeaps();
+
+		U64  ComputeStructureHash()const;
+		void SaveCompiledResults();
+		void RestoreCompiledResults();
 
 		void TraverseRenderPassDependency(const RenderPassInst& renderPass, U32 stackCount);
 		void DependRenderPassRecursive(const RenderPassInst& renderPass, const DynamicArray<I32>& writtenPasses, U32 stackCount, bool mergeDependency);
@@ -360,6 +418,7 @@ namespace Cjing3D
 
 		void ExecuteGraphicsCommands(PhysicalRenderPass& pass, RenderPassExecuteState& state);
 		void ExecuteComputeCommands(PhysicalRenderPass& pass, RenderPassExecuteState& state);
+		void AllocRecorders(GPU::CommandList& parent, Span<GPU::CommandList*> recorders);
 
 	public:
 
@@ -377,7 +436,16 @@ namespace Cjing3D
 				return resInst.mImportedHandle;
 			}
 
-			return mResourceCache.mTextures[resInst.mPhysicalIndex].mHandle;
+			return GetPhysicalTexture(resInst.mPhysicalIndex);
+		}
+
+		GPU::ResHandle GetPhysicalTexture(U32 physicalIndex)
+		{
+			// aliased textures share the handle of the first texture in alias chain
+			if (physicalIndex < (U32)mPhysicalAliases.size() && mPhysicalAliases[physicalIndex] != ~0u) {
+				physicalIndex = mPhysicalAliases[physicalIndex];
+			}
+			return mResourceCache.mTextures[physicalIndex].mHandle;
 		}
 
 		GPU::ResHandle GetBuffer(const RenderGraphResource& res, GPU::BufferDesc* outDesc = nullptr)
@@ -724,6 +792,25 @@ namespace Cjing3D
 
 			SchedulePass(bestIndex);
 		}
+
+		// hoist async compute passes right after their last dependent passes, so that they could 
+		// be overlapped with graphics passes as early as possible
+		for (I32 index = 1; index < renderPasses.size(); index++)
+		{
+			const I32 passIndex = renderPasses[index];
+			if (mRenderPasses[passIndex].mRenderPass->GetQueueFlags() != RENDER_GRAPH_QUEUE_ASYNC_COMPUTE_BIT) {
+				continue;
+			}
+
+			I32 target = index;
+			while (target > 0 && !CheckPassDependent(renderPasses[target - 1], passIndex)) {
+				target--;
+			}
+			for (I32 i = index; i > target; i--) {
+				renderPasses[i] = renderPasses[i - 1];
+			}
+			renderPasses[target] = passIndex;
+		}
 	}
 
 	void RenderGraphImpl::BuildPhysicalResources()
@@ -812,6 +899,78 @@ namespace Cjing3D
 		}
 	}
 
+	void RenderGraphImpl::BuildQueueSyncs()
+	{
+		// physical passes are submitted in order, so a pass only waits for the last dependent 
+		// pass on each other queue
+		const I32 passCount = mPhysicalRenderPasses.size();
+		for (I32 i = 0; i < passCount; i++)
+		{
+			auto& physicalPass = mPhysicalRenderPasses[i];
+			physicalPass.mQueue = GPU::COMMAND_LIST_GRAPHICS;
+			physicalPass.mWaitPasses.clear();
+			if (physicalPass.mSubPasses.empty()) {
+				continue;
+			}
+			if (mRenderPasses[physicalPass.mSubPasses[0]].mRenderPass->GetQueueFlags() == RENDER_GRAPH_QUEUE_ASYNC_COMPUTE_BIT) {
+				physicalPass.mQueue = GPU::COMMAND_LIST_ASYNC_COMPUTE;
+			}
+
+			U32 lastWaitPasses[GPU::COMMAND_LIST_TYPE_COUNT];
+			for (U32& waitPass : lastWaitPasses) {
+				waitPass = ~0u;
+			}
+			for (I32 subPass : physicalPass.mSubPasses)
+			{
+				for (I32 dep : mPassIndexDependencies[subPass])
+				{
+					const U32 depPhysicalIndex = mRenderPasses[dep].mPhysicalIndex;
+					if (depPhysicalIndex == RenderPassInst::Unused || depPhysicalIndex >= (U32)i) {
+						continue;
+					}
+
+					const GPU::CommandListType depQueue = mPhysicalRenderPasses[depPhysicalIndex].mQueue;
+					if (depQueue == physicalPass.mQueue) {
+						continue;
+					}
+					if (lastWaitPasses[depQueue] == ~0u || lastWaitPasses[depQueue] < depPhysicalIndex) {
+						lastWaitPasses[depQueue] = depPhysicalIndex;
+					}
+				}
+			}
+			for (U32 waitPass : lastWaitPasses)
+			{
+				if (waitPass != ~0u) {
+					physicalPass.mWaitPasses.push(waitPass);
+				}
+			}
+		}
+
+		// async compute passes are hoisted right after their dependencies, so graphics passes before
+		// them are finished when they start. But they may be still executing until the first graphics 
+		// pass waits for them (or the later async compute passes)
+		DynamicArray<U32> firstWaiters;
+		firstWaiters.reserve(passCount);
+		for (I32 i = 0; i < passCount; i++) {
+			firstWaiters.push(passCount);
+		}
+		U32 lastOverlappedPass = passCount > 0 ? passCount - 1 : 0;
+		for (I32 i = passCount - 1; i >= 0; i--)
+		{
+			auto& physicalPass = mPhysicalRenderPasses[i];
+			for (U32 waitPass : physicalPass.mWaitPasses) {
+				firstWaiters[waitPass] = i;
+			}
+
+			physicalPass.mLastOverlappedPass = i;
+			if (physicalPass.mQueue == GPU::COMMAND_LIST_ASYNC_COMPUTE)
+			{
+				lastOverlappedPass = std::min(lastOverlappedPass, firstWaiters[i] - 1);
+				physicalPass.mLastOverlappedPass = std::max((U32)i, lastOverlappedPass);
+			}
+		}
+	}
+
 	void RenderGraphImpl::BuildTransients()
 	{
 		DynamicArray<U32> bePhysicalPassUsed;
@@ -1006,42 +1165,44 @@ namespace Cjing3D
 		}
 	}
 
-	void RenderGraphImpl::BuildAliases()
+	void RenderGraphImpl::BuildResourceLifetimes()
 	{
-		// ȡÿResRange(һʹõPassһʹõPass)ͬDimRes
-		// Range no overlapresAlias
-		
-		DynamicArray<ResPassRange> resPassRage(mPhysicalResourceDimensions.size());
-		auto RegisterReader = [&resPassRage](const ResourceInst& res, U32 passIndex)
+		mPhysicalLifetimes.clear();
+		mPhysicalLifetimes.resize(mPhysicalResourceDimensions.size());
+		auto RegisterReader = [this](const ResourceInst& res, U32 passIndex)
 		{
 			if (res.mPhysicalIndex != ResourceInst::Unused)
 			{
-				auto& range = resPassRage[res.mPhysicalIndex];
+				auto& range = mPhysicalLifetimes[res.mPhysicalIndex];
 				range.mFirstReadPass = std::min(range.mFirstReadPass, passIndex);
 				range.mLastReadPass  = std::max(range.mLastReadPass,  passIndex);
 			}
 		};
-		auto RegisterWriter = [&resPassRage](const ResourceInst& res, U32 passIndex)
+		auto RegisterWriter = [this](const ResourceInst& res, U32 passIndex)
 		{
 			if (res.mPhysicalIndex != ResourceInst::Unused)
 			{
-				auto& range = resPassRage[res.mPhysicalIndex];
+				auto& range = mPhysicalLifetimes[res.mPhysicalIndex];
 				range.mFirstWritePass = std::min(range.mFirstWritePass, passIndex);
 				range.mLastWritePass = std::max(range.mLastWritePass, passIndex);
 			}
 		};
 
-		// 1. get pass range for each physical res
+		// get pass range for each physical res, resources of async compute passes
+		// are alive until the last pass which may be overlapped
 		for (I32 index : mPassIndexStack)
 		{
 			auto& renderPass = mRenderPasses[index];
+			const U32 lastOverlappedPass = mPhysicalRenderPasses[renderPass.mPhysicalIndex].mLastOverlappedPass;
 
 			// input resources
 			auto inputs = renderPass.mRenderPass->GetInputs();
 			for (auto input : inputs)
 			{
-				if (auto res = GetResourceInst(input->mRes)) {
+				if (auto res = GetResourceInst(input->mRes)) 
+				{
 					RegisterReader(*res, renderPass.mPhysicalIndex);
+					RegisterReader(*res, lastOverlappedPass);
 				}
 			}
 
@@ -1049,65 +1210,109 @@ namespace Cjing3D
 			auto outputs = renderPass.mRenderPass->GetOutputs();
 			for (auto& output : outputs)
 			{
-				if (auto res = GetResourceInst(output->mRes)) {
-					RegisterReader(*res, renderPass.mPhysicalIndex);
+				if (auto res = GetResourceInst(output->mRes)) 
+				{
+					RegisterWriter(*res, renderPass.mPhysicalIndex);
+					RegisterWriter(*res, lastOverlappedPass);
 				}
 			}
 		}
+	}
 
-		// 2. clear physical aliases
+	void RenderGraphImpl::BuildAliases()
+	{
+		// ȡÿResRange(һʹõPassһʹõPass)ͬDimRes
+		// Range no overlapresAlias
+		
+		// 1. clear physical aliases
 		mPhysicalAliases.resize(mPhysicalResourceDimensions.size());
 		for (U32& v : mPhysicalAliases) {
 			v = ~0;
 		}
+		for (auto& physicalPass : mPhysicalRenderPasses) {
+			physicalPass.mAliasTransfer.clear();
+		}
 
-		// 3. find available aliases
+		// 2. find available aliases, transient textures are placed in transient heaps
 		DynamicArray<DynamicArray<U32>> aliasChains(mPhysicalResourceDimensions.size());
 		for (U32 i = 0; i < mPhysicalResourceDimensions.size(); i++)
 		{
 			auto& dim = mPhysicalResourceDimensions[i];
 
 			// no alias for buffer
-			if (dim.mType == GPU::ResourceType::RESOURCETYPE_BUFFER) {
+			if (dim.mType == GPU::ResourceType::RESOURCETYPE_BUFFER || dim.mIsImported || dim.mIsTransient) {
+				continue;
+			}
+
+			// the res is read before written, the content should be kept
+			const auto& range = mPhysicalLifetimes[i];
+			if (range.IsEmpty() || !range.CanAlias()) {
 				continue;
 			}
 
 			for (U32 j = 0; j < i; j++)
 			{
-				if (mPhysicalResourceDimensions[j] == mPhysicalResourceDimensions[i])
-				{
-					if (!resPassRage[i].CheckRangeOverlop(resPassRage[j]))
-					{
-						mPhysicalAliases[i] = j;
+				if (mPhysicalAliases[j] != ~0 || !(mPhysicalResourceDimensions[j] == dim)) {
+					continue;
+				}
 
-						if (aliasChains[j].empty()) {
-							aliasChains[j].push(j);
-						}
-						aliasChains[j].push(i);
+				// the range should not be overlapped with any res in the alias chain
+				auto& chain = aliasChains[j];
+				bool overlapped = mPhysicalLifetimes[j].IsEmpty() || !mPhysicalLifetimes[j].CanAlias();
+				for (U32 k = 0; k < chain.size() && !overlapped; k++) {
+					overlapped = mPhysicalLifetimes[chain[k]].CheckRangeOverlop(range);
+				}
+				if (!overlapped) {
+					overlapped = mPhysicalLifetimes[j].CheckRangeOverlop(range);
+				}
+				if (overlapped) {
+					continue;
+				}
 
-						break;
-					}
+				mPhysicalAliases[i] = j;
+				if (chain.empty()) {
+					chain.push(j);
 				}
+				chain.push(i);
+				break;
 			}
 		}
 
-		// 4. build alias transfer by alias chains
+		// 3. build alias transfer by alias chains, the transfer happens in the first pass of next res
 		for (auto& chain : aliasChains)
 		{
-			if (chain.empty()) {
-				continue;
+			for (U32 i = 0; i + 1 < chain.size(); i++)
+			{
+				U32 passIndex = mPhysicalLifetimes[chain[i + 1]].FirstUsedPass();
+				mPhysicalRenderPasses[passIndex].mAliasTransfer.push({ chain[i], chain[i + 1] });
 			}
+		}
+	}
 
-			for (U32 i = 0; i < chain.size(); i ++)
-			{
-				if (i + 1 < chain.size()) {
-					mPhysicalRenderPasses[chain[i]].mAliasTransfer.push({chain[i], chain[i + 1]});
-				}
-				else {
-					mPhysicalRenderPasses[chain[i]].mAliasTransfer.push({ chain[i], chain[0] });
-				}
+	void RenderGraphImpl::BuildTransientHeaps()
+	{
+		mTransientHeapAllocator.Clear();
+		mPhysicalPlacements.resize(mPhysicalResourceDimensions.size());
+		for (U32 i = 0; i < mPhysicalResourceDimensions.size(); i++)
+		{
+			mPhysicalPlacements[i] = -1;
+
+			// only transient textures are placed in heaps, others are created as committed resources
+			auto& dim = mPhysicalResourceDimensions[i];
+			const auto& range = mPhysicalLifetimes[i];
+			if (!dim.mIsTransient || dim.mType != GPU::RESOURCETYPE_TEXTURE || range.IsEmpty() || !range.CanAlias()) {
+				continue;
 			}
+
+			mPhysicalPlacements[i] = mTransientHeapAllocator.AddResource(TRANSIENT_HEAP_TEXTURE,
+				GetTextureMemorySize(dim.mTexDesc), range.FirstUsedPass(), range.LastUsedPass());
 		}
+		mTransientHeapAllocator.Build();
+
+		mMemoryStats.mResourceMemory = mTransientHeapAllocator.GetResourceMemory();
+		mMemoryStats.mHeapMemory = mTransientHeapAllocator.GetHeapMemory();
+		mMemoryStats.mPlacedResourceCount = mTransientHeapAllocator.GetResourceCount();
+		mMemoryStats.mHeapCount = mTransientHeapAllocator.GetHeapCount();
 	}
 
 	bool RenderGraphImpl::CheckPassDependent(I32 srcPass, I32 dstPass) const
@@ -1125,12 +1330,100 @@ namespace Cjing3D
 		return false;
 	}
 
-	void RenderGraphImpl::Clear()
+	U64 RenderGraphImpl::ComputeStructureHash() const
+	{
+		// hash everything which compiled results depend on, handles of imported 
+		// resources and attachments are resolved in execute and are not included
+		U64 hash = HashFunc((U64)0, (I32)mRenderPasses.size());
+		for (const auto& renderPass : mRenderPasses)
+		{
+			hash = HashFunc(hash, renderPass.mName.c_str());
+			hash = HashFunc(hash, renderPass.mRenderPass->GetQueueFlags());
+
+			auto inputs = renderPass.mRenderPass->GetInputs();
+			hash = HashFunc(hash, (U64)inputs.length());
+			for (const ResourceNode* input : inputs) {
+				hash = HashFunc(hash, input != nullptr ? input->mIndex : -1);
+			}
+
+			auto outputs = renderPass.mRenderPass->GetOutputs();
+			hash = HashFunc(hash, (U64)outputs.length());
+			for (const ResourceNode* output : outputs) {
+				hash = HashFunc(hash, output != nullptr ? output->mIndex : -1);
+			}
+		}
+
+		// resources
+		hash = HashFunc(hash, (I32)mResourceSlots.size());
+		for (const auto& resSlot : mResourceSlots)
+		{
+			hash = HashFunc(hash, resSlot.mInstIndex);
+			hash = HashFunc(hash, resSlot.mNodeIndex);
+			hash = HashFunc(hash, (I32)resSlot.mVersion);
+		}
+
+		for (const ResourceInst* res : mResourceInsts)
+		{
+			hash = HashFunc(hash, res->mName.c_str());
+			hash = HashFunc(hash, res->mType);
+			hash = HashFunc(hash, (I32)(res->mImportedHandle != GPU::ResHandle::INVALID_HANDLE));
+			if (res->mType == GPU::RESOURCETYPE_BUFFER) {
+				hash = FNV1aHash(hash, &res->mBufferDesc, sizeof(res->mBufferDesc));
+			}
+			else {
+				hash = FNV1aHash(hash, &res->mTexDesc, sizeof(res->mTexDesc));
+			}
+		}
+
+		for (const ResourceNode* node : mResourceNodes)
+		{
+			hash = HashFunc(hash, node->mRes.mIndex);
+			hash = HashFunc(hash, (I32)node->mRes.mVersion);
+			hash = HashFunc(hash, (I32)node->mWrittenPasses.size());
+			for (I32 passIndex : node->mWrittenPasses) {
+				hash = HashFunc(hash, passIndex);
+			}
+			hash = HashFunc(hash, (I32)node->mReadPasses.size());
+			for (I32 passIndex : node->mReadPasses) {
+				hash = HashFunc(hash, passIndex);
+			}
+		}
+
+		// final res
+		hash = HashFunc(hash, mFinalRes.mIndex);
+		hash = HashFunc(hash, (I32)mFinalRes.mVersion);
+
+		// zero is reserved for invalid hash
+		return hash != 0 ? hash : 1;
+	}
+
+	void RenderGraphImpl::SaveCompiledResults()
 	{
-		for (auto& renderPassInst : mRenderPasses) {
-			renderPassInst.mRenderPass->~RenderPass();
+		mCompiledPassPhysicalIndices.resize(mRenderPasses.size());
+		for (I32 i = 0; i < mRenderPasses.size(); i++) {
+			mCompiledPassPhysicalIndices[i] = mRenderPasses[i].mPhysicalIndex;
 		}
 
+		mCompiledResPhysicalIndices.resize(mResourceInsts.size());
+		for (I32 i = 0; i < mResourceInsts.size(); i++) {
+			mCompiledResPhysicalIndices[i] = mResourceInsts[i]->mPhysicalIndex;
+		}
+	}
+
+	void RenderGraphImpl::RestoreCompiledResults()
+	{
+		// pass stack, physical resources, physical passes, barriers and aliases are 
+		// kept between frames, only the physical indices of new insts need restore
+		for (I32 i = 0; i < mRenderPasses.size(); i++) {
+			mRenderPasses[i].mPhysicalIndex = mCompiledPassPhysicalIndices[i];
+		}
+		for (I32 i = 0; i < mResourceInsts.size(); i++) {
+			mResourceInsts[i]->mPhysicalIndex = mCompiledResPhysicalIndices[i];
+		}
+	}
+
+	void RenderGraphImpl::Clear()
+	{
 		// renderPasses
 		for (auto renderPass : mRenderPasses)
 		{
@@ -1153,7 +1446,6 @@ namespace Cjing3D
 		mResourceNodes.clear();
 		mResourceNameMap.clear();
 		mResourceCache.Clear();
-		mPhysicalResourceDimensions.clear();
 		mFinalRes = RenderGraphResource();
 		mBlackboard.Clear();
 
@@ -1165,12 +1457,7 @@ namespace Cjing3D
 	{
 		PROFILE_CPU_BLOCK("RenderGraphCompile");
 
-		// clear datas
-		mPassIndexStack.clear();
-		mPassIndexDependencies.clear();
-		mPassIndexDependencies.resize(mRenderPasses.size());
-		mPassIndexMergeDependencies.clear();
-		mPassIndexMergeDependencies.resize(mRenderPasses.size());
+		mCompileStats.mCompileCount++;
 
 		// check final res
 		if (mFinalRes.IsEmpty())
@@ -1185,6 +1472,24 @@ namespace Cjing3D
 			return false;
 		}
 
+		// reuse compiled results if the structure of graph is not changed
+		U64 structureHash = ComputeStructureHash();
+		if (structureHash == mCompiledHash)
+		{
+			RestoreCompiledResults();
+			mCompileStats.mCacheHitCount++;
+			return true;
+		}
+		mCompiledHash = 0;
+
+		// clear datas
+		mPassIndexStack.clear();
+		mPassIndexDependencies.clear();
+		mPassIndexDependencies.resize(mRenderPasses.size());
+		mPassIndexMergeDependencies.clear();
+		mPassIndexMergeDependencies.resize(mRenderPasses.size());
+		mPhysicalResourceDimensions.clear();
+
 		// get available passes by traversing pass dependencies
 		for (auto& passIndex : finalResNode->mWrittenPasses) {
 			mPassIndexStack.push(passIndex);
@@ -1204,6 +1509,9 @@ namespace Cjing3D
 		// build real passese
 		BuildPhysicalPasses();
 
+		// build cross-queue syncs
+		BuildQueueSyncs();
+
 		// build transients
 		BuildTransients();
 
@@ -1216,8 +1524,13 @@ namespace Cjing3D
 		// build physical barriers
 		BuildPhysicalBarriers();
 
-		// build aliases
+		// build aliases and transient heaps by resource lifetimes
+		BuildResourceLifetimes();
 		BuildAliases();
+		BuildTransientHeaps();
+
+		SaveCompiledResults();
+		mCompiledHash = structureHash;
 
 		return true;
 	}
@@ -1233,7 +1546,7 @@ namespace Cjing3D
 
 			// execute pass
 			cmd.EventBegin(renderPassInst->mName);
-			RenderGraphResources resources(*this, renderPassInst->mRenderPass);
+			RenderGraphResources resources(*this, renderPassInst->mRenderPass, &cmd);
 
 			auto frameBindingSet = resources.GetFrameBindingSet();
 			if (frameBindingSet != GPU::ResHandle::INVALID_HANDLE) {
@@ -1241,6 +1554,7 @@ namespace Cjing3D
 			}
 
 			renderPassInst->mRenderPass->Execute(resources, cmd);
+			resources.MergeParallelRecorders();
 
 			if (frameBindingSet != GPU::ResHandle::INVALID_HANDLE) {
 				cmd.EndFrameBindingSet();
@@ -1265,12 +1579,15 @@ namespace Cjing3D
 	void RenderGraphImpl::ExecuteComputeCommands(PhysicalRenderPass& pass, RenderPassExecuteState& state)
 	{
 		Debug::CheckAssertion(pass.mSubPasses.size() == 1);
-		RenderPassInst* renderPassInst = &mRenderPasses[0];
+		RenderPassInst* renderPassInst = &mRenderPasses[pass.mSubPasses[0]];
 
 		// execute pass
-		auto ent = state.mCmd->Event(renderPassInst->mName);
-		RenderGraphResources resources(*this, renderPassInst->mRenderPass);
-		renderPassInst->mRenderPass->Execute(resources, *state.mCmd);
+		{
+			auto ent = state.mCmd->Event(renderPassInst->mName);
+			RenderGraphResources resources(*this, renderPassInst->mRenderPass, state.mCmd);
+			renderPassInst->mRenderPass->Execute(resources, *state.mCmd);
+			resources.MergeParallelRecorders();
+		}
 
 		// compile cmd
 		if (!state.mCmd->GetCommands().empty())
@@ -1283,6 +1600,21 @@ namespace Cjing3D
 		}
 	}
 
+	void RenderGraphImpl::AllocRecorders(GPU::CommandList& parent, Span<GPU::CommandList*> recorders)
+	{
+		Concurrency::ScopedMutex lock(mRecorderMutex);
+		for (auto& recorder : recorders)
+		{
+			if (mUsedRecorderCount >= mRecorders.size()) {
+				mRecorders.push(CJING_NEW(GPU::CommandList));
+			}
+
+			recorder = mRecorders[mUsedRecorderCount++];
+			recorder->Reset();
+			recorder->SetParent(&parent);
+		}
+	}
+
 	bool RenderGraphImpl::Execute(JobSystem::JobHandle& jobHandle)
 	{
 		PROFILE_CPU_BLOCK("RenderGraphExecute");
@@ -1297,6 +1629,7 @@ namespace Cjing3D
 		I32 renderPassCount = mPhysicalRenderPasses.size();
 
 		mRenderPassExecuteStates.clear();
+		mUsedRecorderCount = 0;
 		mRenderPassExecuteStates.resize(renderPassCount);
 
 		JobSystem::JobHandle executeJobHandle = JobSystem::INVALID_HANDLE;
@@ -1313,16 +1646,15 @@ namespace Cjing3D
 			{
 			case RENDER_GRAPH_QUEUE_GRAPHICS_BIT:
 				mRenderPassExecuteStates[i].mIsGraphics = true;
-				mRenderPassExecuteStates[i].mType = GPU::COMMAND_LIST_GRAPHICS;
 				break;
 			case RENDER_GRAPH_QUEUE_ASYNC_COMPUTE_BIT:
 				mRenderPassExecuteStates[i].mIsGraphics = false;
-				mRenderPassExecuteStates[i].mType = GPU::COMMAND_LIST_ASYNC_COMPUTE;
 				break;
 			default:
 				Logger::Warning("Unsupport render graph queue flag:%d.", flag);
 				break;
 			}
+			mRenderPassExecuteStates[i].mType = mPhysicalRenderPasses[i].mQueue;
 		}
 
 		// execute render passes
@@ -1337,8 +1669,15 @@ namespace Cjing3D
 				continue;
 			}
 
-			// create command list
+			// create command list, and wait for the passes on other queues
 			state.mCmd = GPU::CreateCommandlist(state.mType);
+			for (U32 waitPass : mPhysicalRenderPasses[i].mWaitPasses)
+			{
+				const RenderPassExecuteState& waitState = mRenderPassExecuteStates[waitPass];
+				if (waitState.mCmd != nullptr) {
+					state.mCmd->Wait(*waitState.mCmd);
+				}
+			}
 
 			// execute pass executing job
 			JobSystem::JobInfo& jobInfo = renderPassJobs[jobCount++];
@@ -1366,6 +1705,7 @@ namespace Cjing3D
 					}
 				}
 				state.emitPostBarriers();
+				state.mCommandCount = (U32)state.mCmd->GetCommands().size();
 			};
 		}
 		JobSystem::RunJobs(renderPassJobs.data(), jobCount, &executeJobHandle);
@@ -1432,15 +1772,14 @@ namespace Cjing3D
 	{
 		auto& dim = mPhysicalResourceDimensions[physicalIndex];
 
-		// if current res is aliase
-		if (mPhysicalAliases[physicalIndex] != ~0)
-		{
-			mResourceCache.mTextures[physicalIndex] = mResourceCache.mTextures[mPhysicalAliases[physicalIndex]];
+		// if current res is aliase, the handle is shared with the first texture of alias chain
+		if (mPhysicalAliases[physicalIndex] != ~0) {
 			return;
 		}
 
 		bool needCreate = true;
-		if (mResourceCache.mTextures[physicalIndex].mHandle != GPU::ResHandle::INVALID_HANDLE)
+		if (mResourceCache.mTextures[physicalIndex].mHandle != GPU::ResHandle::INVALID_HANDLE && 
+			!mResourceCache.mTextures[physicalIndex].mIsTransient)
 		{
 			if (dim.mPersistent &&
 				mResourceCache.mTextures[physicalIndex].mDesc == dim.mTexDesc) {
@@ -1452,6 +1791,7 @@ namespace Cjing3D
 		{
 			mResourceCache.mTextures[physicalIndex].mHandle = GPU::CreateTexture(&dim.mTexDesc, nullptr, dim.mName.c_str());
 			mResourceCache.mTextures[physicalIndex].mDesc = dim.mTexDesc;
+			mResourceCache.mTextures[physicalIndex].mIsTransient = false;
 		}
 
 		mResourceCache.mTextures[physicalIndex].mIsUsed = true;
@@ -1473,8 +1813,18 @@ namespace Cjing3D
 			{
 				if (dim.mIsTransient)
 				{
-					mResourceCache.mTextures[i].mHandle = GPU::CreateTransientTexture(&dim.mTexDesc);
-					mResourceCache.mTextures[i].mDesc = dim.mTexDesc;
+					const GPU::TransientPlacement* placement = nullptr;
+					if (mPhysicalPlacements[i] >= 0) {
+						placement = &mTransientHeapAllocator.GetPlacement(mPhysicalPlacements[i]);
+					}
+					auto& texture = mResourceCache.mTextures[i];
+					if (texture.mHandle != GPU::ResHandle::INVALID_HANDLE && !texture.mIsTransient) {
+						GPU::DestroyResource(texture.mHandle);
+					}
+					texture.mHandle = GPU::CreateTransientTexture(&dim.mTexDesc, placement);
+					texture.mDesc = dim.mTexDesc;
+					texture.mIsTransient = true;
+					texture.mIsUsed = true;
 				}
 				else if (!dim.mIsImported)
 				{
@@ -1485,12 +1835,16 @@ namespace Cjing3D
 		mResourceCache.ClearUnusedRes();
 
 		// assign transient resources to render pass infos
-		auto& textures = mResourceCache.mTextures;
 		for (PhysicalRenderPass& physicalPass : mPhysicalRenderPasses)
 		{
+			physicalPass.mRenderPassInfo.mTextures.clear();
 			for (I32 i = 0; i < physicalPass.mPhysicalTextures.size(); i++)
 			{
-				physicalPass.mRenderPassInfo.mTextures.push(textures[physicalPass.mPhysicalTextures[i]].mHandle);
+				// imported textures are not managed by render graph
+				GPU::ResHandle handle = GetPhysicalTexture(physicalPass.mPhysicalTextures[i]);
+				if (handle != GPU::ResHandle::INVALID_HANDLE) {
+					physicalPass.mRenderPassInfo.mTextures.push(handle);
+				}
 			}
 		}
 	}
@@ -1498,9 +1852,10 @@ namespace Cjing3D
 	////////////////////////////////////////////////////////////////////////////////////////////
 	// RenderResources
 	////////////////////////////////////////////////////////////////////////////////////////////
-	RenderGraphResources::RenderGraphResources(RenderGraphImpl& renderGraph, RenderPass* renderPass) :
+	RenderGraphResources::RenderGraphResources(RenderGraphImpl& renderGraph, RenderPass* renderPass, GPU::CommandList* cmd) :
 		mImpl(renderGraph),
-		mRenderPass(renderPass)
+		mRenderPass(renderPass),
+		mCmd(cmd)
 	{
 	}
 
@@ -1523,6 +1878,33 @@ namespace Cjing3D
 		return mImpl.GetTexture(res, outDesc);
 	}
 
+	Span<GPU::CommandList*> RenderGraphResources::CreateParallelRecorders(I32 count)
+	{
+		if (mCmd == nullptr || count <= 0) {
+			return Span<GPU::CommandList*>();
+		}
+
+		// recorders array is alive until the cmd is reset
+		Span<GPU::CommandList*> recorders(mCmd->Alloc<GPU::CommandList*>(count), count);
+		mImpl.AllocRecorders(*mCmd, recorders);
+
+		auto& parallelRecorders = mParallelRecorders.emplace();
+		parallelRecorders.mPosition = mCmd->GetCommands().size();
+		parallelRecorders.mRecorders = recorders;
+		return recorders;
+	}
+
+	void RenderGraphResources::MergeParallelRecorders()
+	{
+		// merge from the last position, so that the positions of previous recorders are unchanged
+		for (I32 i = mParallelRecorders.size() - 1; i >= 0; i--)
+		{
+			auto& parallelRecorders = mParallelRecorders[i];
+			mCmd->MergeSecondaries(parallelRecorders.mPosition, parallelRecorders.mRecorders);
+		}
+		mParallelRecorders.clear();
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////////
 	// RenderGraphResBuilder
 	////////////////////////////////////////////////////////////////////////////////////////////
@@ -1901,6 +2283,16 @@ namespace Cjing3D
 		mImpl->Clear();
 	}
 
+	const RenderGraphCompileStats& RenderGraph::GetCompileStats() const
+	{
+		return mImpl->mCompileStats;
+	}
+
+	const RenderGraphMemoryStats& RenderGraph::GetMemoryStats() const
+	{
+		return mImpl->mMemoryStats;
+	}
+
 	String RenderGraph::ExportGraphviz()
 	{
 #ifdef DEBUG
@@ -1993,6 +2385,67 @@ namespace Cjing3D
 #endif
 	}
 
+	String RenderGraph::ExportTimeline()
+	{
+		const char* queueNames[GPU::COMMAND_LIST_TYPE_COUNT] = { "Graphics", "Async Compute" };
+
+		String ret;
+		ret += "{\"traceEvents\":[\n";
+		for (I32 queue = 0; queue < GPU::COMMAND_LIST_TYPE_COUNT; queue++)
+		{
+			ret += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":";
+			ret += std::to_string(queue).c_str();
+			ret += ",\"args\":{\"name\":\"";
+			ret += queueNames[queue];
+			ret += "\"}}";
+			ret += queue + 1 < GPU::COMMAND_LIST_TYPE_COUNT ? ",\n" : "";
+		}
+
+		// simulate queues like the submission of command lists
+		const auto& physicalPasses = mImpl->mPhysicalRenderPasses;
+		const auto& executeStates = mImpl->mRenderPassExecuteStates;
+		U64 queueTimes[GPU::COMMAND_LIST_TYPE_COUNT] = {};
+		DynamicArray<U64> passEnds;
+		for (I32 i = 0; i < physicalPasses.size(); i++)
+		{
+			const auto& physicalPass = physicalPasses[i];
+			U64 begin = queueTimes[physicalPass.mQueue];
+			for (U32 waitPass : physicalPass.mWaitPasses) {
+				begin = std::max(begin, passEnds[waitPass]);
+			}
+			U64 duration = 1;
+			if (i < executeStates.size()) {
+				duration = std::max(executeStates[i].mCommandCount, 1u);
+			}
+			queueTimes[physicalPass.mQueue] = begin + duration;
+			passEnds.push(begin + duration);
+
+			if (physicalPass.mSubPasses.empty()) {
+				continue;
+			}
+
+			ret += ",\n{\"name\":\"";
+			ret += mImpl->mRenderPasses[physicalPass.mSubPasses[0]].mName;
+			ret += "\",\"ph\":\"X\",\"pid\":0,\"tid\":";
+			ret += std::to_string((I32)physicalPass.mQueue).c_str();
+			ret += ",\"ts\":";
+			ret += std::to_string(begin).c_str();
+			ret += ",\"dur\":";
+			ret += std::to_string(duration).c_str();
+			ret += ",\"args\":{\"pass\":";
+			ret += std::to_string(i).c_str();
+			ret += ",\"waits\":[";
+			for (I32 waitIndex = 0; waitIndex < physicalPass.mWaitPasses.size(); waitIndex++)
+			{
+				ret += waitIndex > 0 ? "," : "";
+				ret += std::to_string(physicalPass.mWaitPasses[waitIndex]).c_str();
+			}
+			ret += "]}}";
+		}
+		ret += "\n]}\n";
+		return ret;
+	}
+
 	RenderGraphResource RenderGraph::ImportTexture(const char* name, GPU::ResHandle handle, const GPU::TextureDesc& desc)
 	{
 		return mImpl->ImportTexture(name, handle, desc);
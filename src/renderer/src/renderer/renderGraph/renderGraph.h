@@ -72,16 +72,54 @@ namespace Cjing3D
 	class RenderGraphResources
 	{
 	public:
-		RenderGraphResources(RenderGraphImpl& renderGraph, RenderPass* renderPass);
+		RenderGraphResources(RenderGraphImpl& renderGraph, RenderPass* renderPass, GPU::CommandList* cmd = nullptr);
 		~RenderGraphResources();
 
 		GPU::ResHandle GetFrameBindingSet()const;
 		GPU::ResHandle GetBuffer(RenderGraphResource res, GPU::BufferDesc* outDesc = nullptr);
 		GPU::ResHandle GetTexture(RenderGraphResource res, GPU::TextureDesc* outDesc = nullptr);
 
+		// create secondary command lists which could be recorded concurrently, all recording
+		// must be finished before execute returned. Commands of recorders are merged in order
+		// at the position where the recorders are created
+		Span<GPU::CommandList*> CreateParallelRecorders(I32 count);
+
 	private:
+		friend class RenderGraphImpl;
+
+		void MergeParallelRecorders();
+
+		struct ParallelRecorders
+		{
+			I32 mPosition = 0;
+			Span<GPU::CommandList*> mRecorders;
+		};
+
 		RenderPass* mRenderPass = nullptr;
 		RenderGraphImpl& mImpl;
+		GPU::CommandList* mCmd = nullptr;
+		DynamicArray<ParallelRecorders> mParallelRecorders;
+	};
+
+	// compiled results are reused until the structure of graph is changed
+	struct RenderGraphCompileStats
+	{
+		U32 mCompileCount = 0;
+		U32 mCacheHitCount = 0;
+
+		F32 GetCacheHitRate()const { 
+			return mCompileCount > 0 ? (F32)mCacheHitCount / (F32)mCompileCount : 0.0f; 
+		}
+	};
+
+	// memory of non-imported resources placed in transient heaps by their lifetimes
+	struct RenderGraphMemoryStats
+	{
+		// only transient textures placed in heaps are counted
+		U64 mResourceMemory = 0;	// without aliasing
+		U64 mHeapMemory = 0;		// aliased in heaps
+		I32 mPlacedResourceCount = 0;
+		I32 mHeapCount = 0;
 	};
 
 	class RenderGraph
@@ -122,6 +160,8 @@ namespace Cjing3D
 		bool Execute(JobSystem::JobHandle& jobHandle);
 		void Clear();
 		void SetFinalResource(const RenderGraphResource& res);
+		const RenderGraphCompileStats& GetCompileStats()const;
+		const RenderGraphMemoryStats& GetMemoryStats()const;
 
 		RenderGraphBlackboard& GetBloackBoard();
 		RenderGraphBlackboard const& GetBloackBoard()const;
@@ -130,6 +170,9 @@ namespace Cjing3D
 		RenderGraphResource ImportBuffer(const char* name, GPU::ResHandle handle, const GPU::BufferDesc& desc);
 
 		String ExportGraphviz();
+		// export queues of physical passes in the last execution as chrome trace events (chrome://tracing),
+		// each pass lasts as many time units as its commands, so that async compute overlap could be viewed
+		String ExportTimeline();
 
 	private:
 		void* Alloc(size_t size);
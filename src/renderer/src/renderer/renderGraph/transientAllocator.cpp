@@ -0,0 +1,115 @@
+#include "transientAllocator.h"
+
+#include <algorithm>
+
+namespace Cjing3D
+{
+	void TransientHeapAllocator::Clear()
+	{
+		mResources.clear();
+		mHeapSizes.clear();
+	}
+
+	I32 TransientHeapAllocator::AddResource(U32 heap, U64 size, U32 firstPass, U32 lastPass)
+	{
+		Resource& res = mResources.emplace();
+		res.mFirstPass = std::min(firstPass, lastPass);
+		res.mLastPass = std::max(firstPass, lastPass);
+		res.mPlacement.mHeap = heap;
+		res.mPlacement.mSize = (size + PLACEMENT_ALIGNMENT - 1) & ~(PLACEMENT_ALIGNMENT - 1);
+		return mResources.size() - 1;
+	}
+
+	void TransientHeapAllocator::Build()
+	{
+		mHeapSizes.clear();
+
+		// place the largest resources first
+		DynamicArray<I32> order;
+		order.reserve(mResources.size());
+		for (I32 i = 0; i < mResources.size(); i++) {
+			order.push(i);
+		}
+		std::sort(order.begin(), order.end(), [this](I32 a, I32 b) {
+			if (mResources[a].mPlacement.mSize != mResources[b].mPlacement.mSize) {
+				return mResources[a].mPlacement.mSize > mResources[b].mPlacement.mSize;
+			}
+			return a < b;
+		});
+
+		struct Range
+		{
+			U64 mBegin;
+			U64 mEnd;
+		};
+		DynamicArray<Range> aliveRanges;
+		DynamicArray<I32> placedResources;
+		placedResources.reserve(mResources.size());
+		for (I32 index : order)
+		{
+			Resource& res = mResources[index];
+
+			// ranges of placed resources which are alive at the same time
+			aliveRanges.clear();
+			for (I32 placedIndex : placedResources)
+			{
+				const Resource& placed = mResources[placedIndex];
+				if (res.IsOverlapped(placed)) {
+					aliveRanges.push({ placed.mPlacement.mOffset, placed.mPlacement.mOffset + placed.mPlacement.mSize });
+				}
+			}
+			std::sort(aliveRanges.begin(), aliveRanges.end(), [](const Range& a, const Range& b) {
+				return a.mBegin < b.mBegin;
+			});
+
+			// find the best fit gap, or place after all alive ranges
+			const U64 size = res.mPlacement.mSize;
+			U64 cursor = 0;
+			U64 bestOffset = ~0ull;
+			U64 bestGap = ~0ull;
+			for (const Range& range : aliveRanges)
+			{
+				if (range.mBegin > cursor)
+				{
+					const U64 gap = range.mBegin - cursor;
+					if (gap >= size && gap < bestGap)
+					{
+						bestOffset = cursor;
+						bestGap = gap;
+					}
+				}
+				cursor = std::max(cursor, range.mEnd);
+			}
+			if (bestOffset == ~0ull) {
+				bestOffset = cursor;
+			}
+
+			res.mPlacement.mOffset = bestOffset;
+			placedResources.push(index);
+
+			const U32 heap = res.mPlacement.mHeap;
+			while (heap >= (U32)mHeapSizes.size()) {
+				mHeapSizes.push(0);
+			}
+			mHeapSizes[heap] = std::max(mHeapSizes[heap], bestOffset + size);
+		}
+	}
+
+	U64 TransientHeapAllocator::GetResourceMemory() const
+	{
+		U64 memory = 0;
+		for (const Resource& res : mResources) {
+			memory += res.mPlacement.mSize;
+		}
+		return memory;
+	}
+
+	U64 TransientHeapAllocator::GetHeapMemory() const
+	{
+		U64 memory = 0;
+		for (U64 heapSize : mHeapSizes) {
+			memory += heapSize;
+		}
+		return memory;
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "gpu\resource.h"
+#include "core\container\dynamicArray.h"
+
+namespace Cjing3D
+{
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// TransientHeapAllocator
+	/// Place transient resources into heaps by their lifetimes (the range of physical passes), resources
+	/// whose lifetimes are not overlapped could share the same memory. Resources are placed from the
+	/// largest to the smallest, each one is placed into the best fit gap between resources which are
+	/// alive at the same time.
+	class TransientHeapAllocator
+	{
+	public:
+		static const U64 PLACEMENT_ALIGNMENT = 64 * 1024;
+
+		TransientHeapAllocator() = default;
+		~TransientHeapAllocator() = default;
+
+		void Clear();
+
+		// add a resource and return the index of its placement
+		I32 AddResource(U32 heap, U64 size, U32 firstPass, U32 lastPass);
+		void Build();
+
+		const GPU::TransientPlacement& GetPlacement(I32 index)const { return mResources[index].mPlacement; }
+		I32 GetResourceCount()const { return mResources.size(); }
+		I32 GetHeapCount()const { return mHeapSizes.size(); }
+		U64 GetHeapSize(U32 heap)const { return heap < (U32)mHeapSizes.size() ? mHeapSizes[heap] : 0; }
+
+		// total memory without aliasing
+		U64 GetResourceMemory()const;
+		// total memory of heaps
+		U64 GetHeapMemory()const;
+
+	private:
+		struct Resource
+		{
+			U32 mFirstPass = 0;
+			U32 mLastPass = 0;
+			GPU::TransientPlacement mPlacement;
+
+			bool IsOverlapped(const Resource& rhs)const {
+				return mPlacement.mHeap == rhs.mPlacement.mHeap && mFirstPass <= rhs.mLastPass && rhs.mFirstPass <= mLastPass;
+			}
+		};
+		DynamicArray<Resource> mResources;
+		DynamicArray<U64> mHeapSizes;
+	};
+}
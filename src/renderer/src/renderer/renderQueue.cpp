@@ -0,0 +1,166 @@
+#include "renderQueue.h"
+#include "core\concurrency\jobsystem.h"
+#include "core\helper\profiler.h"
+
+namespace Cjing3D
+{
+	namespace
+	{
+		static const U32 RADIX_BITS = 8;
+		static const U32 RADIX_SIZE = 1 << RADIX_BITS;
+		static const U64 RADIX_MASK = RADIX_SIZE - 1;
+
+		static const U64 PASS_MASK = (1ull << 4) - 1;
+		static const U64 PIPELINE_MASK = (1ull << 12) - 1;
+		static const U64 MATERIAL_MASK = (1ull << 16) - 1;
+		static const U64 MESH_MASK = (1ull << 20) - 1;
+		static const U64 DEPTH_MASK = (1ull << 12) - 1;
+
+		// run the function for each chunk, chunks are run on job threads if more than one
+		template<typename F>
+		void RunChunks(U32 chunkCount, const F& func)
+		{
+			if (chunkCount <= 1)
+			{
+				func(0);
+				return;
+			}
+
+			JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+			JobSystem::RunJobs(chunkCount, 1, [&func](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+				func((U32)jobIndex);
+				return false;
+			}, 0, &jobHandle);
+			JobSystem::Wait(&jobHandle);
+		}
+	}
+
+	void RenderBatch::Setup(RENDERPASS pass, U32 pipeline, U32 material, U32 meshIndex, U32 objectIndex, F32 depth, bool isTransparent)
+	{
+		U64 depthBucket = (U64)(std::min(std::max(depth, 0.0f), 1.0f) * (F32)(DEPTH_BUCKET_COUNT - 1));
+		const U64 states =
+			(((U64)pipeline & PIPELINE_MASK) << 36) |
+			(((U64)material & MATERIAL_MASK) << 20) |
+			((U64)meshIndex & MESH_MASK);
+
+		if (isTransparent)
+		{
+			// farther objects have smaller keys
+			depthBucket = DEPTH_MASK - depthBucket;
+			mSortKey = (((U64)pass & PASS_MASK) << 60) | (depthBucket << 48) | states;
+		}
+		else
+		{
+			mSortKey = (((U64)pass & PASS_MASK) << 60) | (states << 12) | depthBucket;
+		}
+
+		mMeshIndex = meshIndex;
+		mObjectIndex = objectIndex;
+	}
+
+	void RenderQueue::Clear()
+	{
+		mBatches.clear();
+	}
+
+	void RenderQueue::Reserve(U32 count)
+	{
+		mBatches.reserve(count);
+	}
+
+	RenderBatch& RenderQueue::AddBatch()
+	{
+		return mBatches.emplace();
+	}
+
+	void RenderQueue::Sort()
+	{
+		PROFILE_FUNCTION();
+		const U32 count = (U32)mBatches.size();
+		if (count <= 1) {
+			return;
+		}
+
+		if (count < RADIX_SORT_THRESHOLD)
+		{
+			std::stable_sort(mBatches.begin(), mBatches.end(), [](const RenderBatch& a, const RenderBatch& b) {
+				return a.mSortKey < b.mSortKey;
+			});
+			return;
+		}
+
+		const bool isParallel = count >= PARALLEL_SORT_THRESHOLD && JobSystem::IsInitialized();
+		const U32 chunkSize = isParallel ? SORT_CHUNK_SIZE : count;
+		const U32 chunkCount = (count + chunkSize - 1) / chunkSize;
+		mSortBuffer.resize(count);
+		mChunkOffsets.resize(chunkCount * RADIX_SIZE);
+
+		// bits which are different in keys, the same bytes are skipped
+		DynamicArray<U64> chunkDiffBits;
+		chunkDiffBits.resize(chunkCount);
+		const U64 firstKey = mBatches[0].mSortKey;
+		RunChunks(chunkCount, [&](U32 chunk) {
+			const U32 begin = chunk * chunkSize;
+			const U32 end = std::min(begin + chunkSize, count);
+			U64 diffBits = 0;
+			for (U32 i = begin; i < end; i++) {
+				diffBits |= mBatches[i].mSortKey ^ firstKey;
+			}
+			chunkDiffBits[chunk] = diffBits;
+		});
+
+		U64 diffBits = 0;
+		for (U64 bits : chunkDiffBits) {
+			diffBits |= bits;
+		}
+
+		RenderBatch* src = mBatches.data();
+		RenderBatch* dst = mSortBuffer.data();
+		for (U32 shift = 0; shift < 64; shift += RADIX_BITS)
+		{
+			if (((diffBits >> shift) & RADIX_MASK) == 0) {
+				continue;
+			}
+
+			// count digits of chunks
+			RunChunks(chunkCount, [&](U32 chunk) {
+				U32* counts = &mChunkOffsets[chunk * RADIX_SIZE];
+				Memory::Memset(counts, 0, sizeof(U32) * RADIX_SIZE);
+
+				const U32 begin = chunk * chunkSize;
+				const U32 end = std::min(begin + chunkSize, count);
+				for (U32 i = begin; i < end; i++) {
+					counts[(src[i].mSortKey >> shift) & RADIX_MASK]++;
+				}
+			});
+
+			// offsets of digits, the same digit of chunks are placed in order to keep sort stable
+			U32 offset = 0;
+			for (U32 digit = 0; digit < RADIX_SIZE; digit++)
+			{
+				for (U32 chunk = 0; chunk < chunkCount; chunk++)
+				{
+					U32& digitOffset = mChunkOffsets[chunk * RADIX_SIZE + digit];
+					const U32 digitCount = digitOffset;
+					digitOffset = offset;
+					offset += digitCount;
+				}
+			}
+
+			// scatter chunks
+			RunChunks(chunkCount, [&](U32 chunk) {
+				U32* offsets = &mChunkOffsets[chunk * RADIX_SIZE];
+				const U32 begin = chunk * chunkSize;
+				const U32 end = std::min(begin + chunkSize, count);
+				for (U32 i = begin; i < end; i++) {
+					dst[offsets[(src[i].mSortKey >> shift) & RADIX_MASK]++] = src[i];
+				}
+			});
+			std::swap(src, dst);
+		}
+
+		if (src != mBatches.data()) {
+			mBatches.swap(mSortBuffer);
+		}
+	}
+}
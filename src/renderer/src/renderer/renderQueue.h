@@ -0,0 +1,59 @@
+#pragma once
+
+#include "definitions.h"
+#include "core\container\dynamicArray.h"
+
+namespace Cjing3D
+{
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// RenderBatch
+	/// Draw of a visible object with a 64-bit sort key. Opaque batches are sorted by states to reduce
+	/// state changes, then front to back in the same mesh to reduce overdraw. Transparent batches are
+	/// sorted back to front before states to keep blending correct.
+	///   opaque:      | pass 4 | pipeline 12 | material 16 | mesh 20 | depth 12 |
+	///   transparent: | pass 4 | depth 12 | pipeline 12 | material 16 | mesh 20 |
+	/// Fields are truncated to their bits, the same fields in keys do not guarantee the same states.
+	struct RenderBatch
+	{
+		static const U32 DEPTH_BUCKET_COUNT = 1 << 12;
+
+		U64 mSortKey = 0;
+		U32 mMeshIndex = 0;
+		U32 mObjectIndex = 0;
+
+		// depth is normalized into [0, 1] by the far plane
+		void Setup(RENDERPASS pass, U32 pipeline, U32 material, U32 meshIndex, U32 objectIndex, F32 depth, bool isTransparent);
+	};
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// RenderQueue
+	/// Batches of visible objects sorted by keys in ascending order. Large queues are sorted by a LSD
+	/// radix sort whose chunks are counted and scattered on job threads, bytes which are the same in
+	/// all keys (e.g. pass) are skipped.
+	class RenderQueue
+	{
+	public:
+		// smaller queues are sorted by comparisons, sorts are stable
+		static const U32 RADIX_SORT_THRESHOLD = 256;
+		// smaller queues are sorted on the calling thread
+		static const U32 PARALLEL_SORT_THRESHOLD = 8192;
+		static const U32 SORT_CHUNK_SIZE = 4096;
+
+		RenderQueue() = default;
+		~RenderQueue() = default;
+
+		void Clear();
+		void Reserve(U32 count);
+		RenderBatch& AddBatch();
+		void Sort();
+
+		bool IsEmpty()const { return mBatches.empty(); }
+		U32 GetCount()const { return (U32)mBatches.size(); }
+		const DynamicArray<RenderBatch>& GetBatches()const { return mBatches; }
+
+	private:
+		DynamicArray<RenderBatch> mBatches;
+		DynamicArray<RenderBatch> mSortBuffer;
+		DynamicArray<U32> mChunkOffsets;
+	};
+}
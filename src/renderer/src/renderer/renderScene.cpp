@@ -1,9 +1,111 @@
 
 #include "renderScene.h"
 #include "core\scene\reflection.h"
+#include "resource\resourceManager.h"
 
 namespace Cjing3D
 {	
+    /// ////////////////////////////////////////////////////////////////////////////////
+    /// Components
+    bool MeshComponent::LoadFromModel(const Model& model, I32 meshIndex)
+    {
+        const ModelMesh* modelMesh = model.GetMesh(meshIndex);
+        if (modelMesh == nullptr) {
+            return false;
+        }
+
+        const Span<const char> vertexData = model.GetVertexData();
+        const Span<const char> indexData = model.GetIndexData();
+        const I32 indexStride = modelMesh->mIndexFormat == GPU::INDEX_FORMAT_16BIT ? sizeof(U16) : sizeof(U32);
+        if ((size_t)modelMesh->mVertexDataOffset + (size_t)modelMesh->mVertices * modelMesh->mVertexElementSize > vertexData.length() ||
+            (size_t)modelMesh->mIndexDataOffset + (size_t)modelMesh->mIndices * indexStride > indexData.length())
+        {
+            Logger::Warning("Invalid vertex data of model mesh:%d", meshIndex);
+            return false;
+        }
+
+        auto copySubsets = [](const DynamicArray<ModelSubMesh>& subMeshes, DynamicArray<MeshSubset>& subsets) {
+            subsets.resize(subMeshes.size());
+            for (I32 i = 0; i < subMeshes.size(); i++)
+            {
+                subsets[i].mIndexOffset = subMeshes[i].mIndexOffset;
+                subsets[i].mIndexCount = subMeshes[i].mIndices;
+                subsets[i].mMeshletOffset = subMeshes[i].mStartMeshlets;
+                subsets[i].mMeshletCount = subMeshes[i].mNumMeshlets;
+            }
+        };
+
+        // subsets of lod 0 and simplified lods
+        copySubsets(modelMesh->mSubMeshes, mSubsets);
+        mLods.resize(modelMesh->mLods.size());
+        for (I32 lod = 0; lod < modelMesh->mLods.size(); lod++)
+        {
+            mLods[lod].mError = modelMesh->mLods[lod].mError;
+            copySubsets(modelMesh->mLods[lod].mSubMeshes, mLods[lod].mSubsets);
+        }
+
+        // meshlets of lod 0 for cluster culling
+        mMeshlets = modelMesh->mMeshlets;
+
+        // indices
+        const U8* indices = (const U8*)indexData.data() + modelMesh->mIndexDataOffset;
+        mIndices.resize(modelMesh->mIndices);
+        for (I32 i = 0; i < modelMesh->mIndices; i++)
+        {
+            if (indexStride == sizeof(U16)) {
+                mIndices[i] = ((const U16*)indices)[i];
+            }
+            else {
+                mIndices[i] = ((const U32*)indices)[i];
+            }
+        }
+
+        // vertices, elements are interleaved in order. quantized normals and uvs are only decoded on gpu
+        const U8* vertices = (const U8*)vertexData.data() + modelMesh->mVertexDataOffset;
+        mVertexPositions.clear();
+        mVertexNormals.clear();
+        mVertexUVset.clear();
+        U32 elementOffset = 0;
+        for (const GPU::VertexElement& element : modelMesh->mVertexElements)
+        {
+            for (I32 i = 0; i < modelMesh->mVertices; i++)
+            {
+                const U8* vertex = vertices + i * modelMesh->mVertexElementSize + elementOffset;
+                if (element.mVertexUsage == GPU::VERTEX_USAGE_POSITION && element.mFormat == GPU::FORMAT_R32G32B32_FLOAT)
+                {
+                    F32x3 pos;
+                    Memory::Memcpy(&pos, vertex, sizeof(F32x3));
+                    mVertexPositions.push(pos);
+                }
+                else if (element.mVertexUsage == GPU::VERTEX_USAGE_POSITION && element.mFormat == GPU::FORMAT_R16G16B16A16_UNORM)
+                {
+                    U16 quantized[3];
+                    Memory::Memcpy(quantized, vertex, sizeof(quantized));
+                    F32x3 pos;
+                    for (I32 k = 0; k < 3; k++) {
+                        pos[k] = quantized[k] / 65535.0f * modelMesh->mPositionScale[k] + modelMesh->mPositionOffset[k];
+                    }
+                    mVertexPositions.push(pos);
+                }
+                else if (element.mVertexUsage == GPU::VERTEX_USAGE_NORMAL && element.mFormat == GPU::FORMAT_R32G32B32_FLOAT)
+                {
+                    F32x3 normal;
+                    Memory::Memcpy(&normal, vertex, sizeof(F32x3));
+                    mVertexNormals.push(normal);
+                }
+                else if (element.mVertexUsage == GPU::VERTEX_USAGE_UV && element.mFormat == GPU::FORMAT_R32G32_FLOAT)
+                {
+                    F32x2 uv;
+                    Memory::Memcpy(&uv, vertex, sizeof(F32x2));
+                    mVertexUVset.push(uv);
+                }
+            }
+            elementOffset += GPU::GetFormatInfo(element.mFormat).mBlockBits / 8;
+        }
+
+        return true;
+    }
+
     /// ////////////////////////////////////////////////////////////////////////////////
     /// RenderScene Systems
 
@@ -42,6 +144,8 @@ namespace Cjing3D
         mUniverse(universe)
     {
         // components
+        mMaterials = universe.RegisterComponents<MaterialComponent>(ECS::SceneReflection::RegisterComponentType("Material"));
+        mMeshes = universe.RegisterComponents<MeshComponent>(ECS::SceneReflection::RegisterComponentType("Mesh"));
         mObjects = universe.RegisterComponents<ObjectComponent>(ECS::SceneReflection::RegisterComponentType("Object"));
         mObjectAABBs = universe.RegisterComponents<AABB>(ECS::SceneReflection::RegisterComponentType("ObjectAABB"));
 
@@ -81,6 +185,17 @@ namespace Cjing3D
         return mUniverse;
     }
 
+    MeshComponent* RenderScene::CreateMesh(ECS::Entity entity, const Model& model, I32 meshIndex)
+    {
+        MeshComponent& mesh = mMeshes->Create(entity);
+        if (!mesh.LoadFromModel(model, meshIndex))
+        {
+            mMeshes->Remove(entity);
+            return nullptr;
+        }
+        return &mesh;
+    }
+
     void RenderScene::GetCullingResult(Visibility& cullingResult, Frustum& frustum, I32 cullingFlag)
     {
         struct CullingEntityList
@@ -134,6 +249,90 @@ namespace Cjing3D
         }
     }
 
+    void RenderScene::UpdateObjectLods(Visibility& cullingResult, const Viewport& viewport, F32 maxPixelError)
+    {
+        PROFILE_FUNCTION();
+        if (mMeshes == nullptr) {
+            return;
+        }
+
+        JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+        JobSystem::RunJobs(cullingResult.mObjectCount, 256, [&](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+            const U32 objectIndex = cullingResult.mCulledObjects[jobIndex];
+            ObjectComponent* object = mObjects->GetComponentByIndex(objectIndex);
+            const AABB* aabb = mObjectAABBs->GetComponentByIndex(objectIndex);
+            if (object == nullptr || aabb == nullptr) {
+                return false;
+            }
+
+            const MeshComponent* mesh = mMeshes->GetComponent(object->mMeshID);
+            object->mLod = mesh != nullptr ? SelectLod(*mesh, *aabb, viewport, maxPixelError) : 0;
+            return false;
+        }, 0, &jobHandle);
+        JobSystem::Wait(&jobHandle);
+    }
+
+    void RenderScene::UpdateLoadPriorities(const Visibility& cullingResult)
+    {
+        PROFILE_FUNCTION();
+        if (mMeshes == nullptr || mMaterials == nullptr) {
+            return;
+        }
+
+        // materials are marked once even if they are shared by many objects
+        DynamicArray<bool> isVisible;
+        isVisible.resize((U32)mMaterials->GetCount());
+        isVisible.Fill(false);
+        for (I32 i = 0; i < cullingResult.mObjectCount; i++)
+        {
+            const ObjectComponent* object = mObjects->GetComponentByIndex(cullingResult.mCulledObjects[i]);
+            const MeshComponent* mesh = object != nullptr ? mMeshes->GetComponent(object->mMeshID) : nullptr;
+            if (mesh == nullptr) {
+                continue;
+            }
+
+            for (const auto& subset : mesh->GetSubsets(object->mLod))
+            {
+                const size_t index = mMaterials->GetEntityIndex(subset.mMaterialID);
+                if (index < (size_t)isVisible.size()) {
+                    isVisible[(U32)index] = true;
+                }
+            }
+        }
+
+        // visible materials which are still waiting for io are read first
+        for (I32 i = 0; i < isVisible.size(); i++)
+        {
+            MaterialComponent* material = mMaterials->GetComponentByIndex(i);
+            if (isVisible[i] && material->mMaterial && !material->mMaterial.IsLoaded()) {
+                ResourceManager::SetLoadPriority(material->mMaterial.Ptr(), IOPriority::HIGH);
+            }
+        }
+    }
+
+    I32 RenderScene::SelectLod(const MeshComponent& mesh, const AABB& aabb, const Viewport& viewport, F32 maxPixelError)
+    {
+        if (mesh.mLods.empty()) {
+            return 0;
+        }
+
+        // projected radius of the bounding sphere in pixels
+        const F32 radius = Distance(aabb.GetMin(), aabb.GetMax()) * 0.5f;
+        const F32 distance = std::max(Distance(viewport.mEye, aabb.GetCenter()) - radius, viewport.mNear);
+        const F32 projectedRadius = radius / (distance * std::tan(viewport.mFov * 0.5f)) * viewport.mHeight * 0.5f;
+
+        // lod errors are increasing
+        I32 lod = 0;
+        for (I32 i = 0; i < mesh.mLods.size(); i++)
+        {
+            if (mesh.mLods[i].mError * projectedRadius > maxPixelError) {
+                break;
+            }
+            lod = i + 1;
+        }
+        return lod;
+    }
+
     void RenderScene::RegisterReflect()
     {
         CJING_BEGIN_SCENE(RenderSceneImpl, "RenderScene")
@@ -5,6 +5,7 @@
 #include "renderer\renderer.h"
 
 #include "material.h"
+#include "model.h"
 
 namespace Cjing3D
 {
@@ -45,8 +46,23 @@ namespace Cjing3D
 			ECS::Entity mMaterialID = ECS::INVALID_ENTITY;
 			U32 mIndexOffset = 0;
 			U32 mIndexCount = 0;
+			U32 mMeshletOffset = 0;	// meshlets of lod 0 for cluster culling
+			U32 mMeshletCount = 0;
 		};
 		DynamicArray<MeshSubset> mSubsets;
+		DynamicArray<ModelMeshlet> mMeshlets;
+
+		// simplified lods, subsets are lod 0
+		struct MeshLod
+		{
+			F32 mError = 0.0f;	// relative to the bounding radius
+			DynamicArray<MeshSubset> mSubsets;
+		};
+		DynamicArray<MeshLod> mLods;
+
+		const DynamicArray<MeshSubset>& GetSubsets(I32 lod)const {
+			return (lod > 0 && lod <= mLods.size()) ? mLods[lod - 1].mSubsets : mSubsets;
+		}
 
 		DynamicArray<F32x3> mVertexPositions;
 		DynamicArray<F32x3> mVertexNormals;
@@ -77,6 +93,9 @@ namespace Cjing3D
 		{
 			U32 mColor = 0;
 		};
+
+		// copy subsets, lods, meshlets and cpu side vertices from the mesh of model
+		bool LoadFromModel(const Model& model, I32 meshIndex);
 	};
 
 	struct ObjectComponent
@@ -93,6 +112,7 @@ namespace Cjing3D
 		F32x4 mColor = F32x4(1.0f, 1.0f, 1.0f, 1.0f);
 		F32x3 mCenter = F32x3(0.0f, 0.0f, 0.0f); // assigned in system updating
 		I32   mTransformIndex = -1;
+		I32   mLod = 0;	// assigned in lod selection
 
 		bool IsRenderable()const {
 			return mFalgs & RENDERABLE;
@@ -123,7 +143,16 @@ namespace Cjing3D
 		void Clear()override;
 		Universe& GetUniverse()override;
 
+		MeshComponent* CreateMesh(ECS::Entity entity, const Model& model, I32 meshIndex);
+
 		void GetCullingResult(Visibility& cullingResult, Frustum& frustum, I32 cullingFlag);
+		// select lods of culled objects by projected screen size
+		void UpdateObjectLods(Visibility& cullingResult, const Viewport& viewport, F32 maxPixelError = 1.0f);
+		// bump load priorities of materials used by culled objects
+		void UpdateLoadPriorities(const Visibility& cullingResult);
+
+		// select the coarsest lod whose projected error is less than maxPixelError
+		static I32 SelectLod(const MeshComponent& mesh, const AABB& aabb, const Viewport& viewport, F32 maxPixelError);
 
 		static void RegisterReflect();
 
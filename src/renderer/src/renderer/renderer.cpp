@@ -2,9 +2,12 @@
 #include "renderScene.h"
 #include "renderImage.h"
 #include "textureHelper.h"
+#include "clusterCulling.h"
+#include "renderQueue.h"
 #include "renderGraph\renderGraph.h"
 #include "resource\resourceManager.h"
 #include "core\platform\platform.h"
+#include "core\concurrency\jobsystem.h"
 #include "core\scene\universe.h"
 #include "core\helper\profiler.h"
 #include "core\helper\enumTraits.h"
@@ -31,50 +34,10 @@ namespace Renderer
 		}
 	};
 
-	// Object render batch  for object rendering
-	struct ObjectRenderBatch
-	{
-		U64 mHash = 0;
-		U32 mObjectIndex = 0;
-
-		void Setup(U32 meshIndex, U32 objectIndex, F32 distance)
-		{
-			mHash = ((U64)distance) << 32 | (U64)meshIndex;
-			mObjectIndex = objectIndex;
-		}
-
-		U32 GetMeshIndex()
-		{
-			return (U32)(mHash & 0xFFFFFFFF);
-		}
-	};
-
-	struct ObjectRenderQueue
-	{
-		enum SortMethod
-		{
-			FrontToBack,
-			BackToFront,
-		};
-
-		DynamicArray<ObjectRenderBatch*> mRenderBatches;
-
-		bool IsEmpty()const {
-			return mRenderBatches.empty();
-		}
-		
-		void AddBatch(ObjectRenderBatch* batch) {
-			mRenderBatches.push(batch);
-		}
-
-		void Sort(SortMethod sortMethod)
-		{
-			std::sort(mRenderBatches.begin(), mRenderBatches.end(), 
-				[sortMethod](const ObjectRenderBatch* a, const ObjectRenderBatch* b) {
-					return sortMethod == FrontToBack ? a->mHash < b->mHash : a->mHash > b->mHash;
-				});
-		}
-	};
+	// sorted batches are recorded into parallel recorders, each recorder records at least
+	// PARALLEL_RECORD_BATCH_COUNT batches
+	static const U32 PARALLEL_RECORD_BATCH_COUNT = 1024;
+	static const U32 MAX_PARALLEL_RECORDERS = 8;
 
 	struct InstanceHandler
 	{
@@ -101,7 +64,7 @@ namespace Renderer
 		void BindConstantBuffers(RenderGraphResources& resources, ShaderBindingContext& context, GPU::SHADERSTAGES stage);
 
 		void ProcessMeshRenderQueue(
-			ObjectRenderQueue& queue, 
+			const RenderQueue& queue, 
 			RENDERPASS renderPass, 
 			RENDERTYPE renderType,
 			const Visibility& cullResult, 
@@ -113,6 +76,7 @@ namespace Renderer
 
 		ShaderTechnique GetObjectTech(RENDERPASS renderPass, BLENDMODE blendMode);
 		ShaderTechnique GetObjectTech(Shader& shader, RENDERPASS renderPass, BLENDMODE blendMode);
+		U32 GetPipelineSortID(MaterialComponent& material);
 
 	public:
 		Concurrency::RWLock mLock;
@@ -179,7 +143,7 @@ namespace Renderer
 	}
 
 	void RendererImpl::ProcessMeshRenderQueue(
-		ObjectRenderQueue& queue,
+		const RenderQueue& queue,
 		RENDERPASS renderPass, 
 		RENDERTYPE renderType, 
 		const Visibility& cullResult, 
@@ -205,145 +169,250 @@ namespace Renderer
 		U32 instanceDataSize = sizeof(RenderInstance);
 
 		// allocate all intances
-		I32 instanceSize = queue.mRenderBatches.size() * handlerCount * instanceDataSize;
-		GPU::GPUAllocation instanceAllocation = cmd.GPUAlloc(instanceSize);
-
-		// InstancedBatch combines ObjectRenderBatch by the same meshIndex
-		struct InstancedBatch
+		GPU::UploadAllocator uploadAllocator(cmd);
+		GPU::UploadSpan<RenderInstance> instances = uploadAllocator.Alloc<RenderInstance>(queue.GetCount() * handlerCount);
+		if (!instances)
 		{
-			U32 mMeshIndex = 0;
-			U32 mInstanceCount = 0;
-			U32 mInstanceOffset = 0;
-		};
-		InstancedBatch instancedBatch;
-		instancedBatch.mMeshIndex = ~0;	// init mesh index unused
+			cmd.EventEnd();
+			return;
+		}
 
-		// flush and render current render batch
-		auto FlushRenderBatch = [&](const InstancedBatch& renderBatch)
+		// batches in [batchBegin, batchEnd) are recorded, instances of a batch start at batchBegin * handlerCount
+		auto RecordBatches = [&](GPU::CommandList& recordCmd, ShaderBindingContext& recordContext, U32 batchBegin, U32 batchEnd)
 		{
-			if (renderBatch.mInstanceCount <= 0) {
-				return;
-			}
-
-			const MeshComponent* mesh = scene.mMeshes->GetComponentByIndex(renderBatch.mMeshIndex);
-			if (!mesh) {
-				return;
-			}
-
-			cmd.BindIndexBuffer(GPU::Binding::IndexBuffer(mesh->mIndexBuffer, 0), mesh->GetIndexFormat());
-
-			// bind vertex buffer
-			DynamicArray<GPU::BindingBuffer> buffers;
-			buffers.push(GPU::Binding::VertexBuffer(mesh->mVertexBufferPos, 0, sizeof(MeshComponent::VertexPos)));
-			buffers.push(GPU::Binding::VertexBuffer(mesh->mVertexBufferTex, 0, sizeof(MeshComponent::VertexTex)));
-			buffers.push(GPU::Binding::VertexBuffer(mesh->mVertexBufferColor, 0, sizeof(MeshComponent::VertexColor)));
-			buffers.push(GPU::Binding::VertexBuffer(instanceAllocation.mBuffer, renderBatch.mInstanceOffset, sizeof(RenderInstance)));
-			cmd.BindVertexBuffer(Span(buffers.data(), buffers.size()), 0);
-
-			// render mesh subsets
-			for (const auto& subset : mesh->mSubsets)
+			// InstancedBatch combines ObjectRenderBatch by the same meshIndex
+			struct InstancedBatch
 			{
-				if (subset.mIndexCount <= 0) {
-					continue;
-				}
-
-				MaterialComponent* material = scene.mMaterials->GetComponent(subset.mMaterialID);
-				if (!material) {
-					continue;
+				U32 mMeshIndex = 0;
+				I32 mObjectIndex = -1;
+				I32 mLod = 0;
+				U32 mInstanceCount = 0;
+				U32 mInstanceOffset = 0;
+			};
+			InstancedBatch instancedBatch;
+			instancedBatch.mMeshIndex = ~0;	// init mesh index unused
+			DynamicArray<ClusterCulling::ClusterDraw> clusterDraws;
+
+			// flush and render current render batch
+			auto FlushRenderBatch = [&](const InstancedBatch& renderBatch)
+			{
+				if (renderBatch.mInstanceCount <= 0) {
+					return;
 				}
 
-				// check render enable
-				bool isRenderable = true;
-
-				if (!isRenderable) {
-					continue;
+				const MeshComponent* mesh = scene.mMeshes->GetComponentByIndex(renderBatch.mMeshIndex);
+				if (!mesh) {
+					return;
 				}
 
-				// get target shader technique
-				ShaderTechnique tech;
-				if (material->mUseCustomShader && material->mMaterial)
+				recordCmd.BindIndexBuffer(GPU::Binding::IndexBuffer(mesh->mIndexBuffer, 0), mesh->GetIndexFormat());
+
+				// bind vertex buffer
+				DynamicArray<GPU::BindingBuffer> buffers;
+				buffers.push(GPU::Binding::VertexBuffer(mesh->mVertexBufferPos, 0, sizeof(MeshComponent::VertexPos)));
+				buffers.push(GPU::Binding::VertexBuffer(mesh->mVertexBufferTex, 0, sizeof(MeshComponent::VertexTex)));
+				buffers.push(GPU::Binding::VertexBuffer(mesh->mVertexBufferColor, 0, sizeof(MeshComponent::VertexColor)));
+				buffers.push(GPU::Binding::VertexBuffer(instances.mBuffer, renderBatch.mInstanceOffset, sizeof(RenderInstance)));
+				recordCmd.BindVertexBuffer(Span(buffers.data(), buffers.size()), 0);
+
+				// meshlets are culled for a single instance of lod 0 in the main pass,
+				// instanced batches are drawn entirely
+				const bool isClusterCulling =
+					renderPass == RENDERPASS_MAIN &&
+					renderBatch.mInstanceCount == 1 &&
+					renderBatch.mLod == 0 &&
+					!mesh->mMeshlets.empty() &&
+					cullResult.mViewport != nullptr;
+
+				F32x4x4 worldMatrix = IDENTITY_MATRIX;
+				if (isClusterCulling)
 				{
-					// custom shader
-					tech = GetObjectTech(*material->mMaterial->GetShader(), renderPass, material->GetBlendMode());
+					const ObjectComponent* object = scene.mObjects->GetComponentByIndex(renderBatch.mObjectIndex);
+					Transform* transform = (object != nullptr && object->mTransformIndex >= 0) ? transforms->GetComponentByIndex(object->mTransformIndex) : nullptr;
+					if (transform != nullptr) {
+						worldMatrix = transform->mWorld;
+					}
 				}
-				else
+
+				// render mesh subsets
+				for (const auto& subset : mesh->GetSubsets(renderBatch.mLod))
 				{
-					tech = GetObjectTech(renderPass, material->GetBlendMode());
+					if (subset.mIndexCount <= 0) {
+						continue;
+					}
+
+					const bool isSubsetCulling = isClusterCulling && subset.mMeshletCount > 0;
+					if (isSubsetCulling)
+					{
+						const Viewport& viewport = *cullResult.mViewport;
+						ClusterCulling::CullMeshlets(mesh->mMeshlets.data() + subset.mMeshletOffset, subset.mMeshletCount,
+							worldMatrix, viewport.mFrustum, viewport.mEye, clusterDraws);
+						if (clusterDraws.empty()) {
+							continue;
+						}
+					}
+
+					MaterialComponent* material = scene.mMaterials->GetComponent(subset.mMaterialID);
+					if (!material) {
+						continue;
+					}
+
+					// check render enable
+					bool isRenderable = true;
+
+					if (!isRenderable) {
+						continue;
+					}
+
+					// get target shader technique
+					ShaderTechnique tech;
+					if (material->mUseCustomShader && material->mMaterial)
+					{
+						// custom shader
+						tech = GetObjectTech(*material->mMaterial->GetShader(), renderPass, material->GetBlendMode());
+					}
+					else
+					{
+						tech = GetObjectTech(renderPass, material->GetBlendMode());
+					}
+
+					if (!tech || tech.GetPipelineState() == GPU::ResHandle::INVALID_HANDLE) {
+						continue;
+					}
+
+					// bind material constant buffer
+					ShaderBindingSet bindingSet = Shader::CreateGlobalBindingSet("MaterialBindings");
+					bindingSet.Set("constBuffer_Material", GPU::Binding::ConstantBuffer(material->mConstantBuffer, GPU::SHADERSTAGES_VS));
+					bindingSet.Set("constBuffer_Material", GPU::Binding::ConstantBuffer(material->mConstantBuffer, GPU::SHADERSTAGES_PS));
+
+					// bind material textures
+					bindingSet.Set("texture_BaseColorMap", GPU::Binding::Texture(material->GetTexture(Material::BaseColorMap), GPU::SHADERSTAGES_PS));
+					bindingSet.Set("texture_NormalMap", GPU::Binding::Texture(material->GetTexture(Material::NormalMap), GPU::SHADERSTAGES_PS));
+					bindingSet.Set("texture_SurfaceMap", GPU::Binding::Texture(material->GetTexture(Material::SurfaceMap), GPU::SHADERSTAGES_PS));
+
+					if (recordContext.Bind(tech, bindingSet))
+					{
+						recordCmd.BindPipelineState(tech.GetPipelineState());
+						if (isSubsetCulling)
+						{
+							for (const auto& draw : clusterDraws) {
+								recordCmd.DrawIndexedInstanced(draw.mIndexCount, 1, draw.mIndexOffset, 0, 0);
+							}
+						}
+						else
+						{
+							recordCmd.DrawIndexedInstanced(subset.mIndexCount, renderBatch.mInstanceCount, subset.mIndexOffset, 0, 0);
+						}
+					}
 				}
+			};
 
-				if (!tech || tech.GetPipelineState() == GPU::ResHandle::INVALID_HANDLE) {
+			// MeshIndexͬObjectRenderBatchϲΪһInstancedBatch
+			I32 totalInstanceCount = batchBegin * handlerCount;
+
+			const auto& batches = queue.GetBatches();
+			for (U32 batchIndex = batchBegin; batchIndex < batchEnd; batchIndex++)
+			{
+				const RenderBatch& renderBatch = batches[batchIndex];
+				const I32 objectIndex = renderBatch.mObjectIndex;
+				const I32 meshIndex = renderBatch.mMeshIndex;
+				const ObjectComponent* object = scene.mObjects->GetComponentByIndex(objectIndex);
+				if (object == nullptr) {
 					continue;
 				}
 
-				// bind material constant buffer
-				ShaderBindingSet bindingSet = Shader::CreateGlobalBindingSet("MaterialBindings");
-				bindingSet.Set("constBuffer_Material", GPU::Binding::ConstantBuffer(material->mConstantBuffer, GPU::SHADERSTAGES_VS));
-				bindingSet.Set("constBuffer_Material", GPU::Binding::ConstantBuffer(material->mConstantBuffer, GPU::SHADERSTAGES_PS));
+				// objects of different lods are not instanced together
+				if (meshIndex != instancedBatch.mMeshIndex || object->mLod != instancedBatch.mLod)
+				{
+					FlushRenderBatch(instancedBatch);
+
+					instancedBatch.mMeshIndex = meshIndex;
+					instancedBatch.mObjectIndex = objectIndex;
+					instancedBatch.mLod = object->mLod;
+					instancedBatch.mInstanceCount = 0;
+					instancedBatch.mInstanceOffset = instances.mOffset + totalInstanceCount * instanceDataSize;
+				}
 
-				// bind material textures
-				bindingSet.Set("texture_BaseColorMap", GPU::Binding::Texture(material->GetTexture(Material::BaseColorMap), GPU::SHADERSTAGES_PS));
-				bindingSet.Set("texture_NormalMap", GPU::Binding::Texture(material->GetTexture(Material::NormalMap), GPU::SHADERSTAGES_PS));
-				bindingSet.Set("texture_SurfaceMap", GPU::Binding::Texture(material->GetTexture(Material::SurfaceMap), GPU::SHADERSTAGES_PS));
+				// һµRenderInstanceӵǰInstancedBatch
+				F32x4x4 worldMatrix = IDENTITY_MATRIX;
+				Transform* transform = object->mTransformIndex >= 0 ? transforms->GetComponentByIndex(object->mTransformIndex) : nullptr;
+				if (transform != nullptr) {
+					worldMatrix = transform->mWorld;
+				}
 
-				if (shaderContext.Bind(tech, bindingSet))
+				for (U32 handleIndex = 0; handleIndex < handlerCount; handleIndex++)
 				{
-					cmd.BindPipelineState(tech.GetPipelineState());
-					cmd.DrawIndexedInstanced(subset.mIndexCount, renderBatch.mInstanceCount, subset.mIndexOffset, 0, 0);
+					if ( instanceHandler != nullptr &&
+						 instanceHandler->checkCondition_ != nullptr &&
+						!instanceHandler->checkCondition_(handleIndex, objectIndex, scene)) {
+						continue;
+					}
+
+					// setup renderInstance from worldMatrix and object color
+					RenderInstance& renderInstance = instances[totalInstanceCount];
+					renderInstance.Setup(worldMatrix, object->mColor);
+
+					if (instanceHandler != nullptr &&
+						instanceHandler->processInstance_ != nullptr) {
+						instanceHandler->processInstance_(handleIndex, renderInstance);
+					}
+
+					instancedBatch.mInstanceCount++;
+					totalInstanceCount++;
 				}
 			}
-		};
 
-		// MeshIndexͬObjectRenderBatchϲΪһInstancedBatch
-		I32 totalInstanceCount = 0;
+			FlushRenderBatch(instancedBatch);
+		};
 
-		for (ObjectRenderBatch* renderBatch : queue.mRenderBatches)
+		// large queues are split at mesh boundaries and recorded into parallel recorders,
+		// instance handlers are not required to be thread-safe
+		const U32 batchCount = queue.GetCount();
+		U32 recorderCount = 1;
+		if (instanceHandler == nullptr && JobSystem::IsInitialized())
 		{
-			const I32 objectIndex = renderBatch->mObjectIndex;
-			const I32 meshIndex = renderBatch->GetMeshIndex();
-			if (meshIndex != instancedBatch.mMeshIndex)
-			{
-				FlushRenderBatch(instancedBatch);
-
-				instancedBatch.mMeshIndex = meshIndex;
-				instancedBatch.mInstanceCount = 0;
-				instancedBatch.mInstanceOffset = instanceAllocation.mOffset + totalInstanceCount * instanceDataSize;
-			}
+			recorderCount = std::min(batchCount / PARALLEL_RECORD_BATCH_COUNT, (U32)std::max(Platform::GetCPUsCount(), 1));
+			recorderCount = std::min(recorderCount, MAX_PARALLEL_RECORDERS);
+		}
 
-			// һµRenderInstanceӵǰInstancedBatch
-			const ObjectComponent* object = scene.mObjects->GetComponentByIndex(objectIndex);
-			if (object == nullptr) {
-				continue;
-			}
+		// commands of recorders are merged before the end of event
+		Span<GPU::CommandList*> recorders;
+		if (recorderCount > 1) {
+			recorders = resources.CreateParallelRecorders(recorderCount);
+		}
+		if (recorders.length() < recorderCount || recorderCount <= 1)
+		{
+			RecordBatches(cmd, shaderContext, 0, batchCount);
+			cmd.EventEnd();
+			return;
+		}
 
-			F32x4x4 worldMatrix = IDENTITY_MATRIX;
-			Transform* transform = object->mTransformIndex >= 0 ? transforms->GetComponentByIndex(object->mTransformIndex) : nullptr;
-			if (transform != nullptr) {
-				worldMatrix = transform->mWorld;
+		StaticArray<U32, MAX_PARALLEL_RECORDERS + 1> ranges;
+		ranges[0] = 0;
+		const auto& batches = queue.GetBatches();
+		for (U32 i = 1; i < recorderCount; i++)
+		{
+			U32 split = std::max(batchCount * i / recorderCount, ranges[i - 1]);
+			while (split > 0 && split < batchCount && batches[split].mMeshIndex == batches[split - 1].mMeshIndex) {
+				split++;
 			}
+			ranges[i] = split;
+		}
+		ranges[recorderCount] = batchCount;
 
-			for (U32 handleIndex = 0; handleIndex < handlerCount; handleIndex++)
-			{
-				if ( instanceHandler != nullptr &&
-					 instanceHandler->checkCondition_ != nullptr &&
-					!instanceHandler->checkCondition_(handleIndex, objectIndex, scene)) {
-					continue;
-				}
-
-				// setup renderInstance from worldMatrix and object color
-				RenderInstance& renderInstance = ((RenderInstance*)instanceAllocation.mData)[totalInstanceCount];
-				renderInstance.Setup(worldMatrix, object->mColor);
-
-				if (instanceHandler != nullptr &&
-					instanceHandler->processInstance_ != nullptr) {
-					instanceHandler->processInstance_(handleIndex, renderInstance);
-				}
-
-				instancedBatch.mInstanceCount++;
-				totalInstanceCount++;
+		JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+		JobSystem::RunJobs(recorderCount, 1, [&](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+			if (ranges[jobIndex] >= ranges[jobIndex + 1]) {
+				return false;
 			}
-		}
 
-		FlushRenderBatch(instancedBatch);
+			GPU::CommandList& recorder = *recorders[jobIndex];
+			ShaderBindingContext context(recorder);
+			BindCommonResources(resources, context);
+			RecordBatches(recorder, context, ranges[jobIndex], ranges[jobIndex + 1]);
+			return false;
+		}, 0, &jobHandle);
+		JobSystem::Wait(&jobHandle);
 
 		cmd.EventEnd();
 	}
@@ -365,6 +434,20 @@ namespace Renderer
 		return std::move(shader.CreateTechnique(hasher, desc));
 	}
 
+	U32 RendererImpl::GetPipelineSortID(MaterialComponent& material)
+	{
+		// the technique is selected by the shader and the blend mode in the same pass
+		U32 pipelineID = (U32)material.GetBlendMode();
+		if (material.mUseCustomShader && material.mMaterial)
+		{
+			ShaderRef shader = material.mMaterial->GetShader();
+			if (shader) {
+				HashCombine(pipelineID, shader->GetPath().GetHash());
+			}
+		}
+		return pipelineID;
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Function
 	//////////////////////////////////////////////////////////////////////////
@@ -387,10 +470,16 @@ namespace Renderer
 
 		// initialize impl
 		mImpl = CJING_NEW(RendererImpl);
-		auto clientBounds = Platform::GetClientBounds(params.mWindow);
-		mImpl->mWindowSize = {
-			(U32)(clientBounds.mRight - clientBounds.mLeft),
-			(U32)(clientBounds.mBottom - clientBounds.mTop) };
+		if (params.mIsHeadless) {
+			mImpl->mWindowSize = { params.mHeadlessWidth, params.mHeadlessHeight };
+		}
+		else
+		{
+			auto clientBounds = Platform::GetClientBounds(params.mWindow);
+			mImpl->mWindowSize = {
+				(U32)(clientBounds.mRight - clientBounds.mLeft),
+				(U32)(clientBounds.mBottom - clientBounds.mTop) };
+		}
 
 		// editor may load shaders lazy
 		if (loadShaders) {
@@ -466,7 +555,10 @@ namespace Renderer
 		mImpl->BindCommonResources(resources, context);
 
 		// setup render queue
-		ObjectRenderQueue queue;
+		const bool isTransparent = renderType == RENDERTYPE_TRANSPARENT;
+		const F32 depthScale = 1.0f / std::max(cullResult.mViewport->mFar, 1.0f);
+		RenderQueue queue;
+		queue.Reserve(cullResult.mObjectCount);
 		for (int i = 0; i < cullResult.mObjectCount; i++)
 		{
 			I32 index = cullResult.mCulledObjects[i];
@@ -475,15 +567,32 @@ namespace Renderer
 				continue;
 			}
 
+			const MeshComponent* mesh = scene.mMeshes->GetComponent(object->mMeshID);
+			if (mesh == nullptr) {
+				continue;
+			}
+
+			// states of the object are sorted by the first material of its mesh
+			U32 pipelineID = 0;
+			U32 materialIndex = 0;
+			const auto& subsets = mesh->GetSubsets(object->mLod);
+			MaterialComponent* material = !subsets.empty() ? scene.mMaterials->GetComponent(subsets[0].mMaterialID) : nullptr;
+			if (material != nullptr)
+			{
+				pipelineID = mImpl->GetPipelineSortID(*material);
+				materialIndex = (U32)scene.mMaterials->GetEntityIndex(subsets[0].mMaterialID);
+			}
+
 			F32 distance = Distance(cullResult.mViewport->mEye, object->mCenter);
-			ObjectRenderBatch* batch = cmd.Alloc<ObjectRenderBatch>();
-			batch->Setup(scene.mMeshes->GetEntityIndex(object->mMeshID), index, distance);
+			RenderBatch& batch = queue.AddBatch();
+			batch.Setup(renderPass, pipelineID, materialIndex, (U32)scene.mMeshes->GetEntityIndex(object->mMeshID), index, distance * depthScale, isTransparent);
 		}
 
 		if (!queue.IsEmpty())
 		{
 			// TransparentҪӺǰʵblendingobjectҪǰ󣬸depthCmpover draw
-			queue.Sort(renderType != RENDERTYPE_TRANSPARENT ? ObjectRenderQueue::FrontToBack : ObjectRenderQueue::BackToFront);
+			// the order is encoded in sort keys, adjacent batches of the same mesh are instanced
+			queue.Sort();
 			mImpl->ProcessMeshRenderQueue(queue, renderPass, renderType, cullResult, resources, cmd, context);
 		}
 	}
@@ -547,6 +656,8 @@ namespace Renderer
 		auto scene = GetRenderScene();
 		if (scene != nullptr) {
 			scene->GetCullingResult(cullingResult, viewport.mFrustum, cullingFlag);
+			scene->UpdateObjectLods(cullingResult, viewport);
+			scene->UpdateLoadPriorities(cullingResult);
 		}
 
 		Profiler::EndCPUBlock();
@@ -0,0 +1,540 @@
+#include "assetCooker.h"
+#include "resourceManager.h"
+#include "core\helper\debug.h"
+#include "core\helper\timer.h"
+#include "core\helper\stream.h"
+#include "core\helper\profiler.h"
+#include "core\serialization\jsonArchive.h"
+#include "core\concurrency\jobsystem.h"
+#include "core\platform\platform.h"
+#include "math\hash.h"
+
+#include <algorithm>
+
+namespace Cjing3D
+{
+	namespace
+	{
+		// cache file format:
+		// | CookCacheHeader
+		// | [path string][U64 size][data] for each file (outputs and metadata)
+		// index file format:
+		// | CookCacheHeader
+		// | [U32 path hash][U64 content hash] for each cooked asset
+#pragma pack(1)
+		struct CookCacheHeader
+		{
+			static const U32 MAGIC = 0x4B4F4F43;	// 'COOK'
+			static const U32 VERSION = 1;
+
+			U32 mMagic = MAGIC;
+			U32 mVersion = VERSION;
+			U32 mCount = 0;
+		};
+#pragma pack()
+
+		const char* COOK_INDEX_NAME = "cook.index";
+
+		bool ReadCacheHeader(InputMemoryStream& stream, CookCacheHeader& header)
+		{
+			if (!stream.Read(&header, sizeof(header))) {
+				return false;
+			}
+			return header.mMagic == CookCacheHeader::MAGIC && header.mVersion == CookCacheHeader::VERSION;
+		}
+
+		void GetMetaFilePath(const char* srcPath, MaxPathString& outPath)
+		{
+			outPath = srcPath;
+			outPath.append(".metadata");
+		}
+	}
+
+	const char* AssetCooker::DEFAULT_CACHE_PATH = ".cook_cache";
+
+	AssetCooker::AssetCooker(BaseFileSystem& filesystem, const char* cachePath) :
+		mFileSystem(filesystem),
+		mCachePath(cachePath)
+	{
+	}
+
+	AssetCooker::~AssetCooker()
+	{
+		Clear();
+	}
+
+	void AssetCooker::AddConverter(IResConverter* converter)
+	{
+		if (converter != nullptr && mConverters.indexOf(converter) < 0) {
+			mConverters.push(converter);
+		}
+	}
+
+	void AssetCooker::AddAsset(const char* path)
+	{
+		mAssets.push(Path(path));
+	}
+
+	void AssetCooker::Clear()
+	{
+		mAssets.clear();
+		mResults.clear();
+		mCookedIndex.clear();
+		mStats = Stats();
+	}
+
+	bool AssetCooker::Cook()
+	{
+		PROFILE_FUNCTION();
+		const F64 startTime = Timer::GetAbsoluteTime();
+		mResults.clear();
+		mStats = Stats();
+
+		if (!mFileSystem.IsDirExists(mCachePath.c_str())) {
+			mFileSystem.CreateDir(mCachePath.c_str());
+		}
+		LoadIndex();
+
+		DynamicArray<AssetNode> nodes;
+		BuildGraph(nodes);
+		mResults.resize(nodes.size());
+
+		// cook assets wave by wave, assets in a wave have no pending dependencies
+		DynamicArray<I32> readyNodes;
+		DynamicArray<I32> nextNodes;
+		for (I32 i = 0; i < nodes.size(); i++)
+		{
+			if (nodes[i].mDependencyCount == 0) {
+				readyNodes.push(i);
+			}
+		}
+
+		I32 cookedCount = 0;
+		while (cookedCount < nodes.size())
+		{
+			if (readyNodes.empty())
+			{
+				// cyclic dependencies, cook the remaining assets together
+				Logger::Warning("[AssetCooker] Cyclic dependencies are found.");
+				for (I32 i = 0; i < nodes.size(); i++)
+				{
+					if (nodes[i].mDependencyCount > 0) {
+						readyNodes.push(i);
+					}
+				}
+			}
+
+			for (I32 index : readyNodes) {
+				nodes[index].mDependencyCount = -1;
+			}
+
+			JobSystem::JobHandle jobHandle = JobSystem::INVALID_HANDLE;
+			JobSystem::RunJobs(readyNodes.size(), 1, [&](I32 jobIndex, JobSystem::JobGroupArgs* args, void* sharedMem) {
+				const I32 index = readyNodes[jobIndex];
+				CookAsset(nodes[index], mResults[index]);
+				return false;
+			}, 0, &jobHandle);
+			JobSystem::Wait(&jobHandle);
+
+			cookedCount += readyNodes.size();
+			mStats.mWaveCount++;
+
+			nextNodes.clear();
+			for (I32 index : readyNodes)
+			{
+				for (I32 dependent : nodes[index].mDependents)
+				{
+					if (nodes[dependent].mDependencyCount > 0 && --nodes[dependent].mDependencyCount == 0) {
+						nextNodes.push(dependent);
+					}
+				}
+			}
+			readyNodes.swap(nextNodes);
+		}
+
+		// update index and stats
+		for (const CookResult& result : mResults)
+		{
+			const U32 pathHash = result.mPath.GetHash();
+			switch (result.mState)
+			{
+			case CookState::UP_TO_DATE:
+				mStats.mUpToDateCount++;
+				break;
+			case CookState::RESTORED:
+				mStats.mRestoredCount++;
+				break;
+			case CookState::CONVERTED:
+				mStats.mConvertedCount++;
+				break;
+			default:
+				mStats.mFailedCount++;
+				mCookedIndex.erase(pathHash);
+				continue;
+			}
+
+			U64* contentHash = mCookedIndex.find(pathHash);
+			if (contentHash != nullptr) {
+				*contentHash = result.mContentHash;
+			}
+			else {
+				mCookedIndex.insert(pathHash, result.mContentHash);
+			}
+		}
+		SaveIndex();
+
+		mStats.mAssetCount = mResults.size();
+		mStats.mTotalTime = (Timer::GetAbsoluteTime() - startTime) * 1000.0;
+		return mStats.mFailedCount == 0;
+	}
+
+	void AssetCooker::PrintReport() const
+	{
+		// slowest assets first
+		DynamicArray<const CookResult*> results;
+		results.reserve(mResults.size());
+		for (const CookResult& result : mResults) {
+			results.push(&result);
+		}
+		std::sort(results.begin(), results.end(), [](const CookResult* a, const CookResult* b) {
+			return a->mTime > b->mTime;
+		});
+
+		const char* stateNames[] = { "up-to-date", "restored", "converted", "failed" };
+		for (const CookResult* result : results) {
+			Logger::Info("[AssetCooker] %-10s %8.2f ms  %s", stateNames[(I32)result->mState], result->mTime, result->mPath.c_str());
+		}
+
+		Logger::Info("[AssetCooker] Cooked %d assets in %.2f ms (%d waves): %d up-to-date, %d restored, %d converted, %d failed.",
+			mStats.mAssetCount, mStats.mTotalTime, mStats.mWaveCount,
+			mStats.mUpToDateCount, mStats.mRestoredCount, mStats.mConvertedCount, mStats.mFailedCount);
+	}
+
+	void AssetCooker::BuildGraph(DynamicArray<AssetNode>& nodes)
+	{
+		PROFILE_FUNCTION();
+		HashMap<U32, I32> nodeMap;
+		nodes.reserve(mAssets.size());
+		for (const Path& path : mAssets)
+		{
+			if (nodeMap.find(path.GetHash()) != nullptr) {
+				continue;
+			}
+
+			ResourceType type = ResourceManager::GetResourceType(path.c_str());
+			if (type == ResourceType::INVALID_TYPE) {
+				continue;
+			}
+
+			MaxPathString ext;
+			Path::GetPathExtension(path.toSpan(), ext.toSpan());
+			IResConverter* converter = FindConverter(ext.c_str(), type);
+			if (converter == nullptr) {
+				continue;
+			}
+
+			nodes.resize(nodes.size() + 1);
+			AssetNode& node = nodes.back();
+			node.mPath = path;
+			node.mType = type;
+			node.mConverter = converter;
+
+			// sources and outputs of the last converting
+			MaxPathString metaPath;
+			GetMetaFilePath(path.c_str(), metaPath);
+			if (mFileSystem.IsFileExists(metaPath.c_str()))
+			{
+				JsonArchive archive(metaPath.c_str(), ArchiveMode::ArchiveMode_Read, &mFileSystem);
+				archive.Read("$internal", [&node](JsonArchive& archive) {
+					archive.Read("sources", node.mSources);
+					archive.Read("outputs", node.mOutputs);
+				});
+			}
+		}
+
+		// map assets and their outputs to nodes
+		for (I32 i = 0; i < nodes.size(); i++) {
+			nodeMap.insert(nodes[i].mPath.GetHash(), i);
+		}
+		for (I32 i = 0; i < nodes.size(); i++)
+		{
+			for (const String& output : nodes[i].mOutputs)
+			{
+				const U32 hash = Path(output.c_str()).GetHash();
+				if (nodeMap.find(hash) == nullptr) {
+					nodeMap.insert(hash, i);
+				}
+			}
+		}
+
+		// asset depends on the assets which produce its sources
+		for (I32 i = 0; i < nodes.size(); i++)
+		{
+			for (const String& source : nodes[i].mSources)
+			{
+				const I32* dependency = nodeMap.find(Path(source.c_str()).GetHash());
+				if (dependency == nullptr || *dependency == i) {
+					continue;
+				}
+
+				DynamicArray<I32>& dependents = nodes[*dependency].mDependents;
+				if (dependents.indexOf(i) < 0)
+				{
+					dependents.push(i);
+					nodes[i].mDependencyCount++;
+				}
+			}
+		}
+	}
+
+	IResConverter* AssetCooker::FindConverter(const char* ext, const ResourceType& type)
+	{
+		for (IResConverter* converter : mConverters)
+		{
+			if (converter->SupportsType(ext, type)) {
+				return converter;
+			}
+		}
+		return nullptr;
+	}
+
+	void AssetCooker::CookAsset(AssetNode& node, CookResult& result)
+	{
+		PROFILE_CPU_BLOCK("CookAsset");
+		const F64 startTime = Timer::GetAbsoluteTime();
+		result.mPath = node.mPath;
+		result.mContentHash = ComputeContentHash(node);
+
+		// index is read only during cooking
+		const U64* lastHash = mCookedIndex.find(node.mPath.GetHash());
+		if (lastHash != nullptr && *lastHash == result.mContentHash && IsOutputsValid(node))
+		{
+			result.mState = CookState::UP_TO_DATE;
+		}
+		else if (RestoreCache(result.mContentHash))
+		{
+			result.mState = CookState::RESTORED;
+		}
+		else
+		{
+			Path convertedPath = ResourceManager::GetResourceConvertedPath(node.mPath);
+			ResConverterContext context(mFileSystem);
+			if (context.Convert(node.mConverter, node.mType, node.mPath.c_str(), convertedPath.c_str()))
+			{
+				result.mState = CookState::CONVERTED;
+
+				// metadata is rewritten by the converter, rehash so that the next cooking hits
+				node.mSources = context.GetSources();
+				node.mOutputs = context.GetOutputs();
+				result.mContentHash = ComputeContentHash(node);
+				if (!StoreCache(result.mContentHash, node.mPath, node.mOutputs)) {
+					Logger::Warning("[AssetCooker] Failed to store cache of %s", node.mPath.c_str());
+				}
+			}
+			else
+			{
+				Logger::Error("[AssetCooker] Failed to convert %s", node.mPath.c_str());
+				result.mState = CookState::FAILED;
+			}
+		}
+
+		result.mTime = (Timer::GetAbsoluteTime() - startTime) * 1000.0;
+	}
+
+	U64 AssetCooker::ComputeContentHash(const AssetNode& node)
+	{
+		U64 hash = 0;
+		hash = HashFunc(hash, CookCacheHeader::VERSION);
+		hash = HashFunc(hash, node.mType.Type());
+		hash = HashFunc(hash, node.mConverter->GetVersion(node.mType));
+		hash = HashFunc(hash, node.mPath.c_str());
+
+		DynamicArray<char> data;
+		if (mFileSystem.ReadFile(node.mPath.c_str(), data)) {
+			hash = FNV1aHash(hash, data.data(), data.size());
+		}
+
+		// settings of the metadata, internal infos are excluded
+		MaxPathString metaPath;
+		GetMetaFilePath(node.mPath.c_str(), metaPath);
+		if (mFileSystem.IsFileExists(metaPath.c_str()))
+		{
+			JsonArchive archive(metaPath.c_str(), ArchiveMode::ArchiveMode_Read, &mFileSystem);
+			nlohmann::json settings = *archive.GetCurrentJson();
+			if (settings.is_object()) {
+				settings.erase("$internal");
+			}
+			const std::string settingsStr = settings.dump();
+			hash = FNV1aHash(hash, settingsStr.data(), settingsStr.size());
+		}
+
+		// other sources, e.g. included files of shaders
+		for (const String& source : node.mSources)
+		{
+			if (Path(source.c_str()) == node.mPath) {
+				continue;
+			}
+
+			hash = HashFunc(hash, source.c_str());
+			if (Path::IsAbsolutePath(source))
+			{
+				// outside of the filesystem, only check modified time
+				hash = HashFunc(hash, Platform::GetLastModTime(source));
+				continue;
+			}
+
+			data.clear();
+			if (mFileSystem.ReadFile(source.c_str(), data)) {
+				hash = FNV1aHash(hash, data.data(), data.size());
+			}
+		}
+		return hash;
+	}
+
+	bool AssetCooker::IsOutputsValid(const AssetNode& node) const
+	{
+		if (node.mOutputs.empty()) {
+			return false;
+		}
+		for (const String& output : node.mOutputs)
+		{
+			if (!mFileSystem.IsFileExists(output.c_str())) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void AssetCooker::GetCacheFilePath(U64 contentHash, MaxPathString& outPath) const
+	{
+		char name[32];
+		sprintf_s(name, "/%016llx.cache", contentHash);
+		outPath = mCachePath;
+		outPath.append(name);
+	}
+
+	bool AssetCooker::StoreCache(U64 contentHash, const Path& srcPath, const DynamicArray<String>& outputs)
+	{
+		PROFILE_FUNCTION();
+		MaxPathString metaPath;
+		GetMetaFilePath(srcPath.c_str(), metaPath);
+
+		DynamicArray<const char*> files;
+		for (const String& output : outputs) {
+			files.push(output.c_str());
+		}
+		files.push(metaPath.c_str());
+
+		MemoryStream stream;
+		CookCacheHeader header;
+		header.mCount = files.size();
+		stream.Write(header);
+
+		DynamicArray<char> data;
+		for (const char* file : files)
+		{
+			data.clear();
+			if (!mFileSystem.ReadFile(file, data)) {
+				return false;
+			}
+			stream.WriteString(file);
+			stream.Write((U64)data.size());
+			stream.Write(data.data(), data.size());
+		}
+
+		MaxPathString cachePath;
+		GetCacheFilePath(contentHash, cachePath);
+		return mFileSystem.WriteFile(cachePath.c_str(), (const char*)stream.data(), stream.Size());
+	}
+
+	bool AssetCooker::RestoreCache(U64 contentHash)
+	{
+		MaxPathString cachePath;
+		GetCacheFilePath(contentHash, cachePath);
+		if (!mFileSystem.IsFileExists(cachePath.c_str())) {
+			return false;
+		}
+
+		PROFILE_FUNCTION();
+		DynamicArray<char> data;
+		if (!mFileSystem.ReadFile(cachePath.c_str(), data)) {
+			return false;
+		}
+
+		InputMemoryStream stream((const U8*)data.data(), data.size());
+		CookCacheHeader header;
+		if (!ReadCacheHeader(stream, header)) {
+			return false;
+		}
+
+		for (U32 i = 0; i < header.mCount; i++)
+		{
+			const char* path = stream.ReadString();
+			const U64 size = stream.Read<U64>();
+			if (stream.Offset() + size > stream.Size()) {
+				return false;
+			}
+
+			MaxPathString dirPath;
+			Path::GetPathParentPath(path, dirPath.toSpan());
+			if (dirPath.length() > 0) {
+				mFileSystem.CreateDir(dirPath.c_str());
+			}
+
+			if (!mFileSystem.WriteFile(path, (const char*)stream.data() + stream.Offset(), size)) {
+				return false;
+			}
+			stream.AddOffset((U32)size);
+		}
+		return true;
+	}
+
+	void AssetCooker::LoadIndex()
+	{
+		mCookedIndex.clear();
+
+		MaxPathString indexPath(mCachePath);
+		indexPath.append("/");
+		indexPath.append(COOK_INDEX_NAME);
+		DynamicArray<char> data;
+		if (!mFileSystem.IsFileExists(indexPath.c_str()) || !mFileSystem.ReadFile(indexPath.c_str(), data)) {
+			return;
+		}
+
+		InputMemoryStream stream((const U8*)data.data(), data.size());
+		CookCacheHeader header;
+		if (!ReadCacheHeader(stream, header)) {
+			return;
+		}
+
+		for (U32 i = 0; i < header.mCount; i++)
+		{
+			U32 pathHash = 0;
+			U64 contentHash = 0;
+			if (!stream.Read(&pathHash, sizeof(pathHash)) || !stream.Read(&contentHash, sizeof(contentHash))) {
+				break;
+			}
+			mCookedIndex.insert(pathHash, contentHash);
+		}
+	}
+
+	void AssetCooker::SaveIndex()
+	{
+		MemoryStream stream;
+		CookCacheHeader header;
+		header.mCount = mCookedIndex.size();
+		stream.Write(header);
+		for (const auto& kvp : mCookedIndex)
+		{
+			stream.Write(kvp.first);
+			stream.Write(kvp.second);
+		}
+
+		MaxPathString indexPath(mCachePath);
+		indexPath.append("/");
+		indexPath.append(COOK_INDEX_NAME);
+		if (!mFileSystem.WriteFile(indexPath.c_str(), (const char*)stream.data(), stream.Size())) {
+			Logger::Warning("[AssetCooker] Failed to save cook index.");
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "converter.h"
+#include "core\container\hashMap.h"
+
+namespace Cjing3D
+{
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// AssetCooker
+	/// Batch converts assets without the editor. Dependencies between assets are collected from the
+	/// sources/outputs of their metadata, and assets without pending dependencies are converted
+	/// concurrently on the JobSystem. Each asset is keyed by the hash of its inputs, settings and
+	/// converter version, converted outputs are stored in a local content-addressed cache directory,
+	/// so that unchanged assets are skipped and reverted assets are restored without converting.
+	class AssetCooker
+	{
+	public:
+		static const char* DEFAULT_CACHE_PATH;
+
+		enum class CookState
+		{
+			UP_TO_DATE,		// outputs are valid
+			RESTORED,		// outputs are restored from the cache
+			CONVERTED,
+			FAILED
+		};
+
+		struct CookResult
+		{
+			Path mPath;
+			CookState mState = CookState::FAILED;
+			U64 mContentHash = 0;
+			F64 mTime = 0.0;	// ms
+		};
+
+		struct Stats
+		{
+			I32 mAssetCount = 0;
+			I32 mUpToDateCount = 0;
+			I32 mRestoredCount = 0;
+			I32 mConvertedCount = 0;
+			I32 mFailedCount = 0;
+			I32 mWaveCount = 0;
+			F64 mTotalTime = 0.0;	// ms
+		};
+
+		AssetCooker(BaseFileSystem& filesystem, const char* cachePath = DEFAULT_CACHE_PATH);
+		~AssetCooker();
+
+		void AddConverter(IResConverter* converter);
+		void AddAsset(const char* path);
+		void Clear();
+
+		// cook all added assets, return false if any asset is failed
+		bool Cook();
+		void PrintReport()const;
+
+		const DynamicArray<CookResult>& GetResults()const { return mResults; }
+		const Stats& GetStats()const { return mStats; }
+
+	private:
+		struct AssetNode
+		{
+			Path mPath;
+			ResourceType mType;
+			IResConverter* mConverter = nullptr;
+			DynamicArray<String> mSources;
+			DynamicArray<String> mOutputs;
+			DynamicArray<I32> mDependents;
+			I32 mDependencyCount = 0;
+		};
+
+		void BuildGraph(DynamicArray<AssetNode>& nodes);
+		IResConverter* FindConverter(const char* ext, const ResourceType& type);
+		void CookAsset(AssetNode& node, CookResult& result);
+		U64 ComputeContentHash(const AssetNode& node);
+		bool IsOutputsValid(const AssetNode& node)const;
+		void GetCacheFilePath(U64 contentHash, MaxPathString& outPath)const;
+		bool StoreCache(U64 contentHash, const Path& srcPath, const DynamicArray<String>& outputs);
+		bool RestoreCache(U64 contentHash);
+		void LoadIndex();
+		void SaveIndex();
+
+		BaseFileSystem& mFileSystem;
+		MaxPathString mCachePath;
+		DynamicArray<IResConverter*> mConverters;
+		DynamicArray<Path> mAssets;
+		DynamicArray<CookResult> mResults;
+		Stats mStats;
+
+		// path hash => content hash of the last cooking
+		HashMap<U32, U64> mCookedIndex;
+	};
+}
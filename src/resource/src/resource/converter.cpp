@@ -4,7 +4,8 @@
 #include "core\helper\stream.h"
 #include "core\serialization\jsonArchive.h"
 #include "core\concurrency\jobsystem.h"
-#include "core\compress\lz4.h"
+#include "core\compress\lz4Chunked.h"
+
 
 namespace Cjing3D
 {
@@ -86,26 +87,8 @@ namespace Cjing3D
 		return ret;
 	}
 
-	bool ResConverterContext::WriteResource(const char* path, const U8* data, U32 size)
+	bool ResConverterContext::WriteResource(const char* path, const U8* data, U64 size)
 	{
-		MemoryStream compressedData;
-		I32 compressedSize = 0;
-
-		// if size >= COMPRESSION_SIZE_LIMIT, compress data first
-		constexpr U32 COMPRESSION_SIZE_LIMIT = 4096;
-		if (size > COMPRESSION_SIZE_LIMIT)
-		{
-			// more compressing options?? just use lz4 now
-			const I32 cap = LZ4_compressBound((I32)size);
-			compressedData.Resize(cap);
-			compressedSize = LZ4_compress_default((const char*)data, (char*)compressedData.data(), (I32)size, cap);
-			if (compressedSize == 0)
-			{
-				Logger::Warning("Failed to compress resource by LZ4");
-				return false;
-			}
-		}
-
 		File* file = CJING_NEW(File);
 		if (!mFileSystem.OpenFile(path, *file, FileFlags::DEFAULT_WRITE))
 		{
@@ -117,21 +100,48 @@ namespace Cjing3D
 		CompiledResourceHeader header;
 		header.mDecompressedSize = size;
 
-		// 2. write data
-		// ǰļСҪѹѹС㹻Сʱѹ
-		if (size > COMPRESSION_SIZE_LIMIT && compressedSize < I32(size / 4 * 3))
+		// 2. if size >= COMPRESSION_SIZE_LIMIT, compress data first
+		// data is compressed as independent blocks, which could be decompressed concurrently,
+		// blocks are written to the file directly, so that data larger than 4 GB could be compressed
+		constexpr U32 COMPRESSION_SIZE_LIMIT = 4096;
+		if (size > COMPRESSION_SIZE_LIMIT)
 		{
-			header.mFlags |= CompiledResourceHeader::COMPRESSED_LZ4;
-			file->Write(&header, sizeof(header));
-			file->Write(compressedData.data(), compressedSize);
+			header.mFlags |= CompiledResourceHeader::COMPRESSED_LZ4_CHUNKED;
+			LZ4Chunked::Options options;
+			options.mAcceleration = mCompressAcceleration;
+			bool ret = file->Write(&header, sizeof(header)) != 0;
+			if (ret && !LZ4Chunked::Compress(data, size, *file, options))
+			{
+				Logger::Warning("Failed to compress resource by LZ4");
+				ret = false;
+			}
+
+			// only keep compressed data when it is small enough
+			const U64 compressedSize = file->Tell() - sizeof(header);
+			if (ret && compressedSize < size / 4 * 3)
+			{
+				CJING_SAFE_DELETE(file);
+				return true;
+			}
+
+			// rewrite the file with raw data
+			file->Close();
+			if (!mFileSystem.OpenFile(path, *file, FileFlags::DEFAULT_WRITE))
+			{
+				CJING_SAFE_DELETE(file);
+				return false;
+			}
+			header.mFlags &= ~CompiledResourceHeader::COMPRESSED_LZ4_CHUNKED;
 		}
-		else {
-			file->Write(&header, sizeof(header));
-			file->Write(data, size);
+
+		// 3. write raw data
+		bool ret = file->Write(&header, sizeof(header)) != 0;
+		if (ret && size > 0) {
+			ret = file->Write(data, size) != 0;
 		}
 
 		CJING_SAFE_DELETE(file);
-		return true;
+		return ret;
 	}
 
 	void ResConverterContext::SetMetaDataImpl(const SerializedObject& obj)
@@ -22,7 +22,8 @@ namespace Cjing3D
 		void AddSource(const char* path);
 		void AddOutput(const char* path);
 		bool Convert(IResConverter* converter, const ResourceType& resType, const char* srcPath, const char* destPath);
-		bool WriteResource(const char* path, const U8* data, U32 size);
+		bool WriteResource(const char* path, const U8* data, U64 size);
+
 
 		template<typename T>
 		void SetMetaData(const T& data)
@@ -37,9 +38,16 @@ namespace Cjing3D
 			return data;
 		}
 
+		// lz4 acceleration of compiled resources, 1 is the best ratio (for shipping)
+		void SetCompressAcceleration(I32 acceleration) { mCompressAcceleration = acceleration; }
+		I32 GetCompressAcceleration()const { return mCompressAcceleration; }
+
 		BaseFileSystem& GetFileSystem() { return mFileSystem; }
+
 		const Path& GetMetaFilePath()const { return mMetaPath; }
 		const Path& GetSrcPath()const { return mSrcPath; }
+		const DynamicArray<String>& GetSources()const { return mSources; }
+		const DynamicArray<String>& GetOutputs()const { return mOutputs; }
 
 	private:
 		void SetMetaDataImpl(const SerializedObject& obj);
@@ -49,6 +57,8 @@ namespace Cjing3D
 		BaseFileSystem& mFileSystem;
 		Path mMetaPath;
 		Path mSrcPath;
+		I32 mCompressAcceleration = 1;
+
 
 		DynamicArray<String> mDependencies;
 		DynamicArray<String> mSources;
@@ -63,6 +73,8 @@ namespace Cjing3D
 		virtual void OnEditorGUI(ResConverterContext& context, const ResourceType& type, Resource* res) = 0;
 		virtual bool SupportsType(const char* ext, const ResourceType& type) = 0;
 		virtual bool Convert(ResConverterContext& context, const ResourceType& type, const char* src, const char* dest) = 0;
+		// converted outputs are invalid when version changed
+		virtual U32 GetVersion(const ResourceType& type) { return 0; }
 	};
 
 	class ResConverterPlugin : public Plugin
@@ -0,0 +1,258 @@
+#include "fileIOBackend.h"
+#include "core\filesystem\filesystem.h"
+#include "core\helper\debug.h"
+#include "core\helper\profiler.h"
+#include "core\memory\memory.h"
+
+#include <algorithm>
+
+namespace Cjing3D
+{
+	FileIOBackend::FileIOBackend(BaseFileSystem& filesystem, I32 threadCount) :
+		mFilesystem(filesystem)
+	{
+		threadCount = std::max(threadCount, 1);
+		mThreads.reserve(threadCount);
+		for (I32 i = 0; i < threadCount; i++) {
+			mThreads.push(CJING_NEW(Concurrency::Thread)(IOThreadFunc, this, 65536, "FileIOThread"));
+		}
+	}
+
+	FileIOBackend::~FileIOBackend()
+	{
+		Flush();
+
+		{
+			Concurrency::ScopedConditionMutex lock(mMutex);
+			mIsExiting = true;
+			mRequestCondition.WakeupAll();
+		}
+		for (auto thread : mThreads)
+		{
+			thread->Join();
+			CJING_DELETE(thread);
+		}
+		mThreads.clear();
+	}
+
+	FileIOBackend::RequestHandle FileIOBackend::Read(const Path& path, IOPriority priority, Callback callback)
+	{
+		Debug::CheckAssertion(priority < IOPriority::COUNT);
+
+		IORequest* request = CJING_NEW(IORequest);
+		request->mPath = path;
+		request->mPriority = priority;
+		request->mCallback = callback;
+
+		Concurrency::AtomicIncrement(&mPendingCount);
+		Concurrency::AtomicIncrement(&mRequestCount);
+		RequestHandle handle = INVALID_REQUEST;
+		{
+			Concurrency::ScopedConditionMutex lock(mMutex);
+			if (++mNextHandle == INVALID_REQUEST) {
+				++mNextHandle;
+			}
+			handle = mNextHandle;
+			request->mHandle = handle;
+			mQueues[(I32)priority].push(request);
+			mRequestCondition.Wakeup();
+		}
+		return handle;
+	}
+
+	bool FileIOBackend::SetPriority(RequestHandle handle, IOPriority priority)
+	{
+		Debug::CheckAssertion(priority < IOPriority::COUNT);
+		Concurrency::ScopedConditionMutex lock(mMutex);
+		IORequest* request = RemoveRequest(handle);
+		if (request == nullptr) {
+			return false;
+		}
+
+		request->mPriority = priority;
+		mQueues[(I32)priority].push(request);
+		return true;
+	}
+
+	bool FileIOBackend::Cancel(RequestHandle handle)
+	{
+		IORequest* request = nullptr;
+		{
+			Concurrency::ScopedConditionMutex lock(mMutex);
+			request = RemoveRequest(handle);
+		}
+		if (request == nullptr) {
+			return false;
+		}
+
+		CJING_DELETE(request);
+		Concurrency::AtomicIncrement(&mCanceledCount);
+		CompleteRequest();
+		return true;
+	}
+
+	FileIOBackend::IORequest* FileIOBackend::RemoveRequest(RequestHandle handle)
+	{
+		if (handle == INVALID_REQUEST) {
+			return nullptr;
+		}
+
+		for (auto& queue : mQueues)
+		{
+			for (I32 i = 0; i < queue.size(); i++)
+			{
+				if (queue[i]->mHandle == handle)
+				{
+					IORequest* request = queue[i];
+					queue.erase(i);
+					return request;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	void FileIOBackend::Flush()
+	{
+		Concurrency::ScopedConditionMutex lock(mMutex);
+		while (mPendingCount > 0) {
+			mFlushCondition.Sleep(mMutex);
+		}
+	}
+
+	void FileIOBackend::CompleteRequest()
+	{
+		// wake up flushing threads under the lock, so that the wakeup is not lost between
+		// checking the pending count and sleeping
+		if (Concurrency::AtomicDecrement(&mPendingCount) == 0)
+		{
+			Concurrency::ScopedConditionMutex lock(mMutex);
+			mFlushCondition.WakeupAll();
+		}
+	}
+
+	FileIOBackend::Stats FileIOBackend::GetStats() const
+	{
+		Stats stats;
+		stats.mRequestCount = mRequestCount;
+		stats.mBatchCount = mBatchCount;
+		stats.mPrefetchRanges = mPrefetchRanges;
+		stats.mBytesRead = mBytesRead;
+		stats.mCanceledCount = mCanceledCount;
+
+		Concurrency::ScopedConditionMutex lock(mMutex);
+		for (I32 i = 0; i < (I32)IOPriority::COUNT; i++) {
+			stats.mQueueDepth[i] = mQueues[i].size();
+		}
+		return stats;
+	}
+
+	int FileIOBackend::IOThreadFunc(void* data)
+	{
+		FileIOBackend* backend = reinterpret_cast<FileIOBackend*>(data);
+		DynamicArray<IORequest*> batch;
+		while (true)
+		{
+			{
+				// sleep until any request is queued, queues are checked under the lock
+				Concurrency::ScopedConditionMutex lock(backend->mMutex);
+				while (!backend->mIsExiting && !backend->PopBatch(batch)) {
+					backend->mRequestCondition.Sleep(backend->mMutex);
+				}
+			}
+			if (batch.empty()) {
+				break;
+			}
+
+			backend->ProcessBatch(batch);
+			batch.clear();
+		}
+		return 0;
+	}
+
+	bool FileIOBackend::PopBatch(DynamicArray<IORequest*>& batch)
+	{
+		for (auto& queue : mQueues)
+		{
+			if (queue.empty()) {
+				continue;
+			}
+
+			// split the batch size among io threads, so that requests are still read concurrently
+			const I32 batchSize = std::max(1, std::min(MAX_BATCH_SIZE, (I32)(queue.size() / mThreads.size())));
+			for (I32 i = 0; i < batchSize; i++) {
+				batch.push(queue[i]);
+			}
+			queue.erase(queue.begin(), queue.begin() + batchSize);
+			return true;
+		}
+		return false;
+	}
+
+	void FileIOBackend::ProcessBatch(DynamicArray<IORequest*>& batch)
+	{
+		PROFILE_CPU_BLOCK("FileIOBatch");
+		Concurrency::AtomicIncrement(&mBatchCount);
+
+		// order requests by their physical locations
+		for (IORequest* request : batch) {
+			request->mIsLocated = mFilesystem.GetFileLocation(request->mPath.c_str(), request->mOffset, request->mSize);
+		}
+		std::stable_sort(batch.begin(), batch.end(), [](const IORequest* a, const IORequest* b) {
+			if (a->mIsLocated != b->mIsLocated) {
+				return a->mIsLocated;
+			}
+			return a->mIsLocated && a->mOffset < b->mOffset;
+		});
+
+		// merge nearby ranges into single prefetches, files of the batch are still read one by one
+		U64 rangeBegin = 0;
+		U64 rangeEnd = 0;
+		bool hasRange = false;
+		for (const IORequest* request : batch)
+		{
+			if (!request->mIsLocated) {
+				break;
+			}
+
+			const U64 requestEnd = request->mOffset + request->mSize;
+			if (hasRange && request->mOffset <= rangeEnd + PREFETCH_GAP && requestEnd - rangeBegin <= MAX_PREFETCH_SIZE)
+			{
+				rangeEnd = std::max(rangeEnd, requestEnd);
+				continue;
+			}
+
+			if (hasRange)
+			{
+				mFilesystem.PrefetchRange(rangeBegin, rangeEnd - rangeBegin);
+				Concurrency::AtomicIncrement(&mPrefetchRanges);
+			}
+			rangeBegin = request->mOffset;
+			rangeEnd = requestEnd;
+			hasRange = true;
+		}
+		if (hasRange)
+		{
+			mFilesystem.PrefetchRange(rangeBegin, rangeEnd - rangeBegin);
+			Concurrency::AtomicIncrement(&mPrefetchRanges);
+		}
+
+		// read and complete
+		DynamicArray<char> data;
+		for (IORequest* request : batch)
+		{
+			data.clear();
+			const bool success = mFilesystem.ReadFile(request->mPath.c_str(), data);
+			if (success) {
+				Concurrency::AtomicAdd(&mBytesRead, (I64)data.size());
+			}
+
+			if (request->mCallback) {
+				request->mCallback(success, data);
+			}
+
+			CJING_DELETE(request);
+			CompleteRequest();
+		}
+	}
+}
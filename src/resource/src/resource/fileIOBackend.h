@@ -0,0 +1,99 @@
+#pragma once
+
+#include "core\common\definitions.h"
+#include "core\container\dynamicArray.h"
+#include "core\concurrency\concurrency.h"
+#include "core\filesystem\path.h"
+#include "core\helper\function.h"
+
+namespace Cjing3D
+{
+	class BaseFileSystem;
+
+	enum class IOPriority
+	{
+		HIGH = 0,
+		NORMAL,
+		LOW,
+		COUNT
+	};
+
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// FileIOBackend
+	/// Reads files on a pool of io threads. Each io thread takes a batch of pending requests
+	/// of the highest priority, orders them by their physical location and merges nearby
+	/// ranges of packed files into prefetches before reading. Filesystem reads are issued
+	/// from all io threads concurrently.
+	class FileIOBackend
+	{
+	public:
+		// data is valid only during the callback, callee could swap it out
+		using Callback = Function<void(bool success, DynamicArray<char>& data)>;
+		using RequestHandle = U32;
+		static const RequestHandle INVALID_REQUEST = 0;
+
+		static const I32 MAX_BATCH_SIZE = 32;
+		static const U64 PREFETCH_GAP = 64 * 1024;
+		static const U64 MAX_PREFETCH_SIZE = 8 * 1024 * 1024;
+
+		struct Stats
+		{
+			I64 mRequestCount = 0;
+			I64 mBatchCount = 0;
+			I64 mPrefetchRanges = 0;
+			I64 mBytesRead = 0;
+			I64 mCanceledCount = 0;
+			I32 mQueueDepth[(I32)IOPriority::COUNT] = {};
+		};
+
+		FileIOBackend(BaseFileSystem& filesystem, I32 threadCount);
+		~FileIOBackend();
+
+		RequestHandle Read(const Path& path, IOPriority priority, Callback callback);
+		// move a not yet started request to the queue of the priority
+		bool SetPriority(RequestHandle handle, IOPriority priority);
+		// remove a not yet started request, the callback is not called
+		bool Cancel(RequestHandle handle);
+		// block until all submitted requests are completed
+		void Flush();
+
+		I32 GetThreadCount()const { return mThreads.size(); }
+		I32 GetPendingCount()const { return mPendingCount; }
+		Stats GetStats()const;
+
+	private:
+		struct IORequest
+		{
+			Path mPath;
+			RequestHandle mHandle = INVALID_REQUEST;
+			IOPriority mPriority = IOPriority::NORMAL;
+			Callback mCallback;
+			U64 mOffset = 0;
+			U64 mSize = 0;
+			bool mIsLocated = false;
+		};
+
+		static int IOThreadFunc(void* data);
+		// mMutex should be locked
+		bool PopBatch(DynamicArray<IORequest*>& batch);
+		IORequest* RemoveRequest(RequestHandle handle);
+		void ProcessBatch(DynamicArray<IORequest*>& batch);
+		void CompleteRequest();
+
+		BaseFileSystem& mFilesystem;
+		DynamicArray<Concurrency::Thread*> mThreads;
+		mutable Concurrency::ConditionMutex mMutex;
+		Concurrency::ConditionVariable mRequestCondition;
+		Concurrency::ConditionVariable mFlushCondition;
+		DynamicArray<IORequest*> mQueues[(I32)IOPriority::COUNT];
+		volatile I32 mPendingCount = 0;
+		volatile bool mIsExiting = false;
+		RequestHandle mNextHandle = INVALID_REQUEST;
+
+		volatile I64 mRequestCount = 0;
+		volatile I64 mBatchCount = 0;
+		volatile I64 mPrefetchRanges = 0;
+		volatile I64 mBytesRead = 0;
+		volatile I64 mCanceledCount = 0;
+	};
+}
@@ -4,6 +4,8 @@
 #include "core\helper\stream.h"
 #include "core\concurrency\concurrency.h"
 #include "core\compress\lz4.h"
+#include "core\compress\lz4Chunked.h"
+
 
 namespace  Cjing3D
 {
@@ -169,29 +171,91 @@ namespace  Cjing3D
 	bool ResourceFactory::LoadResourceFromFile(Resource* resource, const char* name, U64 size, const U8* data)
 	{
 		// read shader general header
+		if (size < sizeof(CompiledResourceHeaderV1))
+		{
+			Logger::Warning("resource header is invalid.");
+			return false;
+		}
 		const CompiledResourceHeader& header = *(const CompiledResourceHeader*)data;
 
 		// check magic and version
 		if (header.mMagic != CompiledResourceHeader::MAGIC ||
 			header.mMajor != CompiledResourceHeader::MAJOR ||
-			header.mMinor != CompiledResourceHeader::MINOR)
+			(header.mMinor != CompiledResourceHeader::MINOR && header.mMinor != CompiledResourceHeaderV1::MINOR))
 		{
 			Logger::Warning("resource version mismatch.");
 			return false;
 		}
 
-		if (header.mFlags & CompiledResourceHeader::COMPRESSED_LZ4)
+		// resources compiled by the previous minor version
+		if (header.mMinor == CompiledResourceHeaderV1::MINOR) {
+			return LoadResourceFromFileV1(resource, name, size, data);
+		}
+
+		if (size < sizeof(header))
+		{
+			Logger::Warning("resource header is invalid.");
+			return false;
+		}
+
+		if (header.mFlags & CompiledResourceHeader::COMPRESSED_LZ4_CHUNKED)
+		{
+			// size comes from the file, check it before allocating
+			const U64 compressedSize = size - sizeof(header);
+			LZ4Chunked::Header chunkedHeader;
+			if (!LZ4Chunked::GetHeader(data + sizeof(header), compressedSize, chunkedHeader) ||
+				chunkedHeader.mDecompressedSize != header.mDecompressedSize ||
+				header.mDecompressedSize > compressedSize * LZ4Chunked::MAX_COMPRESSION_RATIO)
+			{
+				Logger::Warning("resource decompressed size is invalid.");
+				return false;
+			}
+
+			// blocks are decompressed concurrently by jobsystem
+			U8* decompressedData = (U8*)CJING_MALLOC((size_t)header.mDecompressedSize);
+			if (decompressedData == nullptr)
+			{
+				Logger::Warning("resource decompress failed, out of memory.");
+				return false;
+			}
+			if (!LZ4Chunked::Decompress(data + sizeof(header), size - sizeof(header), decompressedData, header.mDecompressedSize))
+			{
+				Logger::Warning("resource decompress failed.");
+				CJING_FREE(decompressedData);
+				return false;
+			}
+			bool ret = LoadResource(resource, name, header.mDecompressedSize, decompressedData);
+			CJING_FREE(decompressedData);
+			return ret;
+		}
+		else
+		{
+			return LoadResource(resource, name, size - sizeof(header), data + sizeof(header));
+		}
+	}
+
+	bool ResourceFactory::LoadResourceFromFileV1(Resource* resource, const char* name, U64 size, const U8* data)
+	{
+		// data is compressed as a single LZ4 block
+		const CompiledResourceHeaderV1& header = *(const CompiledResourceHeaderV1*)data;
+		if (header.mFlags & CompiledResourceHeaderV1::COMPRESSED_LZ4)
 		{
-			// if res is compressed, decompress first
+			if (header.mDecompressedSize > (size - sizeof(header)) * LZ4Chunked::MAX_COMPRESSION_RATIO ||
+				header.mDecompressedSize > (U32)LZ4_MAX_INPUT_SIZE)
+			{
+				Logger::Warning("resource decompressed size is invalid.");
+				return false;
+			}
+
 			MemoryStream tmp;
 			tmp.Resize(header.mDecompressedSize);
 			const I32 res = LZ4_decompress_safe((const char*)data + sizeof(header), (char*)tmp.data(), I32(size - sizeof(header)), (I32)tmp.Size());
-			if (res != header.mDecompressedSize) 
+			if (res < 0 || (U32)res != header.mDecompressedSize)
 			{
 				Logger::Warning("resource decompress failed.");
 				return false;
 			}
-			return LoadResource(resource, name, header.mDecompressedSize, tmp.data());
+			return LoadResource(resource, name, tmp.Size(), tmp.data());
 		}
 		else
 		{
@@ -42,13 +42,31 @@ namespace Cjing3D
 	{
 		static const U32 MAGIC;
 		static const I32 MAJOR = 0;
-		static const I32 MINOR = 1;
+		static const I32 MINOR = 2;
 
 		U32 mMagic = MAGIC;
 		I32 mMajor = MAJOR;
 		I32 mMinor = MINOR;
 
 		enum Flags 
+		{
+			COMPRESSED_LZ4_CHUNKED = 1 << 1,	// independent blocks, see LZ4Chunked
+		};
+		U32 mFlags = 0;
+		U32 mPadding = 0;
+		U64 mDecompressedSize = 0;
+	};
+
+	// Compiled resource header of the previous minor version, which is still loadable
+	struct CompiledResourceHeaderV1
+	{
+		static const I32 MINOR = 1;
+
+		U32 mMagic = CompiledResourceHeader::MAGIC;
+		I32 mMajor = CompiledResourceHeader::MAJOR;
+		I32 mMinor = MINOR;
+
+		enum Flags
 		{
 			COMPRESSED_LZ4 = 1 << 0
 		};
@@ -56,6 +74,7 @@ namespace Cjing3D
 		U32 mPadding = 0;
 		U32 mDecompressedSize = 0;
 	};
+
 #pragma pack()
 
 	class Resource
@@ -87,6 +106,9 @@ namespace Cjing3D
 		void SetConvertedPath(const Path& path) { mConvertedPath = path; }
 		I32  GetCompiledSize()const { return mCompiledSize; }
 		void SetCompiledSize(I32 size) { mCompiledSize = size; }
+		// resource is kept in the lru cache of resource manager, guarded by its budget mutex
+		bool IsCached()const { return mIsCached; }
+		void SetCached(bool isCached) { mIsCached = isCached; }
 
 		virtual ResourceType GetType()const = 0;
 
@@ -126,6 +148,7 @@ namespace Cjing3D
 		ResState mState;
 		ResState mDesiredState;
 		I32 mCompiledSize = 0;
+		bool mIsCached = false;
 
 		ConnectionMap mConnectionMap;
 	};
@@ -144,6 +167,9 @@ namespace Cjing3D
 		virtual void RegisterExtensions() = 0;
 
 		bool LoadResourceFromFile(Resource* resource, const char* name, U64 size, const U8* data);
+
+	private:
+		bool LoadResourceFromFileV1(Resource* resource, const char* name, U64 size, const U8* data);
 	};
 
 #define DECLARE_RESOURCE(CLASS_NAME, NAME)                                                      \
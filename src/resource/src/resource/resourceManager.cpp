@@ -1,5 +1,7 @@
 #include "resourceManager.h"
 #include "converter.h"
+#include "fileIOBackend.h"
+#include "resourceRegistry.h"
 #include "core\helper\debug.h"
 #include "core\filesystem\filesystem_physfs.h"
 #include "core\container\hashMap.h"
@@ -33,9 +35,10 @@ namespace ResourceManager
 		AsyncResult DoWrite();
 	};
 
-	static int ReadIOTaskFunc(void* data);
 	static int WriteIOTaskFunc(void* data);
 
+	class ResourceLoadJob;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Impl
 	//////////////////////////////////////////////////////////////////////////
@@ -43,34 +46,48 @@ namespace ResourceManager
 	{
 	public:
 		using FactoryTable = HashMap<U32, ResourceFactory*>;
-		using ResourceTable = HashMap<U32, Resource*>;
-		using ResourceTypeTable = HashMap<U32, ResourceTable>;
 
-		static const I32 MAX_READ_TASKS = 128;
 		static const I32 MAX_WRITE_TASKS = 128;
+		static const I32 IO_THREAD_COUNT = 4;
 
 		// registered infos
 		FactoryTable mResourceFactoires;
-		ResourceTypeTable mResourceTypeTable;
 		HashMap<U32, ResourceType> mRegisteredExt;
 
+		// registered resources, unregistered resources are reclaimed in ProcessReleasedResources
+		ResourceRegistry mRegistry;
+		Concurrency::SpinLock mReleasedLock;
 		DynamicArray<Resource*> mReleasedResources;
-		Concurrency::RWLock mRWLock;
+		// count of releasing threads which may still touch unregistered resources
+		volatile I32 mActiveReleases = 0;
 		BaseFileSystem* mFilesystem = nullptr;
 
 		// resource file io
+		FileIOBackend* mIOBackend = nullptr;
 		Concurrency::Semaphore mWriteTaskSem;
-		Concurrency::Semaphore mReadTaskSem;
 		MPMCBoundedQueue<FileIOTask> mWriteTaskQueue;
-		MPMCBoundedQueue<FileIOTask> mReadTaskQueue;
 		Concurrency::Thread mWriteThread;
-		Concurrency::Thread mReadThread;
 		bool mIOExiting = false;
 
 		
 		volatile I32 mPendingResJobs = 0;
 		volatile I32 mConversionJobs = 0;
 
+		// loading jobs waiting for io, used to bump priority or cancel
+		Concurrency::Mutex mLoadingMutex;
+		HashMap<U64, ResourceLoadJob*> mLoadingJobs;
+		volatile I64 mCanceledCount = 0;
+
+		// memory budget, unreferenced resources are kept in a lru cache
+		// while the budget is enabled, front is the least recently used
+		Concurrency::Mutex mBudgetMutex;
+		U64 mMemoryBudget = 0;
+		U64 mUsedBytes = 0;
+		HashMap<U32, U64> mTypeBudgets;
+		HashMap<U32, U64> mTypeUsedBytes;
+		DynamicArray<Resource*> mUnreferencedResources;
+		I64 mEvictionCount = 0;
+
 		// load hook
 		LoadHook* mLoadHook = nullptr;
 
@@ -82,24 +99,32 @@ namespace ResourceManager
 
 		ResourceFactory* GetFactory(ResourceType type);
 		void AcquireResource(Resource* resource);
+		// return true if the resource is unregistered and should be processed
 		bool ReleaseResource(Resource* resource);
-		Resource* AcquireResource(const Path& path, ResourceType type);
-		void RecordResource(const Path& path, ResourceType type, Resource& resource);
+		Resource* AcquireResource(const Path& path, ResourceType type, ResourceFactory& factory);
+		void OnResourceRevived(Resource* resource);
 		void ProcessReleasedResources();
 		DynamicArray<String> LoadResSources(const char* src);
 		Path GetResourceConvertedPath(const Path& inPath);
+
+		// memory budget
+		bool IsCacheEnabled()const;
+		bool IsOverBudget()const;
+		bool NeedEvict(Resource& resource)const;
+		bool IsTypeOverBudget(U32 type)const;
+		void TrackResourceMemory(Resource& resource, U64 size);
+		void UnregisterResourceLocked(Resource& resource);
+		bool EvictResources();
 	};
 	ResourceManagerImpl* mImpl = nullptr;
 
 	ResourceManagerImpl::ResourceManagerImpl(BaseFileSystem* filesystem) :
-		mReadTaskQueue(MAX_READ_TASKS),
 		mWriteTaskQueue(MAX_WRITE_TASKS),
 		mWriteTaskSem(0, MAX_WRITE_TASKS, "ResWriteSem"),
-		mReadTaskSem(0,  MAX_READ_TASKS, "ResReadSem"),
 		mWriteThread(WriteIOTaskFunc, this, 65536, "WriteIOThread"),
-		mReadThread(ReadIOTaskFunc, this, 65536, "ReadIOThread"),
 		mFilesystem(filesystem)
 	{
+		mIOBackend = CJING_NEW(FileIOBackend)(*filesystem, IO_THREAD_COUNT);
 		mIsInitialized = true;
 	}
 
@@ -111,14 +136,21 @@ namespace ResourceManager
 			JobSystem::YieldCPU();
 		}
 
+		// release all cached resources
+		{
+			Concurrency::ScopedMutex budgetLock(mBudgetMutex);
+			mMemoryBudget = 0;
+			mTypeBudgets.clear();
+		}
+		EvictResources();
+
 		// process released resource
 		ProcessReleasedResources();
 
 		// exit io thread
-		mIOExiting = true;
-		mReadTaskSem.Signal(1);
-		mReadThread.Join();
+		CJING_SAFE_DELETE(mIOBackend);
 
+		mIOExiting = true;
 		mWriteTaskSem.Signal(1);
 		mWriteThread.Join();
 	}
@@ -136,69 +168,83 @@ namespace ResourceManager
 
 	bool ResourceManagerImpl::ReleaseResource(Resource* resource)
 	{
+		Concurrency::AtomicIncrement(&mActiveReleases);
+		bool ret = false;
 		if (resource->SubRefCount() == 0)
 		{
-			Concurrency::ScopedWriteLock lock(mRWLock);
-			ResourceTable* resTable = mResourceTypeTable.find(resource->GetType().Type());
-			if (resTable == nullptr) {
-				return false;
-			}
+			// keep the unreferenced resource registered in the lru cache if budget is enabled
+			bool isCached = false;
+			bool isProcessed = mRegistry.ProcessUnreferenced(*resource, [&](Resource& res) {
+				Concurrency::ScopedMutex budgetLock(mBudgetMutex);
+				if (IsCacheEnabled() && !res.IsFaild() && res.GetCompiledSize() > 0)
+				{
+					// the resource could be revived and released again by other thread before
+					// the shard is locked, then it is already cached
+					if (!res.IsCached())
+					{
+						mUnreferencedResources.push(&res);
+						res.SetCached(true);
+					}
+					isCached = true;
+					return false;
+				}
 
-			U32 key = resource->GetPath().GetHash();
-			auto it = resTable->find(key);
-			if (it != nullptr) {
-				resTable->erase(key);
-			}
+				UnregisterResourceLocked(res);
+				return true;
+			});
 
-			mReleasedResources.push(*it);	
-			return true;
+			// cached resource is not released, but evicted resources should be processed
+			ret = isCached ? EvictResources() : isProcessed;
 		}
-		return false;
+		Concurrency::AtomicDecrement(&mActiveReleases);
+		return ret;
 	}
 
-	Resource* ResourceManagerImpl::AcquireResource(const Path& path, ResourceType type)
+	Resource* ResourceManagerImpl::AcquireResource(const Path& path, ResourceType type, ResourceFactory& factory)
 	{
-		Concurrency::ScopedReadLock lock(mRWLock);
-		ResourceTable* resTable = mResourceTypeTable.find(type.Type());
-		if (resTable == nullptr) {
-			return nullptr;
-		}
+		bool isRevived = false;
+		Resource* ret = mRegistry.AcquireOrCreate(type, path, [&factory]() {
+			return factory.CreateResource();
+		}, &isRevived);
 
-		auto it = resTable->find(path.GetHash());
-		if (it == nullptr) {
-			return nullptr;
+		if (ret != nullptr && isRevived) {
+			OnResourceRevived(ret);
 		}
-
-		Resource* ret = *it;
-		ret->AddRefCount();
 		return ret;
 	}
 
-	void ResourceManagerImpl::RecordResource(const Path& path, ResourceType type, Resource& resource)
+	void ResourceManagerImpl::OnResourceRevived(Resource* resource)
 	{
-		Concurrency::ScopedWriteLock lock(mRWLock);
-		ResourceTable* resTable = mResourceTypeTable.find(type.Type());
-		if (resTable == nullptr) {
-			resTable = mResourceTypeTable.insert(type.Type(), ResourceTable());
+		// resource is acquired from the lru cache
+		Concurrency::ScopedMutex budgetLock(mBudgetMutex);
+		if (resource->IsCached())
+		{
+			mUnreferencedResources.eraseItem(resource);
+			resource->SetCached(false);
 		}
-		resTable->insert(path.GetHash(), &resource);
-
-		// keep one ref count by the resTable
-		resource.AddRefCount();
 	}
 
 	void ResourceManagerImpl::ProcessReleasedResources()
 	{
 		DynamicArray<Resource*> releasedResources;
 		{
-			Concurrency::ScopedWriteLock lock(mRWLock);
-			releasedResources = mReleasedResources;
-			mReleasedResources.clear();
+			Concurrency::ScopedSpinLock lock(mReleasedLock);
+			releasedResources.swap(mReleasedResources);
+		}
+
+		// other threads could still process the swapped resources after their refCount reach zero,
+		// wait until all releases started before the swap are finished
+		if (!releasedResources.empty())
+		{
+			while (mActiveReleases > 0) {
+				Concurrency::YieldCPU();
+			}
 		}
 
 		for (auto resource : releasedResources)
 		{
-			Debug::CheckAssertion(resource->IsLoaded() || resource->IsFaild());
+			// canceled resource is never loaded
+			Debug::CheckAssertion(resource->IsLoaded() || resource->IsFaild() || !resource->WantLoad());
 			resource->OnUnloaded();
 
 			ResourceFactory* factory = mImpl->GetFactory(resource->GetType());
@@ -208,6 +254,121 @@ namespace ResourceManager
 		}
 	}
 
+	bool ResourceManagerImpl::IsCacheEnabled() const
+	{
+		return mMemoryBudget > 0 || mTypeBudgets.size() > 0;
+	}
+
+	bool ResourceManagerImpl::IsOverBudget() const
+	{
+		if (mMemoryBudget > 0 && mUsedBytes > mMemoryBudget) {
+			return true;
+		}
+		for (auto kvp : mTypeBudgets)
+		{
+			if (IsTypeOverBudget(kvp.first)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ResourceManagerImpl::NeedEvict(Resource& resource) const
+	{
+		if (!IsCacheEnabled()) {
+			return true;
+		}
+		return (mMemoryBudget > 0 && mUsedBytes > mMemoryBudget) || IsTypeOverBudget(resource.GetType().Type());
+	}
+
+	bool ResourceManagerImpl::IsTypeOverBudget(U32 type) const
+	{
+		const U64* budget = mTypeBudgets.find(type);
+		const U64* usedBytes = mTypeUsedBytes.find(type);
+		return budget != nullptr && usedBytes != nullptr && *usedBytes > *budget;
+	}
+
+	void ResourceManagerImpl::TrackResourceMemory(Resource& resource, U64 size)
+	{
+		// the size of a reloaded resource replaces the tracked size, so it is not counted twice
+		Concurrency::ScopedMutex budgetLock(mBudgetMutex);
+		const U32 type = resource.GetType().Type();
+		const U64 oldSize = (U64)resource.GetCompiledSize();
+		resource.SetCompiledSize((I32)size);
+		mUsedBytes = mUsedBytes - oldSize + size;
+
+		U64* usedBytes = mTypeUsedBytes.find(type);
+		if (usedBytes == nullptr) {
+			usedBytes = mTypeUsedBytes.insert(type, (U64)0);
+		}
+		*usedBytes = *usedBytes - oldSize + size;
+	}
+
+	void ResourceManagerImpl::UnregisterResourceLocked(Resource& resource)
+	{
+		// registry shard and mBudgetMutex are locked
+		const U64 size = (U64)resource.GetCompiledSize();
+		if (size > 0)
+		{
+			mUsedBytes -= size;
+			U64* usedBytes = mTypeUsedBytes.find(resource.GetType().Type());
+			if (usedBytes != nullptr) {
+				*usedBytes -= size;
+			}
+			resource.SetCompiledSize(0);
+		}
+
+		Concurrency::ScopedSpinLock lock(mReleasedLock);
+		mReleasedResources.push(&resource);
+	}
+
+	bool ResourceManagerImpl::EvictResources()
+	{
+		// registry shard must be locked before mBudgetMutex, so pick a candidate first
+		// and validate it again when both are locked. The candidate could be reclaimed
+		// after the budget mutex is unlocked, so it is counted as an active release
+		Concurrency::AtomicIncrement(&mActiveReleases);
+		bool isEvicted = false;
+		while (true)
+		{
+			Resource* candidate = nullptr;
+			{
+				Concurrency::ScopedMutex budgetLock(mBudgetMutex);
+				if (IsCacheEnabled() && !IsOverBudget()) {
+					break;
+				}
+
+				for (Resource* resource : mUnreferencedResources)
+				{
+					if (resource->GetRefCount() == 0 && NeedEvict(*resource))
+					{
+						candidate = resource;
+						break;
+					}
+				}
+			}
+			if (candidate == nullptr) {
+				break;
+			}
+
+			mRegistry.ProcessUnreferenced(*candidate, [&](Resource& res) {
+				Concurrency::ScopedMutex budgetLock(mBudgetMutex);
+				if (!res.IsCached() || !NeedEvict(res)) {
+					return false;
+				}
+
+				mUnreferencedResources.eraseItem(&res);
+				res.SetCached(false);
+				UnregisterResourceLocked(res);
+				mEvictionCount++;
+				isEvicted = true;
+				return true;
+			});
+		}
+		Concurrency::AtomicDecrement(&mActiveReleases);
+		return isEvicted;
+	}
+
 	DynamicArray<String> ResourceManagerImpl::LoadResSources(const char* src)
 	{
 		DynamicArray<String> ret;
@@ -330,24 +491,6 @@ namespace ResourceManager
 		return ret;
 	}
 
-	static int ReadIOTaskFunc(void* data)
-	{
-		auto* impl = reinterpret_cast<ResourceManagerImpl*>(data);
-		FileIOTask task;
-		while (true)
-		{
-			impl->mReadTaskSem.Wait();
-			if (impl->mReadTaskQueue.Dequeue(task)) {
-				task.DoRead();
-			}
-
-			if (mImpl->mIOExiting) {
-				break;
-			}
-		}
-		return 0;
-	}
-
 	static int WriteIOTaskFunc(void* data)
 	{
 		auto* impl = reinterpret_cast<ResourceManagerImpl*>(data);
@@ -380,9 +523,18 @@ namespace ResourceManager
 		void OnWork(I32 param)override;
 		void OnCompleted()override;
 
+		// read file by io backend, the job is run when reading is completed
+		void SubmitRead(IOPriority priority);
+		void OnCanceled();
+		FileIOBackend::RequestHandle GetIORequest()const { return mIORequest; }
+
 	private:
 		ResourceFactory& mFactory;
 		Resource& mResource;
+		DynamicArray<char> mBuffer;
+		FileIOBackend::RequestHandle mIORequest = FileIOBackend::INVALID_REQUEST;
+		bool mIsReadFinished = false;
+		bool mIsReadSucceed = false;
 		String mName;
 		// target path, maybe is ConvertedPath
 		String mPath;
@@ -408,10 +560,43 @@ namespace ResourceManager
 		Concurrency::AtomicDecrement(&mImpl->mPendingResJobs);
 	}
 
+	void ResourceLoadJob::SubmitRead(IOPriority priority)
+	{
+		Concurrency::ScopedMutex lock(mImpl->mLoadingMutex);
+		mImpl->mLoadingJobs.insert((U64)&mResource, this);
+		mIORequest = mImpl->mIOBackend->Read(mPath.c_str(), priority, [this](bool success, DynamicArray<char>& data) {
+			{
+				Concurrency::ScopedMutex lock(mImpl->mLoadingMutex);
+				mImpl->mLoadingJobs.erase((U64)&mResource);
+			}
+
+			mIsReadFinished = true;
+			mIsReadSucceed = success;
+			mBuffer.swap(data);
+			RunTask(0, JobSystem::Priority::LOW);
+		});
+	}
+
+	void ResourceLoadJob::OnCanceled()
+	{
+		mResource.SetDesiredState(Resource::ResState::EMPTY);
+		if (mImpl->ReleaseResource(&mResource)) {
+			mImpl->ProcessReleasedResources();
+		}
+		CJING_DELETE(this);
+	}
+
 	void ResourceLoadJob::OnWork(I32 param)
 	{
-		DynamicArray<char> buffer;
-		if (!mImpl->mFilesystem->ReadFile(mPath, buffer)) 
+		// immediate job reads file synchronously
+		if (!mIsReadFinished)
+		{
+			mIsReadFinished = true;
+			mIsReadSucceed = mImpl->mFilesystem->ReadFile(mPath, mBuffer);
+		}
+
+		DynamicArray<char>& buffer = mBuffer;
+		if (!mIsReadSucceed)
 		{
 			Logger::Warning("Failed to load resource \"%s\"", mPath);
 			mResource.OnLoaded(false);
@@ -419,6 +604,9 @@ namespace ResourceManager
 		}
 
 		bool success = mFactory.LoadResourceFromFile(&mResource, mName.c_str(), buffer.size(), (const U8*)buffer.data());
+		if (success) {
+			mImpl->TrackResourceMemory(mResource, buffer.size());
+		}
 		if (success && !mResource.IsLoaded())
 		{
 			// try to load original path
@@ -426,7 +614,6 @@ namespace ResourceManager
 			if (!sources.empty()) {
 				mResource.SetSourceFiles(sources);
 			}
-			mResource.SetCompiledSize(buffer.size());
 			mResource.OnLoaded(true);
 		}
 		if (!success)
@@ -482,7 +669,7 @@ namespace ResourceManager
 		mImpl->mResourceFactoires.erase(type.Type());
 	}
 
-	Resource* LoadResource(ResourceType type, const Path& inPath, bool isImmediate)
+	Resource* LoadResource(ResourceType type, const Path& inPath, bool isImmediate, IOPriority priority)
 	{
 		Debug::CheckAssertion(IsInitialized());
 		Debug::CheckAssertion(!inPath.IsEmpty());
@@ -508,15 +695,9 @@ namespace ResourceManager
 		}
 
 		// acquire resource
-		Resource* ret = mImpl->AcquireResource(inPath, type);
-		if (ret == nullptr)
-		{
-			ret = factory->CreateResource();
-			if (ret == nullptr) {
-				return nullptr;
-			}
-			mImpl->RecordResource(inPath, type, *ret);
-			ret->SetPath(inPath);
+		Resource* ret = mImpl->AcquireResource(inPath, type, *factory);
+		if (ret == nullptr) {
+			return nullptr;
 		}
 
 		if (ret->IsNeedLoad())
@@ -546,7 +727,7 @@ namespace ResourceManager
 					loadJob->RunTaskImmediate(0);
 				}
 				else {
-					loadJob->RunTask(0, JobSystem::Priority::LOW);
+					loadJob->SubmitRead(priority);
 				}
 				return ret;
 			}
@@ -613,7 +794,7 @@ namespace ResourceManager
 		F64 maxWaitTime = 10.0f;
 #endif
 		F64 startTime = Timer::GetAbsoluteTime();
-		while(!resource->IsLoaded() && !resource->IsFaild())
+		while(!resource->IsLoaded() && !resource->IsFaild() && resource->WantLoad())
 		{
 			if (mImpl->mLoadHook != nullptr) {
 				mImpl->mLoadHook->OnWait();
@@ -649,7 +830,7 @@ namespace ResourceManager
 		bool isAllLoaded = true;
 		for (Resource* res : resources) 
 		{
-			if (!res->IsLoaded() && !res->IsFaild()) 
+			if (!res->IsLoaded() && !res->IsFaild() && res->WantLoad()) 
 			{
 				isAllLoaded = false;
 				break;
@@ -678,7 +859,7 @@ namespace ResourceManager
 			isAllLoaded = true;
 			for (Resource* res : resources)
 			{
-				if (!res->IsLoaded() && !res->IsFaild())
+				if (!res->IsLoaded() && !res->IsFaild() && res->WantLoad())
 				{
 					isAllLoaded = false;
 					break;
@@ -770,9 +951,24 @@ namespace ResourceManager
 		}
 		else
 		{
+			CJING_SAFE_DELETE(file);
 			Concurrency::AtomicAddAcquire(&asyncHanlde->mRemaining, (I64)size);
-			mImpl->mReadTaskQueue.Enqueue(task);
-			mImpl->mReadTaskSem.Signal(1);
+			mImpl->mIOBackend->Read(path, IOPriority::HIGH, [buffer, size, asyncHanlde](bool success, DynamicArray<char>& data) {
+				// pending -> running
+				auto oldResult = (AsyncResult)Concurrency::AtomicExchange((volatile I32*)&asyncHanlde->mResult, (I32)AsyncResult::RUNNING);
+				Debug::CheckAssertion(oldResult == AsyncResult::PENDING);
+
+				AsyncResult ret = AsyncResult::FAILURE;
+				if (success && (size_t)data.size() == size)
+				{
+					Memory::Memcpy(buffer, data.data(), size);
+					Concurrency::AtomicAddRelease(&asyncHanlde->mRemaining, -(I64)size);
+					ret = AsyncResult::SUCCESS;
+				}
+
+				// running -> ret
+				Concurrency::AtomicExchange((volatile I32*)&asyncHanlde->mResult, (I32)ret);
+			});
 			return AsyncResult::PENDING;
 		}
 	}
@@ -815,6 +1011,93 @@ namespace ResourceManager
 		}
 	}
 
+	bool SetLoadPriority(Resource* resource, IOPriority priority)
+	{
+		Debug::CheckAssertion(IsInitialized());
+		if (resource == nullptr) {
+			return false;
+		}
+
+		Concurrency::ScopedMutex lock(mImpl->mLoadingMutex);
+		ResourceLoadJob** job = mImpl->mLoadingJobs.find((U64)resource);
+		if (job == nullptr) {
+			return false;
+		}
+		return mImpl->mIOBackend->SetPriority((*job)->GetIORequest(), priority);
+	}
+
+	bool CancelLoad(Resource* resource)
+	{
+		Debug::CheckAssertion(IsInitialized());
+		if (resource == nullptr) {
+			return false;
+		}
+
+		ResourceLoadJob* canceledJob = nullptr;
+		{
+			Concurrency::ScopedMutex lock(mImpl->mLoadingMutex);
+			ResourceLoadJob** job = mImpl->mLoadingJobs.find((U64)resource);
+			if (job == nullptr || !mImpl->mIOBackend->Cancel((*job)->GetIORequest())) {
+				return false;
+			}
+			canceledJob = *job;
+			mImpl->mLoadingJobs.erase((U64)resource);
+		}
+
+		canceledJob->OnCanceled();
+		Concurrency::AtomicIncrement(&mImpl->mCanceledCount);
+		return true;
+	}
+
+	void SetMemoryBudget(U64 budget)
+	{
+		Debug::CheckAssertion(IsInitialized());
+		{
+			Concurrency::ScopedMutex budgetLock(mImpl->mBudgetMutex);
+			mImpl->mMemoryBudget = budget;
+		}
+		mImpl->EvictResources();
+		mImpl->ProcessReleasedResources();
+	}
+
+	void SetMemoryBudget(ResourceType type, U64 budget)
+	{
+		Debug::CheckAssertion(IsInitialized());
+		{
+			Concurrency::ScopedMutex budgetLock(mImpl->mBudgetMutex);
+			if (budget > 0) {
+				mImpl->mTypeBudgets.insert(type.Type(), budget);
+			}
+			else {
+				mImpl->mTypeBudgets.erase(type.Type());
+			}
+		}
+		mImpl->EvictResources();
+		mImpl->ProcessReleasedResources();
+	}
+
+	Stats GetStats()
+	{
+		Debug::CheckAssertion(IsInitialized());
+		Stats stats;
+		stats.mPendingLoads = mImpl->mPendingResJobs;
+		stats.mCanceledCount = mImpl->mCanceledCount;
+
+		FileIOBackend::Stats ioStats = mImpl->mIOBackend->GetStats();
+		for (I32 i = 0; i < (I32)IOPriority::COUNT; i++) {
+			stats.mQueueDepth[i] = ioStats.mQueueDepth[i];
+		}
+
+		Concurrency::ScopedMutex budgetLock(mImpl->mBudgetMutex);
+		stats.mUsedBytes = mImpl->mUsedBytes;
+		stats.mCachedCount = mImpl->mUnreferencedResources.size();
+		for (Resource* resource : mImpl->mUnreferencedResources) {
+			stats.mCachedBytes += (U64)resource->GetCompiledSize();
+		}
+		stats.mEvictionCount = mImpl->mEvictionCount;
+		return stats;
+	}
+
 	void SetCurrentLoadHook(LoadHook* loadHook)
 	{
 		Debug::CheckAssertion(IsInitialized());
@@ -851,7 +1134,7 @@ namespace ResourceManager
 				loadJob->RunTaskImmediate(0);
 			}
 			else {
-				loadJob->RunTask(0, JobSystem::Priority::LOW);
+				loadJob->SubmitRead(IOPriority::NORMAL);
 			}
 		}
 		else
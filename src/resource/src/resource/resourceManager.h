@@ -1,6 +1,7 @@
 #pragma once
 
 #include "resource.h"
+#include "fileIOBackend.h"
 
 namespace Cjing3D
 {
@@ -19,12 +20,12 @@ namespace Cjing3D
 		void RegisterFactory(ResourceType type, ResourceFactory* factory);
 		void UnregisterFactory(ResourceType type);
 
-		Resource* LoadResource(ResourceType type, const Path& inPath, bool isImmediate = false);
+		Resource* LoadResource(ResourceType type, const Path& inPath, bool isImmediate = false, IOPriority priority = IOPriority::NORMAL);
 
 		template<typename T>
-		T* LoadResource(const Path& inPath)
+		T* LoadResource(const Path& inPath, IOPriority priority = IOPriority::NORMAL)
 		{
-			return static_cast<T*>(LoadResource(T::ResType, inPath, false));
+			return static_cast<T*>(LoadResource(T::ResType, inPath, false, priority));
 		}
 
 		template<typename T>
@@ -46,6 +47,27 @@ namespace Cjing3D
 		void WaitForResources(Span<Resource*> resources);
 		void WaitAll();
 
+		// streaming, only loads which are not started could be bumped or canceled
+		bool SetLoadPriority(Resource* resource, IOPriority priority);
+		bool CancelLoad(Resource* resource);
+
+		// memory budget in bytes of compiled resources, 0 means unlimited. While any budget is set,
+		// unreferenced resources are kept in a LRU cache and evicted when over the budget
+		void SetMemoryBudget(U64 budget);
+		void SetMemoryBudget(ResourceType type, U64 budget);
+
+		struct Stats
+		{
+			I32 mPendingLoads = 0;
+			I32 mQueueDepth[(I32)IOPriority::COUNT] = {};
+			U64 mUsedBytes = 0;
+			U64 mCachedBytes = 0;
+			I32 mCachedCount = 0;
+			I64 mEvictionCount = 0;
+			I64 mCanceledCount = 0;
+		};
+		Stats GetStats();
+
 		enum AsyncResult
 		{
 			EMPTY = 0,
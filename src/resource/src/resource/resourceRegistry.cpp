@@ -0,0 +1,108 @@
+#include "resourceRegistry.h"
+#include "core\memory\memory.h"
+#include "core\helper\debug.h"
+
+namespace Cjing3D
+{
+	ResourceRegistry::ResourceRegistry(U32 shardCount) :
+		mShardCount(shardCount > 0 ? shardCount : 1)
+	{
+		mShards = CJING_NEW_ARR(Shard, mShardCount);
+	}
+
+	ResourceRegistry::~ResourceRegistry()
+	{
+		CJING_SAFE_DELETE_ARR(mShards, mShardCount);
+	}
+
+	Resource* ResourceRegistry::Acquire(ResourceType type, const Path& path, bool* isRevived)
+	{
+		const U64 key = GetResourceKey(type, path);
+		Shard& shard = GetShard(key);
+		Concurrency::ScopedReadLock lock(shard.mLock);
+		Resource** it = shard.mResources.find(key);
+		if (it == nullptr) {
+			return nullptr;
+		}
+
+		// the resource can not be unregistered while the shard is read locked,
+		// so it is safe to acquire it from zero
+		Resource* ret = *it;
+		const I32 refCount = ret->AddRefCount();
+		if (isRevived != nullptr) {
+			*isRevived = refCount == 1;
+		}
+		return ret;
+	}
+
+	Resource* ResourceRegistry::AcquireOrCreate(ResourceType type, const Path& path, const CreateFunc& createFunc, bool* isRevived)
+	{
+		// fast path, the resource is registered
+		Resource* ret = Acquire(type, path, isRevived);
+		if (ret != nullptr) {
+			return ret;
+		}
+
+		const U64 key = GetResourceKey(type, path);
+		Shard& shard = GetShard(key);
+		Concurrency::ScopedWriteLock lock(shard.mLock);
+
+		// registered by other thread before locked
+		Resource** it = shard.mResources.find(key);
+		if (it != nullptr)
+		{
+			ret = *it;
+			const I32 refCount = ret->AddRefCount();
+			if (isRevived != nullptr) {
+				*isRevived = refCount == 1;
+			}
+			return ret;
+		}
+
+		ret = createFunc();
+		if (ret == nullptr) {
+			return nullptr;
+		}
+
+		ret->SetPath(path);
+		ret->AddRefCount();
+		shard.mResources.insert(key, ret);
+		if (isRevived != nullptr) {
+			*isRevived = false;
+		}
+		return ret;
+	}
+
+	bool ResourceRegistry::ProcessUnreferenced(Resource& resource, const UnreferencedFunc& func)
+	{
+		const U64 key = GetResourceKey(resource.GetType(), resource.GetPath());
+		Shard& shard = GetShard(key);
+		Concurrency::ScopedWriteLock lock(shard.mLock);
+
+		// resource is acquired again before locked
+		if (resource.GetRefCount() > 0) {
+			return false;
+		}
+
+		Resource** it = shard.mResources.find(key);
+		if (it == nullptr || *it != &resource) {
+			return false;
+		}
+
+		if (func(resource)) {
+			shard.mResources.erase(key);
+		}
+		return true;
+	}
+
+	U32 ResourceRegistry::GetResourceCount() const
+	{
+		U32 count = 0;
+		for (U32 i = 0; i < mShardCount; i++)
+		{
+			Concurrency::ScopedReadLock lock(mShards[i].mLock);
+			count += mShards[i].mResources.size();
+		}
+		return count;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "resource.h"
+#include "core\container\hashMap.h"
+#include "core\helper\function.h"
+
+namespace Cjing3D
+{
+	/// //////////////////////////////////////////////////////////////////////////////////////////////////
+	/// ResourceRegistry
+	/// Concurrent table of registered resources keyed by (type, path hash). The table is split into
+	/// shards guarded by their own RWLock, so that loads of different resources rarely contend.
+	/// Resources are only unregistered while they are unreferenced and the shard is locked for writing,
+	/// reclamation of unregistered resources is deferred to the owner.
+	class ResourceRegistry
+	{
+	public:
+		static const U32 DEFAULT_SHARD_COUNT = 64;
+
+		using CreateFunc = Function<Resource*()>;
+		// called with the shard locked, return true to unregister the resource
+		using UnreferencedFunc = Function<bool(Resource& resource)>;
+
+		explicit ResourceRegistry(U32 shardCount = DEFAULT_SHARD_COUNT);
+		~ResourceRegistry();
+
+		// find the resource and acquire a reference, isRevived is true if
+		// the resource was unreferenced before acquired
+		Resource* Acquire(ResourceType type, const Path& path, bool* isRevived = nullptr);
+		// acquire the resource or create and register it atomically
+		Resource* AcquireOrCreate(ResourceType type, const Path& path, const CreateFunc& createFunc, bool* isRevived = nullptr);
+		// call func if the resource is still unreferenced when the shard is locked
+		bool ProcessUnreferenced(Resource& resource, const UnreferencedFunc& func);
+
+		U32 GetShardCount()const { return mShardCount; }
+		U32 GetResourceCount()const;
+
+	private:
+		struct Shard
+		{
+			Concurrency::RWLock mLock;
+			HashMap<U64, Resource*> mResources;
+		};
+
+		static U64 GetResourceKey(ResourceType type, const Path& path)
+		{
+			return ((U64)type.Type() << 32) | (U64)path.GetHash();
+		}
+
+		Shard& GetShard(U64 key)const
+		{
+			return mShards[(U32)(key ^ (key >> 32)) % mShardCount];
+		}
+
+		U32 mShardCount = 0;
+		Shard* mShards = nullptr;
+	};
+}
@@ -7,6 +7,10 @@
 #include "core\platform\platform.h"
 #include "core\filesystem\filesystem.h"
 #include "core\filesystem\filesystem_physfs.h"
+#include "core\filesystem\filesystem_generic.h"
+#include "core\filesystem\filesystem_pack.h"
+#include "resource\fileIOBackend.h"
+#include "resource\resourceRegistry.h"
 #include "core\concurrency\jobsystem.h"
 #include "core\helper\timer.h"
 #include "core\plugin\pluginManager.h"
@@ -129,6 +133,238 @@ TEST_CASE("file io write", "[resource]")
 	} while (!handle.IsComplete());
 }
 
+TEST_CASE("file io backend batch read", "[resource]")
+{
+	const I32 fileCount = 512;
+	const U32 fileSize = 128 * 1024;
+	const char* packPath = "io_test.pak";
+
+	FileSystemGeneric fileSystem(".");
+	{
+		DynamicArray<U8> data;
+		data.resize(fileSize);
+		PackFileBuilder builder;
+		for (I32 i = 0; i < fileCount; i++)
+		{
+			for (U32 j = 0; j < fileSize; j++) {
+				data[j] = (U8)(i * 31 + j * 7);
+			}
+			StaticString<64> path;
+			sprintf_s(path.data(), path.size(), "io_test/%d.bin", i);
+			builder.AddFile(path.c_str(), data.data(), data.size(), false);
+		}
+		REQUIRE(builder.Build(fileSystem, packPath));
+	}
+
+	// sequential reads on the calling thread
+	F64 sequentialTime = 0.0;
+	{
+		FileSystemPack pack(packPath);
+		REQUIRE(pack.IsValid());
+
+		F64 startTime = Timer::GetAbsoluteTime();
+		DynamicArray<char> data;
+		for (I32 i = 0; i < fileCount; i++)
+		{
+			StaticString<64> path;
+			sprintf_s(path.data(), path.size(), "io_test/%d.bin", i);
+			REQUIRE(pack.ReadFile(path.c_str(), data));
+		}
+		sequentialTime = Timer::GetAbsoluteTime() - startTime;
+	}
+
+	// batched reads by io backend, remap the pack so that pages are faulted in again
+	F64 backendTime = 0.0;
+	FileIOBackend::Stats stats;
+	{
+		FileSystemPack pack(packPath);
+		REQUIRE(pack.IsValid());
+
+		volatile I32 succeedCount = 0;
+		F64 startTime = Timer::GetAbsoluteTime();
+		{
+			FileIOBackend backend(pack, 4);
+			for (I32 i = 0; i < fileCount; i++)
+			{
+				StaticString<64> path;
+				sprintf_s(path.data(), path.size(), "io_test/%d.bin", i);
+				backend.Read(path.c_str(), IOPriority::NORMAL, [&succeedCount](bool success, DynamicArray<char>& data) {
+					if (success) {
+						Concurrency::AtomicIncrement(&succeedCount);
+					}
+				});
+			}
+			backend.Flush();
+			stats = backend.GetStats();
+		}
+		backendTime = Timer::GetAbsoluteTime() - startTime;
+		REQUIRE(succeedCount == fileCount);
+	}
+
+	Logger::Print("Read %d files, %d bytes per file", fileCount, fileSize);
+	Logger::Print("\tSequential: %f ms", sequentialTime * 1000.0);
+	Logger::Print("\tBackend:    %f ms, batches:%lld prefetch ranges:%lld", backendTime * 1000.0, stats.mBatchCount, stats.mPrefetchRanges);
+
+	fileSystem.DeleteFile(packPath);
+}
+
+TEST_CASE("file io backend pending requests", "[resource]")
+{
+	// more requests than io threads could take at once, flush should wait for all of them
+	const I32 requestCount = 5000;
+	const char* path = "io_pending_test.txt";
+	const String text = "I wanna to be a guy!";
+
+	FileSystemGeneric fileSystem(".");
+	REQUIRE(fileSystem.WriteFile(path, text.data(), text.length()));
+
+	volatile I32 succeedCount = 0;
+	{
+		FileIOBackend backend(fileSystem, 4);
+		for (I32 i = 0; i < requestCount; i++)
+		{
+			backend.Read(path, (IOPriority)(i % (I32)IOPriority::COUNT), [&succeedCount, &text](bool success, DynamicArray<char>& data) {
+				if (success && data.size() == text.length()) {
+					Concurrency::AtomicIncrement(&succeedCount);
+				}
+			});
+		}
+		backend.Flush();
+		REQUIRE(backend.GetPendingCount() == 0);
+		REQUIRE(succeedCount == requestCount);
+	}
+
+	fileSystem.DeleteFile(path);
+}
+
+namespace
+{
+	F64 RunRegistryContention(U32 shardCount, const DynamicArray<Path>& paths, I32 threadCount, I32 loopCount)
+	{
+		ResourceRegistry registry(shardCount);
+		volatile I32 createdCount = 0;
+
+		auto threadFunc = [&](void* data) {
+			const I32 threadIndex = (I32)(intptr_t)data;
+			for (I32 loop = 0; loop < loopCount; loop++)
+			{
+				for (I32 i = threadIndex; i < paths.size(); i += threadCount)
+				{
+					// threads touch overlapped handles by offsetting the index
+					const Path& path = paths[(i + loop * 7919) % paths.size()];
+					Resource* res = registry.AcquireOrCreate(TestRes::ResType, path, [&createdCount]() {
+						Concurrency::AtomicIncrement(&createdCount);
+						return CJING_NEW(TestRes)();
+					});
+					// keep unreferenced resources registered like the lru cache,
+					// the release still takes the shard write lock
+					if (res->SubRefCount() == 0)
+					{
+						registry.ProcessUnreferenced(*res, [](Resource& unreferenced) {
+							return false;
+						});
+					}
+				}
+			}
+			return 0;
+		};
+
+		F64 startTime = Timer::GetAbsoluteTime();
+		DynamicArray<Concurrency::Thread*> threads;
+		for (I32 i = 0; i < threadCount; i++) {
+			threads.push(CJING_NEW(Concurrency::Thread)(threadFunc, (void*)(intptr_t)i, 65536, "RegistryTest"));
+		}
+		for (auto thread : threads)
+		{
+			thread->Join();
+			CJING_DELETE(thread);
+		}
+		F64 time = Timer::GetAbsoluteTime() - startTime;
+		REQUIRE(createdCount == paths.size());
+		REQUIRE(registry.GetResourceCount() == paths.size());
+
+		// unregister and reclaim all resources
+		for (const Path& path : paths)
+		{
+			Resource* res = registry.Acquire(TestRes::ResType, path);
+			res->SubRefCount();
+			registry.ProcessUnreferenced(*res, [](Resource& unreferenced) {
+				return true;
+			});
+			CJING_DELETE(res);
+		}
+		return time;
+	}
+}
+
+TEST_CASE("file io backend priority", "[resource]")
+{
+	// the only io thread is blocked by the first request, so that queued requests could be reordered
+	const char* path = "io_priority_test.txt";
+	const String text = "I wanna to be a guy!";
+
+	FileSystemGeneric fileSystem(".");
+	REQUIRE(fileSystem.WriteFile(path, text.data(), text.length()));
+
+	const I32 requestCount = 8;
+	volatile I32 isBlocked = 1;
+	DynamicArray<I32> order;
+	{
+		FileIOBackend backend(fileSystem, 1);
+		backend.Read(path, IOPriority::NORMAL, [&isBlocked](bool success, DynamicArray<char>& data) {
+			while (isBlocked) {
+				Concurrency::YieldCPU();
+			}
+		});
+
+		DynamicArray<FileIOBackend::RequestHandle> handles;
+		for (I32 i = 0; i < requestCount; i++)
+		{
+			handles.push(backend.Read(path, IOPriority::LOW, [i, &order](bool success, DynamicArray<char>& data) {
+				order.push(i);
+			}));
+		}
+
+		// the last request is read before all other low requests
+		REQUIRE(backend.SetPriority(handles.back(), IOPriority::HIGH));
+		isBlocked = 0;
+		backend.Flush();
+		REQUIRE(!backend.SetPriority(handles.back(), IOPriority::LOW));
+	}
+
+	REQUIRE(order.size() == requestCount);
+	REQUIRE(order[0] == requestCount - 1);
+	for (I32 i = 1; i < requestCount; i++) {
+		REQUIRE(order[i] == i - 1);
+	}
+
+	fileSystem.DeleteFile(path);
+}
+
+TEST_CASE("resource registry contention", "[resource]")
+{
+	const I32 handleCount = 100000;
+	const I32 threadCount = 16;
+	const I32 loopCount = 4;
+
+	DynamicArray<Path> paths;
+	paths.reserve(handleCount);
+	for (I32 i = 0; i < handleCount; i++)
+	{
+		StaticString<64> path;
+		sprintf_s(path.data(), path.size(), "registry/%d.res", i);
+		paths.push(Path(path.c_str()));
+	}
+
+	F64 globalLockTime = RunRegistryContention(1, paths, threadCount, loopCount);
+	F64 shardedTime = RunRegistryContention(ResourceRegistry::DEFAULT_SHARD_COUNT, paths, threadCount, loopCount);
+
+	const I32 opCount = handleCount * loopCount;
+	Logger::Print("Resource registry %d threads, %d acquire/release", threadCount, opCount);
+	Logger::Print("\tSingle lock: %f ms", globalLockTime * 1000.0);
+	Logger::Print("\tSharded:     %f ms", shardedTime * 1000.0);
+}
+
 int main(int argc, char* argv[])
 {
 	PluginManager::Initialize();